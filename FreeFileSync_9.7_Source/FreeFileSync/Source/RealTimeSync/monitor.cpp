@@ -7,17 +7,23 @@
 #include "monitor.h"
 #include <ctime>
 #include <set>
+#include <map>
 #include <zen/file_access.h>
 #include <zen/dir_watcher.h>
 #include <zen/thread.h>
 //#include <zen/tick_count.h>
 #include <zen/basic_math.h>
+#include <zen/scope_guard.h>
 #include <wx/utils.h>
 #include "../lib/resolve_path.h"
+#include "../lib/ffs_paths.h"
+#include "../lib/change_list.h"
 //#include "../library/db_file.h"     //SYNC_DB_FILE_ENDING -> complete file too much of a dependency; file ending too little to decouple into single header
 //#include "../library/lock_holder.h" //LOCK_FILE_ENDING
 //TEMP_FILE_ENDING
 
+    #include <unistd.h> //getpid
+
 using namespace zen;
 
 
@@ -25,6 +31,9 @@ namespace
 {
 const int FOLDER_EXISTENCE_CHECK_INTERVAL_SEC = 1; //unit: [s]
 
+//keep DirWatchers alive between command invocations: change list must not miss any changes!
+using FolderWatches = std::map<Zstring, std::shared_ptr<DirWatcher>, LessFilePath>;
+
 
 std::vector<Zstring> getFormattedDirs(const std::vector<Zstring>& folderPathPhrases) //throw FileError
 {
@@ -67,7 +76,31 @@ struct WaitResult
 };
 
 
+//extract accumulated changes of a watched folder, except for those of FreeFileSync's own files
+std::vector<DirWatcher::Entry> getChanges(DirWatcher& watcher, const std::function<void()>& onRefreshGui) //throw FileError
+{
+    std::vector<DirWatcher::Entry> changedItems = watcher.getChanges(onRefreshGui); //throw FileError
+
+    //remove to be ignored changes
+    erase_if(changedItems, [](const DirWatcher::Entry& e) { return isIgnoredChange(e.filepath_); });
+    //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
+    return changedItems;
+}
+
+
+void addToChangeList(const std::vector<DirWatcher::Entry>& changedItems, const Zstring& folderPath, std::set<Zstring, LessFilePath>& changedItemPaths)
+{
+    for (const DirWatcher::Entry& e : changedItems)
+        if (contains(e.filepath_, Zstr('\n'))) //can't be represented in change list file
+            changedItemPaths.insert(folderPath);
+        else
+            changedItemPaths.insert(e.filepath_);
+}
+
+
 WaitResult waitForChanges(const std::vector<Zstring>& folderPathPhrases, //throw FileError
+                          FolderWatches& watches, //in/out
+                          std::set<Zstring, LessFilePath>& changedItemPaths, //in/out: all changes, including those not worth a WaitResult
                           const std::function<void(bool readyForSync)>& onRefreshGui)
 {
     const std::vector<Zstring> folderPaths = getFormattedDirs(folderPathPhrases); //throw FileError
@@ -75,10 +108,18 @@ WaitResult waitForChanges(const std::vector<Zstring>& folderPathPhrases, //throw
         throw FileError(_("A folder input field is empty.")); //should have been checked by caller!
 
     //detect when volumes are removed/are not available anymore
-    std::vector<std::pair<Zstring, std::shared_ptr<DirWatcher>>> watches;
+    FolderWatches watchesOld;
+    watchesOld.swap(watches); //support volume names resolving to a different path
 
     for (const Zstring& folderPath : folderPaths)
     {
+        auto itOld = watchesOld.find(folderPath);
+        if (itOld != watchesOld.end())
+        {
+            watches.insert(*itOld);
+            continue;
+        }
+
         try
         {
             //a non-existent network path may block, so check existence asynchronously!
@@ -90,7 +131,8 @@ WaitResult waitForChanges(const std::vector<Zstring>& folderPathPhrases, //throw
             if (!ftDirAvailable.get()) //folder not existing or can't access
                 return WaitResult(folderPath);
 
-            watches.emplace_back(folderPath, std::make_shared<DirWatcher>(folderPath)); //throw FileError
+            watches.emplace(folderPath, std::make_shared<DirWatcher>(folderPath)); //throw FileError
+            changedItemPaths.insert(folderPath); //changes before the watch was installed are unknown
         }
         catch (FileError&)
         {
@@ -124,20 +166,14 @@ WaitResult waitForChanges(const std::vector<Zstring>& folderPathPhrases, //throw
             //IMPORTANT CHECK: dirwatcher has problems detecting removal of top watched directories!
             if (checkDirNow)
                 if (!dirAvailable(folderPath)) //catch errors related to directory removal, e.g. ERROR_NETNAME_DELETED
+                {
+                    watches.erase(it);
                     return WaitResult(folderPath);
+                }
             try
             {
-                std::vector<DirWatcher::Entry> changedItems = watcher.getChanges([&] { onRefreshGui(false /*readyForSync*/); /*may throw!*/ }); //throw FileError
-
-                //remove to be ignored changes
-                erase_if(changedItems, [](const DirWatcher::Entry& e)
-                {
-                    return
-                        //endsWith(e.filepath_, Zstr(".ffs_tmp"))  ||
-                        endsWith(e.filepath_, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
-                        endsWith(e.filepath_, Zstr(".ffs_db"));     //sync.ffs_db, .sync.tmp.ffs_db
-                    //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
-                });
+                const std::vector<DirWatcher::Entry> changedItems = getChanges(watcher, [&] { onRefreshGui(false /*readyForSync*/); /*may throw!*/ }); //throw FileError
+                addToChangeList(changedItems, folderPath, changedItemPaths);
 
                 if (!changedItems.empty())
                     return WaitResult(changedItems[0]); //directory change detected
@@ -145,7 +181,10 @@ WaitResult waitForChanges(const std::vector<Zstring>& folderPathPhrases, //throw
             catch (FileError&)
             {
                 if (!dirAvailable(folderPath)) //a benign(?) race condition with FileError
+                {
+                    watches.erase(it);
                     return WaitResult(folderPath);
+                }
                 throw;
             }
         }
@@ -210,6 +249,13 @@ wxString toString(DirWatcher::ActionType type)
 }
 
 struct ExecCommandNowException {};
+
+
+//file location is made available to the command line via macro %change_list%
+Zstring getChangeListFilePath()
+{
+    return getConfigDirPathPf() + Zstr("RealTimeSync.") + numberTo<Zstring>(::getpid()) + Zstr(".changes");
+}
 }
 
 
@@ -221,8 +267,14 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, unsi
         return;
     }
 
+    const Zstring changeListFilePath = getChangeListFilePath();
+    ZEN_ON_SCOPE_EXIT(try { removeFilePlain(changeListFilePath); /*throw FileError*/ } catch (FileError&) {});
+
     auto execMonitoring = [&] //throw FileError
     {
+        FolderWatches watches;
+        std::set<Zstring, LessFilePath> changedItemPaths; //since last command invocation completed
+
         callback.setPhase(MonitorCallback::MONITOR_PHASE_WAITING);
         waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { callback.requestUiRefresh(); }); //throw FileError
         callback.setPhase(MonitorCallback::MONITOR_PHASE_ACTIVE);
@@ -238,7 +290,7 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, unsi
                 for (;;) //loop over detected changes
                 {
                     //wait for changes (and for all directories to become available)
-                    WaitResult res = waitForChanges(folderPathPhrases, [&](bool readyForSync) //throw FileError, ExecCommandNowException
+                    WaitResult res = waitForChanges(folderPathPhrases, watches, changedItemPaths, [&](bool readyForSync) //throw FileError, ExecCommandNowException
                     {
                         if (readyForSync)
                             if (nextExecDate <= std::time(nullptr))
@@ -265,9 +317,49 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, unsi
             ::wxSetEnv(L"change_path", utfTo<wxString>(lastChangeDetected.filepath_)); //some way to output what file changed to the user
             ::wxSetEnv(L"change_action", toString(lastChangeDetected.action_)); //
 
+            //complete list of changes for FreeFileSync's incremental comparison: FreeFileSync <job>.ffs_batch -ChangeList "%change_list%"
+            bool changeListSaved = false;
+            {
+                ChangeList changeList;
+                for (const auto& w : watches)
+                    changeList.watchedFolderPaths.push_back(w.first);
+
+                if (changedItemPaths.size() > CHANGE_LIST_SIZE_MAX) //=> full comparison
+                    changedItemPaths = std::set<Zstring, LessFilePath>(changeList.watchedFolderPaths.begin(), changeList.watchedFolderPaths.end());
+
+                changeList.changedItemPaths.assign(changedItemPaths.begin(), changedItemPaths.end());
+                try
+                {
+                    saveChangeList(changeList, changeListFilePath); //throw FileError
+                    ::wxSetEnv(L"change_list", utfTo<wxString>(changeListFilePath));
+                    changeListSaved = true;
+                }
+                catch (FileError&) { ::wxUnsetEnv(L"change_list"); } //not critical: FreeFileSync falls back to a full comparison
+            }
+
             //execute command
             callback.executeExternalCommand();
             nextExecDate = std::numeric_limits<time_t>::max();
+
+            //keep all changes until FreeFileSync confirms a completed run (not: crashed, killed, command doesn't use %change_list%, ...)
+            //=> FreeFileSync writes back the items it did not synchronize (conflicts, errors, ...): keep them in the change list until a run does
+            if (changeListSaved)
+                try
+                {
+                    const ChangeList changeListOut = loadChangeList(changeListFilePath); //throw FileError
+                    if (changeListOut.completed)
+                        changedItemPaths = std::set<Zstring, LessFilePath>(changeListOut.unresolvedItemPaths.begin(), changeListOut.unresolvedItemPaths.end());
+                }
+                catch (FileError&) {} //keep all changes
+
+            //changes while the command was running don't trigger another execution, but still need to be in the next change list
+            for (auto it = watches.begin(); it != watches.end();)
+                try
+                {
+                    addToChangeList(getChanges(*it->second, [&] { callback.requestUiRefresh(); }), it->first, changedItemPaths); //throw FileError
+                    ++it;
+                }
+                catch (FileError&) { it = watches.erase(it); } //=> watch is re-installed and folder reported as changed
         }
     };
 
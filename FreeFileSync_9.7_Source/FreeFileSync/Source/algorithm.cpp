@@ -187,6 +187,44 @@ bool zen::allElementsEqual(const FolderComparison& folderCmp)
     return std::all_of(begin(folderCmp), end(folderCmp), [](const BaseFolderPair& baseFolder) { return allItemsCategoryEqual(baseFolder); });
 }
 
+
+namespace
+{
+void addNativeItemPaths(const FileSystemObject& fsObj, std::vector<Zstring>& itemPaths)
+{
+    if (Opt<Zstring> itemPath = AFS::getNativeItemPath(fsObj.getAbstractPath<LEFT_SIDE>()))
+        itemPaths.push_back(*itemPath);
+    if (Opt<Zstring> itemPath = AFS::getNativeItemPath(fsObj.getAbstractPath<RIGHT_SIDE>()))
+        itemPaths.push_back(*itemPath);
+}
+
+
+void collectOutOfSyncItems(const ContainerObject& hierObj, std::vector<Zstring>& itemPaths)
+{
+    for (const FilePair& file : hierObj.refSubFiles())
+        if (!file.isPairEmpty() && file.getCategory() != FILE_EQUAL)
+            addNativeItemPaths(file, itemPaths);
+
+    for (const SymlinkPair& link : hierObj.refSubLinks())
+        if (!link.isPairEmpty() && link.getLinkCategory() != SYMLINK_EQUAL)
+            addNativeItemPaths(link, itemPaths);
+
+    for (const FolderPair& folder : hierObj.refSubFolders())
+        if (!folder.isPairEmpty() && folder.getDirCategory() != DIR_EQUAL)
+            addNativeItemPaths(folder, itemPaths); //=> folder is read completely
+        else
+            collectOutOfSyncItems(folder, itemPaths);
+}
+}
+
+
+std::vector<Zstring> zen::getOutOfSyncItemPaths(const FolderComparison& folderCmp)
+{
+    std::vector<Zstring> itemPaths;
+    std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder) { collectOutOfSyncItems(baseFolder, itemPaths); });
+    return itemPaths;
+}
+
 //---------------------------------------------------------------------------------------------------------------
 
 namespace
@@ -679,7 +717,7 @@ void zen::redetermineSyncDirection(const DirectionConfig& dirCfg, //throw FileEr
     Opt<FileError> dbLoadError; //defer until after default directions have been set!
 
     //try to load sync-database files
-    std::shared_ptr<InSyncFolder> lastSyncState;
+    std::shared_ptr<const InSyncFolder> lastSyncState;
     if (dirCfg.var == DirectionConfig::TWO_WAY || detectMovedFilesEnabled(dirCfg))
         try
         {
@@ -10,7 +10,7 @@
 #include <functional>
 #include "file_hierarchy.h"
 #include "lib/soft_filter.h"
-#include "lib/process_xml.h"
+#include "lib/optional_dialogs.h"
 #include "process_callback.h"
 
 
@@ -32,6 +32,9 @@ void setSyncDirectionRec(SyncDirection newDirection, FileSystemObject& fsObj); /
 
 bool allElementsEqual(const FolderComparison& folderCmp);
 
+//native paths of items still not in sync, e.g. after synchronization: conflicts, errors, excluded rows => incremental comparison must read them again
+std::vector<Zstring> getOutOfSyncItemPaths(const FolderComparison& folderCmp);
+
 //filtering
 void applyFiltering  (FolderComparison& folderCmp, const MainConfiguration& mainCfg); //full filter apply
 void addHardFiltering(BaseFolderPair& baseFolder, const Zstring& excludeFilter);     //exclude additional entries only
@@ -8,6 +8,7 @@
 #include <memory>
 #include <zen/file_access.h>
 #include <zen/perf.h>
+#include <zen/time.h>
 #include <wx/tooltip.h>
 #include <wx/log.h>
 #include <wx+/app_main.h>
@@ -22,6 +23,12 @@
 #include "lib/process_xml.h"
 #include "lib/error_log.h"
 #include "lib/resolve_path.h"
+#include "lib/change_list.h"
+#include "lib/batch_daemon.h"
+#include "lib/sync_pipeline.h"
+#include "lib/db_file.h"
+#include "lib/ffs_paths.h"
+#include "fs/concrete.h"
 
     #include <gtk/gtk.h>
 
@@ -45,6 +52,10 @@ std::vector<Zstring> getCommandlineArgs(const wxApp& app)
 }
 
 const wxEventType EVENT_ENTER_EVENT_LOOP = wxNewEventType();
+
+
+//local socket to control a running daemon
+Zstring getDaemonSocketPath() { return getConfigDirPathPf() + Zstr("FreeFileSync.daemon"); }
 }
 
 //##################################################################################################################
@@ -134,7 +145,8 @@ void Application::onQueryEndSession(wxEvent& event)
 
 void runGuiMode  (const Zstring& globalConfigFile);
 void runGuiMode  (const Zstring& globalConfigFile, const XmlGuiConfig& guiCfg, const std::vector<Zstring>& cfgFilePaths, bool startComparison);
-void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, FfsReturnCode& returnCode);
+void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, const Zstring& changeListFilePath, FfsReturnCode& returnCode);
+void runDaemonMode(const Zstring& globalConfigFile, const std::vector<Zstring>& cfgFilePaths, int runIntervalMin, FfsReturnCode& returnCode);
 void showSyntaxHelp();
 
 
@@ -159,7 +171,10 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
     std::vector<std::pair<Zstring, Zstring>> dirPathPhrasePairs;
     std::vector<std::pair<Zstring, XmlType>> configFiles; //XmlType: batch or GUI files only
     Zstring globalConfigFile;
+    Zstring changeListFilePath; //optional: compare incrementally (batch mode only)
     bool openForEdit = false;
+    bool runDaemon = false;
+    int daemonRunIntervalMin = 0; //0: run on demand only
     {
         std::vector<Zstring> dirPathPhrasesLeft;  //TODO: remove migration code at some time! 2017-12-14
         std::vector<Zstring> dirPathPhrasesRight; //
@@ -169,6 +184,8 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
         const Zchar optionRightDir[] = Zstr("-rightdir"); //
         const Zchar optionDirPair [] = Zstr("-dirpair");
         const Zchar optionSendTo  [] = Zstr("-sendto"); //remaining arguments are unspecified number of folder paths; wonky syntax; let's keep it undocumented
+        const Zchar optionChangeList[] = Zstr("-changelist"); //file written by RealTimeSync, see %change_list%
+        const Zchar optionDaemon  [] = Zstr("-daemon"); //keep running: execute batch jobs on schedule or on demand
 
         auto syntaxHelpRequested = [&](const Zstring& arg)
         {
@@ -188,6 +205,8 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
                    strEqual(arg, optionRightDir, CmpAsciiNoCase()) ||
                    strEqual(arg, optionDirPair,  CmpAsciiNoCase()) ||
                    strEqual(arg, optionSendTo,   CmpAsciiNoCase()) ||
+                   strEqual(arg, optionChangeList, CmpAsciiNoCase()) ||
+                   strEqual(arg, optionDaemon,   CmpAsciiNoCase()) ||
                    syntaxHelpRequested(arg);
         };
 
@@ -230,6 +249,26 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
                 }
                 dirPathPhrasePairs.back().second = *it;
             }
+            else if (strEqual(*it, optionChangeList, CmpAsciiNoCase()))
+            {
+                if (++it == commandArgs.end() || isCommandLineOption(*it))
+                {
+                    notifyFatalError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionChangeList)), _("Syntax error"));
+                    return;
+                }
+                changeListFilePath = *it;
+            }
+            else if (strEqual(*it, optionDaemon, CmpAsciiNoCase()))
+            {
+                if (++it == commandArgs.end() || isCommandLineOption(*it) ||
+                    !std::all_of(it->begin(), it->end(), [](Zchar c) { return isDigit(c); }))
+                {
+                    notifyFatalError(replaceCpy(_("A time interval in minutes is expected after %x."), L"%x", utfTo<std::wstring>(optionDaemon)), _("Syntax error"));
+                    return;
+                }
+                runDaemon = true;
+                daemonRunIntervalMin = stringTo<int>(*it);
+            }
             else if (strEqual(*it, optionSendTo, CmpAsciiNoCase()))
             {
                 for (size_t i = 0; ; ++i)
@@ -358,7 +397,26 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
     //---------------------------
     const Zstring globalConfigFilePath = !globalConfigFile.empty() ? globalConfigFile : xmlAccess::getGlobalConfigFile();
 
-    if (configFiles.empty())
+    if (runDaemon)
+    {
+        if (configFiles.empty() || std::any_of(configFiles.begin(), configFiles.end(), [](const std::pair<Zstring, XmlType>& item) { return item.second != XML_TYPE_BATCH; }))
+        {
+            notifyFatalError(_("Daemon mode requires one or more batch configuration files (*.ffs_batch)."), _("Syntax error"));
+            return;
+        }
+        if (!dirPathPhrasePairs.empty() || openForEdit || !changeListFilePath.empty())
+        {
+            notifyFatalError(_("Directories, -Edit and -ChangeList cannot be used in daemon mode."), _("Syntax error"));
+            return;
+        }
+
+        std::vector<Zstring> filepaths;
+        for (const auto& item : configFiles)
+            filepaths.push_back(item.first);
+
+        runDaemonMode(globalConfigFilePath, filepaths, daemonRunIntervalMin, returnCode_);
+    }
+    else if (configFiles.empty())
     {
         //gui mode: default startup
         if (dirPathPhrasePairs.empty())
@@ -397,7 +455,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
             }
             if (!replaceDirectories(batchCfg.mainCfg))
                 return;
-            runBatchMode(globalConfigFilePath, batchCfg, filepath, returnCode_);
+            runBatchMode(globalConfigFilePath, batchCfg, filepath, changeListFilePath, returnCode_);
         }
         //GUI mode: single config (ffs_gui *or* ffs_batch)
         else
@@ -479,6 +537,8 @@ void showSyntaxHelp()
                                                  L"    [" + _("config files:") + L" *.ffs_gui/*.ffs_batch]" + L"\n" +
                                                  L"    [-DirPair " + _("directory") + L" " + _("directory") + L"]" + L"\n" +
                                                  L"    [-Edit]" + L"\n" +
+                                                 L"    [-ChangeList " + _("file") + L"]" + L"\n" +
+                                                 L"    [-Daemon " + _("minutes") + L"]" + L"\n" +
                                                  L"    [" + _("global config file:") + L" GlobalSettings.xml]" + L"\n" +
                                                  L"\n" +
 
@@ -491,26 +551,23 @@ void showSyntaxHelp()
                                                  L"-Edit" + L"\n" +
                                                  _("Open the selected configuration for editing only without executing it.") + L"\n\n" +
 
+                                                 L"-ChangeList " + _("file") + L"\n" +
+                                                 _("Batch mode: compare only folders with changes detected by RealTimeSync (%change_list%).") + L"\n\n" +
+
+                                                 L"-Daemon " + _("minutes") + L"\n" +
+                                                 _("Keep running and execute the batch jobs in the given interval (0: on demand only). Changed folders are detected between runs for incremental comparison.") + L"\n" +
+                                                 replaceCpy(_("Run jobs on demand by sending \"run [job name]\", \"status\" or \"quit\" to socket %x."), L"%x", fmtPath(getDaemonSocketPath())) + L"\n\n" +
+
                                                  _("global config file:") + L"\n" +
                                                  _("Path to an alternate GlobalSettings.xml file.")));
 }
 
 
-void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, FfsReturnCode& returnCode)
+namespace
+{
+//return "false" on fatal error
+bool readGlobalSettings(const Zstring& globalConfigFilePath, XmlGlobalSettings& globalCfg, const std::function<void(const std::wstring& msg, FfsReturnCode rc)>& notifyError)
 {
-    const bool showPopupAllowed = !batchCfg.mainCfg.ignoreErrors && batchCfg.batchExCfg.batchErrorDialog == BatchErrorDialog::SHOW;
-
-    auto notifyError = [&](const std::wstring& msg, FfsReturnCode rc)
-    {
-        if (showPopupAllowed)
-            showNotificationDialog(nullptr, DialogInfoType::ERROR2, PopupDialogCfg().setDetailInstructions(msg));
-        else //"exit" or "ignore"
-            logFatalError(utfTo<std::string>(msg));
-
-        raiseReturnCode(returnCode, rc);
-    };
-
-    XmlGlobalSettings globalCfg;
     try
     {
         std::wstring warningMsg;
@@ -521,7 +578,10 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
     catch (const FileError& e)
     {
         if (!itemNotExisting(globalConfigFilePath)) //existing or access error
-            return notifyError(e.toString(), FFS_RC_ABORTED); //abort sync!
+        {
+            notifyError(e.toString(), FFS_RC_ABORTED); //abort sync!
+            return false;
+        }
     }
 
     try
@@ -533,13 +593,30 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
         notifyError(e.toString(), FFS_RC_FINISHED_WITH_WARNINGS);
         //continue!
     }
+    return true;
+}
 
-    //all settings have been read successfully...
 
-    //regular check for program updates -> disabled for batch
-    //if (batchCfg.showProgress && manualProgramUpdateRequired())
-    //    checkForUpdatePeriodically(globalCfg.lastUpdateCheck);
-    //WinInet not working when FFS is running as a service!!! https://support.microsoft.com/en-us/kb/238425
+void writeGlobalSettings(const Zstring& globalConfigFilePath, const XmlGlobalSettings& globalCfg, const std::function<void(const std::wstring& msg, FfsReturnCode rc)>& notifyError)
+{
+    try //save global settings to XML: e.g. ignored warnings
+    {
+        xmlAccess::writeConfig(globalCfg, globalConfigFilePath); //FileError
+    }
+    catch (const FileError& e)
+    {
+        notifyError(e.toString(), FFS_RC_FINISHED_WITH_WARNINGS);
+    }
+}
+
+
+//compare and synchronize: getChangeList() is evaluated after the status handler was created
+void runBatchJob(XmlGlobalSettings& globalCfg, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, //throw BatchRequestSwitchToMainDialog
+                 const std::function<Opt<ChangeList>(ProcessCallback& callback)>& getChangeList,
+                 Opt<std::vector<Zstring>>& outOfSyncItemPaths, //out: set if synchronization has completed, see getOutOfSyncItemPaths()
+                 FfsReturnCode& returnCode)
+{
+    const bool showPopupAllowed = !batchCfg.mainCfg.ignoreErrors && batchCfg.batchExCfg.batchErrorDialog == BatchErrorDialog::SHOW;
 
     try //begin of synchronization process (all in one try-catch block)
     {
@@ -560,64 +637,361 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
                                          returnCode,
                                          batchCfg.mainCfg.postSyncCommand,
                                          batchCfg.mainCfg.postSyncCondition,
-                                         batchCfg.batchExCfg.postSyncAction);
+                                         batchCfg.batchExCfg.postSyncAction,
+                                         batchCfg.batchExCfg.saveIoStatistics);
 
         logNonDefaultSettings(globalCfg, statusHandler); //inform about (important) non-default global settings
 
-        const std::vector<FolderPairCfg> cmpConfig = extractCompareCfg(batchCfg.mainCfg);
-
-        //batch mode: place directory locks on directories during both comparison AND synchronization
-        std::unique_ptr<LockHolder> dirLocks;
-
-        //COMPARE DIRECTORIES
-        FolderComparison cmpResult = compare(globalCfg.optDialogs,
-                                             globalCfg.fileTimeTolerance,
-                                             showPopupAllowed, //allowUserInteraction
-                                             globalCfg.runWithBackgroundPriority,
-                                             globalCfg.folderAccessTimeout,
-                                             globalCfg.createLockFile,
-                                             dirLocks,
-                                             cmpConfig,
-                                             statusHandler); //throw ?
-
-        //START SYNCHRONIZATION
-        const std::vector<FolderPairSyncCfg> syncProcessCfg = extractSyncCfg(batchCfg.mainCfg);
-        if (syncProcessCfg.size() != cmpResult.size())
-            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ":" + numberTo<std::string>(__LINE__));
-
-        synchronize(batchStartTime,
-                    globalCfg.verifyFileCopy,
-                    globalCfg.copyLockedFiles,
-                    globalCfg.copyFilePermissions,
-                    globalCfg.failSafeFileCopy,
-                    globalCfg.runWithBackgroundPriority,
-                    globalCfg.folderAccessTimeout,
-                    syncProcessCfg,
-                    cmpResult,
-                    globalCfg.optDialogs,
-                    statusHandler); //throw ?
-
-        //not cancelled? => update last sync date for the selected cfg file
-        for (xmlAccess::ConfigFileItem& cfi : globalCfg.gui.mainDlg.cfgFileHistory)
-            if (equalFilePath(cfi.filePath, cfgFilePath))
+        if (batchCfg.batchExCfg.cleanupVersionsOnly) //clean-up scheduled separately: no comparison, no sync
+            limitVersions(extractSyncCfg(batchCfg.mainCfg), globalCfg.syncThreadsPerFolderPair, statusHandler); //throw X
+        else
+        {
+            const Opt<ChangeList> changeList = getChangeList(statusHandler); //throw X
+
+            if (globalCfg.syncPipelineFolderPairs) //synchronize each folder pair as soon as it is compared
+                outOfSyncItemPaths = compareAndSynchronize(batchStartTime,
+                                                           globalCfg,
+                                                           showPopupAllowed, //allowUserInteraction
+                                                           changeList.get(),
+                                                           batchCfg.mainCfg,
+                                                           statusHandler); //throw ?
+            else
             {
-                cfi.lastSyncTime = std::time(nullptr);
-                break;
+                const std::vector<FolderPairCfg> cmpConfig = extractCompareCfg(batchCfg.mainCfg);
+
+                //batch mode: place directory locks on directories during both comparison AND synchronization
+                std::unique_ptr<LockHolder> dirLocks;
+
+                //COMPARE DIRECTORIES
+                FolderComparison cmpResult = compare(globalCfg.optDialogs,
+                                                     globalCfg.fileTimeTolerance,
+                                                     showPopupAllowed, //allowUserInteraction
+                                                     globalCfg.runWithBackgroundPriority,
+                                                     globalCfg.folderAccessTimeout,
+                                                     globalCfg.traverserThreadsPerFolder,
+                                                     globalCfg.contentCompareThreads,
+                                                     globalCfg.contentCompareSkipUnchanged,
+                                                     changeList.get(),
+                                                     globalCfg.createLockFile,
+                                                     dirLocks,
+                                                     cmpConfig,
+                                                     statusHandler); //throw ?
+
+                //START SYNCHRONIZATION
+                const std::vector<FolderPairSyncCfg> syncProcessCfg = extractSyncCfg(batchCfg.mainCfg);
+                if (syncProcessCfg.size() != cmpResult.size())
+                    throw std::logic_error("Contract violation! " + std::string(__FILE__) + ":" + numberTo<std::string>(__LINE__));
+
+                synchronize(batchStartTime,
+                            globalCfg.verifyFileCopy,
+                            globalCfg.copyLockedFiles,
+                            globalCfg.copyFilePermissions,
+                            globalCfg.failSafeFileCopy,
+                            globalCfg.runWithBackgroundPriority,
+                            globalCfg.folderAccessTimeout,
+                            globalCfg.syncThreadsPerFolderPair,
+                            globalCfg.syncParallelFolderPairs,
+                            syncProcessCfg,
+                            cmpResult,
+                            globalCfg.optDialogs,
+                            statusHandler); //throw ?
+
+                outOfSyncItemPaths = getOutOfSyncItemPaths(cmpResult);
             }
+
+            //not cancelled? => update last sync date for the selected cfg file
+            for (xmlAccess::ConfigFileItem& cfi : globalCfg.gui.mainDlg.cfgFileHistory)
+                if (equalFilePath(cfi.filePath, cfgFilePath))
+                {
+                    cfi.lastSyncTime = std::time(nullptr);
+                    break;
+                }
+        }
     }
     catch (AbortProcess&) {} //exit used by statusHandler
+}
+}
+
+
+void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, const Zstring& changeListFilePath, FfsReturnCode& returnCode)
+{
+    const bool showPopupAllowed = !batchCfg.mainCfg.ignoreErrors && batchCfg.batchExCfg.batchErrorDialog == BatchErrorDialog::SHOW;
+
+    auto notifyError = [&](const std::wstring& msg, FfsReturnCode rc)
+    {
+        if (showPopupAllowed)
+            showNotificationDialog(nullptr, DialogInfoType::ERROR2, PopupDialogCfg().setDetailInstructions(msg));
+        else //"exit" or "ignore"
+            logFatalError(utfTo<std::string>(msg));
+
+        raiseReturnCode(returnCode, rc);
+    };
+
+    XmlGlobalSettings globalCfg;
+    if (!readGlobalSettings(globalConfigFilePath, globalCfg, notifyError))
+        return;
+
+    //all settings have been read successfully...
+
+    //regular check for program updates -> disabled for batch
+    //if (batchCfg.showProgress && manualProgramUpdateRequired())
+    //    checkForUpdatePeriodically(globalCfg.lastUpdateCheck);
+    //WinInet not working when FFS is running as a service!!! https://support.microsoft.com/en-us/kb/238425
+
+    Opt<ChangeList> changeList;
+    Opt<std::vector<Zstring>> outOfSyncItemPaths;
+    FfsReturnCode jobReturnCode = FFS_RC_SUCCESS;
+
+    //hand back items that were not synchronized: RealTimeSync adds them to the next change list
+    auto updateChangeList = [&]
+    {
+        if (!changeList)
+            return;
+
+        ChangeList changeListOut = *changeList;
+        changeListOut.unresolvedItemPaths.clear();
+        changeListOut.completed = true;
+        if (!outOfSyncItemPaths || jobReturnCode != FFS_RC_SUCCESS) //errors, e.g. during traversal: items may be missing from the comparison result
+            changeListOut.unresolvedItemPaths = changeList->changedItemPaths;
+        if (outOfSyncItemPaths)
+            append(changeListOut.unresolvedItemPaths, *outOfSyncItemPaths);
+        try
+        {
+            saveChangeList(changeListOut, changeListFilePath); //throw FileError
+        }
+        catch (const FileError& e) { notifyError(e.toString(), FFS_RC_FINISHED_WITH_WARNINGS); }
+    };
+
+    try
+    {
+        runBatchJob(globalCfg, batchCfg, cfgFilePath, [&](ProcessCallback& callback) -> Opt<ChangeList> //throw BatchRequestSwitchToMainDialog
+        {
+            if (!changeListFilePath.empty())
+                try
+                {
+                    changeList = loadChangeList(changeListFilePath); //throw FileError
+                }
+                catch (const FileError& e) //not critical: compare all folders
+                {
+                    callback.reportInfo(e.toString()); //may throw!
+                }
+            return changeList;
+        }, outOfSyncItemPaths, jobReturnCode);
+    }
     catch (BatchRequestSwitchToMainDialog&)
     {
+        raiseReturnCode(returnCode, jobReturnCode);
+        updateChangeList();
         //open new toplevel window *after* progress dialog is gone => run on main event loop
         return MainDialog::create(globalConfigFilePath, &globalCfg, xmlAccess::convertBatchToGui(batchCfg), { cfgFilePath }, true /*startComparison*/);
     }
+    raiseReturnCode(returnCode, jobReturnCode);
+    updateChangeList();
 
-    try //save global settings to XML: e.g. ignored warnings
+    writeGlobalSettings(globalConfigFilePath, globalCfg, notifyError);
+}
+
+
+namespace
+{
+struct DaemonJob
+{
+    explicit DaemonJob(const Zstring& filePath) : cfgFilePath(filePath), jobName(extractJobName(filePath)) {}
+
+    Zstring cfgFilePath;
+    std::wstring jobName;
+    Opt<FileSignature> cfgFileSignature; //re-read the configuration only after the file has changed
+    XmlBatchConfig batchCfg;
+
+    FolderChangeMonitor changeMonitor;
+    bool lastRunComplete = false; //items that could not be synchronized are missing from the database => compare fully after errors/warnings
+    std::chrono::steady_clock::time_point nextRunTime;
+    std::string lastResult = "not yet run";
+};
+
+
+std::vector<Zstring> getNativeFolderPaths(const MainConfiguration& mainCfg)
+{
+    std::vector<Zstring> folderPaths;
+    auto addFolderPath = [&](const Zstring& folderPathPhrase)
     {
-        xmlAccess::writeConfig(globalCfg, globalConfigFilePath); //FileError
+        if (Opt<Zstring> nativePath = AFS::getNativeItemPath(createAbstractPath(folderPathPhrase))) //directory monitoring is restricted to native paths
+            folderPaths.push_back(*nativePath);
+    };
+
+    addFolderPath(mainCfg.firstPair.folderPathPhraseLeft_);
+    addFolderPath(mainCfg.firstPair.folderPathPhraseRight_);
+    for (const FolderPairEnh& fp : mainCfg.additionalPairs)
+    {
+        addFolderPath(fp.folderPathPhraseLeft_);
+        addFolderPath(fp.folderPathPhraseRight_);
     }
-    catch (const FileError& e)
+    return folderPaths;
+}
+
+
+std::string getReturnCodeName(FfsReturnCode rc)
+{
+    switch (rc)
     {
-        notifyError(e.toString(), FFS_RC_FINISHED_WITH_WARNINGS);
+        case FFS_RC_SUCCESS:
+            return "success";
+        case FFS_RC_FINISHED_WITH_WARNINGS:
+            return "warnings";
+        case FFS_RC_FINISHED_WITH_ERRORS:
+            return "errors";
+        case FFS_RC_ABORTED:
+            return "aborted";
+        case FFS_RC_EXCEPTION:
+            return "exception";
+    }
+    assert(false);
+    return "unknown";
+}
+}
+
+
+void runDaemonMode(const Zstring& globalConfigFilePath, const std::vector<Zstring>& cfgFilePaths, int runIntervalMin, FfsReturnCode& returnCode)
+{
+    auto notifyError = [&](const std::wstring& msg, FfsReturnCode rc)
+    {
+        logFatalError(utfTo<std::string>(msg)); //no user interaction: daemon may run unattended
+        raiseReturnCode(returnCode, rc);
+    };
+
+    XmlGlobalSettings globalCfg; //read once: keep changes made by the jobs, e.g. ignored warnings
+    if (!readGlobalSettings(globalConfigFilePath, globalCfg, notifyError))
+        return;
+
+    std::unique_ptr<DaemonSocket> daemonSocket;
+    try
+    {
+        daemonSocket = std::make_unique<DaemonSocket>(getDaemonSocketPath()); //throw FileError
+    }
+    catch (const FileError& e) { return notifyError(e.toString(), FFS_RC_ABORTED); }
+
+    SyncDatabaseCache dbCache; //keep sync.ffs_db files in memory between runs
+
+    std::vector<DaemonJob> jobs;
+    for (const Zstring& filePath : cfgFilePaths)
+        jobs.emplace_back(filePath);
+
+    const std::chrono::minutes runInterval(runIntervalMin);
+    for (DaemonJob& job : jobs)
+        job.nextRunTime = std::chrono::steady_clock::now(); //start with a full comparison, unless running on demand only
+
+    auto runJob = [&](DaemonJob& job) -> FfsReturnCode
+    {
+        FfsReturnCode jobReturnCode = FFS_RC_SUCCESS;
+        try
+        {
+            const FileSignature cfgFileSignature = getFileSignature(job.cfgFilePath); //throw FileError
+            if (!job.cfgFileSignature || *job.cfgFileSignature != cfgFileSignature)
+            {
+                XmlBatchConfig batchCfg;
+                std::wstring warningMsg;
+                readConfig(job.cfgFilePath, batchCfg, warningMsg); //throw FileError
+
+                if (!warningMsg.empty())
+                    throw FileError(warningMsg); //batch mode: break on errors AND even warnings!
+
+                job.batchCfg = batchCfg;
+                job.cfgFileSignature = cfgFileSignature;
+                job.lastRunComplete = false; //folder pairs or filter may have changed
+            }
+        }
+        catch (const FileError& e)
+        {
+            notifyError(e.toString(), FFS_RC_ABORTED);
+            return FFS_RC_ABORTED;
+        }
+
+        XmlBatchConfig batchCfg = job.batchCfg;
+        batchCfg.batchExCfg.postSyncAction = PostSyncAction::EXIT; //don't wait for the user to close the summary; never shut down the system
+
+        //changes of the previous run itself are included: they don't need to be re-read, but this is simple and always correct
+        job.changeMonitor.setFolders(getNativeFolderPaths(batchCfg.mainCfg));
+        const ChangeList changeList = job.changeMonitor.extractChanges();
+        const bool compareIncrementally = job.lastRunComplete;
+
+        Opt<std::vector<Zstring>> outOfSyncItemPaths;
+        try
+        {
+            runBatchJob(globalCfg, batchCfg, job.cfgFilePath, [&](ProcessCallback& callback) -> Opt<ChangeList> //throw BatchRequestSwitchToMainDialog
+            {
+                if (compareIncrementally)
+                    return changeList;
+                return NoValue();
+            }, outOfSyncItemPaths, jobReturnCode);
+        }
+        catch (BatchRequestSwitchToMainDialog&) { raiseReturnCode(jobReturnCode, FFS_RC_ABORTED); } //not supported for daemon jobs
+
+        //conflicts, excluded items, etc. are missing from the database => read them again until they are synchronized
+        if (outOfSyncItemPaths)
+            job.changeMonitor.addChangedItems(*outOfSyncItemPaths);
+        job.lastRunComplete = jobReturnCode == FFS_RC_SUCCESS && outOfSyncItemPaths;
+        raiseReturnCode(returnCode, jobReturnCode);
+
+        writeGlobalSettings(globalConfigFilePath, globalCfg, notifyError);
+        return jobReturnCode;
+    };
+
+    for (;;)
+    {
+        std::vector<DaemonJob*> jobsToRun;
+
+        std::unique_ptr<DaemonRequest> request;
+        try
+        {
+            request = daemonSocket->getRequest(); //throw FileError
+        }
+        catch (const FileError& e) { notifyError(e.toString(), FFS_RC_FINISHED_WITH_WARNINGS); }
+
+        if (request)
+        {
+            const std::string& command = request->getCommand();
+
+            if (command == "quit")
+                return request->reply("ok");
+            else if (command == "status")
+                for (const DaemonJob& job : jobs)
+                    request->reply(utfTo<std::string>(job.jobName) + ": " + job.lastResult);
+            else if (command == "run" || startsWith(command, "run "))
+            {
+                const std::string jobName = trimCpy(afterFirst(command, ' ', IF_MISSING_RETURN_NONE));
+                for (DaemonJob& job : jobs)
+                    if (jobName.empty() || utfTo<std::string>(job.jobName) == jobName)
+                        jobsToRun.push_back(&job);
+
+                if (jobsToRun.empty())
+                    request->reply("error: unknown job");
+            }
+            else
+                request->reply("error: unknown command");
+        }
+        else if (runIntervalMin > 0)
+            for (DaemonJob& job : jobs)
+                if (job.nextRunTime <= std::chrono::steady_clock::now())
+                    jobsToRun.push_back(&job);
+
+        for (DaemonJob* job : jobsToRun)
+        {
+            const FfsReturnCode jobReturnCode = runJob(*job);
+
+            job->lastResult = getReturnCodeName(jobReturnCode) + " (" + formatTime<std::string>("%Y-%m-%d %H:%M:%S") + ")";
+            job->nextRunTime = std::chrono::steady_clock::now() + runInterval;
+
+            if (request)
+                request->reply(utfTo<std::string>(job->jobName) + ": " + getReturnCodeName(jobReturnCode));
+        }
+
+        if (jobsToRun.empty())
+        {
+            for (DaemonJob& job : jobs)
+                job.changeMonitor.update(); //noexcept
+
+            wxTheApp->Yield(); //e.g. let progress dialogs of previous runs be destroyed
+            std::this_thread::sleep_for(std::chrono::milliseconds(UI_UPDATE_INTERVAL_MS));
+        }
     }
 }
@@ -0,0 +1,511 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+/*
+headless end-to-end benchmark: generate a synthetic folder tree, then measure comparison, sync direction detection,
+synchronization and sync.ffs_db load/save for an initial and an incremental run
+
+output: tab-separated table on stdout (one row per phase), errors on stderr
+
+usage: FreeFileSync_Benchmark [-base <path phrase>] [-files <count>] [-depth <levels>] [-fanout <subfolders>]
+                              [-size <min>-<max>] [-name <min>-<max>] [-changes <percent>] [-threads <count>]
+                              [-compare time|content|size] [-seed <number>]
+
+    -base   any folder path phrase, e.g. "/tmp/bench", "mem:bench" (default) or "latency:delay=20|mem:bench"
+            => <base>/left and <base>/right are created and must not exist yet!
+    -size   file sizes in bytes: log-uniform distribution between min and max
+    -name   length of item names in characters: uniform distribution between min and max
+*/
+
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <functional>
+#include <sys/resource.h> //getrusage
+#include <zen/string_tools.h>
+#include "../comparison.h"
+#include "../algorithm.h"
+#include "../synchronization.h"
+#include "../fs/concrete.h"
+#include "../lib/db_file.h"
+#include "../lib/return_codes.h"
+
+using namespace zen;
+
+
+namespace
+{
+struct BenchmarkConfig
+{
+    Zstring basePathPhrase = Zstr("mem:bench");
+    size_t fileCount = 10000;
+    size_t depth  = 3;
+    size_t fanout = 8;
+    uint64_t fileSizeMin = 0;
+    uint64_t fileSizeMax = 1024 * 1024;
+    size_t nameLengthMin = 8;
+    size_t nameLengthMax = 24;
+    size_t changesPercent = 10;
+    size_t threadCount = 1;
+    CompareVariant compareVar = CompareVariant::TIME_SIZE;
+    unsigned int seed = 0;
+};
+
+
+struct PhaseResult
+{
+    std::string phase;
+    int64_t timeMs = 0;
+    int64_t items  = 0;
+    int64_t bytes  = 0;
+    int64_t peakRssKb = 0;
+};
+
+
+int64_t getPeakRssKb()
+{
+    struct ::rusage usage = {};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return usage.ru_maxrss; //unit: kilobytes on Linux
+}
+
+
+class BenchmarkCallback : public ProcessCallback
+{
+public:
+    void initNewPhase(int itemsTotal, int64_t bytesTotal, Phase phaseId) override {}
+    void updateProcessedData(int itemsDelta, int64_t bytesDelta) override { itemsProcessed_ += itemsDelta; bytesProcessed_ += bytesDelta; } //noexcept!!
+    void updateTotalData    (int itemsDelta, int64_t bytesDelta) override {}
+
+    void requestUiRefresh() override {}
+    void forceUiRefresh  () override {}
+
+    void reportStatus(const std::wstring& text) override {}
+    void reportInfo  (const std::wstring& text) override {}
+
+    void reportWarning(const std::wstring& warningMessage, bool& warningActive) override
+    {
+        std::wcerr << L"Warning: " << warningMessage << L"\n";
+        raiseReturnCode(returnCode_, FFS_RC_FINISHED_WITH_WARNINGS);
+    }
+
+    Response reportError(const std::wstring& errorMessage, size_t retryNumber) override
+    {
+        std::wcerr << L"Error: " << errorMessage << L"\n";
+        raiseReturnCode(returnCode_, FFS_RC_FINISHED_WITH_ERRORS);
+        return IGNORE_ERROR;
+    }
+
+    void reportFatalError(const std::wstring& errorMessage) override
+    {
+        std::wcerr << L"Error: " << errorMessage << L"\n";
+        raiseReturnCode(returnCode_, FFS_RC_FINISHED_WITH_ERRORS);
+    }
+
+    void abortProcessNow() override { throw std::runtime_error("Benchmark aborted."); }
+
+    void resetCounters() { itemsProcessed_ = bytesProcessed_ = 0; }
+
+    int64_t getItemsProcessed() const { return itemsProcessed_; }
+    int64_t getBytesProcessed() const { return bytesProcessed_; }
+
+    FfsReturnCode getReturnCode() const { return returnCode_; }
+    void setReturnCode(FfsReturnCode rc) { raiseReturnCode(returnCode_, rc); }
+
+private:
+    int64_t itemsProcessed_ = 0;
+    int64_t bytesProcessed_ = 0;
+    FfsReturnCode returnCode_ = FFS_RC_SUCCESS;
+};
+
+//==========================================================================================================
+
+class SyntheticTree
+{
+public:
+    SyntheticTree(const BenchmarkConfig& cfg, const AbstractPath& baseFolderPath) : cfg_(cfg), baseFolderPath_(baseFolderPath), random_(cfg.seed)
+    {
+        std::uniform_int_distribution<int> byteDist(0, 255);
+        for (char& c : randomData_)
+            c = static_cast<char>(byteDist(random_));
+    }
+
+    //returns number of bytes written
+    int64_t create(int64_t& itemCount) //throw FileError
+    {
+        AFS::createFolderIfMissingRecursion(baseFolderPath_); //throw FileError
+
+        std::vector<Zstring> folderLevel{ Zstring() };
+        folders_ = folderLevel;
+        for (size_t level = 0; level < cfg_.depth; ++level)
+        {
+            std::vector<Zstring> nextLevel;
+            for (const Zstring& parentRelPath : folderLevel)
+                for (size_t i = 0; i < cfg_.fanout; ++i)
+                {
+                    const Zstring relPath = AFS::appendPaths(parentRelPath, generateItemName(i), FILE_NAME_SEPARATOR);
+                    AFS::createFolderPlain(AFS::appendRelPath(baseFolderPath_, relPath)); //throw FileError
+                    nextLevel.push_back(relPath);
+                    ++itemCount;
+                }
+            append(folders_, nextLevel);
+            folderLevel.swap(nextLevel);
+        }
+
+        int64_t bytesWritten = 0;
+        for (size_t i = 0; i < cfg_.fileCount; ++i)
+        {
+            bytesWritten += addFile(files_, modTimeBase_); //throw FileError
+            ++itemCount;
+        }
+        return bytesWritten;
+    }
+
+    //delete, update and add files: one third each
+    int64_t modify(int64_t& itemCount) //throw FileError
+    {
+        const size_t changeCount = std::min(files_.size(), files_.size() * cfg_.changesPercent / 100);
+        std::shuffle(files_.begin(), files_.end(), random_);
+
+        int64_t bytesWritten = 0;
+        std::vector<Zstring> filesAdded; //don't pick new files as victims during this round
+        for (size_t i = 0; i < changeCount; ++i)
+        {
+            const AbstractPath filePath = AFS::appendRelPath(baseFolderPath_, files_.back());
+            AFS::removeFilePlain(filePath); //throw FileError
+            ++itemCount;
+
+            switch (i % 3)
+            {
+                case 0: //delete
+                    files_.pop_back();
+                    break;
+                case 1: //update
+                    bytesWritten += writeFile(filePath, modTimeBase_ + 24 * 3600); //throw FileError
+                    std::swap(files_.back(), files_[i / 3]); //don't pick the same file again
+                    break;
+                case 2: //delete + add
+                    files_.pop_back();
+                    //new time stamp: file system may reuse the file id of the deleted file => avoid false move detection
+                    bytesWritten += addFile(filesAdded, modTimeBase_ + 2 * 24 * 3600); //throw FileError
+                    break;
+            }
+        }
+        append(files_, filesAdded);
+        return bytesWritten;
+    }
+
+private:
+    Zstring generateItemName(size_t index)
+    {
+        static const char nameChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-";
+
+        const Zstring suffix = Zstr('_') + numberTo<Zstring>(index); //guarantee uniqueness within parent folder
+        const size_t nameLength = std::uniform_int_distribution<size_t>(cfg_.nameLengthMin, std::max(cfg_.nameLengthMin, cfg_.nameLengthMax))(random_);
+
+        Zstring itemName;
+        std::uniform_int_distribution<size_t> charDist(0, sizeof(nameChars) - 2);
+        while (itemName.size() + suffix.size() < nameLength)
+            itemName += nameChars[charDist(random_)];
+        trim(itemName); //leading/trailing blanks are asking for trouble
+        if (itemName.empty())
+            itemName += Zstr('x');
+        return itemName + suffix;
+    }
+
+    uint64_t generateFileSize()
+    {
+        //log-uniform: many small files, few large ones
+        const double logMin = std::log(static_cast<double>(cfg_.fileSizeMin) + 1);
+        const double logMax = std::log(static_cast<double>(std::max(cfg_.fileSizeMin, cfg_.fileSizeMax)) + 1);
+        return static_cast<uint64_t>(std::exp(std::uniform_real_distribution<double>(logMin, logMax)(random_)) - 1);
+    }
+
+    int64_t addFile(std::vector<Zstring>& relPaths, time_t modTime) //throw FileError
+    {
+        const Zstring& parentRelPath = folders_[std::uniform_int_distribution<size_t>(0, folders_.size() - 1)(random_)];
+        const Zstring relPath = AFS::appendPaths(parentRelPath, generateItemName(fileIndex_++) + Zstr(".dat"), FILE_NAME_SEPARATOR);
+        relPaths.push_back(relPath);
+
+        return writeFile(AFS::appendRelPath(baseFolderPath_, relPath), modTime); //throw FileError
+    }
+
+    int64_t writeFile(const AbstractPath& filePath, time_t modTime) //throw FileError
+    {
+        const uint64_t fileSize = generateFileSize();
+        const size_t offset = std::uniform_int_distribution<size_t>(0, randomData_.size() - 1)(random_); //different content per file
+
+        auto streamOut = AFS::getOutputStream(filePath, &fileSize, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        for (uint64_t bytesWritten = 0; bytesWritten < fileSize;)
+        {
+            const size_t pos = static_cast<size_t>((offset + bytesWritten) % randomData_.size());
+            const size_t blockSize = static_cast<size_t>(std::min<uint64_t>(randomData_.size() - pos, fileSize - bytesWritten));
+            streamOut->write(&randomData_[pos], blockSize); //throw FileError
+            bytesWritten += blockSize;
+        }
+        streamOut->finalize(); //throw FileError
+
+        AFS::setModTime(filePath, modTime); //throw FileError
+        return fileSize;
+    }
+
+    const BenchmarkConfig& cfg_;
+    const AbstractPath baseFolderPath_;
+    const time_t modTimeBase_ = 1500000000; //fixed time stamp: reproducible runs
+    std::mt19937 random_;
+    std::vector<char> randomData_ = std::vector<char>(256 * 1024);
+    std::vector<Zstring> folders_; //relative paths
+    std::vector<Zstring> files_;   //
+    size_t fileIndex_ = 0;
+};
+
+
+int64_t countItems(const ContainerObject& hierObj)
+{
+    int64_t itemCount = hierObj.refSubFiles().size() + hierObj.refSubLinks().size() + hierObj.refSubFolders().size();
+    for (const FolderPair& folder : hierObj.refSubFolders())
+        itemCount += countItems(folder);
+    return itemCount;
+}
+
+
+int64_t countItems(const FolderComparison& folderCmp)
+{
+    int64_t itemCount = 0;
+    for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+        itemCount += countItems(*baseFolder);
+    return itemCount;
+}
+
+
+bool parseRange(const std::string& arg, uint64_t& minVal, uint64_t& maxVal)
+{
+    if (!contains(arg, '-'))
+        return false;
+    minVal = stringTo<uint64_t>(beforeFirst(arg, '-', IF_MISSING_RETURN_NONE));
+    maxVal = stringTo<uint64_t>(afterFirst (arg, '-', IF_MISSING_RETURN_NONE));
+    return minVal <= maxVal;
+}
+
+
+bool parseCommandline(int argc, char* argv[], BenchmarkConfig& cfg)
+{
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string option = argv[i];
+        const std::string value  = argv[i + 1];
+
+        uint64_t minVal = 0;
+        uint64_t maxVal = 0;
+
+        if (option == "-base")
+            cfg.basePathPhrase = utfTo<Zstring>(value);
+        else if (option == "-files")
+            cfg.fileCount = stringTo<size_t>(value);
+        else if (option == "-depth")
+            cfg.depth = stringTo<size_t>(value);
+        else if (option == "-fanout")
+            cfg.fanout = std::max<size_t>(stringTo<size_t>(value), 1);
+        else if (option == "-size" && parseRange(value, minVal, maxVal))
+        {
+            cfg.fileSizeMin = minVal;
+            cfg.fileSizeMax = maxVal;
+        }
+        else if (option == "-name" && parseRange(value, minVal, maxVal))
+        {
+            cfg.nameLengthMin = std::max<size_t>(static_cast<size_t>(minVal), 1);
+            cfg.nameLengthMax = static_cast<size_t>(maxVal);
+        }
+        else if (option == "-changes")
+            cfg.changesPercent = std::min<size_t>(stringTo<size_t>(value), 100);
+        else if (option == "-threads")
+            cfg.threadCount = std::max<size_t>(stringTo<size_t>(value), 1);
+        else if (option == "-compare" && value == "time")
+            cfg.compareVar = CompareVariant::TIME_SIZE;
+        else if (option == "-compare" && value == "content")
+            cfg.compareVar = CompareVariant::CONTENT;
+        else if (option == "-compare" && value == "size")
+            cfg.compareVar = CompareVariant::SIZE;
+        else if (option == "-seed")
+            cfg.seed = stringTo<unsigned int>(value);
+        else
+            return false;
+    }
+    return argc % 2 == 1;
+}
+
+
+void printResult(const PhaseResult& r)
+{
+    const double seconds = std::max<int64_t>(r.timeMs, 1) / 1000.0;
+    std::cout << r.phase
+              << '\t' << r.timeMs
+              << '\t' << r.items << '\t' << static_cast<int64_t>(r.items / seconds)
+              << '\t' << r.bytes << '\t' << static_cast<int64_t>(r.bytes / seconds)
+              << '\t' << r.peakRssKb << std::endl;
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    BenchmarkConfig cfg;
+    if (!parseCommandline(argc, argv, cfg))
+    {
+        std::cerr << "Usage: " << argv[0] << " [-base <path phrase>] [-files <count>] [-depth <levels>] [-fanout <subfolders>]\n"
+                  "    [-size <min>-<max>] [-name <min>-<max>] [-changes <percent>] [-threads <count>]\n"
+                  "    [-compare time|content|size] [-seed <number>]\n";
+        return FFS_RC_EXCEPTION;
+    }
+
+    MainConfiguration mainCfg;
+    mainCfg.cmpConfig.compareVar = cfg.compareVar;
+    mainCfg.syncCfg.directionCfg.var = DirectionConfig::TWO_WAY; //exercise sync.ffs_db load/save
+    mainCfg.syncCfg.handleDeletion = DeletionPolicy::PERMANENT;
+    mainCfg.firstPair.folderPathPhraseLeft_  = AFS::getInitPathPhrase(AFS::appendRelPath(createAbstractPath(cfg.basePathPhrase), Zstr("left")));
+    mainCfg.firstPair.folderPathPhraseRight_ = AFS::getInitPathPhrase(AFS::appendRelPath(createAbstractPath(cfg.basePathPhrase), Zstr("right")));
+
+    const AbstractPath folderPathLeft  = createAbstractPath(mainCfg.firstPair.folderPathPhraseLeft_);
+    const AbstractPath folderPathRight = createAbstractPath(mainCfg.firstPair.folderPathPhraseRight_);
+
+    std::cout << "#base=" << utfTo<std::string>(cfg.basePathPhrase) << " files=" << cfg.fileCount << " depth=" << cfg.depth << " fanout=" << cfg.fanout <<
+              " size=" << cfg.fileSizeMin << "-" << cfg.fileSizeMax << " name=" << cfg.nameLengthMin << "-" << cfg.nameLengthMax <<
+              " changes=" << cfg.changesPercent << " threads=" << cfg.threadCount << " seed=" << cfg.seed << "\n";
+    std::cout << "phase\ttime_ms\titems\titems_per_sec\tbytes\tbytes_per_sec\tpeak_rss_kb" << std::endl;
+
+    BenchmarkCallback callback;
+    try
+    {
+        xmlAccess::OptionalDialogs warnings;
+        FolderComparison folderCmp;
+
+        //measure a single phase: "runPhase" returns bytes processed; items and bytes reported via callback are added
+        auto measure = [&](const std::string& phase, const std::function<int64_t(int64_t& itemCount)>& runPhase) //throw FileError, X
+        {
+            callback.resetCounters();
+            int64_t itemCount = 0;
+
+            const auto startTime = std::chrono::steady_clock::now();
+            const int64_t byteCount = runPhase(itemCount);
+            const auto stopTime = std::chrono::steady_clock::now();
+
+            PhaseResult r;
+            r.phase     = phase;
+            r.timeMs    = std::chrono::duration_cast<std::chrono::milliseconds>(stopTime - startTime).count();
+            r.items     = itemCount + callback.getItemsProcessed();
+            r.bytes     = byteCount + callback.getBytesProcessed();
+            r.peakRssKb = getPeakRssKb();
+            printResult(r);
+        };
+
+        auto runCompare = [&](int64_t& itemCount)
+        {
+            std::unique_ptr<LockHolder> dirLocks;
+            folderCmp.clear(); //measure peak memory of a single comparison result only
+            folderCmp = compare(warnings,
+                                2 /*fileTimeTolerance*/,
+                                false /*allowUserInteraction*/,
+                                false /*runWithBackgroundPriority*/,
+                                20 /*folderAccessTimeout*/,
+                                cfg.threadCount /*traverserThreadsPerFolder*/,
+                                cfg.threadCount /*contentCompareThreads*/,
+                                false /*contentCompareSkipUnchanged*/,
+                                nullptr /*changeList*/,
+                                false /*createDirLocks*/,
+                                dirLocks,
+                                extractCompareCfg(mainCfg),
+                                callback); //throw X
+            return int64_t(0);
+        };
+
+        auto runRedetermine = [&](int64_t& itemCount)
+        {
+            redetermineSyncDirection(mainCfg, folderCmp, nullptr /*notifyStatus*/); //throw FileError
+            itemCount = countItems(folderCmp);
+            return int64_t(0);
+        };
+
+        auto runSync = [&](int64_t& itemCount)
+        {
+            synchronize(std::chrono::system_clock::now(),
+                        false /*verifyCopiedFiles*/,
+                        false /*copyLockedFiles*/,
+                        false /*copyFilePermissions*/,
+                        true  /*failSafeFileCopy*/,
+                        false /*runWithBackgroundPriority*/,
+                        20    /*folderAccessTimeout*/,
+                        cfg.threadCount /*syncThreadsPerFolderPair*/,
+                        1 /*parallelFolderPairs*/, //single folder pair
+                        extractSyncCfg(mainCfg),
+                        folderCmp,
+                        warnings,
+                        callback); //throw X
+            return int64_t(0);
+        };
+
+        SyntheticTree treeLeft(cfg, folderPathLeft);
+
+        measure("generate", [&](int64_t& itemCount)
+        {
+            AFS::createFolderIfMissingRecursion(folderPathRight); //throw FileError
+            return treeLeft.create(itemCount); //throw FileError
+        });
+
+        measure("compare",     runCompare);
+        measure("redetermine", runRedetermine);
+        measure("sync",        runSync);
+
+        measure("db_save", [&](int64_t& itemCount)
+        {
+            for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+                saveLastSynchronousState(*baseFolder, nullptr /*notifyStatus*/); //throw FileError
+            itemCount = countItems(folderCmp);
+            return int64_t(0);
+        });
+
+        measure("db_load", [&](int64_t& itemCount)
+        {
+            for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+            {
+                baseFolder->setDatabaseSession(nullptr); //measure loading from disk, not the session kept since synchronization
+                loadLastSynchronousState(*baseFolder, nullptr /*notifyStatus*/); //throw FileError, FileErrorDatabaseNotExisting
+            }
+            itemCount = countItems(folderCmp);
+            return int64_t(0);
+        });
+
+        measure("modify", [&](int64_t& itemCount) { return treeLeft.modify(itemCount); }); //throw FileError
+
+        measure("compare_incremental",     runCompare);
+        measure("redetermine_incremental", runRedetermine);
+        measure("sync_incremental",        runSync);
+
+        measure("verify", [&](int64_t& itemCount) //everything should be in sync now!
+        {
+            runCompare(itemCount);
+            if (!allElementsEqual(folderCmp))
+            {
+                std::cerr << "Error: Folders differ after synchronization.\n";
+                callback.setReturnCode(FFS_RC_FINISHED_WITH_ERRORS);
+            }
+            return int64_t(0);
+        });
+    }
+    catch (const FileError& e)
+    {
+        std::wcerr << L"Error: " << e.toString() << L"\n";
+        return FFS_RC_EXCEPTION;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+        return FFS_RC_EXCEPTION;
+    }
+
+    return callback.getReturnCode();
+}
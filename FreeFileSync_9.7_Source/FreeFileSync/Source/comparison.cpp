@@ -5,12 +5,16 @@
 // *****************************************************************************
 
 #include "comparison.h"
+#include <unordered_set>
+#include <unordered_map>
 #include <zen/process_priority.h>
 #include <zen/perf.h>
 #include "algorithm.h"
 #include "lib/parallel_scan.h"
 #include "lib/dir_exist_async.h"
 #include "lib/binary.h"
+#include "lib/process_xml.h"
+#include "lib/db_file.h"
 #include "lib/cmp_filetime.h"
 #include "lib/status_handler_impl.h"
 #include "fs/concrete.h"
@@ -111,17 +115,47 @@ ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& cfgL
     return output;
 }
 
+
+//incremental comparison: paths of changed items relative to the base folders; NoValue() if change list is not applicable
+Opt<std::set<Zstring, LessFilePath>> getChangedRelPaths(const ChangeList& changeList, const ResolvedFolderPair& fp)
+{
+    std::set<Zstring, LessFilePath> changedRelPaths;
+
+    for (const AbstractPath& folderPath : { fp.folderPathLeft, fp.folderPathRight })
+    {
+        const Opt<Zstring> nativePath = AFS::getNativeItemPath(folderPath);
+        if (!nativePath) //directory monitoring is restricted to native paths
+            return NoValue();
+        const Zstring folderPathPf = appendSeparator(*nativePath);
+
+        //change notifications are complete for watched folders only
+        if (std::none_of(changeList.watchedFolderPaths.begin(), changeList.watchedFolderPaths.end(),
+        [&](const Zstring& watchedPath) { return startsWith(folderPathPf, appendSeparator(watchedPath), CmpFilePath()); }))
+        return NoValue();
+
+        for (const Zstring& itemPath : changeList.changedItemPaths)
+            if (startsWith(folderPathPf, appendSeparator(itemPath), CmpFilePath())) //base folder itself (or a parent) has changed
+                return NoValue();
+            else if (startsWith(itemPath, folderPathPf, CmpFilePath()))
+                changedRelPaths.insert(Zstring(itemPath.begin() + folderPathPf.size(), itemPath.end()));
+    }
+    return changedRelPaths;
+}
+
 //#############################################################################################################################
 
 class ComparisonBuffer
 {
 public:
-    ComparisonBuffer(const std::set<DirectoryKey>& keysToRead, int fileTimeTolerance, ProcessCallback& callback);
+    ComparisonBuffer(const std::set<DirectoryKey>& keysToRead, const std::map<DirectoryKey, IncrementalScan>& incrementalScans,
+                     const std::map<DirectoryKey, IoCounters*>& ioCounters, int fileTimeTolerance,
+                     size_t traverserThreadsPerFolder, size_t contentCompareThreads, bool contentCompareSkipUnchanged, ProcessCallback& callback);
 
     //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
     std::shared_ptr<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
     std::shared_ptr<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::list<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const;
+    std::list<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                                                                const std::vector<std::shared_ptr<DatabaseSession>>& dbSessions) const; //optional: loaded for incremental comparison
 
 private:
     ComparisonBuffer           (const ComparisonBuffer&) = delete;
@@ -134,12 +168,19 @@ private:
 
     std::map<DirectoryKey, DirectoryValue> directoryBuffer_; //contains only *existing* directories
     const int fileTimeTolerance_;
+    const size_t contentCompareThreads_;
+    const bool contentCompareSkipUnchanged_;
     ProcessCallback& callback_;
 };
 
 
-ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& keysToRead, int fileTimeTolerance, ProcessCallback& callback) :
-    fileTimeTolerance_(fileTimeTolerance), callback_(callback)
+ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& keysToRead, const std::map<DirectoryKey, IncrementalScan>& incrementalScans,
+                                   const std::map<DirectoryKey, IoCounters*>& ioCounters, int fileTimeTolerance,
+                                   size_t traverserThreadsPerFolder, size_t contentCompareThreads, bool contentCompareSkipUnchanged, ProcessCallback& callback) :
+    fileTimeTolerance_(fileTimeTolerance),
+    contentCompareThreads_(contentCompareThreads),
+    contentCompareSkipUnchanged_(contentCompareSkipUnchanged),
+    callback_(callback)
 {
     class CbImpl : public FillBufferCallback
     {
@@ -176,8 +217,11 @@ ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& keysToRead, int
     } cb(callback);
 
     fillBuffer(keysToRead, //in
+               incrementalScans, //in
+               ioCounters, //in
                directoryBuffer_, //out
                cb,
+               traverserThreadsPerFolder,
                UI_UPDATE_INTERVAL_MS / 2); //every ~50 ms
 }
 
@@ -394,26 +438,89 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFo
 }
 
 
-std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const
+//check whether a file is still in the state recorded in the database: *exact* match, no file time tolerance
+template <SelectedSide side> inline
+bool unchangedSinceDbEntry(const FilePair& file, const InSyncFile& dbFile)
+{
+    const InSyncDescrFile& descrDb = SelectParam<side>::ref(dbFile.left, dbFile.right);
+
+    return file.getLastWriteTime<side>() == descrDb.modTime &&
+           file.getFileSize<side>() == dbFile.fileSize &&
+           !descrDb.fileId.empty() && file.getFileId<side>() == descrDb.fileId;
+}
+
+
+void findDbEntries(const ContainerObject& hierObj, const InSyncFolder& dbFolder, //in
+                   const std::unordered_set<const FilePair*>& candidates,      //
+                   std::unordered_map<const FilePair*, const InSyncFile*>& output) //out
+{
+    //InSyncFolder's mapping tables use short name as a key: only consider items with matching names on both sides!
+    for (const FilePair& file : hierObj.refSubFiles())
+        if (candidates.find(&file) != candidates.end() &&
+            file.getItemName<LEFT_SIDE>() == file.getItemName<RIGHT_SIDE>())
+        {
+            auto it = dbFolder.files.find(file.getPairItemName());
+            if (it != dbFolder.files.end())
+                output.emplace(&file, &it->second);
+        }
+
+    for (const FolderPair& folder : hierObj.refSubFolders())
+        if (folder.getItemName<LEFT_SIDE>() == folder.getItemName<RIGHT_SIDE>())
+        {
+            auto it = dbFolder.folders.find(folder.getPairItemName());
+            if (it != dbFolder.folders.end())
+                findDbEntries(folder, it->second, candidates, output);
+        }
+}
+
+
+void setCategorySameContent(FilePair& file)
+{
+    //Caveat:
+    //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
+    //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
+    //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
+    if (file.getItemName<LEFT_SIDE>() != file.getItemName<RIGHT_SIDE>())
+        file.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(file));
+#if 0 //don't synchronize modtime only see SynchronizeFolderPair::synchronizeFileInt(), SO_COPY_METADATA_TO_*
+    else if (!sameFileTime(file.getLastWriteTime<LEFT_SIDE>(),
+                           file.getLastWriteTime<RIGHT_SIDE>(), file.base().getFileTimeTolerance(), file.base().getIgnoredTimeShift()))
+        file.setCategoryDiffMetadata(getDescrDiffMetaDate(file));
+#endif
+    else
+        file.setCategory<FILE_EQUAL>();
+}
+
+
+std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                                                                              const std::vector<std::shared_ptr<DatabaseSession>>& dbSessions) const
 {
     std::list<std::shared_ptr<BaseFolderPair>> output;
     if (workLoad.empty())
         return output;
+    assert(dbSessions.size() == workLoad.size());
 
     //PERF_START;
     std::vector<FilePair*> filesToCompareBytewise;
+    std::vector<ContentComparisonItem> itemsToCompare;
 
     //process folder pairs one after another
-    for (const auto& w : workLoad)
+    for (size_t i = 0; i < workLoad.size(); ++i)
     {
+        const auto& w = workLoad[i];
+        IoCounters* ioCounters = getIoCounters(w.first.folderPathLeft, w.first.folderPathRight, callback_);
+        IoCountersScope ioScope(ioCounters);
+
         std::vector<FilePair*> undefinedFiles;
         std::vector<SymlinkPair*> uncategorizedLinks;
         //do basis scan and retrieve candidates for binary comparison (files existing on both sides)
 
         output.push_back(performComparison(w.first, w.second, undefinedFiles, uncategorizedLinks));
+        output.back()->setDatabaseSession(dbSessions[i]); //don't load the database again below
 
         //content comparison of file content happens AFTER finding corresponding files and AFTER filtering
         //in order to separate into two processes (scanning and comparing)
+        std::vector<FilePair*> candidates;
         for (FilePair* file : undefinedFiles)
             //pre-check: files have different content if they have a different filesize (must not be FILE_EQUAL: see InSyncFile)
             if (file->getFileSize<LEFT_SIDE>() != file->getFileSize<RIGHT_SIDE>())
@@ -425,9 +532,56 @@ std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(co
                 if (!file->isActive())
                     file->setCategoryConflict(getConflictSkippedBinaryComparison(*file));
                 else
-                    filesToCompareBytewise.push_back(file);
+                    candidates.push_back(file);
             }
 
+        //perf: don't read files again that were found equal during a previous run and have not changed since
+        //database is kept in the DatabaseSession of the BaseFolderPair (native paths only) => reused by redetermineSyncDirection()
+        std::shared_ptr<const InSyncFolder> lastSyncState;
+        std::unordered_map<const FilePair*, const InSyncFile*> dbEntries;
+        if (contentCompareSkipUnchanged_ && !candidates.empty())
+        {
+            try
+            {
+                lastSyncState = loadLastSynchronousState(*output.back(), //throw FileError, FileErrorDatabaseNotExisting
+                [&](const std::wstring& msg) { callback_.reportStatus(msg); }); //throw X
+            }
+            catch (FileError&) {} //not critical: compare all files; errors are reported by redetermineSyncDirection() if relevant
+
+            if (lastSyncState)
+                findDbEntries(*output.back(), *lastSyncState, std::unordered_set<const FilePair*>(candidates.begin(), candidates.end()), dbEntries);
+        }
+
+        for (FilePair* file : candidates)
+        {
+            ContentComparisonItem item{ file->getAbstractPath<LEFT_SIDE>(), file->getAbstractPath<RIGHT_SIDE>(), ContentDigest() };
+
+            auto it = dbEntries.find(file);
+            if (it != dbEntries.end())
+            {
+                const InSyncFile& dbFile = *it->second;
+                const bool unchangedL = unchangedSinceDbEntry< LEFT_SIDE>(*file, dbFile);
+                const bool unchangedR = unchangedSinceDbEntry<RIGHT_SIDE>(*file, dbFile);
+
+                if (unchangedL && unchangedR && dbFile.cmpVar == CompareVariant::CONTENT)
+                {
+                    file->setContentDigest(dbFile.contentDigest);
+                    setCategorySameContent(*file);
+                    continue;
+                }
+                if (!dbFile.contentDigest.empty()) //only one side has changed: read it and compare against last known content of the other side
+                {
+                    if (unchangedL)
+                        item = ContentComparisonItem{ file->getAbstractPath<RIGHT_SIDE>(), file->getAbstractPath<LEFT_SIDE>(), dbFile.contentDigest };
+                    else if (unchangedR)
+                        item.digest2 = dbFile.contentDigest;
+                }
+            }
+            item.ioCounters = ioCounters; //read on worker threads
+            filesToCompareBytewise.push_back(file);
+            itemsToCompare.push_back(item);
+        }
+
         //finish symlink categorization
         for (SymlinkPair* symlink : uncategorizedLinks)
             categorizeSymlinkByContent(*symlink, callback_);
@@ -446,22 +600,51 @@ std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(co
 
     //PERF_START;
 
-    //compare files (that have same size) bytewise...
-    for (FilePair* file : filesToCompareBytewise)
+    //compare files (that have same size) bytewise: worker threads read ahead, results are evaluated in order => deterministic status and error reporting
+    ParallelContentComparison parallelCmp(itemsToCompare, contentCompareThreads_);
+
+    for (size_t itemIdx = 0; itemIdx < filesToCompareBytewise.size(); ++itemIdx)
     {
+        FilePair* file = filesToCompareBytewise[itemIdx];
+
         callback_.reportStatus(replaceCpy(txtComparingContentOfFiles, L"%x", fmtPath(file->getPairRelativePath())));
 
         //check files that exist in left and right model but have different content
 
         bool haveSameContent = false;
+        ContentDigest contentDigest;
+        bool firstAttempt = true;
         Opt<std::wstring> errMsg = tryReportingError([&]
         {
             StatisticsReporter statReporter(1, file->getFileSize<LEFT_SIDE>(), callback_);
 
-            auto notifyUnbufferedIO = [&](int64_t bytesDelta) { statReporter.reportDelta(0, bytesDelta); };
+            if (firstAttempt)
+            {
+                firstAttempt = false;
+
+                int64_t bytesReported = 0;
+                auto reportBytesProcessed = [&]
+                {
+                    const int64_t bytesDelta = parallelCmp.getBytesProcessed(itemIdx) - bytesReported;
+                    bytesReported += bytesDelta;
+                    statReporter.reportDelta(0, bytesDelta); //may throw
+                };
+
+                while (!parallelCmp.waitForResult(itemIdx, std::chrono::milliseconds(UI_UPDATE_INTERVAL_MS / 2)))
+                    reportBytesProcessed(); //may throw
+                reportBytesProcessed(); //
+
+                haveSameContent = parallelCmp.haveSameContent(itemIdx); //throw FileError
+                if (haveSameContent)
+                    contentDigest = parallelCmp.getContentDigest(itemIdx);
+            }
+            else //retry: compare synchronously
+            {
+                auto notifyUnbufferedIO = [&](int64_t bytesDelta) { statReporter.reportDelta(0, bytesDelta); };
 
-            haveSameContent = filesHaveSameContent(file->getAbstractPath<LEFT_SIDE>(),
-                                                   file->getAbstractPath<RIGHT_SIDE>(), notifyUnbufferedIO); //throw FileError
+                haveSameContent = filesHaveSameContent(file->getAbstractPath<LEFT_SIDE>(),
+                                                       file->getAbstractPath<RIGHT_SIDE>(), notifyUnbufferedIO); //throw FileError
+            }
             statReporter.reportDelta(1, 0);
         }, callback_); //throw X?
 
@@ -471,19 +654,8 @@ std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(co
         {
             if (haveSameContent)
             {
-                //Caveat:
-                //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
-                //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
-                //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
-                if (file->getItemName<LEFT_SIDE>() != file->getItemName<RIGHT_SIDE>())
-                    file->setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(*file));
-#if 0 //don't synchronize modtime only see SynchronizeFolderPair::synchronizeFileInt(), SO_COPY_METADATA_TO_*
-                else if (!sameFileTime(file->getLastWriteTime<LEFT_SIDE>(),
-                                       file->getLastWriteTime<RIGHT_SIDE>(), file->base().getFileTimeTolerance(), file->base().getIgnoredTimeShift()))
-                    file->setCategoryDiffMetadata(getDescrDiffMetaDate(*file));
-#endif
-                else
-                    file->setCategory<FILE_EQUAL>();
+                file->setContentDigest(contentDigest);
+                setCategorySameContent(*file);
             }
             else
                 file->setCategory<FILE_DIFFERENT_CONTENT>();
@@ -551,21 +723,21 @@ void MergeSides::fillOneSide(const FolderContainer& folderCont, const std::wstri
 {
     for (const auto& file : folderCont.files)
     {
-        FilePair& newItem = output.addSubFile<side>(file.first, file.second);
+        FilePair& newItem = output.addSubFile<side>(file.name.toString(), file.attr);
         checkFailedRead(newItem, errorMsg);
     }
 
     for (const auto& symlink : folderCont.symlinks)
     {
-        SymlinkPair& newItem = output.addSubLink<side>(symlink.first, symlink.second);
+        SymlinkPair& newItem = output.addSubLink<side>(symlink.name.toString(), symlink.attr);
         checkFailedRead(newItem, errorMsg);
     }
 
     for (const auto& dir : folderCont.folders)
     {
-        FolderPair& newFolder = output.addSubFolder<side>(dir.first, dir.second.first);
+        FolderPair& newFolder = output.addSubFolder<side>(dir.name.toString(), dir.attr);
         const std::wstring* errorMsgNew = checkFailedRead(newFolder, errorMsg);
-        fillOneSide<side>(dir.second.second, errorMsgNew, newFolder); //recurse
+        fillOneSide<side>(*dir.folderCont, errorMsgNew, newFolder); //recurse
     }
 }
 
@@ -573,8 +745,9 @@ void MergeSides::fillOneSide(const FolderContainer& folderCont, const std::wstri
 //perf: 70% faster than traversing over left and right containers + more natural default sequence
 //- 2 x lessKey vs 1 x cmpFilePath() => no significant difference
 //- simplify loop by placing the eob check at the beginning => slightly slower
-template <class MapType, class ProcessLeftOnly, class ProcessRightOnly, class ProcessBoth> inline
-void linearMerge(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
+//- input: FolderContainer item lists sorted by ScanItemName
+template <class ItemList, class ProcessLeftOnly, class ProcessRightOnly, class ProcessBoth> inline
+void linearMerge(const ItemList& mapLeft, const ItemList& mapRight, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
 {
     auto itL = mapLeft .begin();
     auto itR = mapRight.begin();
@@ -585,16 +758,14 @@ void linearMerge(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOnl
     if (itL == mapLeft .end()) return finishRight();
     if (itR == mapRight.end()) return finishLeft ();
 
-    const auto lessKey = typename MapType::key_compare();
-
     for (;;)
-        if (lessKey(itL->first, itR->first))
+        if (lessItemName(itL->name, itR->name))
         {
             lo(*itL);
             if (++itL == mapLeft.end())
                 return finishRight();
         }
-        else if (lessKey(itR->first, itL->first))
+        else if (lessItemName(itR->name, itL->name))
         {
             ro(*itR);
             if (++itR == mapRight.end())
@@ -613,69 +784,72 @@ void linearMerge(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOnl
 
 void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer& rhs, const std::wstring* errorMsg, ContainerObject& output)
 {
-    using FileData = const FolderContainer::FileList::value_type;
+    using FileData = const FolderContainer::FileItem;
 
     linearMerge(lhs.files, rhs.files,
-    [&](const FileData& fileLeft ) { FilePair& newItem = output.addSubFile< LEFT_SIDE>(fileLeft .first, fileLeft .second); checkFailedRead(newItem, errorMsg); }, //left only
-    [&](const FileData& fileRight) { FilePair& newItem = output.addSubFile<RIGHT_SIDE>(fileRight.first, fileRight.second); checkFailedRead(newItem, errorMsg); }, //right only
+    [&](const FileData& fileLeft ) { FilePair& newItem = output.addSubFile< LEFT_SIDE>(fileLeft .name.toString(), fileLeft .attr); checkFailedRead(newItem, errorMsg); }, //left only
+    [&](const FileData& fileRight) { FilePair& newItem = output.addSubFile<RIGHT_SIDE>(fileRight.name.toString(), fileRight.attr); checkFailedRead(newItem, errorMsg); }, //right only
 
     [&](const FileData& fileLeft, const FileData& fileRight) //both sides
     {
-        FilePair& newItem = output.addSubFile(fileLeft.first,
-                                              fileLeft.second,
+        FilePair& newItem = output.addSubFile(fileLeft.name.toString(),
+                                              fileLeft.attr,
                                               FILE_EQUAL, //dummy-value until categorization is finished later
-                                              fileRight.first,
-                                              fileRight.second);
+                                              fileRight.name.toString(),
+                                              fileRight.attr);
         if (!checkFailedRead(newItem, errorMsg))
             undefinedFiles.push_back(&newItem);
         static_assert(IsSameType<ContainerObject::FileList, FixedList<FilePair>>::value, ""); //ContainerObject::addSubFile() must NOT invalidate references used in "undefinedFiles"!
     });
 
     //-----------------------------------------------------------------------------------------------
-    using SymlinkData = const FolderContainer::SymlinkList::value_type;
+    using SymlinkData = const FolderContainer::SymlinkItem;
 
     linearMerge(lhs.symlinks, rhs.symlinks,
-    [&](const SymlinkData& symlinkLeft ) { SymlinkPair& newItem = output.addSubLink< LEFT_SIDE>(symlinkLeft .first, symlinkLeft .second); checkFailedRead(newItem, errorMsg); }, //left only
-    [&](const SymlinkData& symlinkRight) { SymlinkPair& newItem = output.addSubLink<RIGHT_SIDE>(symlinkRight.first, symlinkRight.second); checkFailedRead(newItem, errorMsg); }, //right only
+    [&](const SymlinkData& symlinkLeft ) { SymlinkPair& newItem = output.addSubLink< LEFT_SIDE>(symlinkLeft .name.toString(), symlinkLeft .attr); checkFailedRead(newItem, errorMsg); }, //left only
+    [&](const SymlinkData& symlinkRight) { SymlinkPair& newItem = output.addSubLink<RIGHT_SIDE>(symlinkRight.name.toString(), symlinkRight.attr); checkFailedRead(newItem, errorMsg); }, //right only
 
     [&](const SymlinkData& symlinkLeft, const SymlinkData& symlinkRight) //both sides
     {
-        SymlinkPair& newItem = output.addSubLink(symlinkLeft.first,
-                                                 symlinkLeft.second,
+        SymlinkPair& newItem = output.addSubLink(symlinkLeft.name.toString(),
+                                                 symlinkLeft.attr,
                                                  SYMLINK_EQUAL, //dummy-value until categorization is finished later
-                                                 symlinkRight.first,
-                                                 symlinkRight.second);
+                                                 symlinkRight.name.toString(),
+                                                 symlinkRight.attr);
         if (!checkFailedRead(newItem, errorMsg))
             undefinedSymlinks.push_back(&newItem);
     });
 
     //-----------------------------------------------------------------------------------------------
-    using FolderData = const FolderContainer::FolderList::value_type;
+    using FolderData = const FolderContainer::FolderItem;
 
     linearMerge(lhs.folders, rhs.folders,
                 [&](const FolderData& dirLeft) //left only
     {
-        FolderPair& newFolder = output.addSubFolder<LEFT_SIDE>(dirLeft.first, dirLeft.second.first);
+        FolderPair& newFolder = output.addSubFolder<LEFT_SIDE>(dirLeft.name.toString(), dirLeft.attr);
         const std::wstring* errorMsgNew = checkFailedRead(newFolder, errorMsg);
-        this->fillOneSide<LEFT_SIDE>(dirLeft.second.second, errorMsgNew, newFolder); //recurse
+        this->fillOneSide<LEFT_SIDE>(*dirLeft.folderCont, errorMsgNew, newFolder); //recurse
     },
     [&](const FolderData& dirRight) //right only
     {
-        FolderPair& newFolder = output.addSubFolder<RIGHT_SIDE>(dirRight.first, dirRight.second.first);
+        FolderPair& newFolder = output.addSubFolder<RIGHT_SIDE>(dirRight.name.toString(), dirRight.attr);
         const std::wstring* errorMsgNew = checkFailedRead(newFolder, errorMsg);
-        this->fillOneSide<RIGHT_SIDE>(dirRight.second.second, errorMsgNew, newFolder); //recurse
+        this->fillOneSide<RIGHT_SIDE>(*dirRight.folderCont, errorMsgNew, newFolder); //recurse
     },
 
     [&](const FolderData& dirLeft, const FolderData& dirRight) //both sides
     {
-        FolderPair& newFolder = output.addSubFolder(dirLeft.first, dirLeft.second.first, DIR_EQUAL, dirRight.first, dirRight.second.first);
+        const Zstring folderNameLeft  = dirLeft .name.toString();
+        const Zstring folderNameRight = dirRight.name.toString();
+
+        FolderPair& newFolder = output.addSubFolder(folderNameLeft, dirLeft.attr, DIR_EQUAL, folderNameRight, dirRight.attr);
         const std::wstring* errorMsgNew = checkFailedRead(newFolder, errorMsg);
 
         if (!errorMsgNew)
-            if (dirLeft.first != dirRight.first)
+            if (folderNameLeft != folderNameRight)
                 newFolder.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(newFolder));
 
-        mergeTwoSides(dirLeft.second.second, dirRight.second.second, errorMsgNew, newFolder); //recurse
+        mergeTwoSides(*dirLeft.folderCont, *dirRight.folderCont, errorMsgNew, newFolder); //recurse
     });
 }
 
@@ -795,6 +969,24 @@ void zen::logNonDefaultSettings(const xmlAccess::XmlGlobalSettings& activeSettin
     if (activeSettings.folderAccessTimeout != defaultSettings.folderAccessTimeout)
         changedSettingsMsg += L"\n    " + _("Folder access timeout") + L" - " + numberTo<std::wstring>(activeSettings.folderAccessTimeout);
 
+    if (activeSettings.traverserThreadsPerFolder != defaultSettings.traverserThreadsPerFolder)
+        changedSettingsMsg += L"\n    " + _("Folder traversal threads") + L" - " + numberTo<std::wstring>(activeSettings.traverserThreadsPerFolder);
+
+    if (activeSettings.contentCompareThreads != defaultSettings.contentCompareThreads)
+        changedSettingsMsg += L"\n    " + _("File content comparison threads") + L" - " + numberTo<std::wstring>(activeSettings.contentCompareThreads);
+
+    if (activeSettings.contentCompareSkipUnchanged != defaultSettings.contentCompareSkipUnchanged)
+        changedSettingsMsg += L"\n    " + _("Skip files unchanged since last content comparison") + L" - " + (activeSettings.contentCompareSkipUnchanged ? _("Enabled") : _("Disabled"));
+
+    if (activeSettings.syncThreadsPerFolderPair != defaultSettings.syncThreadsPerFolderPair)
+        changedSettingsMsg += L"\n    " + _("Parallel file operations per folder pair") + L" - " + numberTo<std::wstring>(activeSettings.syncThreadsPerFolderPair);
+
+    if (activeSettings.syncParallelFolderPairs != defaultSettings.syncParallelFolderPairs)
+        changedSettingsMsg += L"\n    " + _("Folder pairs synchronized in parallel") + L" - " + numberTo<std::wstring>(activeSettings.syncParallelFolderPairs);
+
+    if (activeSettings.syncPipelineFolderPairs != defaultSettings.syncPipelineFolderPairs)
+        changedSettingsMsg += L"\n    " + _("Synchronize folder pairs during comparison") + L" - " + (activeSettings.syncPipelineFolderPairs ? _("Enabled") : _("Disabled"));
+
     if (activeSettings.runWithBackgroundPriority != defaultSettings.runWithBackgroundPriority)
         changedSettingsMsg += L"\n    " + _("Run with background priority") + L" - " + (activeSettings.runWithBackgroundPriority ? _("Enabled") : _("Disabled"));
 
@@ -814,6 +1006,10 @@ FolderComparison zen::compare(xmlAccess::OptionalDialogs& warnings,
                               bool allowUserInteraction,
                               bool runWithBackgroundPriority,
                               int folderAccessTimeout,
+                              size_t traverserThreadsPerFolder,
+                              size_t contentCompareThreads,
+                              bool contentCompareSkipUnchanged,
+                              const ChangeList* changeList,
                               bool createDirLocks,
                               std::unique_ptr<LockHolder>& dirLocks,
                               const std::vector<FolderPairCfg>& cfgList,
@@ -919,40 +1115,102 @@ FolderComparison zen::compare(xmlAccess::OptionalDialogs& warnings,
     {
         //------------------- fill directory buffer ---------------------------------------------------
         std::set<DirectoryKey> dirsToRead;
+        std::map<DirectoryKey, IoCounters*> ioCountersTraversal; //folder read by multiple pairs: counted for the first one
 
         for (const auto& w : workLoad)
         {
+            IoCounters* ioCounters = getIoCounters(w.first.folderPathLeft, w.first.folderPathRight, callback);
+
             if (basefolderExisting(w.first.folderPathLeft)) //only traverse *currently existing* folders: at this point user is aware that non-ex + empty string are seen as empty folder!
+            {
                 dirsToRead.emplace(w.first.folderPathLeft,  w.second.filter.nameFilter, w.second.handleSymlinks);
+                ioCountersTraversal.emplace(DirectoryKey(w.first.folderPathLeft, w.second.filter.nameFilter, w.second.handleSymlinks), ioCounters);
+            }
             if (basefolderExisting(w.first.folderPathRight))
+            {
                 dirsToRead.emplace(w.first.folderPathRight, w.second.filter.nameFilter, w.second.handleSymlinks);
+                ioCountersTraversal.emplace(DirectoryKey(w.first.folderPathRight, w.second.filter.nameFilter, w.second.handleSymlinks), ioCounters);
+            }
         }
 
         FolderComparison output;
+        std::vector<std::shared_ptr<DatabaseSession>> dbSessions(workLoad.size()); //databases loaded for incremental comparison: reuse until synchronization
 
         //reduce peak memory by restricting lifetime of ComparisonBuffer to have ended when loading potentially huge InSyncFolder instance in redetermineSyncDirection()
+        //=> unless the database was already loaded for an incremental comparison or for skipping unchanged files (compare by content)
         {
+            //incremental comparison: read only folders with known changes, take everything else from the sync database
+            std::map<DirectoryKey, IncrementalScan> incrementalScans;
+            if (changeList)
+            {
+                auto getKey = [](const AbstractPath& folderPath, const FolderPairCfg& fpCfg) { return DirectoryKey(folderPath, fpCfg.filter.nameFilter, fpCfg.handleSymlinks); };
+
+                std::map<DirectoryKey, size_t> keyUseCount; //both sides of a folder pair must be read the same way: don't share a folder buffer with other pairs
+                for (const auto& w : workLoad)
+                {
+                    ++keyUseCount[getKey(w.first.folderPathLeft,  w.second)];
+                    ++keyUseCount[getKey(w.first.folderPathRight, w.second)];
+                }
+
+                for (size_t i = 0; i < workLoad.size(); ++i)
+                {
+                    const auto& w = workLoad[i];
+                    const DirectoryKey keyLeft  = getKey(w.first.folderPathLeft,  w.second);
+                    const DirectoryKey keyRight = getKey(w.first.folderPathRight, w.second);
+
+                    if (keyUseCount[keyLeft] != 1 || keyUseCount[keyRight] != 1 ||
+                        !basefolderExisting(w.first.folderPathLeft) || !basefolderExisting(w.first.folderPathRight) ||
+                        w.second.handleSymlinks == SymLinkHandling::FOLLOW) //changes within symlinked folders are not monitored
+                        continue;
+
+                    const Opt<std::set<Zstring, LessFilePath>> changedRelPaths = getChangedRelPaths(*changeList, w.first);
+                    if (!changedRelPaths)
+                        continue;
+
+                    std::shared_ptr<const InSyncFolder> lastSyncState;
+                    try
+                    {
+                        IoCountersScope ioScope(getIoCounters(w.first.folderPathLeft, w.first.folderPathRight, callback));
+                        lastSyncState = loadLastSynchronousState(w.first.folderPathLeft, w.first.folderPathRight, //throw FileError, FileErrorDatabaseNotExisting
+                        [&](const std::wstring& msg) { callback.reportStatus(msg); }, &dbSessions[i]); //throw X
+                    }
+                    catch (FileErrorDatabaseNotExisting&) { continue; } //initial synchronization
+                    catch (const FileError& e) { callback.reportInfo(e.toString()); continue; } //not critical: compare all items; errors are reported by redetermineSyncDirection() if relevant
+
+                    callback.reportInfo(_("Incremental comparison:") + L" " + AFS::getDisplayPath(w.first.folderPathLeft) + L" <-> " + AFS::getDisplayPath(w.first.folderPathRight) +
+                                        L" (" + _P("1 change", "%x changes", changedRelPaths->size()) + L")");
+
+                    incrementalScans.emplace(keyLeft,  IncrementalScan{ lastSyncState,  LEFT_SIDE, *changedRelPaths });
+                    incrementalScans.emplace(keyRight, IncrementalScan{ lastSyncState, RIGHT_SIDE, *changedRelPaths });
+                }
+            }
+
             //------------ traverse/read folders -----------------------------------------------------
             //PERF_START;
-            ComparisonBuffer cmpBuff(dirsToRead, fileTimeTolerance, callback);
+            ComparisonBuffer cmpBuff(dirsToRead, incrementalScans, ioCountersTraversal, fileTimeTolerance, traverserThreadsPerFolder, contentCompareThreads, contentCompareSkipUnchanged, callback);
             //PERF_STOP;
 
             //process binary comparison as one junk
             std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>> workLoadByContent;
-            for (const auto& w : workLoad)
-                switch (w.second.compareVar)
+            std::vector<std::shared_ptr<DatabaseSession>> dbSessionsByContent;
+            for (size_t i = 0; i < workLoad.size(); ++i)
+                switch (workLoad[i].second.compareVar)
                 {
                     case CompareVariant::TIME_SIZE:
                     case CompareVariant::SIZE:
                         break;
                     case CompareVariant::CONTENT:
-                        workLoadByContent.push_back(w);
+                        workLoadByContent  .push_back(workLoad[i]);
+                        dbSessionsByContent.push_back(dbSessions[i]);
                         break;
                 }
-            std::list<std::shared_ptr<BaseFolderPair>> outputByContent = cmpBuff.compareByContent(workLoadByContent);
+            std::list<std::shared_ptr<BaseFolderPair>> outputByContent = cmpBuff.compareByContent(workLoadByContent, dbSessionsByContent);
 
             //write output in expected order
             for (const auto& w : workLoad)
+            {
+                IoCountersScope ioScope(getIoCounters(w.first.folderPathLeft, w.first.folderPathRight, callback));
+
                 switch (w.second.compareVar)
                 {
                     case CompareVariant::TIME_SIZE:
@@ -970,6 +1228,7 @@ FolderComparison zen::compare(xmlAccess::OptionalDialogs& warnings,
                         }
                         break;
                 }
+            }
         }
         assert(output.size() == cfgList.size());
 
@@ -979,9 +1238,14 @@ FolderComparison zen::compare(xmlAccess::OptionalDialogs& warnings,
         {
             const FolderPairCfg& fpCfg = cfgList[it - output.begin()];
 
+            if (const std::shared_ptr<DatabaseSession>& dbSession = dbSessions[it - output.begin()])
+                it->setDatabaseSession(dbSession);
+
             callback.reportStatus(_("Calculating sync directions..."));
             callback.forceUiRefresh();
 
+            IoCountersScope ioScope(getIoCounters(it->getAbstractPath<LEFT_SIDE>(), it->getAbstractPath<RIGHT_SIDE>(), callback));
+
             tryReportingError([&]
             {
                 zen::redetermineSyncDirection(fpCfg.directionCfg, *it, //throw FileError
@@ -8,12 +8,15 @@
 #define COMPARISON_H_8032178534545426
 
 #include "file_hierarchy.h"
-#include "lib/process_xml.h"
+#include "lib/optional_dialogs.h"
 #include "process_callback.h"
 #include "lib/norm_filter.h"
 #include "lib/lock_holder.h"
+#include "lib/change_list.h"
 
 
+namespace xmlAccess { struct XmlGlobalSettings; }
+
 namespace zen
 {
 struct FolderPairCfg
@@ -56,6 +59,10 @@ FolderComparison compare(xmlAccess::OptionalDialogs& warnings,
                          bool allowUserInteraction,
                          bool runWithBackgroundPriority,
                          int folderAccessTimeout,
+                         size_t traverserThreadsPerFolder,
+                         size_t contentCompareThreads,
+                         bool contentCompareSkipUnchanged,
+                         const ChangeList* changeList, //optional: compare incrementally
                          bool createDirLocks,
                          std::unique_ptr<LockHolder>& dirLocks, //out
                          const std::vector<FolderPairCfg>& cfgList,
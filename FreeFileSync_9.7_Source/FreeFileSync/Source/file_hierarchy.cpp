@@ -12,6 +12,56 @@
 using namespace zen;
 
 
+std::atomic<ObjectTable::Slot*> ObjectTable::chunks_[1U << (32 - CHUNK_BITS)];
+std::mutex ObjectTable::lockAlloc_;
+uint32_t   ObjectTable::slotCount_    = 0;
+uint32_t   ObjectTable::freeListHead_ = 0;
+
+
+ObjectHandle ObjectTable::add(const void* obj)
+{
+    std::lock_guard<std::mutex> dummy(lockAlloc_);
+
+    uint32_t slotIdx = 0;
+    if (freeListHead_ != 0) //reuse most recently freed slot: probably still in cache
+    {
+        slotIdx = freeListHead_ - 1;
+        freeListHead_ = chunks_[slotIdx >> CHUNK_BITS].load(std::memory_order_relaxed)[slotIdx & CHUNK_MASK].nextFree;
+    }
+    else
+    {
+        if (slotCount_ == std::numeric_limits<uint32_t>::max())
+            throw std::bad_alloc();
+
+        slotIdx = slotCount_++;
+        std::atomic<Slot*>& chunk = chunks_[slotIdx >> CHUNK_BITS];
+        if (!chunk.load(std::memory_order_relaxed))
+            chunk.store(new Slot[CHUNK_MASK + 1], std::memory_order_release); //never freed: table lives until process exit
+    }
+
+    Slot& slot = chunks_[slotIdx >> CHUNK_BITS].load(std::memory_order_relaxed)[slotIdx & CHUNK_MASK];
+    slot.object.store(obj, std::memory_order_release);
+    return ObjectHandle(slotIdx, slot.generation.load(std::memory_order_relaxed));
+}
+
+
+void ObjectTable::remove(ObjectHandle handle)
+{
+    std::lock_guard<std::mutex> dummy(lockAlloc_);
+
+    Slot& slot = chunks_[handle.slot_ >> CHUNK_BITS].load(std::memory_order_relaxed)[handle.slot_ & CHUNK_MASK];
+    assert(slot.generation.load(std::memory_order_relaxed) == handle.generation_);
+
+    uint32_t generationNew = handle.generation_ + 1;
+    if (generationNew == 0) //wrap-around: 0 is reserved for null handles
+        generationNew = 1;
+
+    slot.generation.store(generationNew, std::memory_order_release); //invalidate first
+    slot.object.store(nullptr, std::memory_order_release);
+
+    slot.nextFree = freeListHead_;
+    freeListHead_ = handle.slot_ + 1;
+}
 
 
 void ContainerObject::removeEmptyRec()
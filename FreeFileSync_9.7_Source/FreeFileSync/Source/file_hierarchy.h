@@ -11,8 +11,12 @@
 #include <cstddef> //required by GCC 4.8.1 to find ptrdiff_t
 #include <string>
 #include <memory>
+#include <vector>
+#include <deque>
 #include <functional>
 #include <unordered_set>
+#include <atomic>
+#include <mutex>
 #include <zen/zstring.h>
 #include <zen/fixed_list.h>
 #include <zen/stl_tools.h>
@@ -47,6 +51,8 @@ struct FileAttributes
     bool isFollowedSymlink = false;
 };
 
+using ContentDigest = Zbase<char>; //SHA-256 of file content; optional: empty if not available
+
 
 struct LinkAttributes
 {
@@ -102,54 +108,170 @@ struct SelectParam<RIGHT_SIDE>
 
 //------------------------------------------------------------------
 
-struct FolderContainer
+//item name stored in a ScanArena: valid as long as the arena is alive
+struct ScanItemName
 {
-    //------------------------------------------------------------------
-    using FolderList  = std::map<Zstring, std::pair<FolderAttributes, FolderContainer>, LessFilePath>; //
-    using FileList    = std::map<Zstring, FileAttributes,  LessFilePath>; //key: file name
-    using SymlinkList = std::map<Zstring, LinkAttributes,  LessFilePath>; //
+    const Zchar* str = nullptr;
+    size_t len = 0;
+
+    Zstring toString() const { return Zstring(str, len); }
+};
+
+inline bool lessItemName (const ScanItemName& lhs, const ScanItemName& rhs) { return CmpFilePath()(lhs.str, lhs.len, rhs.str, rhs.len) <  0; }
+inline bool equalItemName(const ScanItemName& lhs, const ScanItemName& rhs) { return CmpFilePath()(lhs.str, lhs.len, rhs.str, rhs.len) == 0; }
+
+
+class ScanArena;
+
+/*
+scan result of a single folder: flat arrays sorted by item name (LessFilePath)
+    - item names are interned into the ScanArena of the traverser thread => no per-item heap allocation
+    - subfolder containers are owned by a ScanArena, too => addresses are stable while other traverser threads keep filling them
+    - items are appended unsorted during traversal; call sortItems() once the folder has been read completely
+*/
+class FolderContainer
+{
+public:
+    struct FileItem
+    {
+        ScanItemName name;
+        FileAttributes attr;
+    };
+
+    struct SymlinkItem
+    {
+        ScanItemName name;
+        LinkAttributes attr;
+    };
+
+    struct FolderItem
+    {
+        ScanItemName name;
+        FolderAttributes attr;
+        FolderContainer* folderCont; //always bound! owned by ScanArena
+    };
     //------------------------------------------------------------------
 
     FolderContainer() = default;
     FolderContainer           (const FolderContainer&) = delete; //catch accidental (and unnecessary) copying
     FolderContainer& operator=(const FolderContainer&) = delete; //
 
-    FileList    files;
-    SymlinkList symlinks; //non-followed symlinks
-    FolderList  folders;
+    std::vector<FileItem>    files;
+    std::vector<SymlinkItem> symlinks; //non-followed symlinks
+    std::vector<FolderItem>  folders;
+
+    void addSubFile(ScanArena& arena, const Zstring& itemName, const FileAttributes& attr);
+    void addSubLink(ScanArena& arena, const Zstring& itemName, const LinkAttributes& attr);
+    FolderContainer& addSubFolder(ScanArena& arena, const Zstring& itemName, const FolderAttributes& attr);
+
+    void sortItems(); //remove duplicates: keep most recent entry (e.g. added during folder traverser "retry")
+};
+
+
+//per-thread allocator for scan results: not thread-safe!
+class ScanArena
+{
+public:
+    ScanArena() {}
 
-    void addSubFile(const Zstring& itemName, const FileAttributes& attr)
+    ScanItemName internName(const Zstring& itemName)
     {
-        auto rv = files.emplace(itemName, attr);
-        if (!rv.second) //update entry if already existing (e.g. during folder traverser "retry") => does not handle different item name case (irrelvant!..)
-            rv.first->second = attr;
+        const size_t len = itemName.size();
+        if (blocks_.empty() || len > blockSize_ - blockPos_)
+        {
+            blockSize_ = std::max<size_t>(BLOCK_SIZE_MIN, len);
+            blocks_.push_back(std::make_unique<Zchar[]>(blockSize_));
+            blockPos_ = 0;
+        }
+        Zchar* const str = blocks_.back().get() + blockPos_;
+        std::copy(itemName.begin(), itemName.end(), str);
+        blockPos_ += len;
+        return { str, len };
     }
 
-    void addSubLink(const Zstring& itemName, const LinkAttributes& attr)
+    FolderContainer& createFolder()
     {
-        auto rv = symlinks.emplace(itemName, attr);
-        if (!rv.second)
-            rv.first->second = attr;
+        folders_.emplace_back(); //std::deque::emplace_back() does not invalidate references
+        return folders_.back();
     }
 
-    FolderContainer& addSubFolder(const Zstring& itemName, const FolderAttributes& attr)
+private:
+    ScanArena           (const ScanArena&) = delete;
+    ScanArena& operator=(const ScanArena&) = delete;
+
+    static const size_t BLOCK_SIZE_MIN = 64 * 1024;
+
+    std::vector<std::unique_ptr<Zchar[]>> blocks_;
+    size_t blockSize_ = 0;
+    size_t blockPos_  = 0;
+
+    std::deque<FolderContainer> folders_;
+};
+
+//------------------------------------------------------------------
+
+inline
+void FolderContainer::addSubFile(ScanArena& arena, const Zstring& itemName, const FileAttributes& attr)
+{
+    files.push_back({ arena.internName(itemName), attr });
+}
+
+
+inline
+void FolderContainer::addSubLink(ScanArena& arena, const Zstring& itemName, const LinkAttributes& attr)
+{
+    symlinks.push_back({ arena.internName(itemName), attr });
+}
+
+
+inline
+FolderContainer& FolderContainer::addSubFolder(ScanArena& arena, const Zstring& itemName, const FolderAttributes& attr)
+{
+    FolderContainer& subFolder = arena.createFolder();
+    folders.push_back({ arena.internName(itemName), attr, &subFolder });
+    return subFolder;
+}
+
+
+namespace impl
+{
+template <class Item> inline
+void sortScanItems(std::vector<Item>& items)
+{
+    std::stable_sort(items.begin(), items.end(), [](const Item& lhs, const Item& rhs) { return lessItemName(lhs.name, rhs.name); });
+
+    //the last of a sequence of equal names is the most recent => does not handle different item name case (irrelvant!..)
+    auto itOut = items.begin();
+    for (auto it = items.begin(); it != items.end();)
     {
-        auto& p = folders[itemName]; //value default-construction is okay here
-        p.first = attr;
-        return p.second;
-
-        //auto rv = folders.emplace(itemName, std::pair<FolderAttributes, FolderContainer>(attr, FolderContainer()));
-        //if (!rv.second)
-        //  rv.first->second.first = attr;
-        //return rv.first->second.second;
+        auto itLast = it;
+        while (itLast + 1 != items.end() && equalItemName(itLast->name, (itLast + 1)->name))
+            ++itLast;
+
+        if (itOut != itLast)
+            *itOut = std::move(*itLast);
+        ++itOut;
+        it = itLast + 1;
     }
-};
+    items.erase(itOut, items.end());
+}
+}
+
+
+inline
+void FolderContainer::sortItems()
+{
+    impl::sortScanItems(files);
+    impl::sortScanItems(symlinks);
+    impl::sortScanItems(folders);
+}
 
 class BaseFolderPair;
 class FolderPair;
 class FilePair;
 class SymlinkPair;
 class FileSystemObject;
+struct DatabaseSession; //see db_file.h
 
 /*------------------------------------------------------------------
     inheritance diagram:
@@ -309,6 +431,10 @@ public:
     int  getFileTimeTolerance() const { return fileTimeTolerance_; }
     const std::vector<unsigned int>& getIgnoredTimeShift() const { return ignoreTimeShiftMinutes_; }
 
+    //sync database files as loaded during comparison: managed by db_file.cpp
+    const std::shared_ptr<DatabaseSession>& getDatabaseSession() const { return dbSession_; }
+    void setDatabaseSession(const std::shared_ptr<DatabaseSession>& session) { dbSession_ = session; }
+
     void flip() override;
 
 private:
@@ -325,6 +451,8 @@ private:
 
     AbstractPath folderPathLeft_;
     AbstractPath folderPathRight_;
+
+    std::shared_ptr<DatabaseSession> dbSession_; //optional
 };
 
 
@@ -381,39 +509,99 @@ struct FSObjectVisitor
 };
 
 
+//weak reference to an object registered in ObjectTable: slot index + generation
+class ObjectHandle
+{
+public:
+    ObjectHandle() {}
+    ObjectHandle(std::nullptr_t) {}
+
+    explicit operator bool() const { return generation_ != 0; }
+
+    bool operator==(const ObjectHandle& other) const { return slot_ == other.slot_ && generation_ == other.generation_; }
+    bool operator!=(const ObjectHandle& other) const { return !(*this == other); }
+
+    struct Hash { size_t operator()(const ObjectHandle& handle) const { return std::hash<uint64_t>()((static_cast<uint64_t>(handle.slot_) << 32) | handle.generation_); } };
+
+private:
+    ObjectHandle(uint32_t slot, uint32_t generation) : slot_(slot), generation_(generation) {}
+    friend class ObjectTable;
+
+    uint32_t slot_       = 0;
+    uint32_t generation_ = 0; //0: null handle
+};
+
+
+//process-wide slot table: O(1) validity check without hashing, thread-safe
+//- slots are reused after removal, but with an incremented generation => stale handles never match again
+//- slot memory is allocated in fixed-size chunks that are never moved or freed => lock-free lookup
+class ObjectTable
+{
+public:
+    static ObjectHandle add(const void* obj);
+    static void remove(ObjectHandle handle);
+
+    static const void* retrieve(ObjectHandle handle) //returns nullptr if object is not valid anymore
+    {
+        if (!handle)
+            return nullptr;
+
+        const Slot* chunk = chunks_[handle.slot_ >> CHUNK_BITS].load(std::memory_order_acquire);
+        const Slot& slot = chunk[handle.slot_ & CHUNK_MASK];
+
+        //seqlock-like: don't return an object of a slot that is reused concurrently
+        if (slot.generation.load(std::memory_order_acquire) != handle.generation_)
+            return nullptr;
+        const void* obj = slot.object.load(std::memory_order_acquire);
+        return slot.generation.load(std::memory_order_acquire) == handle.generation_ ? obj : nullptr;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> generation{ 1 }; //never 0
+        uint32_t nextFree = 0;                 //only valid while slot is on free list
+        std::atomic<const void*> object{ nullptr };
+    };
+
+    static const int      CHUNK_BITS = 16;
+    static const uint32_t CHUNK_MASK = (1U << CHUNK_BITS) - 1;
+
+    static std::atomic<Slot*> chunks_[1U << (32 - CHUNK_BITS)];
+
+    static std::mutex lockAlloc_; //protects the following:
+    static uint32_t slotCount_; //slots ever allocated
+    static uint32_t freeListHead_; //slot index + 1; 0: empty free list
+};
+
+
 //inherit from this class to allow safe random access by id instead of unsafe raw pointer
 //allow for similar semantics like std::weak_ptr without having to use std::shared_ptr
 template <class T>
 class ObjectMgr
 {
 public:
-    using ObjectId      = ObjectMgr* ;
-    using ObjectIdConst = const ObjectMgr*;
+    using ObjectId      = ObjectHandle;
+    using ObjectIdConst = ObjectHandle;
 
-    ObjectIdConst  getId() const { return this; }
-    /**/  ObjectId getId()       { return this; }
+    ObjectId getId() const { return id_; }
 
-    static const T* retrieve(ObjectIdConst id) //returns nullptr if object is not valid anymore
+    static T* retrieve(ObjectId id) //returns nullptr if object is not valid anymore
     {
-        const auto& aObj = activeObjects();
-        return static_cast<const T*>(aObj.find(id) == aObj.end() ? nullptr : id);
+        if (const void* obj = ObjectTable::retrieve(id))
+            return static_cast<T*>(const_cast<ObjectMgr*>(static_cast<const ObjectMgr*>(obj)));
+        return nullptr;
     }
-    static T* retrieve(ObjectId id) { return const_cast<T*>(retrieve(static_cast<ObjectIdConst>(id))); }
 
 protected:
-    ObjectMgr () { activeObjects().insert(this); }
-    ~ObjectMgr() { activeObjects().erase (this); }
+    ObjectMgr () : id_(ObjectTable::add(static_cast<const ObjectMgr*>(this))) {}
+    ~ObjectMgr() { ObjectTable::remove(id_); }
 
 private:
     ObjectMgr           (const ObjectMgr& rhs) = delete;
     ObjectMgr& operator=(const ObjectMgr& rhs) = delete; //it's not well-defined what copying an objects means regarding object-identity in this context
 
-    static std::unordered_set<const ObjectMgr*>& activeObjects()
-    {
-        static std::unordered_set<const ObjectMgr*> inst;
-        return inst; //external linkage (even in header file!)
-    }
-
+    const ObjectId id_;
 };
 
 //------------------------------------------------------------------
@@ -582,6 +770,10 @@ public:
     void setMoveRef(ObjectId refId) { moveFileRef_ = refId; } //reference to corresponding renamed file
     ObjectId getMoveRef() const { return moveFileRef_; } //may be nullptr
 
+    //digest of (identical) content on both sides: set by compare by content, persisted in sync database
+    void setContentDigest(const ContentDigest& digest) { contentDigest_ = digest; }
+    const ContentDigest& getContentDigest() const { return contentDigest_; } //may be empty
+
     CompareFilesResult getFileCategory() const;
 
     SyncOperation testSyncOperation(SyncDirection testSyncDir) const override; //semantics: "what if"! assumes "active, no conflict, no recursion (directory)!
@@ -611,6 +803,7 @@ private:
     FileAttributes attrR_;
 
     ObjectId moveFileRef_ = nullptr; //optional, filled by redetermineSyncDirection()
+    ContentDigest contentDigest_;    //optional, filled by compareByContent()
 };
 
 //------------------------------------------------------------------
@@ -1052,6 +1245,7 @@ void BaseFolderPair::flip()
     ContainerObject::flip();
     std::swap(folderAvailableLeft_, folderAvailableRight_);
     std::swap(folderPathLeft_,      folderPathRight_);
+    dbSession_ = nullptr; //describes the unflipped folder pair
 }
 
 
@@ -1173,6 +1367,7 @@ void FilePair::setSyncedTo(const Zstring& itemName,
     SelectParam<sideSrc>::ref(attrL_, attrR_) = FileAttributes(lastWriteTimeSrc, fileSize, fileIdSrc, isSymlinkSrc);
 
     moveFileRef_ = nullptr;
+    contentDigest_.clear(); //content was (potentially) written: digest needs to be recalculated
     FileSystemObject::setSynced(itemName); //set FileSystemObject specific part
 }
 
@@ -6,6 +6,7 @@
 
 #include "abstract.h"
 #include <zen/serialize.h>
+#include <zen/stream_copy.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
 
@@ -58,6 +59,41 @@ Opt<AbstractPath> AFS::getParentFolderPath(const AbstractPath& ap)
 }
 
 
+namespace
+{
+struct InputStreamIoStats : public AFS::InputStream
+{
+    InputStreamIoStats(std::unique_ptr<InputStream>&& streamIn) : streamIn_(std::move(streamIn)) {}
+
+    size_t read(void* buffer, size_t bytesToRead) override //throw FileError, ErrorFileLocked, X
+    {
+        IoOperationTimer ioTimer(IoOperation::READ);
+        const size_t bytesRead = streamIn_->read(buffer, bytesToRead); //throw FileError, ErrorFileLocked, X
+        ioTimer.addBytes(bytesRead);
+        return bytesRead;
+    }
+
+    size_t getBlockSize() const override { return streamIn_->getBlockSize(); }
+
+    Opt<AFS::StreamAttributes> getAttributesBuffered() override { return streamIn_->getAttributesBuffered(); } //throw FileError
+
+private:
+    const std::unique_ptr<InputStream> streamIn_;
+};
+}
+
+
+std::unique_ptr<AFS::InputStream> AFS::getInputStream(const AbstractPath& ap, const IOCallback& notifyUnbufferedIO) //throw FileError, ErrorFileLocked, X
+{
+    IoOperationTimer dummy(IoOperation::OPEN_INPUT);
+    auto streamIn = ap.afs->getInputStream(ap.afsPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+
+    if (getCurrentIoCounters()) //don't add a stream layer unless I/O statistics are collected
+        return std::make_unique<InputStreamIoStats>(std::move(streamIn));
+    return streamIn;
+}
+
+
 Opt<AfsPath> AFS::getParentAfsPath(const AfsPath& afsPath)
 {
     if (afsPath.value.empty())
@@ -72,8 +108,9 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsPathSource, const St
                                           const AbstractPath& apTarget, const IOCallback& notifyUnbufferedIO) const
 {
     int64_t totalUnbufferedIO = 0;
+    AsyncIOCounter readIOCounter; //streamIn is read on a worker thread by bufferedStreamCopyPipelined()
 
-    auto streamIn = getInputStream(afsPathSource, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError, ErrorFileLocked, X
+    auto streamIn = getInputStream(afsPathSource, readIOCounter.getCallback()); //throw FileError, ErrorFileLocked, X
 
     StreamAttributes attrSourceNew = {};
     //try to get the most current attributes if possible (input file might have changed after comparison!)
@@ -86,7 +123,7 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsPathSource, const St
     //target existing: undefined behavior! (fail/overwrite/auto-rename)
     auto streamOut = getOutputStream(apTarget, &attrSourceNew.fileSize, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError
 
-    bufferedStreamCopy(*streamIn, *streamOut); //throw FileError, ErrorFileLocked, X
+    bufferedStreamCopyPipelined(*streamIn, *streamOut, readIOCounter, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError, ErrorFileLocked, X
 
     const FileId targetFileId = streamOut->finalize(); //throw FileError, X
 
@@ -142,6 +179,8 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, con
                                                const std::function<void()>& onDeleteTargetFile,
                                                const IOCallback& notifyUnbufferedIO)
 {
+    IoOperationTimer ioTimer(IoOperation::COPY_FILE);
+
     auto copyFilePlain = [&](const AbstractPath& apTargetTmp)
     {
         //caveat: typeid returns static type for pointers, dynamic type for references!!!
@@ -177,6 +216,7 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, con
         //-------------------------------------------------------------------------------------------
 
         const AFS::FileCopyResult result = copyFilePlain(apTargetTmp); //throw FileError, ErrorFileLocked
+        ioTimer.addBytes(result.fileSize);
 
         //transactional behavior: ensure cleanup; not needed before copyFilePlain() which is already transactional
         ZEN_ON_SCOPE_FAIL( try { AFS::removeFilePlain(apTargetTmp); }
@@ -210,7 +250,9 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, con
         if (onDeleteTargetFile)
             onDeleteTargetFile();
 
-        return copyFilePlain(apTarget); //throw FileError, ErrorFileLocked
+        const AFS::FileCopyResult result = copyFilePlain(apTarget); //throw FileError, ErrorFileLocked
+        ioTimer.addBytes(result.fileSize);
+        return result;
     }
 }
 
@@ -13,6 +13,7 @@
 #include <zen/optional.h>
 #include <zen/serialize.h> //InputStream/OutputStream support buffered stream concept
 #include "../lib/icon_holder.h"
+#include "../lib/io_stats.h"
 
 
 namespace zen
@@ -89,7 +90,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         std::vector<Zstring> relPath; //
     };
     //(hopefully) fast: does not distinguish between error/not existing
-    static ItemType getItemType(const AbstractPath& ap) { return ap.afs->getItemType(ap.afsPath); } //throw FileError
+    static ItemType getItemType(const AbstractPath& ap) { IoOperationTimer dummy(IoOperation::GET_ITEM_TYPE); return ap.afs->getItemType(ap.afsPath); } //throw FileError
     //execute potentially SLOW folder traversal but distinguish error/not existing
     static Opt<ItemType> getItemTypeIfExists(const AbstractPath& ap); //throw FileError
     static PathStatus getPathStatus(const AbstractPath& ap); //throw FileError
@@ -97,7 +98,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
 
     //target existing: undefined behavior! (fail/overwrite)
     //does NOT create parent directories recursively if not existing
-    static void createFolderPlain(const AbstractPath& ap) { ap.afs->createFolderPlain(ap.afsPath); } //throw FileError
+    static void createFolderPlain(const AbstractPath& ap) { IoOperationTimer dummy(IoOperation::CREATE_FOLDER); ap.afs->createFolderPlain(ap.afsPath); } //throw FileError
 
     //no error if already existing
     //creates parent directories recursively if not existing
@@ -109,11 +110,11 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
                                               const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion,    //optional
                                               const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion); //one call for each *existing* object!
 
-    static void removeFilePlain   (const AbstractPath& ap) { ap.afs->removeFilePlain   (ap.afsPath); } //throw FileError
-    static void removeSymlinkPlain(const AbstractPath& ap) { ap.afs->removeSymlinkPlain(ap.afsPath); } //throw FileError
-    static void removeFolderPlain (const AbstractPath& ap) { ap.afs->removeFolderPlain (ap.afsPath); } //throw FileError
+    static void removeFilePlain   (const AbstractPath& ap) { IoOperationTimer dummy(IoOperation::REMOVE_FILE   ); ap.afs->removeFilePlain   (ap.afsPath); } //throw FileError
+    static void removeSymlinkPlain(const AbstractPath& ap) { IoOperationTimer dummy(IoOperation::REMOVE_SYMLINK); ap.afs->removeSymlinkPlain(ap.afsPath); } //throw FileError
+    static void removeFolderPlain (const AbstractPath& ap) { IoOperationTimer dummy(IoOperation::REMOVE_FOLDER ); ap.afs->removeFolderPlain (ap.afsPath); } //throw FileError
     //----------------------------------------------------------------------------------------------------------------
-    static void setModTime(const AbstractPath& ap, time_t modTime) { ap.afs->setModTime(ap.afsPath, modTime); } //throw FileError, follows symlinks
+    static void setModTime(const AbstractPath& ap, time_t modTime) { IoOperationTimer dummy(IoOperation::SET_MOD_TIME); ap.afs->setModTime(ap.afsPath, modTime); } //throw FileError, follows symlinks
 
     static AbstractPath getSymlinkResolvedPath(const AbstractPath& ap) { return ap.afs->getSymlinkResolvedPath(ap.afsPath); } //throw FileError
     static std::string getSymlinkBinaryContent(const AbstractPath& ap) { return ap.afs->getSymlinkBinaryContent(ap.afsPath); } //throw FileError
@@ -169,14 +170,16 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     };
 
     //return value always bound:
-    static std::unique_ptr<InputStream> getInputStream(const AbstractPath& ap, const IOCallback& notifyUnbufferedIO) //throw FileError, ErrorFileLocked, X
-    { return ap.afs->getInputStream(ap.afsPath, notifyUnbufferedIO); }
+    static std::unique_ptr<InputStream> getInputStream(const AbstractPath& ap, const IOCallback& notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
 
     //target existing: undefined behavior! (fail/overwrite/auto-rename)
     static std::unique_ptr<OutputStream> getOutputStream(const AbstractPath& ap, //throw FileError
                                                          const uint64_t* streamSize,           //optional
                                                          const IOCallback& notifyUnbufferedIO) //
-    { return std::make_unique<OutputStream>(ap.afs->getOutputStream(ap.afsPath, streamSize, notifyUnbufferedIO), ap, streamSize); }
+    {
+        IoOperationTimer dummy(IoOperation::OPEN_OUTPUT);
+        return std::make_unique<OutputStream>(ap.afs->getOutputStream(ap.afsPath, streamSize, notifyUnbufferedIO), ap, streamSize);
+    }
     //----------------------------------------------------------------------------------------------------------------
 
     struct TraverserCallback
@@ -226,7 +229,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     };
 
     //- client needs to handle duplicate file reports! (FilePlusTraverser fallback, retrying to read directory contents, ...)
-    static void traverseFolder(const AbstractPath& ap, TraverserCallback& sink /*throw X*/) { ap.afs->traverseFolder(ap.afsPath, sink); } //throw X
+    static void traverseFolder(const AbstractPath& ap, TraverserCallback& sink /*throw X*/) { IoOperationTimer dummy(IoOperation::TRAVERSE_FOLDER); ap.afs->traverseFolder(ap.afsPath, sink); } //throw X
     //----------------------------------------------------------------------------------------------------------------
 
     static bool supportPermissionCopy(const AbstractPath& apSource, const AbstractPath& apTarget); //throw FileError
@@ -275,14 +278,14 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     struct RecycleSession
     {
         virtual ~RecycleSession() {}
-        virtual bool recycleItem(const AbstractPath& itemPath, const Zstring& logicalRelPath) = 0; //throw FileError; return true if item existed
+        virtual bool recycleItem(const AbstractPath& itemPath, const Zstring& logicalRelPath) = 0; //throw FileError; return true if item existed; thread-safe: called by parallel file operations
         virtual void tryCleanup(const std::function<void (const std::wstring& displayPath)>& notifyDeletionStatus /*optional; currentItem may be empty*/) = 0; //throw FileError
     };
 
     //precondition: supportsRecycleBin() must return true!
     static std::unique_ptr<RecycleSession> createRecyclerSession(const AbstractPath& ap) { return ap.afs->createRecyclerSession(ap.afsPath); } //throw FileError, return value must be bound!
 
-    static void recycleItemIfExists(const AbstractPath& ap) { ap.afs->recycleItemIfExists(ap.afsPath); } //throw FileError
+    static void recycleItemIfExists(const AbstractPath& ap) { IoOperationTimer dummy(IoOperation::RECYCLE); ap.afs->recycleItemIfExists(ap.afsPath); } //throw FileError
 
     //================================================================================================================
 
@@ -494,7 +497,9 @@ AbstractFileSystem::OutputStream::~OutputStream()
 inline
 void AbstractFileSystem::OutputStream::write(const void* data, size_t len) //throw FileError, X
 {
+    IoOperationTimer ioTimer(IoOperation::WRITE);
     outStream_->write(data, len); //throw FileError, X
+    ioTimer.addBytes(len);
     bytesWrittenTotal_ += len;
 }
 
@@ -509,6 +514,7 @@ AbstractFileSystem::FileId AbstractFileSystem::OutputStream::finalize() //throw
                                               L"%x", numberTo<std::wstring>(*bytesExpected_)),
                                    L"%y", numberTo<std::wstring>(bytesWrittenTotal_)));
 
+    IoOperationTimer dummy(IoOperation::WRITE);
     const FileId fileId = outStream_->finalize(); //throw FileError, X
     finalizeSucceeded_ = true;
     return fileId;
@@ -530,6 +536,7 @@ bool AbstractFileSystem::supportPermissionCopy(const AbstractPath& apSource, con
 inline
 void AbstractFileSystem::renameItem(const AbstractPath& apSource, const AbstractPath& apTarget) //throw FileError, ErrorDifferentVolume
 {
+    IoOperationTimer dummy(IoOperation::RENAME_ITEM);
     if (typeid(*apSource.afs) == typeid(*apTarget.afs))
         return apSource.afs->renameItemForSameAfsType(apSource.afsPath, apTarget); //throw FileError, ErrorDifferentVolume
 
@@ -543,6 +550,7 @@ void AbstractFileSystem::renameItem(const AbstractPath& apSource, const Abstract
 inline
 void AbstractFileSystem::copyNewFolder(const AbstractPath& apSource, const AbstractPath& apTarget, bool copyFilePermissions) //throw FileError
 {
+    IoOperationTimer dummy(IoOperation::COPY_FOLDER);
     if (typeid(*apSource.afs) == typeid(*apTarget.afs))
         return apSource.afs->copyNewFolderForSameAfsType(apSource.afsPath, apTarget, copyFilePermissions); //throw FileError
 
@@ -559,6 +567,7 @@ void AbstractFileSystem::copyNewFolder(const AbstractPath& apSource, const Abstr
 inline
 void AbstractFileSystem::copySymlink(const AbstractPath& apSource, const AbstractPath& apTarget, bool copyFilePermissions) //throw FileError
 {
+    IoOperationTimer dummy(IoOperation::COPY_SYMLINK);
     if (typeid(*apSource.afs) == typeid(*apTarget.afs))
         return apSource.afs->copySymlinkForSameAfsType(apSource.afsPath, apTarget, copyFilePermissions); //throw FileError
 
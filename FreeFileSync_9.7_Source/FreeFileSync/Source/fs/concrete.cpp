@@ -6,6 +6,8 @@
 
 #include "concrete.h"
 #include "native.h"
+#include "memory.h"
+#include "latency.h"
 
 using namespace zen;
 
@@ -17,6 +19,11 @@ AbstractPath zen::createAbstractPath(const Zstring& itemPathPhrase) //noexcept
         return createItemPathNative(itemPathPhrase); //noexcept
 
     //then the rest:
+    if (acceptsItemPathPhraseMemory(itemPathPhrase)) //noexcept
+        return createItemPathMemory(itemPathPhrase); //noexcept
+
+    if (acceptsItemPathPhraseLatency(itemPathPhrase)) //noexcept
+        return createItemPathLatency(itemPathPhrase); //noexcept
 
 
     //no idea? => native!
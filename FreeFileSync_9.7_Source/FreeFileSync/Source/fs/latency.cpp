@@ -0,0 +1,455 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "latency.h"
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <random>
+#include "concrete.h"
+
+using namespace zen;
+using AFS = AbstractFileSystem;
+
+
+namespace
+{
+const Zchar latencyPrefix[] = Zstr("latency:");
+
+
+struct LatencyConfig
+{
+    std::chrono::milliseconds delay{ 0 }; //per call
+    uint64_t bandwidth = 0; //bytes per second and stream; 0: unlimited
+    double errorRate = 0;   //[0, 1]
+};
+
+
+LatencyConfig parseLatencyOptions(const Zstring& options)
+{
+    LatencyConfig cfg;
+    for (const Zstring& option : split(options, Zstr(','), SplitType::SKIP_EMPTY))
+    {
+        const Zstring key   = trimCpy(beforeFirst(option, Zstr('='), IF_MISSING_RETURN_NONE));
+        const Zstring value = trimCpy(afterFirst (option, Zstr('='), IF_MISSING_RETURN_NONE));
+
+        if (key == Zstr("delay"))
+            cfg.delay = std::chrono::milliseconds(std::max(stringTo<int>(value), 0));
+        else if (key == Zstr("bandwidth"))
+            cfg.bandwidth = stringTo<uint64_t>(value) * 1024;
+        else if (key == Zstr("errors"))
+            cfg.errorRate = std::min(std::max(stringTo<double>(value), 0.0), 1.0);
+        else
+            assert(false);
+    }
+    return cfg;
+}
+
+
+AbstractPath wrapItemPathLatency(const AbstractPath& innerPath, const Zstring& options);
+
+
+//limit throughput of a single stream
+class StreamThrottle
+{
+public:
+    explicit StreamThrottle(uint64_t bytesPerSec) : bytesPerSec_(bytesPerSec) {}
+
+    void onTransfer(size_t bytes)
+    {
+        if (bytesPerSec_ == 0)
+            return;
+        bytesTotal_ += bytes;
+        std::this_thread::sleep_until(startTime_ + std::chrono::microseconds(bytesTotal_ * 1000000 / bytesPerSec_));
+    }
+
+private:
+    const uint64_t bytesPerSec_;
+    uint64_t bytesTotal_ = 0;
+    const std::chrono::steady_clock::time_point startTime_ = std::chrono::steady_clock::now();
+};
+
+
+class LatencyFileSystem;
+
+struct InputStreamLatency : public AbstractFileSystem::InputStream
+{
+    InputStreamLatency(std::unique_ptr<InputStream>&& streamIn, const LatencyFileSystem& afs, const AfsPath& afsPath);
+
+    size_t read(void* buffer, size_t bytesToRead) override; //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+    size_t getBlockSize() const override { return streamIn_->getBlockSize(); } //non-zero block size is AFS contract!
+    Opt<AFS::StreamAttributes> getAttributesBuffered() override { return streamIn_->getAttributesBuffered(); } //throw FileError
+
+private:
+    const std::unique_ptr<InputStream> streamIn_; //bound
+    const LatencyFileSystem& afs_;
+    const AfsPath afsPath_;
+    StreamThrottle throttle_;
+};
+
+
+struct OutputStreamLatency : public AbstractFileSystem::OutputStreamImpl
+{
+    OutputStreamLatency(std::unique_ptr<AFS::OutputStream>&& streamOut, const LatencyFileSystem& afs, const AfsPath& afsPath);
+
+    void write(const void* buffer, size_t bytesToWrite) override; //throw FileError, X
+    AFS::FileId finalize() override; //throw FileError, X
+
+private:
+    const std::unique_ptr<AFS::OutputStream> streamOut_; //bound; transactional: deletes inner file if not finalized
+    const LatencyFileSystem& afs_;
+    const AfsPath afsPath_;
+    StreamThrottle throttle_;
+};
+
+
+class TraverserCallbackLatency : public AFS::TraverserCallback
+{
+public:
+    TraverserCallbackLatency(const LatencyFileSystem& afs, const AfsPath& folderPath, TraverserCallback& sink) :
+        afs_(afs), folderPath_(folderPath), sink_(sink) {}
+
+    TraverserCallbackLatency(const LatencyFileSystem& afs, const AfsPath& folderPath, std::unique_ptr<TraverserCallback>&& sink) :
+        afs_(afs), folderPath_(folderPath), sinkOwned_(std::move(sink)), sink_(*sinkOwned_) {}
+
+    void                               onFile   (const FileInfo&    fi) override { sink_.onFile(fi); }           //
+    HandleLink                         onSymlink(const SymlinkInfo& si) override { return sink_.onSymlink(si); } //throw X
+    std::unique_ptr<TraverserCallback> onFolder (const FolderInfo&  fi) override;                                //
+
+    HandleError reportDirError (const std::wstring& msg, size_t retryNumber)                         override { return sink_.reportDirError (msg, retryNumber); }
+    HandleError reportItemError(const std::wstring& msg, size_t retryNumber, const Zstring& itemName) override { return sink_.reportItemError(msg, retryNumber, itemName); }
+
+private:
+    const LatencyFileSystem& afs_;
+    const AfsPath folderPath_;
+    const std::unique_ptr<TraverserCallback> sinkOwned_; //optional
+    TraverserCallback& sink_;
+};
+
+
+struct RecycleSessionLatency : public AbstractFileSystem::RecycleSession
+{
+    RecycleSessionLatency(std::unique_ptr<RecycleSession>&& session) : session_(std::move(session)) {}
+
+    bool recycleItem(const AbstractPath& itemPath, const Zstring& logicalRelPath) override; //throw FileError
+    void tryCleanup(const std::function<void (const std::wstring& displayPath)>& notifyDeletionStatus) override { session_->tryCleanup(notifyDeletionStatus); } //throw FileError
+
+private:
+    const std::unique_ptr<RecycleSession> session_; //bound
+};
+
+//===========================================================================================================================
+
+class LatencyFileSystem : public AbstractFileSystem
+{
+public:
+    LatencyFileSystem(const AbstractPath& innerRootPath, const Zstring& options) : innerRootPath_(innerRootPath), options_(options), cfg_(parseLatencyOptions(options)) {}
+
+    const LatencyConfig& getConfig() const { return cfg_; }
+
+    AbstractPath getInnerPath(const AfsPath& afsPath) const { return AFS::appendRelPath(innerRootPath_, afsPath.value); }
+
+    static AbstractPath getInnerPath(const AbstractPath& ap) { return static_cast<const LatencyFileSystem&>(getAfs(ap)).getInnerPath(getAfsPath(ap)); }
+
+    template <class Function>
+    void simulateCall(Function getErrorMsg) const //throw FileError
+    {
+        if (cfg_.delay.count() > 0)
+            std::this_thread::sleep_for(cfg_.delay);
+
+        if (cfg_.errorRate > 0)
+        {
+            bool failed = false;
+            {
+                std::lock_guard<std::mutex> dummy(lockRandom_);
+                failed = std::bernoulli_distribution(cfg_.errorRate)(random_);
+            }
+            if (failed)
+                throw FileError(getErrorMsg(), L"Simulated error.");
+        }
+    }
+
+    bool simulateFolderRead(const AfsPath& afsPath, TraverserCallback& sink) const //throw X; return "true" on success, "false" if error was ignored
+    {
+        return tryReportingDirError([&] //throw X
+        {
+            simulateCall([&] { return replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        }, sink);
+    }
+
+    std::wstring getDisplayPath(const AfsPath& afsPath) const override { return utfTo<std::wstring>(latencyPrefix + options_ + Zstr('|')) + AFS::getDisplayPath(getInnerPath(afsPath)); }
+
+private:
+    Zstring getInitPathPhrase(const AfsPath& afsPath) const override { return latencyPrefix + options_ + Zstr('|') + AFS::getInitPathPhrase(getInnerPath(afsPath)); }
+
+    bool isNullFileSystem() const override { return AFS::isNullPath(innerRootPath_); }
+
+    int compareDeviceRootSameAfsType(const AbstractFileSystem& afsRhs) const override
+    {
+        return compareAbstractPath(innerRootPath_, static_cast<const LatencyFileSystem&>(afsRhs).innerRootPath_);
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    ItemType getItemType(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        return AFS::getItemType(getInnerPath(afsPath)); //throw FileError
+    }
+
+    PathStatusImpl getPathStatus(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+
+        const PathStatus ps = AFS::getPathStatus(getInnerPath(afsPath)); //throw FileError
+        return { ps.existingType, getAfsPath(ps.existingPath), ps.relPath }; //inner root path has empty AfsPath
+    }
+    //----------------------------------------------------------------------------------------------------------------
+
+    void createFolderPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot create directory %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        AFS::createFolderPlain(getInnerPath(afsPath)); //throw FileError
+    }
+
+    void removeFilePlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot delete file %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        AFS::removeFilePlain(getInnerPath(afsPath)); //throw FileError
+    }
+
+    void removeSymlinkPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot delete file %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        AFS::removeSymlinkPlain(getInnerPath(afsPath)); //throw FileError
+    }
+
+    void removeFolderPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot delete directory %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        AFS::removeFolderPlain(getInnerPath(afsPath)); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    void setModTime(const AfsPath& afsPath, time_t modTime) const override //throw FileError, follows symlinks
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        AFS::setModTime(getInnerPath(afsPath), modTime); //throw FileError
+    }
+
+    AbstractPath getSymlinkResolvedPath(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot determine final path for %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        return wrapItemPathLatency(AFS::getSymlinkResolvedPath(getInnerPath(afsPath)), options_); //throw FileError
+    }
+
+    std::string getSymlinkBinaryContent(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot resolve symbolic link %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        return AFS::getSymlinkBinaryContent(getInnerPath(afsPath)); //throw FileError
+    }
+    //----------------------------------------------------------------------------------------------------------------
+
+    //return value always bound:
+    std::unique_ptr<InputStream> getInputStream(const AfsPath& afsPath, const IOCallback& notifyUnbufferedIO) const override //throw FileError, ErrorFileLocked, X
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        return std::make_unique<InputStreamLatency>(AFS::getInputStream(getInnerPath(afsPath), notifyUnbufferedIO), *this, afsPath); //throw FileError, ErrorFileLocked, X
+    }
+
+    //target existing: undefined behavior! (fail/overwrite/auto-rename)
+    std::unique_ptr<OutputStreamImpl> getOutputStream(const AfsPath& afsPath, //throw FileError
+                                                      const uint64_t* streamSize,                          //optional
+                                                      const IOCallback& notifyUnbufferedIO) const override //
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        return std::make_unique<OutputStreamLatency>(AFS::getOutputStream(getInnerPath(afsPath), streamSize, notifyUnbufferedIO), *this, afsPath); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    void traverseFolder(const AfsPath& afsPath, TraverserCallback& sink /*throw X*/) const override //throw X
+    {
+        if (simulateFolderRead(afsPath, sink)) //throw X
+        {
+            TraverserCallbackLatency travLatency(*this, afsPath, sink);
+            AFS::traverseFolder(getInnerPath(afsPath), travLatency); //throw X
+        }
+    }
+    //----------------------------------------------------------------------------------------------------------------
+
+    //symlink handling: follow link!
+    //target existing: undefined behavior! (fail/overwrite/auto-rename)
+    FileCopyResult copyFileForSameAfsType(const AfsPath& afsPathSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked
+                                          const AbstractPath& apTarget, bool copyFilePermissions, const IOCallback& notifyUnbufferedIO) const override //may be nullptr; throw X!
+    {
+        if (copyFilePermissions)
+            throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), L"Operation not supported.");
+
+        //copy via streams: no server-side copy => all data goes through both (throttled) connections
+        return copyFileAsStream(afsPathSource, attrSource, apTarget, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+    }
+
+    //target existing: undefined behavior! (fail/overwrite)
+    //symlink handling: follow link!
+    void copyNewFolderForSameAfsType(const AfsPath& afsPathSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot create directory %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))); }); //throw FileError
+        AFS::copyNewFolder(getInnerPath(afsPathSource), getInnerPath(apTarget), copyFilePermissions); //throw FileError
+    }
+
+    void copySymlinkForSameAfsType(const AfsPath& afsPathSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
+    {
+        simulateCall([&]
+        {
+            return replaceCpy(replaceCpy(_("Cannot copy symbolic link %x to %y."),
+                                         L"%x", L"\n" + fmtPath(getDisplayPath(afsPathSource))),
+                              L"%y", L"\n" + fmtPath(AFS::getDisplayPath(apTarget)));
+        }); //throw FileError
+        AFS::copySymlink(getInnerPath(afsPathSource), getInnerPath(apTarget), copyFilePermissions); //throw FileError
+    }
+
+    //target existing: undefined behavior! (fail/overwrite/auto-rename)
+    void renameItemForSameAfsType(const AfsPath& afsPathSource, const AbstractPath& apTarget) const override //throw FileError, ErrorDifferentVolume
+    {
+        simulateCall([&]
+        {
+            return replaceCpy(replaceCpy(_("Cannot move file %x to %y."),
+                                         L"%x", L"\n" + fmtPath(getDisplayPath(afsPathSource))),
+                              L"%y", L"\n" + fmtPath(AFS::getDisplayPath(apTarget)));
+        }); //throw FileError
+        AFS::renameItem(getInnerPath(afsPathSource), getInnerPath(apTarget)); //throw FileError, ErrorDifferentVolume
+    }
+
+    bool supportsPermissions(const AfsPath& afsPath) const override { return false; } //throw FileError
+
+    //----------------------------------------------------------------------------------------------------------------
+    ImageHolder getFileIcon      (const AfsPath& afsPath, int pixelSize) const override { return AFS::getFileIcon      (getInnerPath(afsPath), pixelSize); } //noexcept; optional return value
+    ImageHolder getThumbnailImage(const AfsPath& afsPath, int pixelSize) const override { return AFS::getThumbnailImage(getInnerPath(afsPath), pixelSize); } //
+
+    void connectNetworkFolder(const AfsPath& afsPath, bool allowUserInteraction) const override //throw FileError
+    {
+        AFS::connectNetworkFolder(getInnerPath(afsPath), allowUserInteraction); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+
+    uint64_t getFreeDiskSpace(const AfsPath& afsPath) const override //throw FileError, returns 0 if not available
+    {
+        simulateCall([&] { return replaceCpy(_("Cannot determine free disk space for %x."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        return AFS::getFreeDiskSpace(getInnerPath(afsPath)); //throw FileError
+    }
+
+    bool supportsRecycleBin(const AfsPath& afsPath, const std::function<void ()>& onUpdateGui) const override //throw FileError
+    {
+        return AFS::supportsRecycleBin(getInnerPath(afsPath), onUpdateGui); //throw FileError
+    }
+
+    std::unique_ptr<RecycleSession> createRecyclerSession(const AfsPath& afsPath) const override //throw FileError, return value must be bound!
+    {
+        return std::make_unique<RecycleSessionLatency>(AFS::createRecyclerSession(getInnerPath(afsPath))); //throw FileError
+    }
+
+    void recycleItemIfExists(const AfsPath& afsPath) const override //throw FileError
+    {
+        simulateCall([&] { return replaceCpy(_("Unable to move %x to the recycle bin."), L"%x", fmtPath(getDisplayPath(afsPath))); }); //throw FileError
+        AFS::recycleItemIfExists(getInnerPath(afsPath)); //throw FileError
+    }
+
+    const AbstractPath innerRootPath_; //empty AfsPath
+    const Zstring options_;
+    const LatencyConfig cfg_;
+
+    mutable std::mutex lockRandom_;
+    mutable std::default_random_engine random_{ std::random_device()() };
+};
+
+//===========================================================================================================================
+
+InputStreamLatency::InputStreamLatency(std::unique_ptr<InputStream>&& streamIn, const LatencyFileSystem& afs, const AfsPath& afsPath) :
+    streamIn_(std::move(streamIn)), afs_(afs), afsPath_(afsPath), throttle_(afs.getConfig().bandwidth) {}
+
+
+size_t InputStreamLatency::read(void* buffer, size_t bytesToRead) //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+{
+    afs_.simulateCall([&] { return replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(afs_.getDisplayPath(afsPath_))); }); //throw FileError
+
+    const size_t bytesRead = streamIn_->read(buffer, bytesToRead); //throw FileError, ErrorFileLocked, X
+    throttle_.onTransfer(bytesRead);
+    return bytesRead;
+}
+
+
+OutputStreamLatency::OutputStreamLatency(std::unique_ptr<AFS::OutputStream>&& streamOut, const LatencyFileSystem& afs, const AfsPath& afsPath) :
+    streamOut_(std::move(streamOut)), afs_(afs), afsPath_(afsPath), throttle_(afs.getConfig().bandwidth) {}
+
+
+void OutputStreamLatency::write(const void* buffer, size_t bytesToWrite) //throw FileError, X
+{
+    afs_.simulateCall([&] { return replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(afs_.getDisplayPath(afsPath_))); }); //throw FileError
+
+    streamOut_->write(buffer, bytesToWrite); //throw FileError, X
+    throttle_.onTransfer(bytesToWrite);
+}
+
+
+AFS::FileId OutputStreamLatency::finalize() //throw FileError, X
+{
+    afs_.simulateCall([&] { return replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(afs_.getDisplayPath(afsPath_))); }); //throw FileError
+    return streamOut_->finalize(); //throw FileError, X
+}
+
+
+std::unique_ptr<AFS::TraverserCallback> TraverserCallbackLatency::onFolder(const FolderInfo& fi) //throw X
+{
+    std::unique_ptr<TraverserCallback> trav = sink_.onFolder(fi); //throw X
+    if (!trav)
+        return nullptr;
+
+    const AfsPath subFolderPath(AFS::appendPaths(folderPath_.value, fi.itemName, FILE_NAME_SEPARATOR));
+
+    if (!afs_.simulateFolderRead(subFolderPath, *trav)) //throw X
+        return nullptr; //error ignored: folder content is considered incomplete
+
+    return std::make_unique<TraverserCallbackLatency>(afs_, subFolderPath, std::move(trav));
+}
+
+
+bool RecycleSessionLatency::recycleItem(const AbstractPath& itemPath, const Zstring& logicalRelPath) //throw FileError
+{
+    return session_->recycleItem(LatencyFileSystem::getInnerPath(itemPath), logicalRelPath); //throw FileError
+}
+
+
+AbstractPath wrapItemPathLatency(const AbstractPath& innerPath, const Zstring& options)
+{
+    const AFS::PathComponents comp = AFS::getPathComponents(innerPath);
+
+    Zstring relPath;
+    for (const Zstring& itemName : comp.relPath)
+        relPath = AFS::appendPaths(relPath, itemName, FILE_NAME_SEPARATOR);
+
+    return AbstractPath(std::make_shared<LatencyFileSystem>(comp.rootPath, options), AfsPath(relPath));
+}
+}
+
+
+bool zen::acceptsItemPathPhraseLatency(const Zstring& itemPathPhrase) //noexcept
+{
+    Zstring path = trimCpy(itemPathPhrase);
+    return startsWith(path, latencyPrefix); //check for explicit latency path prefix only!
+}
+
+
+AbstractPath zen::createItemPathLatency(const Zstring& itemPathPhrase) //noexcept
+{
+    Zstring path = trimCpy(itemPathPhrase);
+    if (startsWith(path, latencyPrefix))
+        path = path.c_str() + strLength(latencyPrefix);
+
+    const Zstring options     = trimCpy(beforeFirst(path, Zstr('|'), IF_MISSING_RETURN_NONE));
+    const Zstring innerPhrase =         afterFirst (path, Zstr('|'), IF_MISSING_RETURN_ALL);
+
+    return wrapItemPathLatency(createAbstractPath(innerPhrase), options); //noexcept
+}
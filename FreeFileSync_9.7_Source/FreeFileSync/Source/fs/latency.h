@@ -0,0 +1,27 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef FS_LATENCY_09823740598273049857
+#define FS_LATENCY_09823740598273049857
+
+#include "abstract.h"
+
+namespace zen
+{
+/*
+simulate slow and unreliable (network) storage for testing and benchmarking: "latency:<options>|<path phrase>"
+wrap any other file system, e.g. "latency:delay=20,bandwidth=10000,errors=0.001|mem:test"
+
+options (comma-separated, all optional):
+    delay=<ms>        latency added to each call, e.g. per item access, per folder read, per stream open
+    bandwidth=<KB/s>  throughput limit for each input and output stream
+    errors=<rate>     probability [0, 1] of a call failing with FileError
+*/
+bool acceptsItemPathPhraseLatency (const Zstring& itemPathPhrase); //noexcept
+AbstractPath createItemPathLatency(const Zstring& itemPathPhrase); //noexcept
+}
+
+#endif //FS_LATENCY_09823740598273049857
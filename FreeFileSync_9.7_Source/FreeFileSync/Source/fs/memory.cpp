@@ -0,0 +1,515 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "memory.h"
+#include <map>
+#include <mutex>
+#include <ctime>
+#include <cstring>
+#include <zen/globals.h>
+#include <zen/sys_error.h>
+
+using namespace zen;
+using AFS = AbstractFileSystem;
+
+
+namespace
+{
+const Zchar memoryPrefix[] = Zstr("mem:");
+
+
+struct MemoryItem
+{
+    AFS::ItemType type = AFS::ItemType::FILE; //FILE or FOLDER
+    time_t modTime = 0;
+    uint64_t fileIndex = 0;
+    std::shared_ptr<const std::string> content = std::make_shared<const std::string>(); //immutable => input streams read without holding the volume lock
+    std::map<Zstring, std::shared_ptr<MemoryItem>, LessFilePath> children; //folders only; shared ownership: see OutputStreamMemory
+};
+
+
+struct MemoryVolume
+{
+    explicit MemoryVolume(uint64_t volId) : volumeId(volId) { root.type = AFS::ItemType::FOLDER; }
+
+    const uint64_t volumeId;
+    std::mutex lockVolume; //serialize access to all items below
+    MemoryItem root;
+    uint64_t fileIndexLast = 0;
+};
+
+
+class MemoryVolumes
+{
+public:
+    static std::shared_ptr<MemoryVolumes> instance()
+    {
+        static Global<MemoryVolumes> inst(std::make_unique<MemoryVolumes>());
+        return inst.get();
+    }
+
+    std::shared_ptr<MemoryVolume> getVolume(const Zstring& volumeName) //create if not yet existing
+    {
+        std::lock_guard<std::mutex> dummy(lockVolumes_);
+        std::shared_ptr<MemoryVolume>& vol = volumes_[volumeName];
+        if (!vol)
+            vol = std::make_shared<MemoryVolume>(++volumeIdLast_);
+        return vol;
+    }
+
+private:
+    std::mutex lockVolumes_;
+    std::map<Zstring, std::shared_ptr<MemoryVolume>, LessFilePath> volumes_;
+    uint64_t volumeIdLast_ = 0;
+};
+
+
+//emulate error codes of a native file system
+std::wstring formatMemoryError(ErrorCode ec) { return formatSystemError(L"MemoryFileSystem", ec); }
+
+
+AFS::FileId makeFileId(const MemoryVolume& vol, uint64_t fileIndex)
+{
+    AFS::FileId out(reinterpret_cast<const char*>(&vol.volumeId), sizeof(vol.volumeId));
+    out.     append(reinterpret_cast<const char*>(&fileIndex),    sizeof(fileIndex));
+    return out;
+}
+
+//===========================================================================================================================
+
+struct InputStreamMemory : public AbstractFileSystem::InputStream
+{
+    InputStreamMemory(const std::shared_ptr<const std::string>& content, const AFS::StreamAttributes& attr, const IOCallback& notifyUnbufferedIO) :
+        content_(content), attr_(attr), notifyUnbufferedIO_(notifyUnbufferedIO) {}
+
+    size_t read(void* buffer, size_t bytesToRead) override //throw X; return "bytesToRead" bytes unless end of stream!
+    {
+        const size_t bytesRead = std::min(bytesToRead, content_->size() - pos_);
+        if (bytesRead > 0)
+            std::memcpy(buffer, content_->data() + pos_, bytesRead);
+        pos_ += bytesRead;
+
+        if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesRead); //throw X
+        return bytesRead;
+    }
+
+    size_t getBlockSize() const override { return 128 * 1024; } //non-zero block size is AFS contract!
+
+    Opt<AFS::StreamAttributes> getAttributesBuffered() override { return attr_; } //throw FileError
+
+private:
+    const std::shared_ptr<const std::string> content_;
+    const AFS::StreamAttributes attr_;
+    const IOCallback notifyUnbufferedIO_;
+    size_t pos_ = 0;
+};
+
+
+struct OutputStreamMemory : public AbstractFileSystem::OutputStreamImpl
+{
+    OutputStreamMemory(const std::shared_ptr<MemoryVolume>& vol, const std::shared_ptr<MemoryItem>& file, const std::wstring& displayPath,
+                       const uint64_t* streamSize, const IOCallback& notifyUnbufferedIO) :
+        vol_(vol), file_(file), fileIndex_(file->fileIndex), displayPath_(displayPath), notifyUnbufferedIO_(notifyUnbufferedIO)
+    {
+        if (streamSize)
+            buffer_.reserve(static_cast<size_t>(*streamSize));
+    }
+
+    void write(const void* buffer, size_t bytesToWrite) override //throw FileError, X
+    {
+        buffer_.append(static_cast<const char*>(buffer), bytesToWrite);
+        if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesToWrite); //throw X
+    }
+
+    AFS::FileId finalize() override //throw FileError, X
+    {
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        std::shared_ptr<MemoryItem> file = file_.lock(); //file might have been renamed (fine) or deleted (error) in the meantime
+        if (!file)
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), formatMemoryError(ENOENT));
+
+        file->content = std::make_shared<const std::string>(std::move(buffer_));
+        file->modTime = std::time(nullptr);
+        return makeFileId(*vol_, fileIndex_);
+    }
+
+private:
+    const std::shared_ptr<MemoryVolume> vol_;
+    const std::weak_ptr<MemoryItem> file_; //owned by the volume
+    const uint64_t fileIndex_;
+    const std::wstring displayPath_;
+    const IOCallback notifyUnbufferedIO_;
+    std::string buffer_;
+};
+
+//===========================================================================================================================
+
+class MemoryFileSystem : public AbstractFileSystem
+{
+public:
+    MemoryFileSystem(const Zstring& volumeName, const std::shared_ptr<MemoryVolume>& vol) : volumeName_(volumeName), vol_(vol) {}
+
+private:
+    Zstring getInitPathPhrase(const AfsPath& afsPath) const override { return appendPaths(memoryPrefix + volumeName_, afsPath.value, FILE_NAME_SEPARATOR); }
+
+    std::wstring getDisplayPath(const AfsPath& afsPath) const override { return utfTo<std::wstring>(getInitPathPhrase(afsPath)); }
+
+    bool isNullFileSystem() const override { return volumeName_.empty(); }
+
+    int compareDeviceRootSameAfsType(const AbstractFileSystem& afsRhs) const override
+    {
+        const Zstring& volumeNameRhs = static_cast<const MemoryFileSystem&>(afsRhs).volumeName_;
+
+        return CmpFilePath()(volumeName_  .c_str(), volumeName_  .size(),
+                             volumeNameRhs.c_str(), volumeNameRhs.size());
+    }
+
+    //caller must hold lock!
+    MemoryItem* findItem(const AfsPath& afsPath) const
+    {
+        MemoryItem* item = &vol_->root;
+        for (const Zstring& itemName : split(afsPath.value, FILE_NAME_SEPARATOR, SplitType::SKIP_EMPTY))
+        {
+            if (item->type != ItemType::FOLDER)
+                return nullptr;
+            auto it = item->children.find(itemName);
+            if (it == item->children.end())
+                return nullptr;
+            item = it->second.get();
+        }
+        return item;
+    }
+
+    //caller must hold lock!
+    MemoryItem& getParentFolder(const AfsPath& afsPath, const std::wstring& errorMsg) const //throw FileError
+    {
+        const Opt<AfsPath> parentAfsPath = getParentAfsPath(afsPath);
+        if (!parentAfsPath) //device root
+            throw FileError(errorMsg, formatMemoryError(EINVAL));
+
+        MemoryItem* parent = findItem(*parentAfsPath);
+        if (!parent)
+            throw FileError(errorMsg, formatMemoryError(ENOENT));
+        if (parent->type != ItemType::FOLDER)
+            throw FileError(errorMsg, formatMemoryError(ENOTDIR));
+        return *parent;
+    }
+
+    //caller must hold lock!
+    std::shared_ptr<MemoryItem> createItem(const AfsPath& afsPath, ItemType type, const std::wstring& errorMsg) const //throw FileError, ErrorTargetExisting
+    {
+        MemoryItem& parent = getParentFolder(afsPath, errorMsg); //throw FileError
+
+        std::shared_ptr<MemoryItem>& item = parent.children[getItemName(afsPath)];
+        if (item)
+            throw ErrorTargetExisting(errorMsg, formatMemoryError(EEXIST));
+
+        item = std::make_shared<MemoryItem>();
+        item->type      = type;
+        item->modTime   = std::time(nullptr);
+        item->fileIndex = ++vol_->fileIndexLast;
+        return item;
+    }
+
+    void removeItem(const AfsPath& afsPath, ItemType type, const std::wstring& errorMsg) const //throw FileError
+    {
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        MemoryItem& parent = getParentFolder(afsPath, errorMsg); //throw FileError
+
+        auto it = parent.children.find(getItemName(afsPath));
+        if (it == parent.children.end())
+            throw FileError(errorMsg, formatMemoryError(ENOENT));
+
+        if (it->second->type != type)
+            throw FileError(errorMsg, formatMemoryError(type == ItemType::FOLDER ? ENOTDIR : EISDIR));
+
+        if (!it->second->children.empty())
+            throw FileError(errorMsg, formatMemoryError(ENOTEMPTY));
+
+        parent.children.erase(it);
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    ItemType getItemType(const AfsPath& afsPath) const override //throw FileError
+    {
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        if (const MemoryItem* item = findItem(afsPath))
+            return item->type;
+
+        throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(ENOENT));
+    }
+
+    PathStatusImpl getPathStatus(const AfsPath& afsPath) const override //throw FileError
+    {
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+
+        const std::vector<Zstring> itemNames = split(afsPath.value, FILE_NAME_SEPARATOR, SplitType::SKIP_EMPTY);
+        const MemoryItem* item = &vol_->root;
+        Zstring existingPath;
+
+        for (auto it = itemNames.begin(); it != itemNames.end(); ++it)
+        {
+            auto itChild = item->children.find(*it); //files have no children
+            if (itChild == item->children.end())
+                return { item->type, AfsPath(existingPath), std::vector<Zstring>(it, itemNames.end()) };
+
+            existingPath = appendPaths(existingPath, *it, FILE_NAME_SEPARATOR);
+            item = itChild->second.get();
+        }
+        return { item->type, afsPath, {} };
+    }
+    //----------------------------------------------------------------------------------------------------------------
+
+    //target existing: undefined behavior! (fail/overwrite) => Memory will fail like Native
+    void createFolderPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        createItem(afsPath, ItemType::FOLDER, replaceCpy(_("Cannot create directory %x."), L"%x", fmtPath(getDisplayPath(afsPath)))); //throw FileError, ErrorTargetExisting
+    }
+
+    void removeFilePlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        removeItem(afsPath, ItemType::FILE, replaceCpy(_("Cannot delete file %x."), L"%x", fmtPath(getDisplayPath(afsPath)))); //throw FileError
+    }
+
+    void removeSymlinkPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        throw FileError(replaceCpy(_("Cannot delete file %x."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(ENOTSUP));
+    }
+
+    void removeFolderPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        removeItem(afsPath, ItemType::FOLDER, replaceCpy(_("Cannot delete directory %x."), L"%x", fmtPath(getDisplayPath(afsPath)))); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    void setModTime(const AfsPath& afsPath, time_t modTime) const override //throw FileError, follows symlinks
+    {
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        MemoryItem* item = findItem(afsPath);
+        if (!item)
+            throw FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(ENOENT));
+        item->modTime = modTime;
+    }
+
+    AbstractPath getSymlinkResolvedPath(const AfsPath& afsPath) const override //throw FileError
+    {
+        throw FileError(replaceCpy(_("Cannot determine final path for %x."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(ENOTSUP));
+    }
+
+    std::string getSymlinkBinaryContent(const AfsPath& afsPath) const override //throw FileError
+    {
+        throw FileError(replaceCpy(_("Cannot resolve symbolic link %x."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(ENOTSUP));
+    }
+    //----------------------------------------------------------------------------------------------------------------
+
+    //return value always bound:
+    std::unique_ptr<InputStream> getInputStream(const AfsPath& afsPath, const IOCallback& notifyUnbufferedIO) const override //throw FileError, ErrorFileLocked, (X)
+    {
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        const MemoryItem* item = findItem(afsPath);
+        if (!item || item->type != ItemType::FILE)
+            throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(item ? EISDIR : ENOENT));
+
+        const StreamAttributes attr = { item->modTime, item->content->size(), makeFileId(*vol_, item->fileIndex) };
+        return std::make_unique<InputStreamMemory>(item->content, attr, notifyUnbufferedIO);
+    }
+
+    //target existing: undefined behavior! (fail/overwrite/auto-rename) => Memory will fail like Native
+    std::unique_ptr<OutputStreamImpl> getOutputStream(const AfsPath& afsPath, //throw FileError
+                                                      const uint64_t* streamSize,                          //optional
+                                                      const IOCallback& notifyUnbufferedIO) const override //
+    {
+        const std::wstring displayPath = getDisplayPath(afsPath);
+
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        const std::shared_ptr<MemoryItem> file = createItem(afsPath, ItemType::FILE, replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath))); //throw FileError, ErrorTargetExisting
+
+        return std::make_unique<OutputStreamMemory>(vol_, file, displayPath, streamSize, notifyUnbufferedIO);
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    void traverseFolder(const AfsPath& afsPath, TraverserCallback& sink /*throw X*/) const override //throw X
+    {
+        struct ItemDetails
+        {
+            Zstring itemName;
+            ItemType type;
+            uint64_t fileSize;
+            time_t modTime;
+            uint64_t fileIndex;
+        };
+        std::vector<ItemDetails> items;
+
+        tryReportingDirError([&] //throw X
+        {
+            items.clear(); //don't collect duplicates when retrying
+
+            std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+            const MemoryItem* folder = findItem(afsPath);
+            if (!folder || folder->type != ItemType::FOLDER)
+                throw FileError(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(folder ? ENOTDIR : ENOENT));
+
+            for (const auto& child : folder->children)
+                items.push_back({ child.first, child.second->type, child.second->content->size(), child.second->modTime, child.second->fileIndex });
+        }, sink);
+
+        //report items *after* releasing the lock: sink may access this file system
+        for (const ItemDetails& item : items)
+            if (item.type == ItemType::FOLDER)
+            {
+                if (std::unique_ptr<TraverserCallback> trav = sink.onFolder({ item.itemName, nullptr })) //throw X
+                    traverseFolder(AfsPath(appendPaths(afsPath.value, item.itemName, FILE_NAME_SEPARATOR)), *trav); //throw X
+            }
+            else
+                sink.onFile({ item.itemName, item.fileSize, item.modTime, makeFileId(*vol_, item.fileIndex), nullptr /*symlinkInfo*/ }); //throw X
+    }
+    //----------------------------------------------------------------------------------------------------------------
+
+    //symlink handling: follow link!
+    //target existing: undefined behavior! (fail/overwrite/auto-rename) => Memory will fail like Native
+    FileCopyResult copyFileForSameAfsType(const AfsPath& afsPathSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked
+                                          const AbstractPath& apTarget, bool copyFilePermissions, const IOCallback& notifyUnbufferedIO) const override //may be nullptr; throw X!
+    {
+        const auto& afsTarget = static_cast<const MemoryFileSystem&>(getAfs(apTarget));
+        const AfsPath afsPathTarget = getAfsPath(apTarget);
+
+        const std::wstring errorMsg = replaceCpy(replaceCpy(_("Cannot copy file %x to %y."),
+                                                            L"%x", L"\n" + fmtPath(getDisplayPath(afsPathSource))),
+                                                 L"%y", L"\n" + fmtPath(afsTarget.getDisplayPath(afsPathTarget)));
+        if (copyFilePermissions)
+            throw FileError(errorMsg, formatMemoryError(ENOTSUP));
+
+        FileCopyResult result;
+        std::shared_ptr<const std::string> content;
+        {
+            std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+            const MemoryItem* item = findItem(afsPathSource);
+            if (!item || item->type != ItemType::FILE)
+                throw FileError(errorMsg, formatMemoryError(item ? EISDIR : ENOENT));
+
+            content = item->content; //copy-on-write: content is immutable
+            result.fileSize     = content->size();
+            result.modTime      = item->modTime;
+            result.sourceFileId = makeFileId(*vol_, item->fileIndex);
+        }
+
+        if (notifyUnbufferedIO) notifyUnbufferedIO(2 * makeSigned(result.fileSize)); //throw X; consistent with stream-based copy: bytes read + bytes written
+
+        //lock target volume separately: might be a different volume => no nested locks
+        std::lock_guard<std::mutex> dummy(afsTarget.vol_->lockVolume);
+        const std::shared_ptr<MemoryItem> file = afsTarget.createItem(afsPathTarget, ItemType::FILE, errorMsg); //throw FileError, ErrorTargetExisting
+        file->content = content;
+        file->modTime = result.modTime;
+
+        result.targetFileId = makeFileId(*afsTarget.vol_, file->fileIndex);
+        return result;
+    }
+
+    //target existing: undefined behavior! (fail/overwrite) => Memory will fail like Native
+    //symlink handling: follow link!
+    void copyNewFolderForSameAfsType(const AfsPath& afsPathSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
+    {
+        if (copyFilePermissions)
+            throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), formatMemoryError(ENOTSUP));
+
+        AFS::createFolderPlain(apTarget); //throw FileError
+    }
+
+    void copySymlinkForSameAfsType(const AfsPath& afsPathSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
+    {
+        throw FileError(replaceCpy(replaceCpy(_("Cannot copy symbolic link %x to %y."),
+                                              L"%x", L"\n" + fmtPath(getDisplayPath(afsPathSource))),
+                                   L"%y", L"\n" + fmtPath(AFS::getDisplayPath(apTarget))), formatMemoryError(ENOTSUP));
+    }
+
+    //target existing: undefined behavior! (fail/overwrite/auto-rename) => Memory will fail like Native
+    void renameItemForSameAfsType(const AfsPath& afsPathSource, const AbstractPath& apTarget) const override //throw FileError, ErrorDifferentVolume
+    {
+        const AfsPath afsPathTarget = getAfsPath(apTarget);
+
+        const std::wstring errorMsg = replaceCpy(replaceCpy(_("Cannot move file %x to %y."),
+                                                            L"%x", L"\n" + fmtPath(getDisplayPath(afsPathSource))),
+                                                 L"%y", L"\n" + fmtPath(getDisplayPath(afsPathTarget)));
+
+        if (compareDeviceRootSameAfsType(getAfs(apTarget)) != 0)
+            throw ErrorDifferentVolume(errorMsg, formatMemoryError(EXDEV));
+
+        //don't move a folder into itself
+        if (startsWith(afsPathTarget.value + FILE_NAME_SEPARATOR, afsPathSource.value + FILE_NAME_SEPARATOR))
+            throw FileError(errorMsg, formatMemoryError(EINVAL));
+
+        std::lock_guard<std::mutex> dummy(vol_->lockVolume);
+        MemoryItem& parentSource = getParentFolder(afsPathSource, errorMsg); //throw FileError
+
+        auto itSource = parentSource.children.find(getItemName(afsPathSource));
+        if (itSource == parentSource.children.end())
+            throw FileError(errorMsg, formatMemoryError(ENOENT));
+
+        MemoryItem& parentTarget = getParentFolder(afsPathTarget, errorMsg); //throw FileError
+
+        std::shared_ptr<MemoryItem>& itemTarget = parentTarget.children[getItemName(afsPathTarget)];
+        if (itemTarget)
+            throw ErrorTargetExisting(errorMsg, formatMemoryError(EEXIST));
+
+        itemTarget = std::move(itSource->second);
+        parentSource.children.erase(itSource); //std::map has stable references: "itemTarget" is still valid
+    }
+
+    bool supportsPermissions(const AfsPath& afsPath) const override { return false; } //throw FileError
+
+    //----------------------------------------------------------------------------------------------------------------
+    ImageHolder getFileIcon      (const AfsPath& afsPath, int pixelSize) const override { return ImageHolder(); } //noexcept; optional return value
+    ImageHolder getThumbnailImage(const AfsPath& afsPath, int pixelSize) const override { return ImageHolder(); } //
+
+    void connectNetworkFolder(const AfsPath& afsPath, bool allowUserInteraction) const override {} //throw FileError
+
+    //----------------------------------------------------------------------------------------------------------------
+
+    uint64_t getFreeDiskSpace(const AfsPath& afsPath) const override { return 0; } //throw FileError, returns 0 if not available
+
+    bool supportsRecycleBin(const AfsPath& afsPath, const std::function<void ()>& onUpdateGui) const override { return false; } //throw FileError
+
+    std::unique_ptr<RecycleSession> createRecyclerSession(const AfsPath& afsPath) const override //throw FileError, return value must be bound!
+    {
+        assert(false); //see supportsRecycleBin()
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ":" + numberTo<std::string>(__LINE__));
+    }
+
+    void recycleItemIfExists(const AfsPath& afsPath) const override //throw FileError
+    {
+        throw FileError(replaceCpy(_("Unable to move %x to the recycle bin."), L"%x", fmtPath(getDisplayPath(afsPath))), formatMemoryError(ENOTSUP));
+    }
+
+    const Zstring volumeName_;
+    const std::shared_ptr<MemoryVolume> vol_; //bound
+};
+}
+
+
+bool zen::acceptsItemPathPhraseMemory(const Zstring& itemPathPhrase) //noexcept
+{
+    Zstring path = trimCpy(itemPathPhrase);
+    return startsWith(path, memoryPrefix); //check for explicit memory path prefix only!
+}
+
+
+AbstractPath zen::createItemPathMemory(const Zstring& itemPathPhrase) //noexcept
+{
+    Zstring path = trimCpy(itemPathPhrase);
+    if (startsWith(path, memoryPrefix))
+        path = path.c_str() + strLength(memoryPrefix);
+
+    const std::vector<Zstring> itemNames = split(path, FILE_NAME_SEPARATOR, SplitType::SKIP_EMPTY);
+    if (itemNames.empty())
+        return AbstractPath(std::make_shared<MemoryFileSystem>(Zstring(), MemoryVolumes::instance()->getVolume(Zstring())), AfsPath(Zstring()));
+
+    Zstring relPath;
+    for (auto it = itemNames.begin() + 1; it != itemNames.end(); ++it)
+        relPath = AFS::appendPaths(relPath, *it, FILE_NAME_SEPARATOR);
+
+    return AbstractPath(std::make_shared<MemoryFileSystem>(itemNames[0], MemoryVolumes::instance()->getVolume(itemNames[0])), AfsPath(relPath));
+}
@@ -0,0 +1,23 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef FS_MEMORY_3810745198237409812
+#define FS_MEMORY_3810745198237409812
+
+#include "abstract.h"
+
+namespace zen
+{
+/*
+volatile file system for testing and benchmarking: "mem:<volume name>/<relative path>"
+    - volumes are created on first access and live until process exit => all paths referring to the same volume name share their content
+    - supports files and folders only: no symlinks, permissions or recycle bin
+*/
+bool acceptsItemPathPhraseMemory (const Zstring& itemPathPhrase); //noexcept
+AbstractPath createItemPathMemory(const Zstring& itemPathPhrase); //noexcept
+}
+
+#endif //FS_MEMORY_3810745198237409812
@@ -0,0 +1,145 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "async_process_callback.h"
+#include <zen/scope_guard.h>
+
+using namespace zen;
+
+
+void AsyncProcessCallback::forwardRequests(ProcessCallback& callback) //throw X
+{
+    int     itemsProcessedDelta = 0;
+    int64_t bytesProcessedDelta = 0;
+    int     itemsTotalDelta     = 0;
+    int64_t bytesTotalDelta     = 0;
+    std::wstring statusText;
+    bool statusChanged = false;
+    std::vector<std::wstring> infoMsgs;
+    {
+        std::lock_guard<std::mutex> dummy(lockUpdates_);
+        std::swap(itemsProcessedDelta, itemsProcessedDelta_);
+        std::swap(bytesProcessedDelta, bytesProcessedDelta_);
+        std::swap(itemsTotalDelta,     itemsTotalDelta_);
+        std::swap(bytesTotalDelta,     bytesTotalDelta_);
+        std::swap(statusChanged,       statusChanged_);
+        if (statusChanged)
+            statusText = statusText_;
+        infoMsgs.swap(infoMsgs_);
+    }
+
+    //statistics first: nothrow!
+    if (itemsProcessedDelta != 0 || bytesProcessedDelta != 0)
+        callback.updateProcessedData(itemsProcessedDelta, bytesProcessedDelta);
+    if (itemsTotalDelta != 0 || bytesTotalDelta != 0)
+        callback.updateTotalData(itemsTotalDelta, bytesTotalDelta);
+
+    for (const std::wstring& msg : infoMsgs)
+        callback.reportInfo(msg); //throw X
+
+    if (statusChanged)
+        callback.reportStatus(statusText); //throw X
+
+    //handle blocking request *after* buffered updates: keep order of messages as reported by the worker thread
+    std::function<void(ProcessCallback& callback)> request;
+    {
+        std::lock_guard<std::mutex> dummy(lockRequest_);
+        if (request_ && !requestDone_)
+            request = request_;
+    }
+    if (request)
+    {
+        request(callback); //throw X
+        {
+            std::lock_guard<std::mutex> dummy(lockRequest_);
+            requestDone_ = true;
+        }
+        conditionRequestDone_.notify_all();
+    }
+}
+
+
+void AsyncProcessCallback::runOnMainThread(const std::function<void(ProcessCallback& callback)>& request) //throw ThreadInterruption
+{
+    std::unique_lock<std::mutex> dummy(lockRequest_);
+    assert(!request_); //a single worker thread per instance
+
+    request_     = request;
+    requestDone_ = false;
+    ZEN_ON_SCOPE_EXIT(request_ = nullptr); //even on ThreadInterruption: main thread won't run it anymore
+
+    interruptibleWait(conditionRequestDone_, dummy, [this] { return requestDone_; }); //throw ThreadInterruption
+}
+
+
+void AsyncProcessCallback::initNewPhase(int itemsTotal, int64_t bytesTotal, Phase phaseId) //throw ThreadInterruption
+{
+    runOnMainThread([&](ProcessCallback& callback) { callback.initNewPhase(itemsTotal, bytesTotal, phaseId); }); //throw ThreadInterruption
+}
+
+
+void AsyncProcessCallback::updateProcessedData(int itemsDelta, int64_t bytesDelta) //noexcept
+{
+    std::lock_guard<std::mutex> dummy(lockUpdates_);
+    itemsProcessedDelta_ += itemsDelta;
+    bytesProcessedDelta_ += bytesDelta;
+}
+
+
+void AsyncProcessCallback::updateTotalData(int itemsDelta, int64_t bytesDelta) //noexcept
+{
+    std::lock_guard<std::mutex> dummy(lockUpdates_);
+    itemsTotalDelta_ += itemsDelta;
+    bytesTotalDelta_ += bytesDelta;
+}
+
+
+void AsyncProcessCallback::reportStatus(const std::wstring& text) //throw ThreadInterruption
+{
+    {
+        std::lock_guard<std::mutex> dummy(lockUpdates_);
+        statusText_    = text;
+        statusChanged_ = true;
+    }
+    interruptionPoint(); //throw ThreadInterruption
+}
+
+
+void AsyncProcessCallback::reportInfo(const std::wstring& text) //throw ThreadInterruption
+{
+    {
+        std::lock_guard<std::mutex> dummy(lockUpdates_);
+        infoMsgs_.push_back(text);
+    }
+    interruptionPoint(); //throw ThreadInterruption
+}
+
+
+void AsyncProcessCallback::reportWarning(const std::wstring& warningMessage, bool& warningActive) //throw ThreadInterruption
+{
+    runOnMainThread([&](ProcessCallback& callback) { callback.reportWarning(warningMessage, warningActive); }); //throw ThreadInterruption
+}
+
+
+ProcessCallback::Response AsyncProcessCallback::reportError(const std::wstring& errorMessage, size_t retryNumber) //throw ThreadInterruption
+{
+    Response response = IGNORE_ERROR;
+    runOnMainThread([&](ProcessCallback& callback) { response = callback.reportError(errorMessage, retryNumber); }); //throw ThreadInterruption
+    return response;
+}
+
+
+void AsyncProcessCallback::reportFatalError(const std::wstring& errorMessage) //throw ThreadInterruption
+{
+    runOnMainThread([&](ProcessCallback& callback) { callback.reportFatalError(errorMessage); }); //throw ThreadInterruption
+}
+
+
+void AsyncProcessCallback::abortProcessNow() //throw ThreadInterruption
+{
+    runOnMainThread([](ProcessCallback& callback) { callback.abortProcessNow(); }); //throw ThreadInterruption
+    throw ThreadInterruption(); //main thread should have thrown and interrupted us already!
+}
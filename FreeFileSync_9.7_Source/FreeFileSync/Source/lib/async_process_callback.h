@@ -0,0 +1,82 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef ASYNC_PROCESS_CALLBACK_H_8347502983475092384
+#define ASYNC_PROCESS_CALLBACK_H_8347502983475092384
+
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include <zen/thread.h>
+#include "../process_callback.h"
+
+
+namespace zen
+{
+/*
+ProcessCallback for a worker thread running part of the process, e.g. synchronization of a folder pair; the real ProcessCallback (GUI, batch) is owned by the main thread
+
+    - statistics, status and info messages are buffered until the main thread forwards them
+    - errors, warnings and phase changes block the worker thread until the main thread has handled them
+    - main thread's callback throwing (e.g. user abort) => interrupt the worker threads: they see ThreadInterruption at their next callback
+*/
+class AsyncProcessCallback : public ProcessCallback
+{
+public:
+    explicit AsyncProcessCallback(IoStatistics* ioStats) : ioStats_(ioStats) {}
+
+    //context of main thread: call repeatedly
+    void forwardRequests(ProcessCallback& callback); //throw X
+
+    //context of worker thread:
+    void initNewPhase(int itemsTotal, int64_t bytesTotal, Phase phaseId) override; //throw ThreadInterruption
+
+    void updateProcessedData(int itemsDelta, int64_t bytesDelta) override; //noexcept
+    void updateTotalData    (int itemsDelta, int64_t bytesDelta) override; //
+
+    void requestUiRefresh() override { interruptionPoint(); } //throw ThreadInterruption
+    void forceUiRefresh  () override { interruptionPoint(); } //
+
+    void reportStatus(const std::wstring& text) override; //throw ThreadInterruption
+    void reportInfo  (const std::wstring& text) override; //
+
+    void reportWarning(const std::wstring& warningMessage, bool& warningActive) override; //throw ThreadInterruption
+
+    Response reportError     (const std::wstring& errorMessage, size_t retryNumber) override; //throw ThreadInterruption
+    void     reportFatalError(const std::wstring& errorMessage) override;                     //
+
+    void abortProcessNow() override; //throw ThreadInterruption
+
+    IoStatistics* getIoStatistics() override { return ioStats_; }
+
+private:
+    AsyncProcessCallback           (const AsyncProcessCallback&) = delete;
+    AsyncProcessCallback& operator=(const AsyncProcessCallback&) = delete;
+
+    void runOnMainThread(const std::function<void(ProcessCallback& callback)>& request); //throw ThreadInterruption
+
+    IoStatistics* const ioStats_; //thread-safe; optional
+
+    //---- buffered updates ----
+    std::mutex lockUpdates_; //protects the following:
+    int     itemsProcessedDelta_ = 0;
+    int64_t bytesProcessedDelta_ = 0;
+    int     itemsTotalDelta_     = 0;
+    int64_t bytesTotalDelta_     = 0;
+    std::wstring statusText_;
+    bool statusChanged_ = false;
+    std::vector<std::wstring> infoMsgs_;
+
+    //---- blocking requests ----
+    std::mutex lockRequest_; //protects the following:
+    std::condition_variable conditionRequestDone_;
+    std::function<void(ProcessCallback& callback)> request_; //empty if none
+    bool requestDone_ = false;
+};
+}
+
+#endif //ASYNC_PROCESS_CALLBACK_H_8347502983475092384
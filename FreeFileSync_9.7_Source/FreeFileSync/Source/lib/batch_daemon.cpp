@@ -0,0 +1,251 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "batch_daemon.h"
+#include <zen/scope_guard.h>
+#include <zen/basic_math.h>
+#include <zen/utf.h>
+
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h> //umask
+    #include <sys/un.h>
+
+using namespace zen;
+
+
+namespace
+{
+const size_t REQUEST_LENGTH_MAX = 10000; //[bytes]
+const int REQUEST_TIMEOUT_MS = 1000; //client must send its request right after connecting
+const size_t PENDING_CLIENTS_MAX = 16;
+
+}
+
+
+void FolderChangeMonitor::setFolders(const std::vector<Zstring>& folderPaths) //noexcept
+{
+    const std::set<Zstring, LessFilePath> folderPathsNew(folderPaths.begin(), folderPaths.end());
+
+    for (auto it = watches_.begin(); it != watches_.end();)
+        if (folderPathsNew.find(it->first) == folderPathsNew.end())
+            it = watches_.erase(it);
+        else
+            ++it;
+
+    for (const Zstring& folderPath : folderPathsNew)
+        if (watches_.find(folderPath) == watches_.end())
+            try
+            {
+                FolderWatch fw;
+                fw.folderId = getFileSignature(folderPath).fileId; //throw FileError
+                fw.watcher  = std::make_unique<DirWatcher>(folderPath); //throw FileError
+
+                watches_.emplace(folderPath, std::move(fw));
+                changedItemPaths_.insert(folderPath); //changes before the watch was installed are unknown
+            }
+            catch (FileError&) {} //e.g. folder not yet existing: compare fully
+}
+
+
+void FolderChangeMonitor::update() //noexcept
+{
+    for (auto it = watches_.begin(); it != watches_.end();)
+        try
+        {
+            //DirWatcher doesn't notice removal of the top watched folder
+            if (!(getFileSignature(it->first).fileId == it->second.folderId)) //throw FileError
+                throw FileError(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(it->first)));
+
+            for (const DirWatcher::Entry& e : it->second.watcher->getChanges(nullptr /*processGuiMessages*/)) //throw FileError
+                if (!isIgnoredChange(e.filepath_))
+                    changedItemPaths_.insert(e.filepath_);
+            ++it;
+        }
+        catch (FileError&) { it = watches_.erase(it); } //=> watch is re-installed and folder reported as changed
+}
+
+
+ChangeList FolderChangeMonitor::extractChanges()
+{
+    update(); //noexcept
+
+    ChangeList changeList;
+    for (const auto& w : watches_)
+        changeList.watchedFolderPaths.push_back(w.first);
+
+    if (changedItemPaths_.size() <= CHANGE_LIST_SIZE_MAX)
+        changeList.changedItemPaths.assign(changedItemPaths_.begin(), changedItemPaths_.end());
+    else
+        changeList.changedItemPaths = changeList.watchedFolderPaths; //=> full comparison
+
+    changedItemPaths_.clear();
+    return changeList;
+}
+
+//------------------------------------------------------------------------------------------
+
+DaemonRequest::~DaemonRequest()
+{
+    ::close(clientSocket_);
+}
+
+
+void DaemonRequest::reply(const std::string& text) //noexcept
+{
+    const std::string buffer = text + '\n';
+
+    for (size_t bytesWritten = 0; bytesWritten < buffer.size();)
+    {
+        const ssize_t bytes = ::send(clientSocket_, buffer.c_str() + bytesWritten, buffer.size() - bytesWritten, MSG_NOSIGNAL);
+        if (bytes <= 0)
+            return; //client has gone away: nothing we can do
+        bytesWritten += bytes;
+    }
+}
+
+
+DaemonSocket::DaemonSocket(const Zstring& socketPath) : socketPath_(socketPath) //throw FileError
+{
+    const std::wstring errorMsg = replaceCpy(_("Cannot open socket %x."), L"%x", fmtPath(socketPath));
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path))
+        throw FileError(errorMsg, L"Path is too long.");
+    std::copy(socketPath.begin(), socketPath.end(), addr.sun_path);
+
+    socket_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket_ == -1)
+        THROW_LAST_FILE_ERROR(errorMsg, L"socket");
+    ZEN_ON_SCOPE_FAIL(::close(socket_));
+
+    //socket file is created with mode 0600: other users must not run jobs (fchmod() on the socket has no effect on the file)
+    auto bindSocket = [&]
+    {
+        const mode_t maskOld = ::umask(S_IXUSR | S_IRWXG | S_IRWXO);
+        ZEN_ON_SCOPE_EXIT(::umask(maskOld));
+        return ::bind(socket_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    };
+
+    if (!bindSocket())
+    {
+        if (errno != EADDRINUSE)
+            THROW_LAST_FILE_ERROR(errorMsg, L"bind");
+
+        //socket file left over from a previous daemon or still in use?
+        const int testSocket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (testSocket == -1)
+            THROW_LAST_FILE_ERROR(errorMsg, L"socket");
+        const bool inUse = ::connect(testSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+        ::close(testSocket);
+
+        if (inUse)
+            throw FileError(errorMsg, _("Another instance is already running."));
+
+        ::unlink(socketPath.c_str());
+        if (!bindSocket())
+            THROW_LAST_FILE_ERROR(errorMsg, L"bind");
+    }
+    ZEN_ON_SCOPE_FAIL(::unlink(socketPath.c_str()));
+
+    if (::listen(socket_, SOMAXCONN) != 0)
+        THROW_LAST_FILE_ERROR(errorMsg, L"listen");
+}
+
+
+DaemonSocket::~DaemonSocket()
+{
+    for (const auto& client : pendingClients_)
+        ::close(client.first);
+    ::close(socket_);
+    ::unlink(socketPath_.c_str());
+}
+
+
+std::unique_ptr<DaemonRequest> DaemonSocket::getRequest() //throw FileError
+{
+    //accept new clients
+    for (;;)
+    {
+        const int clientSocket = ::accept4(socket_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (clientSocket == -1)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open socket %x."), L"%x", fmtPath(socketPath_)), L"accept4");
+        }
+
+        //don't rely on the socket file's permissions alone: reject other users
+        ucred peerCred = {};
+        socklen_t peerCredLen = sizeof(peerCred);
+        if (::getsockopt(clientSocket, SOL_SOCKET, SO_PEERCRED, &peerCred, &peerCredLen) != 0 ||
+            peerCred.uid != ::getuid() ||
+            pendingClients_.size() >= PENDING_CLIENTS_MAX)
+            ::close(clientSocket);
+        else
+            pendingClients_.emplace(clientSocket, PendingClient{ std::string(), std::chrono::steady_clock::now() });
+    }
+
+    //read a single line per client without waiting: partial input is buffered until the next call
+    std::vector<pollfd> pfds;
+    for (const auto& client : pendingClients_)
+        pfds.push_back({ client.first, POLLIN, 0 });
+
+    if (!pfds.empty())
+        if (::poll(&pfds[0], pfds.size(), 0 /*timeout*/) < 0 && errno != EINTR)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open socket %x."), L"%x", fmtPath(socketPath_)), L"poll");
+
+    const auto now = std::chrono::steady_clock::now();
+
+    for (const pollfd& pfd : pfds)
+    {
+        PendingClient& client = pendingClients_.find(pfd.fd)->second;
+        bool dropClient = false;
+
+        if (pfd.revents != 0) //POLLIN, POLLHUP, POLLERR
+        {
+            char buffer[1024] = {};
+            const ssize_t bytesRead = ::recv(pfd.fd, buffer, sizeof(buffer), 0);
+            if (bytesRead > 0)
+                client.input.append(buffer, bytesRead);
+            else if (bytesRead == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                dropClient = true; //disconnected without sending a complete request
+        }
+
+        if (contains(client.input, '\n'))
+        {
+            std::string command = beforeFirst(client.input, '\n', IF_MISSING_RETURN_ALL);
+            trim(command);
+
+            if (!command.empty() && command.size() <= REQUEST_LENGTH_MAX)
+            {
+                const int flags = ::fcntl(pfd.fd, F_GETFL);
+                if (flags != -1)
+                    ::fcntl(pfd.fd, F_SETFL, flags & ~O_NONBLOCK); //DaemonRequest::reply() expects a blocking socket
+
+                pendingClients_.erase(pfd.fd);
+                return std::make_unique<DaemonRequest>(pfd.fd, command);
+            }
+            dropClient = true;
+        }
+
+        if (client.input.size() > REQUEST_LENGTH_MAX ||
+            numeric::dist(now, client.connectTime) > std::chrono::milliseconds(REQUEST_TIMEOUT_MS)) //handle potential chrono wrap-around!
+            dropClient = true;
+
+        if (dropClient)
+        {
+            ::close(pfd.fd);
+            pendingClients_.erase(pfd.fd);
+        }
+    }
+    return nullptr;
+}
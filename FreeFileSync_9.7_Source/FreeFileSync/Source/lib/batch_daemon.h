@@ -0,0 +1,101 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef BATCH_DAEMON_H_2390847509238457092
+#define BATCH_DAEMON_H_2390847509238457092
+
+#include <map>
+#include <set>
+#include <memory>
+#include <chrono>
+#include <zen/dir_watcher.h>
+#include <zen/file_access.h>
+#include "change_list.h"
+
+
+namespace zen
+{
+/*
+daemon mode: run batch jobs repeatedly within a single long-running process
+
+    - file system changes of the base folders are collected between runs => incremental comparison
+    - sync databases stay in memory between runs: see SyncDatabaseCache
+    - jobs are started on schedule or on demand via a local socket
+*/
+
+//collect changes of (native) base folders between runs of a daemon job, similar to RealTimeSync's %change_list%
+class FolderChangeMonitor
+{
+public:
+    //watch exactly these folders: newly watched folders are reported as changed (=> full comparison), folders that can't be watched are not reported as watched
+    void setFolders(const std::vector<Zstring>& folderPaths); //noexcept
+
+    //fetch pending change notifications: call regularly to prevent the event queue from overflowing
+    void update(); //noexcept: drops a watch on error or if its folder was removed or replaced => re-installed by next setFolders()
+
+    //changes since the previous call
+    ChangeList extractChanges();
+
+    //items the previous run did not synchronize: report them again with the next changes
+    void addChangedItems(const std::vector<Zstring>& itemPaths) { changedItemPaths_.insert(itemPaths.begin(), itemPaths.end()); }
+
+private:
+    struct FolderWatch
+    {
+        std::unique_ptr<DirWatcher> watcher;
+        FileId folderId; //detect folder being deleted and recreated: notifications of the old folder don't cover the new one
+    };
+    std::map<Zstring, FolderWatch, LessFilePath> watches_;
+    std::set<Zstring, LessFilePath> changedItemPaths_;
+};
+
+
+//local control socket: one request per connection, consisting of a single line of text; the reply is sent after the request was processed
+//accessible by the current user only
+class DaemonRequest
+{
+public:
+    DaemonRequest(int clientSocket, const std::string& command) : clientSocket_(clientSocket), command_(command) {}
+    ~DaemonRequest();
+
+    const std::string& getCommand() const { return command_; }
+
+    void reply(const std::string& text); //noexcept: client may have disconnected already
+
+private:
+    DaemonRequest           (const DaemonRequest&) = delete;
+    DaemonRequest& operator=(const DaemonRequest&) = delete;
+
+    const int clientSocket_;
+    const std::string command_;
+};
+
+
+class DaemonSocket
+{
+public:
+    explicit DaemonSocket(const Zstring& socketPath); //throw FileError: e.g. another daemon is already listening
+    ~DaemonSocket();
+
+    std::unique_ptr<DaemonRequest> getRequest(); //throw FileError; non-blocking: nullptr if there is no complete request (yet)
+
+private:
+    DaemonSocket           (const DaemonSocket&) = delete;
+    DaemonSocket& operator=(const DaemonSocket&) = delete;
+
+    struct PendingClient
+    {
+        std::string input; //request received so far
+        std::chrono::steady_clock::time_point connectTime;
+    };
+
+    const Zstring socketPath_;
+    int socket_ = -1;
+    std::map<int, PendingClient> pendingClients_; //client socket => partial request: a slow client must not block the daemon
+};
+}
+
+#endif //BATCH_DAEMON_H_2390847509238457092
@@ -7,6 +7,10 @@
 #include "binary.h"
 #include <vector>
 #include <chrono>
+#include <deque>
+#include <map>
+#include <atomic>
+#include <zen/sha256.h>
 
 using namespace zen;
 using AFS = AbstractFileSystem;
@@ -89,6 +93,165 @@ private:
     std::chrono::steady_clock::time_point lastDelayViolation_ = std::chrono::steady_clock::now();
     bool eof_ = false;
 };
+
+
+//read file on a separate thread: chunks are passed via a bounded queue => overlap reading with comparison
+class AsyncStreamReader
+{
+public:
+    AsyncStreamReader(const AbstractPath& filePath, const IOCallback& notifyUnbufferedIO) //notifyUnbufferedIO: context of reader thread!
+    {
+        reader_ = InterruptibleThread([this, filePath, notifyUnbufferedIO, ioCounters = getCurrentIoCounters()]
+        {
+            setCurrentThreadName("Compare Reader");
+            IoCountersScope ioScope(ioCounters);
+            try
+            {
+                StreamReader reader(filePath, notifyUnbufferedIO); //throw FileError, X
+                do
+                {
+                    std::vector<char> chunk;
+                    reader.appendChunk(chunk); //throw FileError, X
+
+                    std::unique_lock<std::mutex> dummy(lockChunks_);
+                    interruptibleWait(conditionChunkTaken_, dummy, [this] { return chunks_.size() < CHUNKS_BUFFERED_MAX; }); //throw ThreadInterruption
+                    chunks_.push_back(std::move(chunk));
+                    conditionChunkAdded_.notify_all();
+                }
+                while (!reader.isEof());
+            }
+            catch (FileError&) //includes ErrorFileLocked
+            {
+                std::lock_guard<std::mutex> dummy(lockChunks_);
+                readError_ = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> dummy(lockChunks_);
+            readerDone_ = true;
+            conditionChunkAdded_.notify_all();
+        });
+    }
+
+    ~AsyncStreamReader()
+    {
+        reader_.interrupt();
+        reader_.join();
+    }
+
+    //context of worker thread:
+    bool getChunk(std::vector<char>& buffer) //throw FileError, ThreadInterruption; return false if end of stream
+    {
+        std::unique_lock<std::mutex> dummy(lockChunks_);
+        interruptibleWait(conditionChunkAdded_, dummy, [this] { return !chunks_.empty() || readerDone_; }); //throw ThreadInterruption
+
+        if (!chunks_.empty())
+        {
+            buffer.swap(chunks_.front());
+            chunks_.pop_front();
+            conditionChunkTaken_.notify_all();
+            return true;
+        }
+        if (readError_)
+            std::rethrow_exception(readError_); //throw FileError
+        buffer.clear();
+        return false;
+    }
+
+private:
+    AsyncStreamReader           (const AsyncStreamReader&) = delete;
+    AsyncStreamReader& operator=(const AsyncStreamReader&) = delete;
+
+    static const size_t CHUNKS_BUFFERED_MAX = 2;
+
+    std::mutex lockChunks_;
+    std::condition_variable conditionChunkAdded_;
+    std::condition_variable conditionChunkTaken_;
+    std::deque<std::vector<char>> chunks_;
+    std::exception_ptr readError_;
+    bool readerDone_ = false;
+
+    InterruptibleThread reader_; //declare last: thread accesses members above!
+};
+
+
+//context of worker thread: read second file asynchronously while reading the first one and comparing
+bool filesHaveSameContentPipelined(const AbstractPath& filePath1, const AbstractPath& filePath2, //throw FileError, ThreadInterruption
+                                   ContentDigest& digest1, //out: only set if same content
+                                   const IOCallback& notifyUnbufferedIO)
+{
+    AsyncStreamReader reader2(filePath2, notifyUnbufferedIO); //notifyUnbufferedIO: both threads!
+    StreamReader      reader1(filePath1, notifyUnbufferedIO); //throw FileError, X
+
+    std::vector<char> buffer1;
+    std::vector<char> buffer2;
+    size_t pos1 = 0;
+    size_t pos2 = 0;
+    bool eof1 = false;
+    bool eof2 = false;
+    Sha256 hash1; //calculate on the fly: cheaper than reading the file again later
+
+    for (;;)
+    {
+        if (pos1 == buffer1.size() && !eof1)
+        {
+            buffer1.clear();
+            pos1 = 0;
+            reader1.appendChunk(buffer1); //throw FileError, X
+            eof1 = reader1.isEof();
+            hash1.update(buffer1.data(), buffer1.size());
+        }
+        if (pos2 == buffer2.size() && !eof2)
+        {
+            pos2 = 0;
+            eof2 = !reader2.getChunk(buffer2); //throw FileError, ThreadInterruption
+        }
+
+        const size_t bytesCmp = std::min(buffer1.size() - pos1, buffer2.size() - pos2);
+        if (!std::equal(buffer1.begin() + pos1, buffer1.begin() + pos1 + bytesCmp,
+                        buffer2.begin() + pos2))
+            return false;
+        pos1 += bytesCmp;
+        pos2 += bytesCmp;
+
+        const bool exhausted1 = pos1 == buffer1.size() && eof1;
+        const bool exhausted2 = pos2 == buffer2.size() && eof2;
+        if (exhausted1 || exhausted2)
+        {
+            if (exhausted1 && exhausted2)
+            {
+                digest1 = hash1.finalize<ContentDigest>();
+                return true;
+            }
+            if (exhausted1 ? pos2 != buffer2.size() : pos1 != buffer1.size())
+                return false;
+            //else: other side might still be at a chunk boundary just before end of stream
+        }
+    }
+}
+
+
+//context of worker thread: content of second file is known from a previous run => read the first file only
+bool fileMatchesDigest(const AbstractPath& filePath, const ContentDigest& digest, //throw FileError, X
+                       ContentDigest& digestOut, //out: only set if same content
+                       const IOCallback& notifyUnbufferedIO)
+{
+    StreamReader reader(filePath, notifyUnbufferedIO); //throw FileError, X
+    Sha256 hash;
+
+    std::vector<char> buffer;
+    do
+    {
+        buffer.clear();
+        reader.appendChunk(buffer); //throw FileError, X
+        hash.update(buffer.data(), buffer.size());
+    }
+    while (!reader.isEof());
+
+    if (hash.finalize<ContentDigest>() != digest)
+        return false;
+    digestOut = digest;
+    return true;
+}
 }
 
 
@@ -139,3 +302,142 @@ bool zen::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath
 
     return true;
 }
+
+
+struct ParallelContentComparison::SharedData
+{
+    explicit SharedData(const std::vector<ContentComparisonItem>& jobsIn) :
+        jobs(jobsIn), items(jobsIn.size()) {}
+
+    enum class ItemStatus : unsigned char
+    {
+        PENDING,
+        SAME_CONTENT,
+        DIFFERENT_CONTENT,
+        FAILED,
+    };
+    struct Item
+    {
+        int64_t bytesProcessed = 0; //all files read combined
+        ItemStatus status = ItemStatus::PENDING;
+        ContentDigest digest;
+    };
+
+    const std::vector<ContentComparisonItem> jobs;
+    std::atomic<size_t> nextItemIdx{ 0 }; //distribute work in input order
+
+    std::mutex lockItems; //protects the following:
+    std::condition_variable conditionItemDone;
+    std::vector<Item> items;
+    std::map<size_t, FileError> errors; //rare: don't bloat "Item"
+};
+
+
+ParallelContentComparison::ParallelContentComparison(const std::vector<ContentComparisonItem>& items, size_t threadCount) :
+    shared_(std::make_shared<SharedData>(items))
+{
+    threadCount = std::max<size_t>(1, std::min(threadCount, items.size()));
+
+    for (size_t i = 0; i < threadCount; ++i)
+        worker_.emplace_back([shared = shared_]
+        {
+            setCurrentThreadName("Compare Content");
+
+            std::unique_ptr<IoCountersScope> ioScope; //items of the same folder pair are consecutive: rebind only when the folder pair changes
+            IoCounters* ioCountersBound = nullptr;
+
+            for (;;)
+            {
+                const size_t itemIdx = shared->nextItemIdx++;
+                if (itemIdx >= shared->jobs.size())
+                    return;
+                const ContentComparisonItem& job = shared->jobs[itemIdx];
+
+                if (job.ioCounters != ioCountersBound)
+                {
+                    ioScope.reset();
+                    ioScope = std::make_unique<IoCountersScope>(job.ioCounters);
+                    ioCountersBound = job.ioCounters;
+                }
+
+                auto notifyUnbufferedIO = [&](int64_t bytesDelta) //context of comparison and reader thread
+                {
+                    {
+                        std::lock_guard<std::mutex> dummy(shared->lockItems);
+                        shared->items[itemIdx].bytesProcessed += bytesDelta;
+                    }
+                    interruptionPoint(); //throw ThreadInterruption
+                };
+
+                SharedData::ItemStatus status = SharedData::ItemStatus::FAILED;
+                ContentDigest digest;
+                Opt<FileError> error;
+                try
+                {
+                    const bool sameContent = job.digest2.empty() ?
+                                             filesHaveSameContentPipelined(job.filePath1, job.filePath2, digest, notifyUnbufferedIO) : //throw FileError, ThreadInterruption
+                                             fileMatchesDigest(job.filePath1, job.digest2, digest, notifyUnbufferedIO);                //
+                    status = sameContent ? SharedData::ItemStatus::SAME_CONTENT : SharedData::ItemStatus::DIFFERENT_CONTENT;
+                }
+                catch (const FileError& e) { error = e; }
+
+                std::lock_guard<std::mutex> dummy(shared->lockItems);
+                shared->items[itemIdx].status = status;
+                shared->items[itemIdx].digest = digest;
+                if (error)
+                    shared->errors.emplace(itemIdx, *error);
+                shared->conditionItemDone.notify_all();
+            }
+        });
+}
+
+
+ParallelContentComparison::~ParallelContentComparison()
+{
+    for (InterruptibleThread& wt : worker_)
+        wt.interrupt(); //interrupt all first, then join
+    for (InterruptibleThread& wt : worker_)
+        wt.join();
+}
+
+
+bool ParallelContentComparison::waitForResult(size_t itemIdx, std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> dummy(shared_->lockItems);
+    return shared_->conditionItemDone.wait_for(dummy, timeout, [&] { return shared_->items[itemIdx].status != SharedData::ItemStatus::PENDING; });
+}
+
+
+int64_t ParallelContentComparison::getBytesProcessed(size_t itemIdx) const
+{
+    const int filesRead = shared_->jobs[itemIdx].digest2.empty() ? 2 : 1;
+
+    std::lock_guard<std::mutex> dummy(shared_->lockItems);
+    return shared_->items[itemIdx].bytesProcessed / filesRead; //harmonize with filesHaveSameContent(): report bytes per file
+}
+
+
+bool ParallelContentComparison::haveSameContent(size_t itemIdx) const //throw FileError
+{
+    std::lock_guard<std::mutex> dummy(shared_->lockItems);
+    switch (shared_->items[itemIdx].status)
+    {
+        case SharedData::ItemStatus::SAME_CONTENT:
+            return true;
+        case SharedData::ItemStatus::DIFFERENT_CONTENT:
+            return false;
+        case SharedData::ItemStatus::FAILED:
+            throw shared_->errors.find(itemIdx)->second;
+        case SharedData::ItemStatus::PENDING:
+            break;
+    }
+    throw std::logic_error("Contract violation! " + std::string(__FILE__) + ":" + numberTo<std::string>(__LINE__));
+}
+
+
+ContentDigest ParallelContentComparison::getContentDigest(size_t itemIdx) const
+{
+    std::lock_guard<std::mutex> dummy(shared_->lockItems);
+    assert(shared_->items[itemIdx].status == SharedData::ItemStatus::SAME_CONTENT);
+    return shared_->items[itemIdx].digest;
+}
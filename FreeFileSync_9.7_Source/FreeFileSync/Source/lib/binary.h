@@ -7,7 +7,10 @@
 #ifndef BINARY_H_3941281398513241134
 #define BINARY_H_3941281398513241134
 
+#include <chrono>
+#include <zen/thread.h>
 #include "../fs/abstract.h"
+#include "../file_hierarchy.h"
 
 
 namespace zen
@@ -15,6 +18,37 @@ namespace zen
 bool filesHaveSameContent(const AbstractPath& filePath1, //throw FileError
                           const AbstractPath& filePath2,
                           const IOCallback& notifyUnbufferedIO); //may be nullptr
+
+
+struct ContentComparisonItem
+{
+    AbstractPath filePath1;
+    AbstractPath filePath2;
+    ContentDigest digest2; //optional: if available, file 1 is compared against this digest instead of reading file 2
+    IoCounters* ioCounters = nullptr; //optional: collect I/O statistics
+};
+
+//compare file pairs on a bounded number of worker threads; both files of a pair are read concurrently while comparing
+//=> results are queried from the calling thread one after another in input order
+class ParallelContentComparison
+{
+public:
+    ParallelContentComparison(const std::vector<ContentComparisonItem>& items, size_t threadCount);
+    ~ParallelContentComparison(); //interrupt and join worker threads
+
+    bool waitForResult(size_t itemIdx, std::chrono::milliseconds timeout); //return true if result is available
+    int64_t getBytesProcessed(size_t itemIdx) const; //unit compatible with filesHaveSameContent()'s notifyUnbufferedIO
+    bool haveSameContent(size_t itemIdx) const; //throw FileError; precondition: waitForResult() returned true
+    ContentDigest getContentDigest(size_t itemIdx) const; //digest of file 1; precondition: haveSameContent() returned true
+
+private:
+    ParallelContentComparison           (const ParallelContentComparison&) = delete;
+    ParallelContentComparison& operator=(const ParallelContentComparison&) = delete;
+
+    struct SharedData;
+    const std::shared_ptr<SharedData> shared_;
+    std::vector<InterruptibleThread> worker_;
+};
 }
 
 #endif //BINARY_H_3941281398513241134
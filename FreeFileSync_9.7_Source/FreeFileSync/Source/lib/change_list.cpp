@@ -0,0 +1,84 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "change_list.h"
+#include <zen/file_io.h>
+#include <zen/utf.h>
+
+using namespace zen;
+
+
+namespace
+{
+/*
+UTF-8 text file, one native path per line:
+
+    [Watched]
+    /home/zenju/Documents
+    [Changed]
+    /home/zenju/Documents/new file.txt
+    [Unresolved]
+    /home/zenju/Documents/conflict.txt
+    [Completed]
+*/
+const char HEADER_WATCHED   [] = "[Watched]";
+const char HEADER_CHANGED   [] = "[Changed]";
+const char HEADER_UNRESOLVED[] = "[Unresolved]";
+const char HEADER_COMPLETED [] = "[Completed]"; //no items: must be the last line
+const char LINE_BREAK[] = "\n";
+}
+
+
+void zen::saveChangeList(const ChangeList& changeList, const Zstring& filePath) //throw FileError
+{
+    std::string stream = std::string(HEADER_WATCHED) + LINE_BREAK;
+    for (const Zstring& folderPath : changeList.watchedFolderPaths)
+        stream += utfTo<std::string>(folderPath) + LINE_BREAK;
+
+    stream += std::string(HEADER_CHANGED) + LINE_BREAK;
+    for (const Zstring& itemPath : changeList.changedItemPaths)
+        stream += utfTo<std::string>(itemPath) + LINE_BREAK;
+
+    if (!changeList.unresolvedItemPaths.empty())
+    {
+        stream += std::string(HEADER_UNRESOLVED) + LINE_BREAK;
+        for (const Zstring& itemPath : changeList.unresolvedItemPaths)
+            stream += utfTo<std::string>(itemPath) + LINE_BREAK;
+    }
+
+    if (changeList.completed)
+        stream += std::string(HEADER_COMPLETED) + LINE_BREAK;
+
+    saveBinContainer(filePath, stream, nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+
+ChangeList zen::loadChangeList(const Zstring& filePath) //throw FileError
+{
+    const std::string stream = loadBinContainer<std::string>(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    ChangeList changeList;
+    std::vector<Zstring>* section = nullptr;
+
+    for (const std::string& line : split(stream, LINE_BREAK, SplitType::SKIP_EMPTY))
+        if (line == HEADER_WATCHED)
+            section = &changeList.watchedFolderPaths;
+        else if (line == HEADER_CHANGED)
+            section = &changeList.changedItemPaths;
+        else if (line == HEADER_UNRESOLVED)
+            section = &changeList.unresolvedItemPaths;
+        else if (line == HEADER_COMPLETED)
+        {
+            changeList.completed = true;
+            section = nullptr;
+        }
+        else if (section)
+            section->push_back(utfTo<Zstring>(line));
+        else
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), L"Unexpected file format.");
+
+    return changeList;
+}
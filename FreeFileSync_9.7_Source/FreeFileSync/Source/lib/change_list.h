@@ -0,0 +1,40 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CHANGE_LIST_H_4872390584732098745
+#define CHANGE_LIST_H_4872390584732098745
+
+#include <vector>
+#include <zen/zstring.h>
+#include <zen/file_error.h>
+
+
+namespace zen
+{
+//file system changes detected by RealTimeSync since the previous command invocation: allows FreeFileSync to compare incrementally
+struct ChangeList
+{
+    std::vector<Zstring> watchedFolderPaths;  //change notifications are complete for these folders (and their subfolders) only
+    std::vector<Zstring> changedItemPaths;    //native paths of created/updated/deleted files and folders
+    std::vector<Zstring> unresolvedItemPaths; //written back by FreeFileSync: items not (yet) in sync after the command => add to the next change list
+    bool completed = false; //written back by FreeFileSync: "unresolvedItemPaths" is final; otherwise (e.g. crash) all changes are still unresolved
+};
+
+const size_t CHANGE_LIST_SIZE_MAX = 100000; //too many changes: let FreeFileSync rather do a full comparison
+
+//changes of FreeFileSync's own files don't need synchronization
+inline
+bool isIgnoredChange(const Zstring& itemPath)
+{
+    return endsWith(itemPath, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
+           endsWith(itemPath, Zstr(".ffs_db"));     //sync.ffs_db, .sync.tmp.ffs_db
+}
+
+void       saveChangeList(const ChangeList& changeList, const Zstring& filePath); //throw FileError
+ChangeList loadChangeList(const Zstring& filePath); //throw FileError
+}
+
+#endif //CHANGE_LIST_H_4872390584732098745
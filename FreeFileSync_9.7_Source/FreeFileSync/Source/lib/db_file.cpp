@@ -7,8 +7,15 @@
 #include "db_file.h"
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/thread.h>
+#include <zen/scope_guard.h>
+#include <zen/globals.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
 #include <wx+/zlib_wrap.h>
 
+    #include <unistd.h> //ftruncate
+
 
 using namespace zen;
 
@@ -17,26 +24,45 @@ namespace
 {
 //-------------------------------------------------------------------------------------------------------------------------------
 const char FILE_FORMAT_DESCR[] = "FreeFileSync";
-const int DB_FORMAT_CONTAINER = 10; //since 2017-02-01
-const int DB_FORMAT_STREAM    =  3; //
+const int DB_FORMAT_CONTAINER = 11; //since 2026-10-18: journal
+const int DB_FORMAT_STREAM    =  5; //since 2026-10-18: chunked compression
+
+const size_t DB_STREAM_CHUNK_SIZE = 1024 * 1024; //[bytes] uncompressed; zlib's 32 kB window => no measurable loss of compression
+
+const double DB_JOURNAL_SIZE_RATIO_MAX = 0.5; //compact journal into a new snapshot when it grows larger than this fraction of the snapshot
 //-------------------------------------------------------------------------------------------------------------------------------
 
+using UniqueId = std::string;
+
+struct JournalRecord
+{
+    UniqueId recordID;
+    ByteArray changes; //compressed: see JournalWriter
+};
+bool operator==(const JournalRecord& lhs, const JournalRecord& rhs) { return lhs.recordID == rhs.recordID && lhs.changes == rhs.changes; }
+
 struct SessionData
 {
     bool isLeadStream;
-    ByteArray rawStream;
+    ByteArray rawStream; //snapshot: split between both database files
+    std::vector<JournalRecord> journal; //changes since the snapshot, oldest first: stored in both database files
 };
-bool operator==(const SessionData& lhs, const SessionData& rhs) { return lhs.isLeadStream == rhs.isLeadStream && lhs.rawStream == rhs.rawStream; }
 
-using UniqueId  = std::string;
 using DbStreams = std::map<UniqueId, SessionData>; //list of streams ordered by session UUID
 
+struct DbFile
+{
+    DbStreams streams;
+    uint64_t validSize = 0; //end of the last complete journal record: position for the next append
+    int version = DB_FORMAT_CONTAINER; //as found on disk: older versions ignore journal records => must be rewritten before appending
+};
+
 /*------------------------------------------------------------------------------
   | ensure 32/64 bit portability: use fixed size data types only e.g. uint32_t |
   ------------------------------------------------------------------------------*/
 
-template <SelectedSide side> inline
-AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder, bool tempfile = false)
+inline
+AbstractPath getDatabaseFilePath(const AbstractPath& baseFolderPath, bool tempfile = false)
 {
     //Linux and Windows builds are binary incompatible: different file id?, problem with case sensitivity?
     //precomposed/decomposed UTF? are UTC file times really compatible? what about endianess!?
@@ -53,11 +79,33 @@ AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder, bool tempfile
     else
         dbFileName = dbName + SYNC_DB_FILE_ENDING;
 
-    return AFS::appendRelPath(baseFolder.getAbstractPath<side>(), dbFileName);
+    return AFS::appendRelPath(baseFolderPath, dbFileName);
 }
 
 //#######################################################################################################################################
 
+/*
+file format:
+    header | stream list: session ID, lead flag, snapshot stream | journal records until end of file
+
+journal record: [session ID, record ID, changes] + CRC32
+    - appended to both database files after each sync: the files are only rewritten when the journal is compacted
+    - an incomplete record at the end of the file (e.g. power loss) is ignored and overwritten by the next append
+*/
+ByteArray serializeJournalRecord(const UniqueId& sessionID, const JournalRecord& record)
+{
+    MemoryStreamOut<ByteArray> recordOut;
+    writeContainer(recordOut, sessionID);
+    writeContainer(recordOut, record.recordID);
+    writeContainer(recordOut, record.changes);
+
+    MemoryStreamOut<ByteArray> streamOut;
+    writeContainer(streamOut, recordOut.ref());
+    writeNumber<uint32_t>(streamOut, getCrc32(recordOut.ref().begin(), recordOut.ref().end()));
+    return streamOut.ref();
+}
+
+
 void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const IOCallback& notifyUnbufferedIO) //throw FileError
 {
     const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(dbPath, //throw FileError
@@ -80,47 +128,97 @@ void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const
         writeContainer<ByteArray>(*fileStreamOut, stream.second.rawStream); //
     }
 
+    //keep journals of other sessions
+    for (const auto& stream : streamList)
+        for (const JournalRecord& record : stream.second.journal)
+        {
+            const ByteArray buf = serializeJournalRecord(stream.first, record);
+            writeArray(*fileStreamOut, &*buf.begin(), buf.size()); //throw FileError, X
+        }
+
     //commit and close stream:
     fileStreamOut->finalize(); //throw FileError, X
 
 }
 
 
-DbStreams loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbufferedIO) //throw FileError, FileErrorDatabaseNotExisting
+//native files only: AFS has no means to truncate a torn record
+uint64_t appendJournalRecord(const Zstring& dbFilePath, uint64_t validSize, const UniqueId& sessionID, const JournalRecord& record, //throw FileError
+                             const IOCallback& notifyUnbufferedIO) //returns new valid size
+{
+    const ByteArray buf = serializeJournalRecord(sessionID, record);
+
+    FileOutput fileOut(dbFilePath, FileOutput::ACC_APPEND_EXISTING, notifyUnbufferedIO); //throw FileError, (ErrorTargetExisting)
+    //don't create a file deleted in the meantime: ftruncate() would fill it with zeros up to "validSize"
+
+    //drop incomplete record of an interrupted append
+    if (::ftruncate(fileOut.getHandle(), validSize) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(dbFilePath)), L"ftruncate");
+
+    fileOut.write(&*buf.begin(), buf.size()); //throw FileError, X
+    fileOut.finalize();                       //
+    return validSize + buf.size();
+}
+
+
+//track read position: needed to find the end of the last complete journal record
+struct CountingInputStream
+{
+    explicit CountingInputStream(AFS::InputStream& streamIn) : streamIn_(streamIn) {}
+
+    size_t read(void* buffer, size_t bytesToRead) //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+    {
+        const size_t bytesRead = streamIn_.read(buffer, bytesToRead);
+        pos_ += bytesRead;
+        return bytesRead;
+    }
+
+    uint64_t pos() const { return pos_; }
+
+private:
+    AFS::InputStream& streamIn_;
+    uint64_t pos_ = 0;
+};
+
+
+DbFile loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbufferedIO) //throw FileError, FileErrorDatabaseNotExisting
 {
     try
     {
-        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(dbPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+        const std::unique_ptr<AFS::InputStream> fileStreamInAfs = AFS::getInputStream(dbPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+        CountingInputStream fileStreamIn(*fileStreamInAfs);
 
         //read FreeFileSync file identifier
         char formatDescr[sizeof(FILE_FORMAT_DESCR)] = {};
-        readArray(*fileStreamIn, formatDescr, sizeof(formatDescr)); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+        readArray(fileStreamIn, formatDescr, sizeof(formatDescr)); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
 
         if (!std::equal(FILE_FORMAT_DESCR, FILE_FORMAT_DESCR + sizeof(FILE_FORMAT_DESCR), formatDescr))
             throw FileError(replaceCpy(_("Database file %x is incompatible."), L"%x", fmtPath(AFS::getDisplayPath(dbPath))));
 
-        const int version = readNumber<int32_t>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+        const int version = readNumber<int32_t>(fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
 
-        //TODO: remove migration code at some time! 2017-02-01
-        if (version != 9 &&
+        //TODO: remove migration code at some time! 2017-02-01 + 2026-10-18
+        if (version != 9  &&
+            version != 10 &&
             version != DB_FORMAT_CONTAINER) //read file format version number
             throw FileError(replaceCpy(_("Database file %x is incompatible."), L"%x", fmtPath(AFS::getDisplayPath(dbPath))));
 
-        DbStreams output;
+        DbFile output;
+        output.version = version;
 
         //read stream list
-        size_t dbCount = readNumber<uint32_t>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+        size_t dbCount = readNumber<uint32_t>(fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
         while (dbCount-- != 0)
         {
             //DB id of partner databases
-            std::string sessionID = readContainer<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+            std::string sessionID = readContainer<std::string>(fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
 
             SessionData sessionData = {};
 
             //TODO: remove migration code at some time! 2017-02-01
             if (version == 9)
             {
-                sessionData.rawStream = readContainer<ByteArray>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+                sessionData.rawStream = readContainer<ByteArray>(fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
 
                 MemoryStreamIn<ByteArray> streamIn(sessionData.rawStream);
                 const int streamVersion = readNumber<int32_t>(streamIn); //throw UnexpectedEndOfStreamError
@@ -130,12 +228,42 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbuff
             }
             else
             {
-                sessionData.isLeadStream = readNumber<int8_t>(*fileStreamIn) != 0;  //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
-                sessionData.rawStream    = readContainer<ByteArray>(*fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+                sessionData.isLeadStream = readNumber<int8_t>(fileStreamIn) != 0;  //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+                sessionData.rawStream    = readContainer<ByteArray>(fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
             }
 
-            output[sessionID] = std::move(sessionData);
+            output.streams[sessionID] = std::move(sessionData);
         }
+        output.validSize = fileStreamIn.pos();
+
+        //read journal records
+        if (version >= 11)
+            for (;;)
+            {
+                ByteArray recordBuf;
+                uint32_t crc32 = 0;
+                try
+                {
+                    recordBuf = readContainer<ByteArray>(fileStreamIn); //throw FileError, ErrorFileLocked, X, UnexpectedEndOfStreamError
+                    crc32     = readNumber<uint32_t>(fileStreamIn);     //
+                }
+                catch (UnexpectedEndOfStreamError&) { break; } //end of file or incomplete record
+
+                if (getCrc32(recordBuf.begin(), recordBuf.end()) != crc32)
+                    break; //partially written: dismiss all remaining data
+
+                MemoryStreamIn<ByteArray> recordIn(recordBuf);
+                const UniqueId sessionID = readContainer<UniqueId>(recordIn); //throw UnexpectedEndOfStreamError
+                JournalRecord record;
+                record.recordID = readContainer<UniqueId >(recordIn); //
+                record.changes  = readContainer<ByteArray>(recordIn); //
+
+                auto it = output.streams.find(sessionID);
+                if (it != output.streams.end()) //else: session was removed during compaction
+                    it->second.journal.push_back(record);
+
+                output.validSize = fileStreamIn.pos();
+            }
         return output;
     }
     catch (FileError&)
@@ -163,6 +291,250 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IOCallback& notifyUnbuff
 
 //#######################################################################################################################################
 
+class DatabaseCache
+{
+public:
+    //nullptr if not cached or changed on disk in the meantime
+    std::shared_ptr<const DbFile> getFile(const Zstring& dbFilePath, const FileSignature& signature) const
+    {
+        std::lock_guard<std::mutex> dummy(lockCache_);
+        auto it = files_.find(dbFilePath);
+        if (it != files_.end() && it->second.signature == signature)
+            return it->second.dbFile;
+        return nullptr;
+    }
+
+    void setFile(const Zstring& dbFilePath, const FileSignature& signature, const std::shared_ptr<const DbFile>& dbFile)
+    {
+        std::lock_guard<std::mutex> dummy(lockCache_);
+        files_[dbFilePath] = { signature, dbFile };
+    }
+
+    //a state ID identifies the stream content: no need to validate the parsed state against the file signatures again
+    std::shared_ptr<const InSyncFolder> getSyncState(const Zstring& dbFilePathL, const Zstring& dbFilePathR, const UniqueId& stateID) const
+    {
+        std::lock_guard<std::mutex> dummy(lockCache_);
+        auto it = syncStates_.find({ dbFilePathL, dbFilePathR });
+        if (it != syncStates_.end() && it->second.stateID == stateID)
+            return it->second.syncState;
+        return nullptr;
+    }
+
+    void setSyncState(const Zstring& dbFilePathL, const Zstring& dbFilePathR, const UniqueId& stateID, const std::shared_ptr<const InSyncFolder>& syncState)
+    {
+        std::lock_guard<std::mutex> dummy(lockCache_);
+        syncStates_[{ dbFilePathL, dbFilePathR }] = { stateID, syncState };
+    }
+
+private:
+    struct CachedFile
+    {
+        FileSignature signature;
+        std::shared_ptr<const DbFile> dbFile;
+    };
+    struct CachedSyncState
+    {
+        UniqueId stateID; //see getStateID()
+        std::shared_ptr<const InSyncFolder> syncState;
+    };
+
+    mutable std::mutex lockCache_;
+    std::map<Zstring, CachedFile, LessFilePath> files_;
+    std::map<std::pair<Zstring, Zstring>, CachedSyncState> syncStates_; //key: native database file paths left/right
+};
+
+Global<DatabaseCache> globalDatabaseCache; //bound while a SyncDatabaseCache instance exists
+
+
+std::shared_ptr<const DbFile> loadStreamsCached(const AbstractPath& dbPath, const IOCallback& notifyUnbufferedIO) //throw FileError, FileErrorDatabaseNotExisting
+{
+    if (std::shared_ptr<DatabaseCache> cache = globalDatabaseCache.get())
+        if (const Opt<Zstring> dbFilePath = AFS::getNativeItemPath(dbPath))
+        {
+            Opt<FileSignature> signature;
+            try { signature = getFileSignature(*dbFilePath); /*throw FileError*/ }
+            catch (FileError&) {} //e.g. not existing: let loadStreams() report the details
+
+            if (signature)
+            {
+                if (std::shared_ptr<const DbFile> dbFile = cache->getFile(*dbFilePath, *signature))
+                    return dbFile;
+
+                //file changed while loading? => its new signature won't match the one taken before: the entry will never be used
+                auto dbFile = std::make_shared<const DbFile>(loadStreams(dbPath, notifyUnbufferedIO)); //throw FileError, FileErrorDatabaseNotExisting
+                cache->setFile(*dbFilePath, *signature, dbFile);
+                return dbFile;
+            }
+        }
+
+    return std::make_shared<const DbFile>(loadStreams(dbPath, notifyUnbufferedIO)); //throw FileError, FileErrorDatabaseNotExisting
+}
+
+//#######################################################################################################################################
+
+//zlib is single-threaded: split streams into independent chunks and (de-)compress them on all cores
+template <class Function> //void(size_t jobIdx) noexcept
+void runParallelJobs(size_t jobCount, Function fun)
+{
+    std::atomic<size_t> nextJobIdx(0);
+    auto processJobs = [&]
+    {
+        for (size_t jobIdx = nextJobIdx++; jobIdx < jobCount; jobIdx = nextJobIdx++)
+            fun(jobIdx);
+    };
+
+    const size_t threadCount = std::min<size_t>(jobCount, std::max(std::thread::hardware_concurrency(), 1U));
+    std::vector<InterruptibleThread> worker;
+    ZEN_ON_SCOPE_EXIT(for (InterruptibleThread& wt : worker) wt.join());
+
+    for (size_t i = 1; i < threadCount; ++i) //current thread is the first worker
+        worker.emplace_back([processJobs]
+        {
+            setCurrentThreadName("DB (de-)compression");
+            processJobs();
+        });
+    processJobs();
+}
+
+
+struct DbStreamChunk
+{
+    size_t streamIdx = 0;
+    size_t offset    = 0; //position within uncompressed stream
+    size_t size      = 0; //uncompressed
+    uint32_t crc32   = 0; //
+    ByteArray compressed;
+};
+
+
+//format: per stream: chunk count; per chunk: uncompressed size, CRC32 of uncompressed data, compressed data
+void writeCompressedStreams(MemoryStreamOut<ByteArray>& streamOut, const std::vector<ByteArray>& streams, //throw FileError
+                            const std::wstring& displayFilePathL, //used for diagnostics only
+                            const std::wstring& displayFilePathR)
+{
+    std::vector<DbStreamChunk> chunks;
+    for (size_t i = 0; i < streams.size(); ++i)
+        for (size_t offset = 0; offset < streams[i].size(); offset += DB_STREAM_CHUNK_SIZE)
+        {
+            DbStreamChunk chunk;
+            chunk.streamIdx = i;
+            chunk.offset    = offset;
+            chunk.size      = std::min(DB_STREAM_CHUNK_SIZE, streams[i].size() - offset);
+            chunks.push_back(chunk);
+        }
+
+    std::atomic<bool> zlibError(false);
+    runParallelJobs(chunks.size(), [&](size_t chunkIdx)
+    {
+        DbStreamChunk& chunk = chunks[chunkIdx];
+        const auto itFirst = streams[chunk.streamIdx].begin() + chunk.offset;
+        try
+        {
+            ByteArray data;
+            data.resize(chunk.size); //throw bad_alloc
+            std::copy(itFirst, itFirst + chunk.size, data.begin());
+
+            chunk.crc32 = getCrc32(data.begin(), data.end());
+            /* Zlib: optimal level - testcase 1 million files
+            level|size [MB]|time [ms]
+              0    49.54      272 (uncompressed)
+              1    14.53     1013
+              2    14.13     1106
+              3    13.76     1288 - best compromise between speed and compression
+              4    13.20     1526
+              5    12.73     1916
+              6    12.58     2765
+              7    12.54     3633
+              8    12.51     9032
+              9    12.50    19698 (maximal compression) */
+            chunk.compressed = compress(data, 3); //throw ZlibInternalError, bad_alloc
+        }
+        catch (ZlibInternalError&) { zlibError = true; }
+        catch (std::bad_alloc&)    { zlibError = true; }
+    });
+    if (zlibError)
+        throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"zlib internal error");
+
+    auto itChunk = chunks.begin();
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        const auto itChunkEnd = std::find_if(itChunk, chunks.end(), [&](const DbStreamChunk& chunk) { return chunk.streamIdx != i; });
+
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(itChunkEnd - itChunk));
+        for (; itChunk != itChunkEnd; ++itChunk)
+        {
+            writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(itChunk->size));
+            writeNumber<uint32_t>(streamOut, itChunk->crc32);
+            writeContainer(streamOut, itChunk->compressed);
+        }
+    }
+}
+
+
+std::vector<ByteArray> readCompressedStreams(MemoryStreamIn<ByteArray>& streamIn, size_t streamCount, //throw FileError, UnexpectedEndOfStreamError, bad_alloc
+                                             const std::wstring& displayFilePathL, //used for diagnostics only
+                                             const std::wstring& displayFilePathR)
+{
+    std::vector<DbStreamChunk> chunks;
+    std::vector<ByteArray> streams(streamCount);
+
+    for (size_t i = 0; i < streamCount; ++i)
+    {
+        size_t streamSize = 0;
+        size_t chunkCount = readNumber<uint32_t>(streamIn); //throw UnexpectedEndOfStreamError
+        while (chunkCount-- != 0)
+        {
+            DbStreamChunk chunk;
+            chunk.streamIdx  = i;
+            chunk.offset     = streamSize;
+            chunk.size       = readNumber<uint32_t>(streamIn); //
+            chunk.crc32      = readNumber<uint32_t>(streamIn); //throw UnexpectedEndOfStreamError
+            chunk.compressed = readContainer<ByteArray>(streamIn); //
+            streamSize += chunk.size;
+            chunks.push_back(chunk);
+        }
+        streams[i].resize(streamSize); //throw bad_alloc
+    }
+
+    enum class ChunkStatus
+    {
+        OK,
+        ZLIB_ERROR,
+        CHECKSUM_ERROR,
+    };
+    std::vector<ChunkStatus> chunkStatus(chunks.size(), ChunkStatus::OK);
+
+    runParallelJobs(chunks.size(), [&](size_t chunkIdx)
+    {
+        const DbStreamChunk& chunk = chunks[chunkIdx];
+        try
+        {
+            const ByteArray data = decompress(chunk.compressed); //throw ZlibInternalError, bad_alloc
+            if (data.size() != chunk.size ||
+                getCrc32(data.begin(), data.end()) != chunk.crc32)
+                chunkStatus[chunkIdx] = ChunkStatus::CHECKSUM_ERROR;
+            else
+                std::copy(data.begin(), data.end(), streams[chunk.streamIdx].begin() + chunk.offset);
+        }
+        catch (ZlibInternalError&) { chunkStatus[chunkIdx] = ChunkStatus::ZLIB_ERROR; }
+        catch (std::bad_alloc&)    { chunkStatus[chunkIdx] = ChunkStatus::ZLIB_ERROR; }
+    });
+
+    for (const ChunkStatus status : chunkStatus)
+        switch (status)
+        {
+            case ChunkStatus::OK:
+                break;
+            case ChunkStatus::ZLIB_ERROR:
+                throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"Zlib internal error");
+            case ChunkStatus::CHECKSUM_ERROR:
+                throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(displayFilePathL) + L"\n" + fmtPath(displayFilePathR), L"Checksum mismatch");
+        }
+    return streams;
+}
+
+//#######################################################################################################################################
+
 class StreamGenerator
 {
 public:
@@ -178,43 +550,18 @@ public:
         writeNumber<int32_t>(outL, DB_FORMAT_STREAM);
         writeNumber<int32_t>(outR, DB_FORMAT_STREAM);
 
-        auto compStream = [&](const ByteArray& stream) -> ByteArray //throw FileError
-        {
-            try
-            {
-                /* Zlib: optimal level - testcase 1 million files
-                level|size [MB]|time [ms]
-                  0    49.54      272 (uncompressed)
-                  1    14.53     1013
-                  2    14.13     1106
-                  3    13.76     1288 - best compromise between speed and compression
-                  4    13.20     1526
-                  5    12.73     1916
-                  6    12.58     2765
-                  7    12.54     3633
-                  8    12.51     9032
-                  9    12.50    19698 (maximal compression) */
-                return compress(stream, 3); //throw ZlibInternalError
-            }
-            catch (ZlibInternalError&)
-            {
-                throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"zlib internal error");
-            }
-        };
-
         StreamGenerator generator;
         //PERF_START
         generator.recurse(dbFolder);
         //PERF_STOP
 
-        const ByteArray bufText     = compStream(generator.streamOutText_    .ref());
-        const ByteArray bufSmallNum = compStream(generator.streamOutSmallNum_.ref());
-        const ByteArray bufBigNum   = compStream(generator.streamOutBigNum_  .ref());
-
         MemoryStreamOut<ByteArray> streamOut;
-        writeContainer(streamOut, bufText);
-        writeContainer(streamOut, bufSmallNum);
-        writeContainer(streamOut, bufBigNum);
+        writeCompressedStreams(streamOut, //throw FileError
+        {
+            generator.streamOutText_    .ref(),
+            generator.streamOutSmallNum_.ref(),
+            generator.streamOutBigNum_  .ref()
+        }, displayFilePathL, displayFilePathR);
 
         const ByteArray& buf = streamOut.ref();
 
@@ -244,6 +591,7 @@ private:
 
             writeFileDescr(streamOutBigNum_, dbFile.second.left);
             writeFileDescr(streamOutBigNum_, dbFile.second.right);
+            writeContainer(streamOutBigNum_, dbFile.second.contentDigest);
         }
 
         writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.symlinks.size()));
@@ -320,8 +668,10 @@ public:
             if (streamVersion != streamVersionR)
                 throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(displayFilePathL) + L"\n" + fmtPath(displayFilePathR), L"Different stream formats");
 
-            //TODO: remove migration code at some time! 2017-02-01
+            //TODO: remove migration code at some time! 2017-02-01 + 2026-10-18
             if (streamVersion != 2 &&
+                streamVersion != 3 &&
+                streamVersion != 4 &&
                 streamVersion != DB_FORMAT_STREAM)
                 throw FileError(replaceCpy(_("Database file %x is incompatible."), L"%x", fmtPath(displayFilePathL)), L"Unknown stream format");
 
@@ -372,15 +722,22 @@ public:
                 if (sizePart2 > 0) readArray(streamInPart2, &*buf.begin() + sizePart1, sizePart2); //
 
                 MemoryStreamIn<ByteArray> streamIn(buf);
-                const ByteArray bufText     = readContainer<ByteArray>(streamIn); //
-                const ByteArray bufSmallNum = readContainer<ByteArray>(streamIn); //throw UnexpectedEndOfStreamError
-                const ByteArray bufBigNum   = readContainer<ByteArray>(streamIn); //
+                std::vector<ByteArray> streams;
+
+                //TODO: remove migration code at some time! 2026-10-18
+                if (streamVersion < 5)
+                {
+                    const ByteArray bufText     = readContainer<ByteArray>(streamIn); //
+                    const ByteArray bufSmallNum = readContainer<ByteArray>(streamIn); //throw UnexpectedEndOfStreamError
+                    const ByteArray bufBigNum   = readContainer<ByteArray>(streamIn); //
+
+                    streams = { decompStream(bufText), decompStream(bufSmallNum), decompStream(bufBigNum) }; //throw FileError
+                }
+                else
+                    streams = readCompressedStreams(streamIn, 3, displayFilePathL, displayFilePathR); //throw FileError, UnexpectedEndOfStreamError, bad_alloc
 
                 auto output = std::make_shared<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
-                StreamParser parser(streamVersion,
-                                    decompStream(bufText),
-                                    decompStream(bufSmallNum),
-                                    decompStream(bufBigNum)); //throw FileError
+                StreamParser parser(streamVersion, streams[0], streams[1], streams[2]);
                 if (leadStreamLeft)
                     parser.recurse<LEFT_SIDE>(*output); //throw UnexpectedEndOfStreamError
                 else
@@ -404,10 +761,7 @@ private:
         streamVersion_(streamVersion),
         streamInText_(bufText),
         streamInSmallNum_(bufSmallNumbers),
-        streamInBigNum_(bufBigNumbers)
-    {
-        (void)streamVersion_; //clang: -Wunused-private-field
-    }
+        streamInBigNum_(bufBigNumbers) {}
 
     template <SelectedSide leadSide>
     void recurse(InSyncFolder& container) //throw UnexpectedEndOfStreamError
@@ -422,9 +776,14 @@ private:
             const InSyncDescrFile dataL = readFileDescr(streamInBigNum_);
             const InSyncDescrFile dataT = readFileDescr(streamInBigNum_);
 
+            ContentDigest contentDigest;
+            //TODO: remove migration code at some time! 2026-10-18
+            if (streamVersion_ >= 4)
+                contentDigest = readContainer<ContentDigest>(streamInBigNum_);
+
             container.addFile(itemName,
                               SelectParam<leadSide>::ref(dataL, dataT),
-                              SelectParam<leadSide>::ref(dataT, dataL), cmpVar, fileSize);
+                              SelectParam<leadSide>::ref(dataT, dataL), cmpVar, fileSize, contentDigest);
         }
 
         size_t linkCount = readNumber<uint32_t>(streamInSmallNum_);
@@ -492,7 +851,7 @@ private:
                 const uint64_t fileSize = readNumber<uint64_t>(inputBoth_);
                 const InSyncDescrFile dataL = readFileDescr(inputLeft_);
                 const InSyncDescrFile dataR = readFileDescr(inputRight_);
-                container.addFile(itemName, dataL, dataR, cmpVar, fileSize);
+                container.addFile(itemName, dataL, dataR, cmpVar, fileSize, ContentDigest());
             }
 
             size_t linkCount = readNumber<uint32_t>(inputBoth_);
@@ -530,6 +889,218 @@ private:
 
 //#######################################################################################################################################
 
+/*
+journal: per-item changes of the last synchronous state as found by LastSynchronousStateUpdater
+    - item paths relative to the base folder (FILE_NAME_SEPARATOR: database files are platform-specific anyway)
+    - item data in order "lead side, other side" like the snapshot streams
+*/
+enum JournalOperation //stored in database file: don't change!
+{
+    JOURNAL_SET_FILE       = 0,
+    JOURNAL_SET_SYMLINK    = 1,
+    JOURNAL_SET_FOLDER     = 2, //create or update status only: keep child items
+    JOURNAL_REMOVE_FILE    = 3,
+    JOURNAL_REMOVE_SYMLINK = 4,
+    JOURNAL_REMOVE_FOLDER  = 5,
+};
+
+
+class JournalWriter
+{
+public:
+    explicit JournalWriter(bool leadStreamLeft) : leadStreamLeft_(leadStreamLeft) {}
+
+    void setFile(const Zstring& relPath, const InSyncFile& dbFile)
+    {
+        writeItem(JOURNAL_SET_FILE, relPath);
+        writeNumber<int32_t>(streamOut_, static_cast<int32_t>(dbFile.cmpVar));
+        writeNumber<uint64_t>(streamOut_, dbFile.fileSize);
+        writeFileDescr(leadStreamLeft_ ? dbFile.left  : dbFile.right);
+        writeFileDescr(leadStreamLeft_ ? dbFile.right : dbFile.left);
+        writeContainer(streamOut_, dbFile.contentDigest);
+    }
+
+    void setSymlink(const Zstring& relPath, const InSyncSymlink& dbSymlink)
+    {
+        writeItem(JOURNAL_SET_SYMLINK, relPath);
+        writeNumber<int32_t>(streamOut_, static_cast<int32_t>(dbSymlink.cmpVar));
+        writeNumber<int64_t>(streamOut_, (leadStreamLeft_ ? dbSymlink.left  : dbSymlink.right).modTime);
+        writeNumber<int64_t>(streamOut_, (leadStreamLeft_ ? dbSymlink.right : dbSymlink.left ).modTime);
+    }
+
+    void setFolder(const Zstring& relPath, InSyncFolder::InSyncStatus status)
+    {
+        writeItem(JOURNAL_SET_FOLDER, relPath);
+        writeNumber<int32_t>(streamOut_, status);
+    }
+
+    void removeFile   (const Zstring& relPath) { writeItem(JOURNAL_REMOVE_FILE,    relPath); }
+    void removeSymlink(const Zstring& relPath) { writeItem(JOURNAL_REMOVE_SYMLINK, relPath); }
+    void removeFolder (const Zstring& relPath) { writeItem(JOURNAL_REMOVE_FOLDER,  relPath); }
+
+    bool empty() const { return streamOut_.ref().empty(); }
+
+    ByteArray getChanges(const std::wstring& displayFilePathL, const std::wstring& displayFilePathR) const //throw FileError
+    {
+        try
+        {
+            return compress(streamOut_.ref(), 3); //throw ZlibInternalError
+        }
+        catch (ZlibInternalError&)
+        {
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"zlib internal error");
+        }
+    }
+
+private:
+    void writeItem(JournalOperation op, const Zstring& relPath)
+    {
+        writeNumber<int8_t>(streamOut_, static_cast<int8_t>(op));
+        writeContainer(streamOut_, utfTo<Zbase<char>>(relPath));
+    }
+
+    void writeFileDescr(const InSyncDescrFile& descr)
+    {
+        writeNumber<int64_t>(streamOut_, descr.modTime);
+        writeContainer(streamOut_, descr.fileId);
+    }
+
+    const bool leadStreamLeft_;
+    MemoryStreamOut<ByteArray> streamOut_;
+};
+
+
+class JournalParser
+{
+public:
+    static void execute(InSyncFolder& dbFolder, //throw FileError
+                        bool leadStreamLeft,
+                        const std::vector<JournalRecord>& journal,
+                        size_t recordCount, //apply first records only
+                        const std::wstring& displayFilePathL, //used for diagnostics only
+                        const std::wstring& displayFilePathR)
+    {
+        JournalParser parser(dbFolder, leadStreamLeft, displayFilePathL, displayFilePathR);
+        try
+        {
+            for (size_t i = 0; i < recordCount; ++i)
+            {
+                const ByteArray changes = decompress(journal[i].changes); //throw ZlibInternalError
+                MemoryStreamIn<ByteArray> streamIn(changes);
+
+                while (streamIn.pos() < changes.size())
+                    parser.applyChange(streamIn); //throw FileError, UnexpectedEndOfStreamError
+            }
+        }
+        catch (ZlibInternalError&)
+        {
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), L"Zlib internal error");
+        }
+        catch (UnexpectedEndOfStreamError&)
+        {
+            parser.throwCorrupted(L"Unexpected end of journal record.");
+        }
+    }
+
+private:
+    JournalParser(InSyncFolder& dbFolder, bool leadStreamLeft, const std::wstring& displayFilePathL, const std::wstring& displayFilePathR) :
+        dbFolder_(dbFolder), leadStreamLeft_(leadStreamLeft), displayFilePathL_(displayFilePathL), displayFilePathR_(displayFilePathR) {}
+
+    void applyChange(MemoryStreamIn<ByteArray>& streamIn) //throw FileError, UnexpectedEndOfStreamError
+    {
+        const auto op = static_cast<JournalOperation>(readNumber<int8_t>(streamIn));
+        const Zstring relPath = utfTo<Zstring>(readContainer<Zbase<char>>(streamIn));
+
+        std::vector<Zstring> itemNames = split(relPath, FILE_NAME_SEPARATOR, SplitType::SKIP_EMPTY);
+        if (itemNames.empty())
+            throwCorrupted(L"Invalid item path.");
+
+        const Zstring itemName = itemNames.back();
+        itemNames.pop_back();
+
+        InSyncFolder* parentFolder = &dbFolder_;
+        for (const Zstring& folderName : itemNames)
+        {
+            auto it = parentFolder->folders.find(folderName);
+            if (it == parentFolder->folders.end())
+                throwCorrupted(L"Parent folder missing: " + utfTo<std::wstring>(relPath));
+            parentFolder = &it->second;
+        }
+
+        switch (op)
+        {
+            case JOURNAL_SET_FILE:
+            {
+                const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn));
+                const uint64_t fileSize = readNumber<uint64_t>(streamIn);
+                const InSyncDescrFile dataL = readFileDescr(streamIn);
+                const InSyncDescrFile dataT = readFileDescr(streamIn);
+                const ContentDigest contentDigest = readContainer<ContentDigest>(streamIn);
+
+                const InSyncFile dbFile(leadStreamLeft_ ? dataL : dataT,
+                                        leadStreamLeft_ ? dataT : dataL, cmpVar, fileSize, contentDigest);
+                auto rv = parentFolder->files.emplace(itemName, dbFile);
+                if (!rv.second)
+                    rv.first->second = dbFile;
+            }
+            break;
+
+            case JOURNAL_SET_SYMLINK:
+            {
+                const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn));
+                const InSyncDescrLink dataL(readNumber<int64_t>(streamIn));
+                const InSyncDescrLink dataT(readNumber<int64_t>(streamIn));
+
+                const InSyncSymlink dbSymlink(leadStreamLeft_ ? dataL : dataT,
+                                              leadStreamLeft_ ? dataT : dataL, cmpVar);
+                auto rv = parentFolder->symlinks.emplace(itemName, dbSymlink);
+                if (!rv.second)
+                    rv.first->second = dbSymlink;
+            }
+            break;
+
+            case JOURNAL_SET_FOLDER:
+            {
+                const auto status = static_cast<InSyncFolder::InSyncStatus>(readNumber<int32_t>(streamIn));
+                parentFolder->addFolder(itemName, status).status = status; //get or create
+            }
+            break;
+
+            case JOURNAL_REMOVE_FILE:
+                parentFolder->files.erase(itemName);
+                break;
+            case JOURNAL_REMOVE_SYMLINK:
+                parentFolder->symlinks.erase(itemName);
+                break;
+            case JOURNAL_REMOVE_FOLDER:
+                parentFolder->folders.erase(itemName);
+                break;
+
+            default:
+                throwCorrupted(L"Unknown journal operation.");
+        }
+    }
+
+    static InSyncDescrFile readFileDescr(MemoryStreamIn<ByteArray>& streamIn) //throw UnexpectedEndOfStreamError
+    {
+        const auto modTime = readNumber<int64_t>(streamIn); //throw UnexpectedEndOfStreamError
+        const AFS::FileId fileId = readContainer<Zbase<char>>(streamIn);
+        return InSyncDescrFile(modTime, fileId);
+    }
+
+    [[noreturn]] void throwCorrupted(const std::wstring& details) const
+    {
+        throw FileError(_("Database file is corrupted:") + L"\n" + fmtPath(displayFilePathL_) + L"\n" + fmtPath(displayFilePathR_), details);
+    }
+
+    InSyncFolder& dbFolder_;
+    const bool leadStreamLeft_;
+    const std::wstring displayFilePathL_;
+    const std::wstring displayFilePathR_;
+};
+
+//#######################################################################################################################################
+
 class LastSynchronousStateUpdater
 {
     /*
@@ -539,16 +1110,17 @@ class LastSynchronousStateUpdater
         => update all database entries!
     */
 public:
-    static void execute(const BaseFolderPair& baseFolder, InSyncFolder& dbFolder)
+    static void execute(const BaseFolderPair& baseFolder, InSyncFolder& dbFolder, JournalWriter* journal) //journal: optional, records all changes to "dbFolder"
     {
-        LastSynchronousStateUpdater updater(baseFolder.getCompVariant(), baseFolder.getFilter());
+        LastSynchronousStateUpdater updater(baseFolder.getCompVariant(), baseFolder.getFilter(), journal);
         updater.recurse(baseFolder, dbFolder);
     }
 
 private:
-    LastSynchronousStateUpdater(CompareVariant activeCmpVar, const HardFilter& filter) :
+    LastSynchronousStateUpdater(CompareVariant activeCmpVar, const HardFilter& filter, JournalWriter* journal) :
         filter_(filter),
-        activeCmpVar_(activeCmpVar) {}
+        activeCmpVar_(activeCmpVar),
+        journal_(journal) {}
 
     void recurse(const ContainerObject& hierObj, InSyncFolder& dbFolder)
     {
@@ -558,15 +1130,32 @@ private:
     }
 
     template <class M, class V>
-    static V& mapAddOrUpdate(M& map, const Zstring& key, V&& value)
+    static V& mapAddOrUpdate(M& map, const Zstring& key, V&& value, bool& changed)
     {
         auto rv = map.emplace(key, value); //C++11 emplace will move r-value arguments => don't use std::forward!
         if (rv.second)
+        {
+            changed = true;
             return rv.first->second;
-
+        }
+        changed = !equalEntry(rv.first->second, value);
         return rv.first->second = std::forward<V>(value);
     }
 
+    static bool equalEntry(const InSyncDescrFile& lhs, const InSyncDescrFile& rhs) { return lhs.modTime == rhs.modTime && lhs.fileId == rhs.fileId; }
+    static bool equalEntry(const InSyncDescrLink& lhs, const InSyncDescrLink& rhs) { return lhs.modTime == rhs.modTime; }
+
+    static bool equalEntry(const InSyncFile& lhs, const InSyncFile& rhs)
+    {
+        return equalEntry(lhs.left, rhs.left) && equalEntry(lhs.right, rhs.right) &&
+               lhs.cmpVar == rhs.cmpVar && lhs.fileSize == rhs.fileSize && lhs.contentDigest == rhs.contentDigest;
+    }
+
+    static bool equalEntry(const InSyncSymlink& lhs, const InSyncSymlink& rhs)
+    {
+        return equalEntry(lhs.left, rhs.left) && equalEntry(lhs.right, rhs.right) && lhs.cmpVar == rhs.cmpVar;
+    }
+
     void process(const ContainerObject::FileList& currentFiles, const Zstring& parentRelPath, InSyncFolder::FileList& dbFiles)
     {
         std::unordered_set<const InSyncFile*> toPreserve; //referencing fixed-in-memory std::map elements
@@ -583,13 +1172,17 @@ private:
                     assert(file.getFileSize<LEFT_SIDE>() == file.getFileSize<RIGHT_SIDE>());
 
                     //create or update new "in-sync" state
+                    bool changed = false;
                     InSyncFile& dbFile = mapAddOrUpdate(dbFiles, file.getPairItemName(),
                                                         InSyncFile(InSyncDescrFile(file.getLastWriteTime< LEFT_SIDE>(),
                                                                                    file.getFileId       < LEFT_SIDE>()),
                                                                    InSyncDescrFile(file.getLastWriteTime<RIGHT_SIDE>(),
                                                                                    file.getFileId       <RIGHT_SIDE>()),
                                                                    activeCmpVar_,
-                                                                   file.getFileSize<LEFT_SIDE>()));
+                                                                   file.getFileSize<LEFT_SIDE>(),
+                                                                   file.getContentDigest()), changed);
+                    if (changed && journal_)
+                        journal_->setFile(AFS::appendPaths(parentRelPath, file.getPairItemName(), FILE_NAME_SEPARATOR), dbFile);
                     toPreserve.insert(&dbFile);
                 }
                 else //not in sync: preserve last synchronous state
@@ -607,8 +1200,11 @@ private:
                 return false;
             //all items not existing in "currentFiles" have either been deleted meanwhile or been excluded via filter:
             const Zstring& itemRelPath = AFS::appendPaths(parentRelPath, v.first, FILE_NAME_SEPARATOR);
-            return filter_.passFileFilter(itemRelPath);
+            const bool passFilter = filter_.passFileFilter(itemRelPath);
             //note: items subject to traveral errors are also excluded by this file filter here! see comparison.cpp, modified file filter for read errors
+            if (passFilter && journal_)
+                journal_->removeFile(itemRelPath);
+            return passFilter;
         });
     }
 
@@ -624,10 +1220,13 @@ private:
                     assert(symlink.getItemName<LEFT_SIDE>() == symlink.getItemName<RIGHT_SIDE>());
 
                     //create or update new "in-sync" state
+                    bool changed = false;
                     InSyncSymlink& dbSymlink = mapAddOrUpdate(dbSymlinks, symlink.getPairItemName(),
                                                               InSyncSymlink(InSyncDescrLink(symlink.getLastWriteTime<LEFT_SIDE>()),
                                                                             InSyncDescrLink(symlink.getLastWriteTime<RIGHT_SIDE>()),
-                                                                            activeCmpVar_));
+                                                                            activeCmpVar_), changed);
+                    if (changed && journal_)
+                        journal_->setSymlink(AFS::appendPaths(parentRelPath, symlink.getPairItemName(), FILE_NAME_SEPARATOR), dbSymlink);
                     toPreserve.insert(&dbSymlink);
                 }
                 else //not in sync: preserve last synchronous state
@@ -645,7 +1244,10 @@ private:
                 return false;
             //all items not existing in "currentSymlinks" have either been deleted meanwhile or been excluded via filter:
             const Zstring& itemRelPath = AFS::appendPaths(parentRelPath, v.first, FILE_NAME_SEPARATOR);
-            return filter_.passFileFilter(itemRelPath);
+            const bool passFilter = filter_.passFileFilter(itemRelPath);
+            if (passFilter && journal_)
+                journal_->removeSymlink(itemRelPath);
+            return passFilter;
         });
     }
 
@@ -667,6 +1269,8 @@ private:
                         auto it = insertResult.first;
 
                         InSyncFolder& dbFolder = it->second;
+                        if ((insertResult.second || dbFolder.status != InSyncFolder::DIR_STATUS_IN_SYNC) && journal_)
+                            journal_->setFolder(AFS::appendPaths(parentRelPath, key, FILE_NAME_SEPARATOR), InSyncFolder::DIR_STATUS_IN_SYNC);
                         dbFolder.status = InSyncFolder::DIR_STATUS_IN_SYNC; //update immediate directory entry
                         toPreserve.insert(&dbFolder);
                         recurse(folder, dbFolder);
@@ -680,7 +1284,11 @@ private:
                         //Example: directories on left and right differ in case while sub-files are equal
                     {
                         //reuse last "in-sync" if available or insert strawman entry (do not try to update and thereby remove child elements!!!)
-                        InSyncFolder& dbFolder = dbFolders.emplace(folder.getPairItemName(), InSyncFolder(InSyncFolder::DIR_STATUS_STRAW_MAN)).first->second;
+                        auto insertResult = dbFolders.emplace(folder.getPairItemName(), InSyncFolder(InSyncFolder::DIR_STATUS_STRAW_MAN));
+                        if (insertResult.second && journal_)
+                            journal_->setFolder(AFS::appendPaths(parentRelPath, folder.getPairItemName(), FILE_NAME_SEPARATOR), InSyncFolder::DIR_STATUS_STRAW_MAN);
+
+                        InSyncFolder& dbFolder = insertResult.first->second;
                         toPreserve.insert(&dbFolder);
                         recurse(folder, dbFolder); //unconditional recursion without filter check! => no problem since "childItemMightMatch" is optional!!!
                     }
@@ -714,6 +1322,8 @@ private:
             const bool passFilter = filter_.passDirFilter(itemRelPath, &childItemMightMatch);
             if (!passFilter && childItemMightMatch)
                 dbSetEmptyState(v.second, appendSeparator(itemRelPath)); //child items might match, e.g. *.txt include filter!
+            if (passFilter && journal_)
+                journal_->removeFolder(itemRelPath);
             return passFilter;
         });
     }
@@ -721,8 +1331,20 @@ private:
     //delete all entries for removed folder (= "in-sync") from database
     void dbSetEmptyState(InSyncFolder& dbFolder, const Zstring& parentRelPathPf)
     {
-        erase_if(dbFolder.files,    [&](const InSyncFolder::FileList   ::value_type& v) { return filter_.passFileFilter(parentRelPathPf + v.first); });
-        erase_if(dbFolder.symlinks, [&](const InSyncFolder::SymlinkList::value_type& v) { return filter_.passFileFilter(parentRelPathPf + v.first); });
+        erase_if(dbFolder.files, [&](const InSyncFolder::FileList::value_type& v)
+        {
+            const bool passFilter = filter_.passFileFilter(parentRelPathPf + v.first);
+            if (passFilter && journal_)
+                journal_->removeFile(parentRelPathPf + v.first);
+            return passFilter;
+        });
+        erase_if(dbFolder.symlinks, [&](const InSyncFolder::SymlinkList::value_type& v)
+        {
+            const bool passFilter = filter_.passFileFilter(parentRelPathPf + v.first);
+            if (passFilter && journal_)
+                journal_->removeSymlink(parentRelPathPf + v.first);
+            return passFilter;
+        });
 
         erase_if(dbFolder.folders, [&](InSyncFolder::FolderList::value_type& v)
         {
@@ -732,12 +1354,15 @@ private:
             const bool passFilter = filter_.passDirFilter(itemRelPath, &childItemMightMatch);
             if (!passFilter && childItemMightMatch)
                 dbSetEmptyState(v.second, appendSeparator(itemRelPath));
+            if (passFilter && journal_)
+                journal_->removeFolder(itemRelPath);
             return passFilter;
         });
     }
 
     const HardFilter& filter_; //filter used while scanning directory: generates view on actual files!
     const CompareVariant activeCmpVar_;
+    JournalWriter* const journal_; //optional
 };
 
 
@@ -792,144 +1417,398 @@ std::pair<DbStreams::const_iterator,
 
     return std::make_pair(itCommonL, itCommonR);
 }
+
+
+//journal records found in both database files: the last record may be missing in one of them if appending was interrupted
+size_t getCommonJournalSize(const SessionData& sessionL, const SessionData& sessionR)
+{
+    size_t i = 0;
+    while (i < sessionL.journal.size() &&
+           i < sessionR.journal.size() && sessionL.journal[i] == sessionR.journal[i])
+        ++i;
+    return i;
+}
+
+
+//identifies the content of a session including its journal
+UniqueId getStateID(const std::pair<DbStreams::const_iterator, DbStreams::const_iterator>& commonSession)
+{
+    const size_t journalSize = getCommonJournalSize(commonSession.first->second, commonSession.second->second);
+    return journalSize == 0 ? commonSession.first->first : commonSession.first->second.journal[journalSize - 1].recordID;
+}
+
+
+std::shared_ptr<InSyncFolder> parseSession(const std::pair<DbStreams::const_iterator, DbStreams::const_iterator>& commonSession, //throw FileError
+                                           const std::wstring& displayFilePathL, //used for diagnostics only
+                                           const std::wstring& displayFilePathR)
+{
+    const SessionData& sessionL = commonSession.first ->second;
+    const SessionData& sessionR = commonSession.second->second;
+    assert(sessionL.isLeadStream != sessionR.isLeadStream);
+
+    std::shared_ptr<InSyncFolder> syncState = StreamParser::execute(sessionL.isLeadStream, sessionL.rawStream, sessionR.rawStream, //throw FileError
+                                                                    displayFilePathL, displayFilePathR);
+
+    JournalParser::execute(*syncState, sessionL.isLeadStream, sessionL.journal, getCommonJournalSize(sessionL, sessionR), //throw FileError
+                           displayFilePathL, displayFilePathR);
+    return syncState;
+}
 }
 
 //#######################################################################################################################################
 
-std::shared_ptr<InSyncFolder> zen::loadLastSynchronousState(const BaseFolderPair& baseFolder, //throw FileError, FileErrorDatabaseNotExisting -> return value always bound!
-                                                            const std::function<void(const std::wstring& statusMsg)>& notifyStatus)
+namespace zen
+{
+struct DatabaseSession
+{
+    Zstring dbFilePathL; //native paths only
+    Zstring dbFilePathR; //
+    FileSignature signatureL; //taken *before* loading: files changed while loading won't match
+    FileSignature signatureR; //
+    std::shared_ptr<const DbFile> dbFileL; //all sessions
+    std::shared_ptr<const DbFile> dbFileR; //
+    UniqueId sessionID; //common session of the folder pair
+    std::shared_ptr<const InSyncFolder> lastSyncState; //parsed from the common session's streams and journal
+};
+}
+
+
+namespace
+{
+//nullptr if there is no session or it is outdated: database files changed on disk in the meantime
+std::shared_ptr<DatabaseSession> getCurrentSession(const BaseFolderPair& baseFolder, const AbstractPath& dbPathLeft, const AbstractPath& dbPathRight)
 {
-    const AbstractPath dbPathLeft  = getDatabaseFilePath< LEFT_SIDE>(baseFolder);
-    const AbstractPath dbPathRight = getDatabaseFilePath<RIGHT_SIDE>(baseFolder);
+    if (const std::shared_ptr<DatabaseSession>& session = baseFolder.getDatabaseSession())
+    {
+        const Opt<Zstring> dbFilePathL = AFS::getNativeItemPath(dbPathLeft);
+        const Opt<Zstring> dbFilePathR = AFS::getNativeItemPath(dbPathRight);
+
+        if (dbFilePathL && equalFilePath(*dbFilePathL, session->dbFilePathL) &&
+            dbFilePathR && equalFilePath(*dbFilePathR, session->dbFilePathR))
+            try
+            {
+                if (getFileSignature(*dbFilePathL) == session->signatureL && //throw FileError
+                    getFileSignature(*dbFilePathR) == session->signatureR)   //
+                    return session;
+            }
+            catch (FileError&) {} //e.g. database file deleted
+    }
+    return nullptr;
+}
+}
+
+//#######################################################################################################################################
 
+std::shared_ptr<const InSyncFolder> zen::loadLastSynchronousState(BaseFolderPair& baseFolder, //throw FileError, FileErrorDatabaseNotExisting -> return value always bound!
+                                                                  const std::function<void(const std::wstring& statusMsg)>& notifyStatus)
+{
     if (!baseFolder.isAvailable< LEFT_SIDE>() ||
         !baseFolder.isAvailable<RIGHT_SIDE>())
     {
         //avoid race condition with directory existence check: reading sync.ffs_db may succeed although first dir check had failed => conflicts!
         //https://sourceforge.net/tracker/?func=detail&atid=1093080&aid=3531351&group_id=234430
-        const AbstractPath filePath = !baseFolder.isAvailable<LEFT_SIDE>() ? dbPathLeft : dbPathRight;
+        const AbstractPath filePath = getDatabaseFilePath(!baseFolder.isAvailable<LEFT_SIDE>() ? baseFolder.getAbstractPath<LEFT_SIDE>() : baseFolder.getAbstractPath<RIGHT_SIDE>());
         throw FileErrorDatabaseNotExisting(_("Initial synchronization:") + L" \n" + //it could be due to a to-be-created target directory not yet existing => FileErrorDatabaseNotExisting
                                            replaceCpy(_("Database file %x does not yet exist."), L"%x", fmtPath(AFS::getDisplayPath(filePath))));
     }
 
+    if (std::shared_ptr<DatabaseSession> session = getCurrentSession(baseFolder, getDatabaseFilePath(baseFolder.getAbstractPath< LEFT_SIDE>()),
+                                                                                 getDatabaseFilePath(baseFolder.getAbstractPath<RIGHT_SIDE>())))
+        return session->lastSyncState;
+
+    baseFolder.setDatabaseSession(nullptr); //outdated
+
+    std::shared_ptr<DatabaseSession> session;
+    std::shared_ptr<const InSyncFolder> syncState = loadLastSynchronousState(baseFolder.getAbstractPath< LEFT_SIDE>(), //throw FileError, FileErrorDatabaseNotExisting
+                                                                             baseFolder.getAbstractPath<RIGHT_SIDE>(), notifyStatus, &session);
+    baseFolder.setDatabaseSession(session);
+    return syncState;
+}
+
+
+std::shared_ptr<const InSyncFolder> zen::loadLastSynchronousState(const AbstractPath& folderPathLeft, const AbstractPath& folderPathRight, //throw FileError, FileErrorDatabaseNotExisting
+                                                                  const std::function<void(const std::wstring& statusMsg)>& notifyStatus,
+                                                                  std::shared_ptr<DatabaseSession>* session)
+{
+    IoOperationTimer dummy(IoOperation::DATABASE_LOAD);
+
+    if (session)
+        *session = nullptr;
+
+    const AbstractPath dbPathLeft  = getDatabaseFilePath(folderPathLeft);
+    const AbstractPath dbPathRight = getDatabaseFilePath(folderPathRight);
+
+    const Opt<Zstring> dbFilePathL = AFS::getNativeItemPath(dbPathLeft);
+    const Opt<Zstring> dbFilePathR = AFS::getNativeItemPath(dbPathRight);
+
+    Opt<FileSignature> signatureL;
+    Opt<FileSignature> signatureR;
+    if (session && dbFilePathL && dbFilePathR)
+        try
+        {
+            signatureL = getFileSignature(*dbFilePathL); //throw FileError
+            signatureR = getFileSignature(*dbFilePathR); //
+        }
+        catch (FileError&) {} //e.g. not existing: let loadStreams() report the details
+
     StreamStatusNotifier notifyLoadL(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathLeft) )), notifyStatus);
     StreamStatusNotifier notifyLoadR(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathRight))), notifyStatus);
 
     //read file data: list of session ID + DirInfo-stream
-    const DbStreams streamsLeft  = ::loadStreams(dbPathLeft,  notifyLoadL); //throw FileError, FileErrorDatabaseNotExisting, X
-    const DbStreams streamsRight = ::loadStreams(dbPathRight, notifyLoadR); //
+    const std::shared_ptr<const DbFile> dbFileLeft  = loadStreamsCached(dbPathLeft,  notifyLoadL); //throw FileError, FileErrorDatabaseNotExisting, X
+    const std::shared_ptr<const DbFile> dbFileRight = loadStreamsCached(dbPathRight, notifyLoadR); //
 
     //find associated session: there can be at most one session within intersection of left and right ids
     std::pair<DbStreams::const_iterator,
-        DbStreams::const_iterator> session = getCommonSession(streamsLeft, streamsRight, //throw FileError, FileErrorDatabaseNotExisting
-                                                              AFS::getDisplayPath(dbPathLeft),
-                                                              AFS::getDisplayPath(dbPathRight));
+        DbStreams::const_iterator> commonSession = getCommonSession(dbFileLeft->streams, dbFileRight->streams, //throw FileError, FileErrorDatabaseNotExisting
+                                                                    AFS::getDisplayPath(dbPathLeft),
+                                                                    AFS::getDisplayPath(dbPathRight));
+    const UniqueId stateID = getStateID(commonSession);
 
-    const bool leadStreamLeft = session.first->second.isLeadStream;
-    assert(session.first->second.isLeadStream != session.second->second.isLeadStream);
-    const ByteArray& streamL = session.first ->second.rawStream;
-    const ByteArray& streamR = session.second->second.rawStream;
+    std::shared_ptr<DatabaseCache> cache = globalDatabaseCache.get();
 
-    return StreamParser::execute(leadStreamLeft, streamL, streamR, //throw FileError
-                                 AFS::getDisplayPath(dbPathLeft),
-                                 AFS::getDisplayPath(dbPathRight));
+    std::shared_ptr<const InSyncFolder> syncState;
+    if (cache && dbFilePathL && dbFilePathR)
+        syncState = cache->getSyncState(*dbFilePathL, *dbFilePathR, stateID);
+
+    if (!syncState)
+    {
+        syncState = parseSession(commonSession, AFS::getDisplayPath(dbPathLeft), AFS::getDisplayPath(dbPathRight)); //throw FileError
+
+        if (cache && dbFilePathL && dbFilePathR)
+            cache->setSyncState(*dbFilePathL, *dbFilePathR, stateID, syncState);
+    }
+
+    if (session && signatureL && signatureR)
+    {
+        auto newSession = std::make_shared<DatabaseSession>();
+        newSession->dbFilePathL   = *dbFilePathL;
+        newSession->dbFilePathR   = *dbFilePathR;
+        newSession->signatureL    = *signatureL;
+        newSession->signatureR    = *signatureR;
+        newSession->dbFileL       = dbFileLeft;
+        newSession->dbFileR       = dbFileRight;
+        newSession->sessionID     = commonSession.first->first;
+        newSession->lastSyncState = syncState;
+        *session = newSession;
+    }
+    return syncState;
 }
 
 
-void zen::saveLastSynchronousState(const BaseFolderPair& baseFolder, const std::function<void(const std::wstring& statusMsg)>& notifyStatus) //throw FileError
+void zen::saveLastSynchronousState(BaseFolderPair& baseFolder, const std::function<void(const std::wstring& statusMsg)>& notifyStatus) //throw FileError
 {
+    IoOperationTimer dummy(IoOperation::DATABASE_SAVE);
+
     //transactional behaviour! write to tmp files first
-    const AbstractPath dbPathLeft  = getDatabaseFilePath< LEFT_SIDE>(baseFolder);
-    const AbstractPath dbPathRight = getDatabaseFilePath<RIGHT_SIDE>(baseFolder);
+    const AbstractPath dbPathLeft  = getDatabaseFilePath(baseFolder.getAbstractPath< LEFT_SIDE>());
+    const AbstractPath dbPathRight = getDatabaseFilePath(baseFolder.getAbstractPath<RIGHT_SIDE>());
 
-    const AbstractPath dbPathLeftTmp  = getDatabaseFilePath< LEFT_SIDE>(baseFolder, true /*tempfile*/);
-    const AbstractPath dbPathRightTmp = getDatabaseFilePath<RIGHT_SIDE>(baseFolder, true /*tempfile*/);
-
-    StreamStatusNotifier notifyLoadL(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathLeft) )), notifyStatus);
-    StreamStatusNotifier notifyLoadR(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathRight))), notifyStatus);
+    const AbstractPath dbPathLeftTmp  = getDatabaseFilePath(baseFolder.getAbstractPath< LEFT_SIDE>(), true /*tempfile*/);
+    const AbstractPath dbPathRightTmp = getDatabaseFilePath(baseFolder.getAbstractPath<RIGHT_SIDE>(), true /*tempfile*/);
 
     StreamStatusNotifier notifySaveL(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathLeft) )), notifyStatus);
     StreamStatusNotifier notifySaveR(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathRight))), notifyStatus);
 
-    //(try to) load old database files...
-    DbStreams streamsLeft; //list of session ID + DirInfo-stream
-    DbStreams streamsRight;
-
-    try { streamsLeft  = ::loadStreams(dbPathLeft, notifyLoadL); }
-    catch (FileError&) {}
-    try { streamsRight = ::loadStreams(dbPathRight, notifyLoadR); }
-    catch (FileError&) {}
-    //if error occurs: just overwrite old file! User is already informed about issues right after comparing!
+    std::shared_ptr<const DbFile> dbFileOldL; //list of session ID + DirInfo-stream
+    std::shared_ptr<const DbFile> dbFileOldR; //
+    Opt<UniqueId> sessionIdOld;
+    std::shared_ptr<InSyncFolder> lastSyncState; //nullptr: no (valid) old session => journal not applicable
 
-    std::shared_ptr<InSyncFolder> lastSyncState = std::make_shared<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
-    auto itStreamOldL = streamsLeft .cend();
-    auto itStreamOldR = streamsRight.cend();
-    try
+    //reuse database files loaded during comparison...
+    if (std::shared_ptr<DatabaseSession> session = getCurrentSession(baseFolder, dbPathLeft, dbPathRight))
     {
-        //find associated session: there can be at most one session within intersection of left and right ids
-        std::pair<DbStreams::const_iterator,
-            DbStreams::const_iterator> session = getCommonSession(streamsLeft, streamsRight, //throw FileError, FileErrorDatabaseNotExisting
-                                                                  AFS::getDisplayPath(dbPathLeft),
-                                                                  AFS::getDisplayPath(dbPathRight));
+        dbFileOldL   = session->dbFileL;
+        dbFileOldR   = session->dbFileR;
+        sessionIdOld = session->sessionID;
+        lastSyncState = std::make_shared<InSyncFolder>(*session->lastSyncState); //copy in memory: still way cheaper than loading and parsing the database files
+    }
+    else //...or (try to) load old database files
+    {
+        baseFolder.setDatabaseSession(nullptr); //outdated
+
+        StreamStatusNotifier notifyLoadL(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathLeft) )), notifyStatus);
+        StreamStatusNotifier notifyLoadR(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(dbPathRight))), notifyStatus);
 
-        itStreamOldL = session.first;
-        itStreamOldR = session.second;
-        const bool leadStreamLeft = itStreamOldL->second.isLeadStream;
+        try { dbFileOldL = loadStreamsCached(dbPathLeft, notifyLoadL); }
+        catch (FileError&) {}
+        try { dbFileOldR = loadStreamsCached(dbPathRight, notifyLoadR); }
+        catch (FileError&) {}
+        //if error occurs: just overwrite old file! User is already informed about issues right after comparing!
 
-        //load last synchrounous state
-        lastSyncState = StreamParser::execute(leadStreamLeft,
-                                              itStreamOldL->second.rawStream, //throw FileError
-                                              itStreamOldR->second.rawStream,
-                                              AFS::getDisplayPath(dbPathLeft),
-                                              AFS::getDisplayPath(dbPathRight));
+        if (dbFileOldL && dbFileOldR)
+            try
+            {
+                //find associated session: there can be at most one session within intersection of left and right ids
+                std::pair<DbStreams::const_iterator,
+                    DbStreams::const_iterator> commonSession = getCommonSession(dbFileOldL->streams, dbFileOldR->streams, //throw FileError, FileErrorDatabaseNotExisting
+                                                                                AFS::getDisplayPath(dbPathLeft),
+                                                                                AFS::getDisplayPath(dbPathRight));
+                sessionIdOld = commonSession.first->first;
+
+                //load last synchrounous state
+                lastSyncState = parseSession(commonSession, AFS::getDisplayPath(dbPathLeft), AFS::getDisplayPath(dbPathRight)); //throw FileError
+            }
+            catch (FileError&) {} //if error occurs: just overwrite old file! User is already informed about issues right after comparing!
     }
-    catch (FileError&) {} //if error occurs: just overwrite old file! User is already informed about issues right after comparing!
 
     //update last synchrounous state
-    LastSynchronousStateUpdater::execute(baseFolder, *lastSyncState);
-
-    //serialize again
-    SessionData sessionDataL = {};
-    SessionData sessionDataR = {};
-    sessionDataL.isLeadStream = true;
-    sessionDataR.isLeadStream = false;
-
-    StreamGenerator::execute(*lastSyncState, //throw FileError
-                             AFS::getDisplayPath(dbPathLeft),
-                             AFS::getDisplayPath(dbPathRight),
-                             sessionDataL.rawStream,
-                             sessionDataR.rawStream);
-
-    //check if there is some work to do at all
-    if (itStreamOldL != streamsLeft .end() && itStreamOldL->second == sessionDataL &&
-        itStreamOldR != streamsRight.end() && itStreamOldR->second == sessionDataR)
+    std::unique_ptr<JournalWriter> journal; //record changes relative to the old session
+    if (lastSyncState)
+        journal = std::make_unique<JournalWriter>(dbFileOldL->streams.find(*sessionIdOld)->second.isLeadStream);
+    else
+        lastSyncState = std::make_shared<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
+
+    LastSynchronousStateUpdater::execute(baseFolder, *lastSyncState, journal.get());
+
+    if (journal && journal->empty())
         return; //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
 
-    //erase old session data
-    if (itStreamOldL != streamsLeft.end())
-        streamsLeft.erase(itStreamOldL);
-    if (itStreamOldR != streamsRight.end())
-        streamsRight.erase(itStreamOldR);
-
-    //create new session data
-    const std::string sessionID = zen::generateGUID();
-
-    streamsLeft [sessionID] = std::move(sessionDataL);
-    streamsRight[sessionID] = std::move(sessionDataR);
-
-    //write (temp-) files as a transaction
-    saveStreams(streamsLeft,  dbPathLeftTmp,  notifySaveL); //throw FileError
-    auto guardTmpL = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathLeftTmp); } catch (FileError&) {} });
-    saveStreams(streamsRight, dbPathRightTmp, notifySaveR); //
-    auto guardTmpR = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathRightTmp); } catch (FileError&) {} });
-
-    //operation finished: rename temp files -> this should work (almost) transactionally:
-    //if there were no write access, creation of temp files would have failed
-    AFS::removeFileIfExists(dbPathLeft);          //throw FileError
-    AFS::renameItem(dbPathLeftTmp, dbPathLeft);   //throw FileError, (ErrorDifferentVolume)
-    guardTmpL.dismiss();
-
-    AFS::removeFileIfExists(dbPathRight);         //
-    AFS::renameItem(dbPathRightTmp, dbPathRight); //
-    guardTmpR.dismiss();
+    const Opt<Zstring> dbFilePathL = AFS::getNativeItemPath(dbPathLeft);
+    const Opt<Zstring> dbFilePathR = AFS::getNativeItemPath(dbPathRight);
+
+    //append changes to the journal if possible: no need to rewrite (and re-read) the full snapshot
+    Opt<JournalRecord> journalRecord;
+    if (journal && dbFilePathL && dbFilePathR && //appending requires truncation of torn records => native files only
+        dbFileOldL->version == DB_FORMAT_CONTAINER && //old formats: write a snapshot first
+        dbFileOldR->version == DB_FORMAT_CONTAINER)
+    {
+        const SessionData& sessionL = dbFileOldL->streams.find(*sessionIdOld)->second;
+        const SessionData& sessionR = dbFileOldR->streams.find(*sessionIdOld)->second;
+
+        const size_t journalSize = getCommonJournalSize(sessionL, sessionR);
+        if (journalSize == sessionL.journal.size() && //otherwise a previous append was interrupted => compact
+            journalSize == sessionR.journal.size())
+        {
+            JournalRecord record;
+            record.recordID = zen::generateGUID();
+            record.changes  = journal->getChanges(AFS::getDisplayPath(dbPathLeft), AFS::getDisplayPath(dbPathRight)); //throw FileError
+
+            uint64_t journalBytes = record.changes.size();
+            for (const JournalRecord& r : sessionL.journal)
+                journalBytes += r.changes.size();
+
+            //compact when replaying the journal becomes more expensive than reading a new snapshot
+            if (journalBytes <= DB_JOURNAL_SIZE_RATIO_MAX * (sessionL.rawStream.size() + sessionR.rawStream.size()))
+                journalRecord = std::move(record);
+        }
+    }
+
+    std::shared_ptr<const DbFile> dbFileNewL;
+    std::shared_ptr<const DbFile> dbFileNewR;
+    UniqueId sessionID;
+    UniqueId stateID;
+
+    if (journalRecord)
+    {
+        auto dbFileL = std::make_shared<DbFile>(*dbFileOldL);
+        auto dbFileR = std::make_shared<DbFile>(*dbFileOldR);
+
+        //no transaction needed: a record missing in either file is ignored when loading, and the next save will compact
+        dbFileL->validSize = appendJournalRecord(*dbFilePathL, dbFileOldL->validSize, *sessionIdOld, *journalRecord, notifySaveL); //throw FileError
+        dbFileR->validSize = appendJournalRecord(*dbFilePathR, dbFileOldR->validSize, *sessionIdOld, *journalRecord, notifySaveR); //
+
+        dbFileL->streams[*sessionIdOld].journal.push_back(*journalRecord);
+        dbFileR->streams[*sessionIdOld].journal.push_back(*journalRecord);
+
+        dbFileNewL = dbFileL;
+        dbFileNewR = dbFileR;
+        sessionID  = *sessionIdOld;
+        stateID    = journalRecord->recordID;
+    }
+    else //compact into a new snapshot
+    {
+        //serialize again
+        SessionData sessionDataL = {};
+        SessionData sessionDataR = {};
+        sessionDataL.isLeadStream = true;
+        sessionDataR.isLeadStream = false;
+
+        StreamGenerator::execute(*lastSyncState, //throw FileError
+                                 AFS::getDisplayPath(dbPathLeft),
+                                 AFS::getDisplayPath(dbPathRight),
+                                 sessionDataL.rawStream,
+                                 sessionDataR.rawStream);
+
+        auto dbFileL = std::make_shared<DbFile>();
+        auto dbFileR = std::make_shared<DbFile>();
+        if (dbFileOldL) dbFileL->streams = dbFileOldL->streams;
+        if (dbFileOldR) dbFileR->streams = dbFileOldR->streams;
+
+        //erase old session data
+        if (sessionIdOld)
+        {
+            dbFileL->streams.erase(*sessionIdOld);
+            dbFileR->streams.erase(*sessionIdOld);
+        }
+
+        //create new session data
+        sessionID = stateID = zen::generateGUID();
+
+        dbFileL->streams[sessionID] = std::move(sessionDataL);
+        dbFileR->streams[sessionID] = std::move(sessionDataR);
+
+        //write (temp-) files as a transaction
+        saveStreams(dbFileL->streams, dbPathLeftTmp,  notifySaveL); //throw FileError
+        auto guardTmpL = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathLeftTmp); } catch (FileError&) {} });
+        saveStreams(dbFileR->streams, dbPathRightTmp, notifySaveR); //
+        auto guardTmpR = makeGuard<ScopeGuardRunMode::ON_FAIL>([&] { try { AFS::removeFilePlain(dbPathRightTmp); } catch (FileError&) {} });
+
+        //operation finished: rename temp files -> this should work (almost) transactionally:
+        //if there were no write access, creation of temp files would have failed
+        AFS::removeFileIfExists(dbPathLeft);          //throw FileError
+        AFS::renameItem(dbPathLeftTmp, dbPathLeft);   //throw FileError, (ErrorDifferentVolume)
+        guardTmpL.dismiss();
+
+        AFS::removeFileIfExists(dbPathRight);         //
+        AFS::renameItem(dbPathRightTmp, dbPathRight); //
+        guardTmpR.dismiss();
+
+        if (dbFilePathL && dbFilePathR)
+        {
+            dbFileL->validSize = getFileSignature(*dbFilePathL).fileSize; //throw FileError
+            dbFileR->validSize = getFileSignature(*dbFilePathR).fileSize; //
+        }
+        dbFileNewL = dbFileL;
+        dbFileNewR = dbFileR;
+    }
+
+    //keep the new database files in memory: a repeated synchronization or the next comparison (daemon mode) won't need to load them
+    baseFolder.setDatabaseSession(nullptr);
+
+    if (dbFilePathL && dbFilePathR)
+        try
+        {
+            auto session = std::make_shared<DatabaseSession>();
+            session->dbFilePathL   = *dbFilePathL;
+            session->dbFilePathR   = *dbFilePathR;
+            session->signatureL    = getFileSignature(*dbFilePathL); //throw FileError
+            session->signatureR    = getFileSignature(*dbFilePathR); //
+            session->dbFileL       = dbFileNewL;
+            session->dbFileR       = dbFileNewR;
+            session->sessionID     = sessionID;
+            session->lastSyncState = lastSyncState;
+            baseFolder.setDatabaseSession(session);
+
+            if (std::shared_ptr<DatabaseCache> cache = globalDatabaseCache.get())
+            {
+                cache->setFile(*dbFilePathL, session->signatureL, session->dbFileL);
+                cache->setFile(*dbFilePathR, session->signatureR, session->dbFileR);
+                cache->setSyncState(*dbFilePathL, *dbFilePathR, stateID, lastSyncState);
+            }
+        }
+        catch (FileError&) {} //not critical: load from disk next time
+}
+
+
+SyncDatabaseCache::SyncDatabaseCache()
+{
+    assert(!globalDatabaseCache.get());
+    globalDatabaseCache.set(std::make_unique<DatabaseCache>());
+}
+
+
+SyncDatabaseCache::~SyncDatabaseCache()
+{
+    globalDatabaseCache.set(nullptr);
 }
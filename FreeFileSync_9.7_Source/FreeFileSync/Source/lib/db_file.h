@@ -36,11 +36,13 @@ struct InSyncDescrLink
 //artificial hierarchy of last synchronous state:
 struct InSyncFile
 {
-    InSyncFile(const InSyncDescrFile& l, const InSyncDescrFile& r, CompareVariant cv, uint64_t fileSizeIn) : left(l), right(r), cmpVar(cv), fileSize(fileSizeIn) {}
+    InSyncFile(const InSyncDescrFile& l, const InSyncDescrFile& r, CompareVariant cv, uint64_t fileSizeIn, const ContentDigest& digest) :
+        left(l), right(r), cmpVar(cv), fileSize(fileSizeIn), contentDigest(digest) {}
     InSyncDescrFile left;  //support flip()!
     InSyncDescrFile right; //
     CompareVariant cmpVar; //the one active while finding "file in sync"
     uint64_t fileSize; //file size must be identical on both sides!
+    ContentDigest contentDigest; //optional: content of both sides as described by left, right and fileSize
 };
 
 struct InSyncSymlink
@@ -80,9 +82,9 @@ struct InSyncFolder
         return folders.emplace(shortName, InSyncFolder(st)).first->second;
     }
 
-    void addFile(const Zstring& shortName, const InSyncDescrFile& dataL, const InSyncDescrFile& dataR, CompareVariant cmpVar, uint64_t fileSize)
+    void addFile(const Zstring& shortName, const InSyncDescrFile& dataL, const InSyncDescrFile& dataR, CompareVariant cmpVar, uint64_t fileSize, const ContentDigest& digest)
     {
-        files.emplace(shortName, InSyncFile(dataL, dataR, cmpVar, fileSize));
+        files.emplace(shortName, InSyncFile(dataL, dataR, cmpVar, fileSize, digest));
     }
 
     void addSymlink(const Zstring& shortName, const InSyncDescrLink& dataL, const InSyncDescrLink& dataR, CompareVariant cmpVar)
@@ -94,11 +96,36 @@ struct InSyncFolder
 
 DEFINE_NEW_FILE_ERROR(FileErrorDatabaseNotExisting);
 
-std::shared_ptr<InSyncFolder> loadLastSynchronousState(const BaseFolderPair& baseDirObj, //throw FileError, FileErrorDatabaseNotExisting -> return value always bound!
-                                                       const std::function<void(const std::wstring& statusMsg)>& notifyStatus);
+/*
+database session: the database files of a folder pair as loaded during comparison, attached to the BaseFolderPair
+    - keeps the parsed last synchronous state and the streams of all other sessions => saveLastSynchronousState() only needs to serialize
+    - native paths only: reused as long as size, modification time and file id of both database files are unchanged, otherwise the files are loaded again
+*/
+std::shared_ptr<const InSyncFolder> loadLastSynchronousState(BaseFolderPair& baseFolder, //throw FileError, FileErrorDatabaseNotExisting -> return value always bound!
+                                                             const std::function<void(const std::wstring& statusMsg)>& notifyStatus);
 
-void saveLastSynchronousState(const BaseFolderPair& baseDirObj, //throw FileError
+//before comparison: caller must ensure both base folders are existing!
+std::shared_ptr<const InSyncFolder> loadLastSynchronousState(const AbstractPath& folderPathLeft, const AbstractPath& folderPathRight, //throw FileError, FileErrorDatabaseNotExisting
+                                                             const std::function<void(const std::wstring& statusMsg)>& notifyStatus,
+                                                             std::shared_ptr<DatabaseSession>* session = nullptr); //optional out: attach to the BaseFolderPair created for these folders
+
+void saveLastSynchronousState(BaseFolderPair& baseFolder, //throw FileError
                               const std::function<void(const std::wstring& statusMsg)>& notifyStatus);
+
+
+//long-running processes (daemon mode): keep database files and their parsed content in memory between sync runs
+//- native paths only: a cached database file is used as long as its size, modification time and file id are unchanged
+//- at most one instance at a time
+class SyncDatabaseCache
+{
+public:
+    SyncDatabaseCache();
+    ~SyncDatabaseCache();
+
+private:
+    SyncDatabaseCache           (const SyncDatabaseCache&) = delete;
+    SyncDatabaseCache& operator=(const SyncDatabaseCache&) = delete;
+};
 }
 
 #endif //DB_FILE_H_834275398588021574
@@ -7,7 +7,9 @@
 #include "ffs_paths.h"
 #include <zen/file_access.h>
 #include <wx/stdpaths.h>
+#include <wx/utils.h>
 #include <wx/app.h>
+#include <stdlib.h> //getenv()
 
 
 using namespace zen;
@@ -68,6 +70,23 @@ Zstring zen::getConfigDirPathPf()
 }
 
 
+Zstring zen::getCacheDirPathPf()
+{
+    if (isPortableVersion())
+        return getConfigDirPathPf();
+
+    //XDG Base Directory Specification: $XDG_CACHE_HOME, default ~/.cache; relative paths are invalid
+    Zstring cacheHomePath;
+    if (const char* buf = ::getenv("XDG_CACHE_HOME")) //no extended error reporting
+        if (startsWith(buf, FILE_NAME_SEPARATOR))
+            cacheHomePath = buf;
+    if (cacheHomePath.empty())
+        cacheHomePath = appendSeparator(utfTo<Zstring>(wxGetHomeDir())) + Zstr(".cache");
+
+    return appendSeparator(appendSeparator(cacheHomePath) + Zstr("FreeFileSync"));
+}
+
+
 //this function is called by RealTimeSync!!!
 Zstring zen::getFreeFileSyncLauncherPath()
 {
@@ -16,6 +16,7 @@ namespace zen
 //------------------------------------------------------------------------------
 Zstring getResourceDirPf  (); //resource directory WITH trailing path separator
 Zstring getConfigDirPathPf(); //config directory WITH trailing path separator
+Zstring getCacheDirPathPf (); //cache directory WITH trailing path separator; may not yet exist
 //------------------------------------------------------------------------------
 
 bool isPortableVersion();
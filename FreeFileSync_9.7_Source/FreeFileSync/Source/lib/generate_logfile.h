@@ -9,6 +9,7 @@
 
 #include <zen/error_log.h>
 #include <zen/file_io.h>
+#include <zen/file_access.h>
 #include <zen/format_unit.h>
 #include "ffs_paths.h"
 #include "../fs/abstract.h"
@@ -32,9 +33,14 @@ void streamToLogFile(const SummaryInfo& summary, //throw FileError
                      const ErrorLog& log,
                      AFS::OutputStream& streamOut);
 
+/*
+LastSyncs.log is an append-only segmented log: cost of saving is proportional to the new entry, not to the retained history
+    LastSyncs.log          newest segment: entries are appended, newest last
+    LastSyncs.1.log, ...   older segments: dropped by rotation once the newest segment is full
+*/
 void saveToLastSyncsLog(const SummaryInfo& summary, //throw FileError
                         const ErrorLog& log,
-                        size_t maxBytesToWrite,
+                        size_t maxBytesToWrite, //total size of all segments; a single entry is truncated to the size of one segment
                         const IOCallback& notifyUnbufferedIO);
 
 Zstring getLastSyncsLogfilePath();
@@ -144,13 +150,43 @@ inline
 Zstring getLastSyncsLogfilePath() { return getConfigDirPathPf() + Zstr("LastSyncs.log"); }
 
 
+namespace
+{
+const size_t LAST_SYNCS_SEGMENT_COUNT = 4;
+
+
+Zstring getLastSyncsSegmentPath(size_t segment) //segment 0 is the newest
+{
+    Zstring filePath = getConfigDirPathPf() + Zstr("LastSyncs");
+    if (segment > 0)
+        filePath += Zstr(".") + numberTo<Zstring>(segment);
+    return filePath + Zstr(".log");
+}
+
+
+void rotateLastSyncsLog() //throw FileError
+{
+    const Zstring oldestPath = getLastSyncsSegmentPath(LAST_SYNCS_SEGMENT_COUNT - 1);
+    if (fileAvailable(oldestPath))
+        removeFilePlain(oldestPath); //throw FileError
+
+    for (size_t segment = LAST_SYNCS_SEGMENT_COUNT - 1; segment-- > 0;)
+    {
+        const Zstring segPath = getLastSyncsSegmentPath(segment);
+        if (fileAvailable(segPath))
+            renameFile(segPath, getLastSyncsSegmentPath(segment + 1)); //throw FileError, (ErrorDifferentVolume, ErrorTargetExisting)
+    }
+}
+}
+
+
 inline
 void saveToLastSyncsLog(const SummaryInfo& summary, //throw FileError
                         const ErrorLog& log,
                         size_t maxBytesToWrite, //log may be *huge*, e.g. 1 million items; LastSyncs.log *must not* create performance problems!
                         const IOCallback& notifyUnbufferedIO)
 {
-    const Zstring filepath = getLastSyncsLogfilePath();
+    const size_t segmentSizeMax = std::max<size_t>(maxBytesToWrite / LAST_SYNCS_SEGMENT_COUNT, 1);
 
     Utf8String newStream = utfTo<Utf8String>(generateLogHeader(summary));
     replace(newStream, '\n', LINE_BREAK); //don't replace line break any earlier
@@ -162,49 +198,25 @@ void saveToLastSyncsLog(const SummaryInfo& summary, //throw FileError
         newStream += replaceCpy(utfTo<Utf8String>(formatMessage<std::wstring>(entry)), '\n', LINE_BREAK);
         newStream += LINE_BREAK;
 
-        if (newStream.size() > maxBytesToWrite)
+        if (newStream.size() > segmentSizeMax)
         {
             newStream += "[...]";
             newStream += LINE_BREAK;
             break;
         }
     }
+    newStream += LINE_BREAK; //separate from next entry
 
-    //fill up the rest of permitted space by appending old log
-    if (newStream.size() < maxBytesToWrite)
-    {
-        Utf8String oldStream;
-        try
-        {
-            oldStream = loadBinContainer<Utf8String>(filepath, notifyUnbufferedIO); //throw FileError, X
-            //Note: we also report the loaded bytes via onUpdateSaveStatus()!
-        }
-        catch (FileError&) {}
+    const Zstring logFilePath = getLastSyncsSegmentPath(0);
 
-        if (!oldStream.empty())
-        {
-            newStream += LINE_BREAK;
-            newStream += LINE_BREAK;
-            newStream += oldStream; //impliticly limited by "maxBytesToWrite"!
-
-            //truncate size if required
-            if (newStream.size() > maxBytesToWrite)
-            {
-                //but do not cut in the middle of a row
-                auto it = std::search(newStream.cbegin() + maxBytesToWrite, newStream.cend(), std::begin(LINE_BREAK), std::end(LINE_BREAK) - 1);
-                if (it != newStream.cend())
-                {
-                    newStream.resize(it - newStream.cbegin());
-                    newStream += LINE_BREAK;
-
-                    newStream += "[...]";
-                    newStream += LINE_BREAK;
-                }
-            }
-        }
-    }
+    //start a new segment if the current one is full
+    if (fileAvailable(logFilePath))
+        if (getFileSize(logFilePath) + newStream.size() > segmentSizeMax) //throw FileError
+            rotateLastSyncsLog(); //throw FileError
 
-    saveBinContainer(filepath, newStream, notifyUnbufferedIO); //throw FileError, X
+    FileOutput logOut(logFilePath, FileOutput::ACC_APPEND, notifyUnbufferedIO); //throw FileError
+    logOut.write(newStream.c_str(), newStream.size()); //throw FileError, X
+    logOut.finalize();                             //
 }
 }
 
@@ -202,21 +202,111 @@ bool matchesMaskBegin(const Zchar* str, const Zchar* mask)
 }
 
 
-template <class PathEndMatcher> inline
-bool matchesMask(const Zstring& name, const std::vector<Zstring>& masks)
+inline
+bool matchesMaskBegin(const Zstring& name, const std::vector<Zstring>& masks)
 {
-    return std::any_of(masks.begin(), masks.end(), [&](const Zstring& mask) { return matchesMask<PathEndMatcher>(name.c_str(), mask.c_str()); });
+    return std::any_of(masks.begin(), masks.end(), [&](const Zstring& mask) { return matchesMaskBegin(name.c_str(), mask.c_str()); });
 }
 
 
 inline
-bool matchesMaskBegin(const Zstring& name, const std::vector<Zstring>& masks)
+bool containsRange(const std::vector<Zstring>& sortedStrings, const Zchar* first, const Zchar* last)
 {
-    return std::any_of(masks.begin(), masks.end(), [&](const Zstring& mask) { return matchesMaskBegin(name.c_str(), mask.c_str()); });
+    auto it = std::lower_bound(sortedStrings.begin(), sortedStrings.end(), first, [last](const Zstring& str, const Zchar* first2)
+    {
+        return std::lexicographical_compare(str.begin(), str.end(), first2, last); //same order as operator<(Zstring, Zstring)
+    });
+    return it != sortedStrings.end() && std::equal(it->begin(), it->end(), first, last);
 }
 }
 
 
+MaskMatcher::MaskMatcher(const std::vector<Zstring>& masks)
+{
+    for (const Zstring& mask : masks)
+    {
+        auto itLiteralBegin = std::find_if(mask.begin(), mask.end(), [](Zchar c) { return c != Zstr('*'); });
+        auto itLiteralEnd   = std::find_if(itLiteralBegin, mask.end(), [](Zchar c) { return c == Zstr('*') || c == Zstr('?'); });
+
+        if (std::any_of(itLiteralEnd, mask.end(), [](Zchar c) { return c != Zstr('*'); })) //"?" or "*" inside
+            otherMasks_.push_back(mask);
+        else if (itLiteralBegin == itLiteralEnd) //"*"
+            prefixMasks_.push_back(Zstring());
+        else if (itLiteralBegin == mask.begin())
+        {
+            if (itLiteralEnd == mask.end())
+                literalMasks_.push_back(mask);
+            else
+                prefixMasks_.emplace_back(itLiteralBegin, itLiteralEnd);
+        }
+        else if (itLiteralEnd == mask.end())
+            suffixMasks_.emplace_back(itLiteralBegin, itLiteralEnd);
+        else //"*abc*"
+            otherMasks_.push_back(mask);
+    }
+
+    removeDuplicates(literalMasks_); //sort for binary search
+    removeDuplicates(prefixMasks_);  //
+    removeDuplicates(suffixMasks_);  //
+
+    for (const Zstring& prefix : prefixMasks_) prefixLengths_.push_back(prefix.size());
+    for (const Zstring& suffix : suffixMasks_) suffixLengths_.push_back(suffix.size());
+    removeDuplicates(prefixLengths_);
+    removeDuplicates(suffixLengths_);
+}
+
+
+bool MaskMatcher::matches(const Zstring& relPath, bool parentFolderOnly) const
+{
+    const Zchar* const pathFirst = relPath.c_str();
+    const Zchar* const pathLast  = pathFirst + relPath.size();
+
+    //"abc" and "*abc" must match the path up to a separator or, unless parentFolderOnly, up to the end
+    auto matchesUpTo = [&](const Zchar* itEnd)
+    {
+        if (containsRange(literalMasks_, pathFirst, itEnd))
+            return true;
+
+        for (const size_t len : suffixLengths_)
+        {
+            if (len > static_cast<size_t>(itEnd - pathFirst))
+                break;
+            if (containsRange(suffixMasks_, itEnd - len, itEnd))
+                return true;
+        }
+        return false;
+    };
+
+    const Zchar* itLastSep = nullptr;
+    for (const Zchar* it = pathFirst; it != pathLast; ++it)
+        if (*it == FILE_NAME_SEPARATOR)
+        {
+            if (matchesUpTo(it))
+                return true;
+            itLastSep = it;
+        }
+    if (!parentFolderOnly && matchesUpTo(pathLast))
+        return true;
+
+    //"abc*" must match the beginning of the path; parentFolderOnly: a separator must follow
+    if (const Zchar* const itPrefixMax = parentFolderOnly ? itLastSep : pathLast)
+        for (const size_t len : prefixLengths_)
+        {
+            if (len > static_cast<size_t>(itPrefixMax - pathFirst))
+                break;
+            if (containsRange(prefixMasks_, pathFirst, pathFirst + len))
+                return true;
+        }
+
+    return std::any_of(otherMasks_.begin(), otherMasks_.end(), [&](const Zstring& mask)
+    {
+        return parentFolderOnly ?
+               matchesMask<ParentFolderMatch>(pathFirst, mask.c_str()) :
+               matchesMask<AnyMatch         >(pathFirst, mask.c_str());
+    });
+}
+
+
 std::vector<Zstring> zen::splitByDelimiter(const Zstring& filterString)
 {
     //delimiters may be FILTER_ITEM_SEPARATOR or '\n'
@@ -245,6 +335,8 @@ NameFilter::NameFilter(const Zstring& includePhrase, const Zstring& excludePhras
     removeDuplicates(includeMasksFolder);
     removeDuplicates(excludeMasksFileFolder);
     removeDuplicates(excludeMasksFolder);
+
+    compileMasks();
 }
 
 
@@ -254,6 +346,17 @@ void NameFilter::addExclusion(const Zstring& excludePhrase)
 
     removeDuplicates(excludeMasksFileFolder);
     removeDuplicates(excludeMasksFolder);
+
+    compileMasks();
+}
+
+
+void NameFilter::compileMasks()
+{
+    includeMatcherFileFolder = MaskMatcher(includeMasksFileFolder);
+    includeMatcherFolder     = MaskMatcher(includeMasksFolder);
+    excludeMatcherFileFolder = MaskMatcher(excludeMasksFileFolder);
+    excludeMatcherFolder     = MaskMatcher(excludeMasksFolder);
 }
 
 
@@ -262,12 +365,12 @@ bool NameFilter::passFileFilter(const Zstring& relFilePath) const
     assert(!startsWith(relFilePath, FILE_NAME_SEPARATOR));
     const Zstring& pathFmt = relFilePath; //nothing to do here
 
-    if (matchesMask<AnyMatch         >(pathFmt, excludeMasksFileFolder) || //either full match on file or partial match on any parent folder
-        matchesMask<ParentFolderMatch>(pathFmt, excludeMasksFolder))       //partial match on any parent folder only
+    if (excludeMatcherFileFolder.matches(pathFmt, false) || //either full match on file or partial match on any parent folder
+        excludeMatcherFolder    .matches(pathFmt, true))    //partial match on any parent folder only
         return false;
 
-    return matchesMask<AnyMatch         >(pathFmt, includeMasksFileFolder) ||
-           matchesMask<ParentFolderMatch>(pathFmt, includeMasksFolder);
+    return includeMatcherFileFolder.matches(pathFmt, false) ||
+           includeMatcherFolder    .matches(pathFmt, true);
 }
 
 
@@ -278,8 +381,8 @@ bool NameFilter::passDirFilter(const Zstring& relDirPath, bool* childItemMightMa
 
     const Zstring& pathFmt = relDirPath; //nothing to do here
 
-    if (matchesMask<AnyMatch>(pathFmt, excludeMasksFileFolder) ||
-        matchesMask<AnyMatch>(pathFmt, excludeMasksFolder))
+    if (excludeMatcherFileFolder.matches(pathFmt, false) ||
+        excludeMatcherFolder    .matches(pathFmt, false))
     {
         if (childItemMightMatch)
             *childItemMightMatch = false; //perf: no need to traverse deeper; subfolders/subfiles would be excluded by filter anyway!
@@ -297,8 +400,8 @@ bool NameFilter::passDirFilter(const Zstring& relDirPath, bool* childItemMightMa
         return false;
     }
 
-    if (!matchesMask<AnyMatch>(pathFmt, includeMasksFileFolder) &&
-        !matchesMask<AnyMatch>(pathFmt, includeMasksFolder))
+    if (!includeMatcherFileFolder.matches(pathFmt, false) &&
+        !includeMatcherFolder    .matches(pathFmt, false))
     {
         if (childItemMightMatch)
         {
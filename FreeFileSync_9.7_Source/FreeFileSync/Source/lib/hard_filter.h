@@ -74,6 +74,26 @@ private:
 };
 
 
+//match a relative path against a list of wildcard masks in one go: instead of trying each mask in turn,
+//masks without wildcards, "*abc" and "abc*" are found via binary search for each sub path
+class MaskMatcher
+{
+public:
+    MaskMatcher() {}
+    explicit MaskMatcher(const std::vector<Zstring>& masks);
+
+    bool matches(const Zstring& relPath, bool parentFolderOnly) const; //parentFolderOnly: strict match of a parent folder path, e.g. "abc" matches "abc/def"
+
+private:
+    std::vector<Zstring> literalMasks_; //sorted
+    std::vector<Zstring> prefixMasks_;  //sorted: "abc*" -> "abc"
+    std::vector<Zstring> suffixMasks_;  //sorted: "*abc" -> "abc"
+    std::vector<size_t> prefixLengths_; //sorted + unique
+    std::vector<size_t> suffixLengths_; //
+    std::vector<Zstring> otherMasks_;   //match one by one
+};
+
+
 class NameFilter : public HardFilter  //standard filter by filepath
 {
 public:
@@ -91,10 +111,17 @@ public:
 private:
     bool cmpLessSameType(const HardFilter& other) const override;
 
+    void compileMasks();
+
     std::vector<Zstring> includeMasksFileFolder; //
     std::vector<Zstring> includeMasksFolder;     //upper case (windows) + unique items by construction
     std::vector<Zstring> excludeMasksFileFolder; //
     std::vector<Zstring> excludeMasksFolder;     //
+
+    MaskMatcher includeMatcherFileFolder; //
+    MaskMatcher includeMatcherFolder;     //compiled from the mask lists above
+    MaskMatcher excludeMatcherFileFolder; //
+    MaskMatcher excludeMatcherFolder;     //
 };
 
 
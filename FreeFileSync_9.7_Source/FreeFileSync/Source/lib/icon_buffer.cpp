@@ -9,8 +9,14 @@
 #include <set>
 #include <zen/thread.h> //includes <std/thread.hpp>
 #include <zen/scope_guard.h>
+#include <zen/guid.h>
+#include <zen/crc.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
 #include <wx+/image_resources.h>
+#include <wx+/zlib_wrap.h>
 #include "icon_loader.h"
+#include "ffs_paths.h"
 
 
 using namespace zen;
@@ -20,7 +26,14 @@ using AFS = AbstractFileSystem;
 namespace
 {
 const size_t BUFFER_SIZE_MAX = 800; //maximum number of icons to hold in buffer: must be big enough to hold visible icons + preload buffer! Consider OS limit on GDI resources (wxBitmap)!!!
+//generic icons are not part of this limit: buffered per file extension
 
+const size_t ICON_LOADER_THREADS = 4; //decoding images for thumbnails is CPU-bound
+
+const size_t THUMBNAIL_CACHE_SLOTS = 10000; //on-disk thumbnail cache: limit file count; a new thumbnail replaces the one sharing its slot
+
+const char THUMBNAIL_FORMAT_DESCR[] = "FreeFileSync Thumbnail";
+const int THUMBNAIL_FORMAT_VER = 1;
 
 
 //destroys raw icon! Call from GUI thread only!
@@ -38,11 +51,167 @@ wxBitmap extractWxBitmap(ImageHolder&& ih)
 }
 
 
+//icon is determined by the file extension alone => load once per extension instead of once per item
+bool hasGenericIcon(const Zstring& itemName, IconBuffer::IconSize sz)
+{
+    const Zstring& ext = getFileExtension(itemName);
+    if (ext.empty() ||               //e.g. "AUTHORS" has own mime type on Linux, executables
+        hasLinkExtension(itemName)) //*.desktop files specify their own icon
+        return false;
+
+    switch (sz)
+    {
+        case IconBuffer::SIZE_SMALL:
+            return true;
+        case IconBuffer::SIZE_MEDIUM:
+        case IconBuffer::SIZE_LARGE:
+            return !supportsThumbnails(ext); //thumbnails are per item
+    }
+    assert(false);
+    return false;
+}
+
+//---------------------- on-disk thumbnail cache -------------------------
+/*
+one file per slot: format descriptor | key: (file path, icon size, file signature) | compressed image
+
+    - thumbnails are reused until the file is modified, even across program runs
+    - items without thumbnail are cached as an empty image => don't try to decode them again
+*/
+std::string getThumbnailKey(const Zstring& filePath, int pixelSize) //throw FileError
+{
+    const FileSignature sig = getFileSignature(filePath); //throw FileError
+
+    MemoryStreamOut<std::string> streamOut;
+    writeContainer(streamOut, utfTo<std::string>(filePath));
+    writeNumber<int32_t >(streamOut, pixelSize);
+    writeNumber<uint64_t>(streamOut, sig.fileSize);
+    writeNumber<int64_t >(streamOut, sig.modTimeNs);
+    return streamOut.ref();
+}
+
+
+Zstring getThumbnailCacheFilePath(const Zstring& cacheFolderPath, const std::string& key)
+{
+    return appendSeparator(cacheFolderPath) + numberTo<Zstring>(getCrc32(key) % THUMBNAIL_CACHE_SLOTS) + Zstr(".ffs_thumb");
+}
+
+
+//returns false if not cached
+bool loadCachedThumbnail(const Zstring& cacheFilePath, const std::string& key, ImageHolder& img) //throw FileError
+{
+    const std::string rawStream = loadBinContainer<std::string>(cacheFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    try
+    {
+        MemoryStreamIn<std::string> streamIn(rawStream);
+
+        char formatDescr[sizeof(THUMBNAIL_FORMAT_DESCR)] = {};
+        readArray(streamIn, formatDescr, sizeof(formatDescr)); //throw UnexpectedEndOfStreamError
+
+        if (!std::equal(THUMBNAIL_FORMAT_DESCR, THUMBNAIL_FORMAT_DESCR + sizeof(THUMBNAIL_FORMAT_DESCR), formatDescr) ||
+            readNumber<int32_t>(streamIn) != THUMBNAIL_FORMAT_VER || //throw UnexpectedEndOfStreamError
+            readContainer<std::string>(streamIn) != key)             //=> slot is used by a different thumbnail
+            return false;
+
+        MemoryStreamIn<std::string> streamInImg(decompress(readContainer<std::string>(streamIn))); //throw UnexpectedEndOfStreamError, ZlibInternalError
+
+        const int  width    = readNumber<int32_t>(streamInImg); //throw UnexpectedEndOfStreamError
+        const int  height   = readNumber<int32_t>(streamInImg); //
+        const bool hasAlpha = readNumber<int8_t >(streamInImg) != 0; //
+
+        if (width < 0 || height < 0 || width > 4096 || height > 4096) //"no thumbnail" is stored as 0 x 0
+            return false;
+
+        if (width > 0 && height > 0)
+        {
+            img = ImageHolder(width, height, hasAlpha);
+            readArray(streamInImg, img.getRgb(), width * height * 3); //throw UnexpectedEndOfStreamError
+            if (hasAlpha)
+                readArray(streamInImg, img.getAlpha(), width * height); //
+        }
+        return true;
+    }
+    catch (UnexpectedEndOfStreamError&) { return false; } //corrupted, e.g. power loss: overwrite
+    catch (ZlibInternalError&)          { return false; } //
+}
+
+
+void saveCachedThumbnail(const Zstring& cacheFilePath, const std::string& key, ImageHolder& img) //throw FileError, ZlibInternalError
+{
+    MemoryStreamOut<std::string> streamOutImg;
+    writeNumber<int32_t>(streamOutImg, img.getWidth ());
+    writeNumber<int32_t>(streamOutImg, img.getHeight());
+    writeNumber<int8_t >(streamOutImg, img.getAlpha() ? 1 : 0);
+    if (img)
+    {
+        writeArray(streamOutImg, img.getRgb(), img.getWidth() * img.getHeight() * 3);
+        if (img.getAlpha())
+            writeArray(streamOutImg, img.getAlpha(), img.getWidth() * img.getHeight());
+    }
+
+    MemoryStreamOut<std::string> streamOut;
+    writeArray(streamOut, THUMBNAIL_FORMAT_DESCR, sizeof(THUMBNAIL_FORMAT_DESCR));
+    writeNumber<int32_t>(streamOut, THUMBNAIL_FORMAT_VER);
+    writeContainer(streamOut, key);
+    writeContainer(streamOut, compress(streamOutImg.ref(), 3)); //throw ZlibInternalError
+
+    //write temporary file first: other icon loader threads may be reading the slot
+    const Zstring shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+    const Zstring tmpFilePath = cacheFilePath + Zchar('.') + shortGuid + AFS::TEMP_FILE_ENDING;
+
+    ZEN_ON_SCOPE_FAIL(try { removeFilePlain(tmpFilePath); }
+    catch (FileError&) {}); //also remove a partially written file
+    saveBinContainer(tmpFilePath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    try
+    {
+        renameFile(tmpFilePath, cacheFilePath); //throw FileError, ErrorDifferentVolume, ErrorTargetExisting
+    }
+    catch (ErrorTargetExisting&)
+    {
+        removeFilePlain(cacheFilePath); //throw FileError
+        renameFile(tmpFilePath, cacheFilePath); //throw FileError, (ErrorDifferentVolume), ErrorTargetExisting
+    }
+}
+
+
+ImageHolder getThumbnailImageCached(const AbstractPath& itemPath, int pixelSize, const Zstring& cacheFolderPath)
+{
+    const Opt<Zstring> nativePath = AFS::getNativeItemPath(itemPath);
+    if (!nativePath) //restrict caching to native paths until further
+        return AFS::getThumbnailImage(itemPath, pixelSize);
+
+    std::string key;
+    Zstring cacheFilePath;
+    try
+    {
+        key           = getThumbnailKey(*nativePath, pixelSize); //throw FileError
+        cacheFilePath = getThumbnailCacheFilePath(cacheFolderPath, key);
+
+        ImageHolder img;
+        if (loadCachedThumbnail(cacheFilePath, key, img)) //throw FileError
+            return img;
+    }
+    catch (FileError&) {} //not yet cached (or file not accessible => no thumbnail anyway)
+
+    ImageHolder img = AFS::getThumbnailImage(itemPath, pixelSize);
+
+    if (!key.empty())
+        try
+        {
+            createDirectoryIfMissingRecursion(cacheFolderPath); //throw FileError
+            saveCachedThumbnail(cacheFilePath, key, img); //throw FileError, ZlibInternalError
+        }
+        catch (FileError&) {} //not an error in this context: cache is best effort
+        catch (ZlibInternalError&) {}
+
+    return img;
+}
 }
 
 //################################################################################################################################################
 
-ImageHolder getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz)
+ImageHolder getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz, const Zstring& thumbnailCacheFolderPath)
 {
     //1. try to load thumbnails
     switch (sz)
@@ -51,7 +220,7 @@ ImageHolder getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz
             break;
         case IconBuffer::SIZE_MEDIUM:
         case IconBuffer::SIZE_LARGE:
-            if (ImageHolder img = AFS::getThumbnailImage(itemPath, IconBuffer::getSize(sz)))
+            if (ImageHolder img = getThumbnailImageCached(itemPath, IconBuffer::getSize(sz), thumbnailCacheFolderPath))
                 return img;
             //else: fallback to non-thumbnail icon
             break;
@@ -160,8 +329,7 @@ public:
 
         //thread safety: moving ImageHolder is free from side effects, but ~wxBitmap() is NOT! => do NOT delete items from iconList here!
         auto rc = iconList.emplace(filePath, makeValueObject());
-        assert(rc.second); //insertion took place
-        if (rc.second)
+        if (rc.second) //else: loaded by another worker thread in the meantime
         {
             refData(rc.first).iconRaw = std::move(icon);
             priorityListPushBack(rc.first);
@@ -283,10 +451,12 @@ class WorkerThread //lifetime is part of icon buffer
 public:
     WorkerThread(const std::shared_ptr<WorkLoad>& workload,
                  const std::shared_ptr<Buffer>& buffer,
-                 IconBuffer::IconSize st) :
+                 IconBuffer::IconSize st,
+                 const Zstring& thumbnailCacheFolderPath) :
         workload_(workload),
         buffer_(buffer),
-        iconSizeType_(st) {}
+        iconSizeType_(st),
+        thumbnailCacheFolderPath_(thumbnailCacheFolderPath) {}
 
     void operator()() const; //thread entry
 
@@ -294,6 +464,7 @@ private:
     std::shared_ptr<WorkLoad> workload_; //main/worker thread may access different shared_ptr instances safely (even though they have the same target!)
     std::shared_ptr<Buffer> buffer_;     //http://www.boost.org/doc/libs/1_43_0/libs/smart_ptr/shared_ptr.htm?sess=8153b05b34d890e02d48730db1ff7ddc#ThreadSafety
     const IconBuffer::IconSize iconSizeType_;
+    const Zstring thumbnailCacheFolderPath_;
 };
 
 
@@ -311,7 +482,7 @@ void WorkerThread::operator()() const //thread entry
             const AbstractPath itemPath = workload_->extractNextFile(); //throw ThreadInterruption
 
             if (!buffer_->hasIcon(itemPath)) //perf: workload may contain duplicate entries?
-                buffer_->insert(itemPath, getDisplayIcon(itemPath, iconSizeType_));
+                buffer_->insert(itemPath, getDisplayIcon(itemPath, iconSizeType_, thumbnailCacheFolderPath_));
         }
 
 }
@@ -323,7 +494,7 @@ struct IconBuffer::Impl
     std::shared_ptr<WorkLoad> workload = std::make_shared<WorkLoad>();
     std::shared_ptr<Buffer>   buffer   = std::make_shared<Buffer>();
 
-    InterruptibleThread worker;
+    std::vector<InterruptibleThread> worker; //load thumbnails in parallel
 
     //-------------------------
     std::map<Zstring, wxBitmap, LessFilePath> extensionIcons; //no item count limit!? Test case C:\ ~ 3800 unique file extensions
@@ -332,15 +503,20 @@ struct IconBuffer::Impl
 
 IconBuffer::IconBuffer(IconSize sz) : pimpl_(std::make_unique<Impl>()), iconSizeType(sz)
 {
-    pimpl_->worker = InterruptibleThread(WorkerThread(pimpl_->workload, pimpl_->buffer, sz));
+    const Zstring thumbnailCacheFolderPath = getCacheDirPathPf() + Zstr("Thumbnails");
+
+    for (size_t i = 0; i < ICON_LOADER_THREADS; ++i)
+        pimpl_->worker.emplace_back(WorkerThread(pimpl_->workload, pimpl_->buffer, sz, thumbnailCacheFolderPath));
 }
 
 
 IconBuffer::~IconBuffer()
 {
     setWorkload({}); //make sure interruption point is always reached! //needed???
-    pimpl_->worker.interrupt();
-    pimpl_->worker.join();
+    for (InterruptibleThread& wt : pimpl_->worker)
+        wt.interrupt(); //interrupt all first, then join
+    for (InterruptibleThread& wt : pimpl_->worker)
+        wt.join();
 }
 
 
@@ -363,12 +539,19 @@ int IconBuffer::getSize(IconSize sz)
 
 bool IconBuffer::readyForRetrieval(const AbstractPath& filePath)
 {
+    if (hasGenericIcon(AFS::getItemName(filePath), iconSizeType))
+        return true;
+
     return pimpl_->buffer->hasIcon(filePath);
 }
 
 
 Opt<wxBitmap> IconBuffer::retrieveFileIcon(const AbstractPath& filePath)
 {
+    const Zstring& itemName = AFS::getItemName(filePath);
+    if (hasGenericIcon(itemName, iconSizeType))
+        return getIconByExtension(itemName); //resolved once per extension
+
     if (Opt<wxBitmap> ico = pimpl_->buffer->retrieve(filePath))
         return ico;
 
@@ -383,7 +566,12 @@ void IconBuffer::setWorkload(const std::vector<AbstractPath>& load)
 {
     assert(load.size() < BUFFER_SIZE_MAX / 2);
 
-    pimpl_->workload->setWorkload(load); //since buffer can only increase due to new workload,
+    std::vector<AbstractPath> itemLoad; //generic icons are loaded by extension: see retrieveFileIcon()
+    for (const AbstractPath& filePath : load)
+        if (!hasGenericIcon(AFS::getItemName(filePath), iconSizeType))
+            itemLoad.push_back(filePath);
+
+    pimpl_->workload->setWorkload(itemLoad); //since buffer can only increase due to new workload,
     pimpl_->buffer->limitSize();         //this is the place to impose the limit from main thread!
 }
 
@@ -400,7 +588,11 @@ wxBitmap IconBuffer::getIconByExtension(const Zstring& filePath)
         const Zstring& templateName(ext.empty() ? Zstr("file") : Zstr("file.") + ext);
         //don't pass actual file name to getIconByTemplatePath(), e.g. "AUTHORS" has own mime type on Linux!!!
         //=> we want to buffer by extension only to minimize buffer-misses!
-        it = pimpl_->extensionIcons.emplace(ext, extractWxBitmap(getIconByTemplatePath(templateName, IconBuffer::getSize(iconSizeType)))).first;
+        ImageHolder ih = getIconByTemplatePath(templateName, IconBuffer::getSize(iconSizeType));
+        if (!ih)
+            ih = zen::genericFileIcon(IconBuffer::getSize(iconSizeType));
+
+        it = pimpl_->extensionIcons.emplace(ext, extractWxBitmap(std::move(ih))).first;
     }
     //need buffer size limit???
     return it->second;
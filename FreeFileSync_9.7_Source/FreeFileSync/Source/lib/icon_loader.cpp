@@ -5,7 +5,10 @@
 // *****************************************************************************
 
 #include "icon_loader.h"
+#include <set>
+#include <mutex>
 #include <zen/scope_guard.h>
+#include <zen/string_tools.h>
 
     #include <gtk/gtk.h>
     #include <sys/stat.h>
@@ -16,6 +19,9 @@ using namespace zen;
 
 namespace
 {
+std::mutex lockIconTheme; //GtkIconTheme is not thread-safe: icons may be loaded by multiple threads
+
+
 ImageHolder copyToImageHolder(const GdkPixbuf* pixbuf)
 {
     //see: https://developer.gnome.org/gdk-pixbuf/stable/gdk-pixbuf-The-GdkPixbuf-Structure.html
@@ -77,6 +83,8 @@ ImageHolder copyToImageHolder(const GdkPixbuf* pixbuf)
 
 ImageHolder imageHolderFromGicon(GIcon* gicon, int pixelSize)
 {
+    std::lock_guard<std::mutex> dummy(lockIconTheme);
+
     if (gicon)
         if (GtkIconTheme* defaultTheme = ::gtk_icon_theme_get_default()) //not owned!
             if (GtkIconInfo* iconInfo = ::gtk_icon_theme_lookup_by_gicon(defaultTheme, gicon, pixelSize, GTK_ICON_LOOKUP_USE_BUILTIN)) //this may fail if icon is not installed on system
@@ -189,3 +197,26 @@ ImageHolder zen::getThumbnailImage(const Zstring& filePath, int pixelSize) //ret
 
     return ImageHolder();
 }
+
+
+bool zen::supportsThumbnails(const Zstring& fileExtension)
+{
+    static const std::set<Zstring, LessAsciiNoCase> thumbnailExtensions = [] //C++11 thread-safe init
+    {
+        std::set<Zstring, LessAsciiNoCase> output;
+
+        GSList* formats = ::gdk_pixbuf_get_formats(); //list must be freed, but not its elements
+        ZEN_ON_SCOPE_EXIT(::g_slist_free(formats));
+
+        for (GSList* it = formats; it; it = it->next)
+            if (gchar** extensions = ::gdk_pixbuf_format_get_extensions(static_cast<GdkPixbufFormat*>(it->data)))
+            {
+                ZEN_ON_SCOPE_EXIT(::g_strfreev(extensions));
+                for (gchar** ext = extensions; *ext; ++ext)
+                    output.insert(*ext);
+            }
+        return output;
+    }();
+
+    return thumbnailExtensions.find(fileExtension) != thumbnailExtensions.end();
+}
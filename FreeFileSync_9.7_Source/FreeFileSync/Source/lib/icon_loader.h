@@ -22,6 +22,8 @@ ImageHolder genericFileIcon(int pixelSize);
 ImageHolder genericDirIcon(int pixelSize);
 ImageHolder getFileIcon(const Zstring& filePath, int pixelSize);
 ImageHolder getThumbnailImage(const Zstring& filePath, int pixelSize);
+
+bool supportsThumbnails(const Zstring& fileExtension); //file types getThumbnailImage() can handle (case-insensitive), e.g. "jpg"
 }
 
 #endif //ICON_LOADER_H_1348701985713445
@@ -0,0 +1,235 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "io_stats.h"
+#include <zen/i18n.h>
+#include <zen/utf.h>
+#include <zen/string_tools.h>
+
+using namespace zen;
+
+
+const char* zen::getIoOperationName(IoOperation op)
+{
+    switch (op)
+    {
+        case IoOperation::TRAVERSE_FOLDER:
+            return "traverse_folder";
+        case IoOperation::GET_ITEM_TYPE:
+            return "get_item_type";
+        case IoOperation::CREATE_FOLDER:
+            return "create_folder";
+        case IoOperation::REMOVE_FILE:
+            return "remove_file";
+        case IoOperation::REMOVE_SYMLINK:
+            return "remove_symlink";
+        case IoOperation::REMOVE_FOLDER:
+            return "remove_folder";
+        case IoOperation::RENAME_ITEM:
+            return "rename_item";
+        case IoOperation::SET_MOD_TIME:
+            return "set_mod_time";
+        case IoOperation::OPEN_INPUT:
+            return "open_input";
+        case IoOperation::READ:
+            return "read";
+        case IoOperation::OPEN_OUTPUT:
+            return "open_output";
+        case IoOperation::WRITE:
+            return "write";
+        case IoOperation::COPY_FILE:
+            return "copy_file";
+        case IoOperation::COPY_FOLDER:
+            return "copy_folder";
+        case IoOperation::COPY_SYMLINK:
+            return "copy_symlink";
+        case IoOperation::RECYCLE:
+            return "recycle";
+        case IoOperation::DATABASE_LOAD:
+            return "database_load";
+        case IoOperation::DATABASE_SAVE:
+            return "database_save";
+        case IoOperation::FILTER:
+            return "filter";
+    }
+    assert(false);
+    return "unknown";
+}
+
+
+uint64_t zen::getLatencyPercentileUs(const IoOperationStats& stats, double percentile)
+{
+    if (stats.callCount == 0)
+        return 0;
+
+    const double callsBelow = stats.callCount * percentile / 100;
+    uint64_t callsTotal = 0;
+    for (size_t bucket = 0; bucket < IO_LATENCY_BUCKETS; ++bucket)
+    {
+        callsTotal += stats.latencyHistogram[bucket];
+        if (callsTotal >= callsBelow)
+            return 1ULL << bucket;
+    }
+    return 1ULL << (IO_LATENCY_BUCKETS - 1);
+}
+
+
+IoStatsTable IoCounters::getStats() const
+{
+    std::lock_guard<std::mutex> dummy(lockStats_);
+    return stats_;
+}
+
+
+void IoCounters::merge(const IoStatsTable& stats)
+{
+    std::lock_guard<std::mutex> dummy(lockStats_);
+
+    for (size_t i = 0; i < IO_OPERATION_COUNT; ++i)
+    {
+        const IoOperationStats& src = stats [i];
+        IoOperationStats&       trg = stats_[i];
+
+        trg.callCount   += src.callCount;
+        trg.errorCount  += src.errorCount;
+        trg.bytes       += src.bytes;
+        trg.timeTotalNs += src.timeTotalNs;
+        for (size_t bucket = 0; bucket < IO_LATENCY_BUCKETS; ++bucket)
+            trg.latencyHistogram[bucket] += src.latencyHistogram[bucket];
+    }
+}
+
+
+IoCounters& IoStatistics::getFolderPairCounters(const std::wstring& displayPathLeft, const std::wstring& displayPathRight)
+{
+    std::lock_guard<std::mutex> dummy(lockFolderPairs_);
+
+    for (const std::unique_ptr<FolderPairCounters>& fp : folderPairs_)
+        if (fp->displayPathLeft == displayPathLeft && fp->displayPathRight == displayPathRight)
+            return fp->counters;
+
+    folderPairs_.push_back(std::make_unique<FolderPairCounters>());
+    folderPairs_.back()->displayPathLeft  = displayPathLeft;
+    folderPairs_.back()->displayPathRight = displayPathRight;
+    return folderPairs_.back()->counters;
+}
+
+
+std::vector<IoStatistics::FolderPairStats> IoStatistics::getStats() const
+{
+    std::lock_guard<std::mutex> dummy(lockFolderPairs_);
+
+    std::vector<FolderPairStats> output;
+    for (const std::unique_ptr<FolderPairCounters>& fp : folderPairs_)
+        output.push_back({ fp->displayPathLeft, fp->displayPathRight, fp->counters.getStats() });
+    return output;
+}
+
+
+std::wstring zen::formatIoStatistics(const IoStatistics::FolderPairStats& fpStats)
+{
+    auto fmtColumn = [](const std::wstring& str, size_t width) { return str.size() < width ? std::wstring(width - str.size(), L' ') + str : str; };
+
+    std::wstring output = _("I/O statistics:") + L" " + fpStats.displayPathLeft;
+    if (!fpStats.displayPathRight.empty()) //e.g. versioning folder clean-up
+        output += L" <-> " + fpStats.displayPathRight;
+    output += L"\n"
+              L"    operation          calls  errors    total [ms]   p50 [us]   p95 [us]   p99 [us]          bytes";
+
+    for (size_t i = 0; i < IO_OPERATION_COUNT; ++i)
+    {
+        const IoOperationStats& stats = fpStats.stats[i];
+        if (stats.callCount > 0)
+        {
+            std::wstring opName = utfTo<std::wstring>(getIoOperationName(static_cast<IoOperation>(i)));
+            opName.resize(std::max<size_t>(opName.size(), 15), L' ');
+
+            output += L"\n    " + opName +
+                      fmtColumn(numberTo<std::wstring>(stats.callCount),              9) +
+                      fmtColumn(numberTo<std::wstring>(stats.errorCount),             8) +
+                      fmtColumn(numberTo<std::wstring>(stats.timeTotalNs / 1000000), 14) +
+                      fmtColumn(numberTo<std::wstring>(getLatencyPercentileUs(stats, 50)), 11) +
+                      fmtColumn(numberTo<std::wstring>(getLatencyPercentileUs(stats, 95)), 11) +
+                      fmtColumn(numberTo<std::wstring>(getLatencyPercentileUs(stats, 99)), 11) +
+                      fmtColumn(numberTo<std::wstring>(stats.bytes),                 15);
+        }
+    }
+    return output;
+}
+
+
+namespace
+{
+std::string formatJsonString(const std::wstring& str)
+{
+    std::string output = "\"";
+    for (const char c : utfTo<std::string>(str))
+        switch (c)
+        {
+            case '"':
+                output += "\\\"";
+                break;
+            case '\\':
+                output += "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) //control characters
+                    output += "\\u00" + printNumber<std::string>("%02x", static_cast<unsigned char>(c));
+                else
+                    output += c;
+                break;
+        }
+    return output + "\"";
+}
+}
+
+
+std::string zen::serializeIoStatisticsJson(const std::vector<IoStatistics::FolderPairStats>& stats)
+{
+    std::string output = "{\n"
+                         "  \"histogram_bucket_upper_us\": [";
+    for (size_t bucket = 0; bucket < IO_LATENCY_BUCKETS; ++bucket)
+        output += (bucket == 0 ? "" : ", ") + numberTo<std::string>(1ULL << bucket);
+    output += "],\n"
+              "  \"folder_pairs\": [";
+
+    for (auto itFp = stats.begin(); itFp != stats.end(); ++itFp)
+    {
+        output += std::string(itFp == stats.begin() ? "" : ",") + "\n"
+                  "    {\n"
+                  "      \"left\": "  + formatJsonString(itFp->displayPathLeft)  + ",\n"
+                  "      \"right\": " + formatJsonString(itFp->displayPathRight) + ",\n"
+                  "      \"operations\": {";
+
+        bool firstOp = true;
+        for (size_t i = 0; i < IO_OPERATION_COUNT; ++i)
+        {
+            const IoOperationStats& opStats = itFp->stats[i];
+            if (opStats.callCount > 0)
+            {
+                output += std::string(firstOp ? "" : ",") + "\n"
+                          "        \"" + getIoOperationName(static_cast<IoOperation>(i)) + "\": {" +
+                          " \"calls\": "         + numberTo<std::string>(opStats.callCount) +
+                          ", \"errors\": "       + numberTo<std::string>(opStats.errorCount) +
+                          ", \"bytes\": "        + numberTo<std::string>(opStats.bytes) +
+                          ", \"time_total_us\": " + numberTo<std::string>(opStats.timeTotalNs / 1000) +
+                          ", \"p50_us\": "       + numberTo<std::string>(getLatencyPercentileUs(opStats, 50)) +
+                          ", \"p95_us\": "       + numberTo<std::string>(getLatencyPercentileUs(opStats, 95)) +
+                          ", \"p99_us\": "       + numberTo<std::string>(getLatencyPercentileUs(opStats, 99)) +
+                          ", \"histogram\": [";
+                for (size_t bucket = 0; bucket < IO_LATENCY_BUCKETS; ++bucket)
+                    output += (bucket == 0 ? "" : ", ") + numberTo<std::string>(opStats.latencyHistogram[bucket]);
+                output += "] }";
+                firstOp = false;
+            }
+        }
+        output += std::string(firstOp ? "" : "\n      ") + "}\n"
+                  "    }";
+    }
+    output += std::string(stats.empty() ? "" : "\n  ") + "]\n"
+              "}\n";
+    return output;
+}
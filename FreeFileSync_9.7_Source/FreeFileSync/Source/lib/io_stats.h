@@ -0,0 +1,221 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef IO_STATS_H_3487209457203845723
+#define IO_STATS_H_3487209457203845723
+
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <zen/thread.h>      //ZEN_THREAD_LOCAL_SPECIFIER
+#include <zen/scope_guard.h> //getUncaughtExceptionCount()
+
+
+namespace zen
+{
+/*
+instrumentation of file system primitives: call and error counts, total time, bytes and latency histogram per operation type
+
+    - a thread collects into its own counters while bound to a folder pair via IoCountersScope => no locking, no atomics
+    - the counters are merged into the folder pair's IoCounters when the scope ends
+    - unbound threads (e.g. GUI, or when the ProcessCallback does not collect statistics): IoOperationTimer is a no-op
+    - nested calls of the same operation (e.g. wrapped file systems) are counted only once; different operations are counted inclusively,
+      e.g. a file copy is counted as COPY_FILE and its final rename as RENAME_ITEM
+*/
+enum class IoOperation
+{
+    TRAVERSE_FOLDER,
+    GET_ITEM_TYPE,
+    CREATE_FOLDER,
+    REMOVE_FILE,
+    REMOVE_SYMLINK,
+    REMOVE_FOLDER,
+    RENAME_ITEM,
+    SET_MOD_TIME,
+    OPEN_INPUT,
+    READ,
+    OPEN_OUTPUT,
+    WRITE,
+    COPY_FILE,
+    COPY_FOLDER,
+    COPY_SYMLINK,
+    RECYCLE,
+    DATABASE_LOAD,
+    DATABASE_SAVE,
+    FILTER,
+};
+const size_t IO_OPERATION_COUNT = static_cast<size_t>(IoOperation::FILTER) + 1;
+
+const char* getIoOperationName(IoOperation op); //e.g. "traverse_folder"
+
+const size_t IO_LATENCY_BUCKETS = 24; //bucket 0: < 1 µs; bucket n: [2^(n-1), 2^n) µs; last bucket: everything slower
+
+struct IoOperationStats
+{
+    uint64_t callCount   = 0;
+    uint64_t errorCount  = 0;
+    uint64_t bytes       = 0;
+    uint64_t timeTotalNs = 0;
+    std::array<uint64_t, IO_LATENCY_BUCKETS> latencyHistogram = {};
+};
+using IoStatsTable = std::array<IoOperationStats, IO_OPERATION_COUNT>;
+
+uint64_t getLatencyPercentileUs(const IoOperationStats& stats, double percentile); //upper bound of the histogram bucket; 0 if no calls
+
+
+class IoCounters //statistics of a single folder pair
+{
+public:
+    IoStatsTable getStats() const;
+
+private:
+    friend class IoCountersScope;
+    void merge(const IoStatsTable& stats);
+
+    mutable std::mutex lockStats_;
+    IoStatsTable stats_;
+};
+
+
+class IoStatistics //statistics of all folder pairs of a sync run
+{
+public:
+    //thread-safe; returned reference stays valid for the lifetime of IoStatistics
+    IoCounters& getFolderPairCounters(const std::wstring& displayPathLeft, const std::wstring& displayPathRight);
+
+    struct FolderPairStats
+    {
+        std::wstring displayPathLeft;
+        std::wstring displayPathRight;
+        IoStatsTable stats;
+    };
+    std::vector<FolderPairStats> getStats() const; //in order of first use
+
+private:
+    struct FolderPairCounters
+    {
+        std::wstring displayPathLeft;
+        std::wstring displayPathRight;
+        IoCounters counters;
+    };
+    mutable std::mutex lockFolderPairs_;
+    std::vector<std::unique_ptr<FolderPairCounters>> folderPairs_;
+};
+
+std::wstring formatIoStatistics(const IoStatistics::FolderPairStats& fpStats); //human-readable table for the log file
+std::string serializeIoStatisticsJson(const std::vector<IoStatistics::FolderPairStats>& stats); //UTF-8
+
+
+namespace impl
+{
+struct IoThreadState
+{
+    IoCounters* counters = nullptr;
+    IoStatsTable stats;
+    unsigned int activeOps = 0; //bit mask of IoOperation: detect nested calls
+};
+
+inline
+IoThreadState*& refThreadLocalIoState()
+{
+    static ZEN_THREAD_LOCAL_SPECIFIER IoThreadState* threadLocalIoState = nullptr;
+    return threadLocalIoState;
+}
+}
+
+
+//bind the current thread to a folder pair's counters; nullptr: keep current binding
+class IoCountersScope
+{
+public:
+    explicit IoCountersScope(IoCounters* counters) : state_(counters ? std::make_unique<impl::IoThreadState>() : nullptr)
+    {
+        if (state_)
+        {
+            state_->counters = counters;
+            oldState_ = impl::refThreadLocalIoState();
+            impl::refThreadLocalIoState() = state_.get();
+        }
+    }
+
+    ~IoCountersScope()
+    {
+        if (state_)
+        {
+            impl::refThreadLocalIoState() = oldState_;
+            state_->counters->merge(state_->stats);
+        }
+    }
+
+private:
+    IoCountersScope           (const IoCountersScope&) = delete;
+    IoCountersScope& operator=(const IoCountersScope&) = delete;
+
+    const std::unique_ptr<impl::IoThreadState> state_;
+    impl::IoThreadState* oldState_ = nullptr;
+};
+
+//counters the current thread is bound to (or nullptr): pass on to short-lived helper threads
+inline IoCounters* getCurrentIoCounters() { return impl::refThreadLocalIoState() ? impl::refThreadLocalIoState()->counters : nullptr; }
+
+
+class IoOperationTimer
+{
+public:
+    explicit IoOperationTimer(IoOperation op) : op_(op)
+    {
+        impl::IoThreadState* state = impl::refThreadLocalIoState();
+        if (state && !(state->activeOps & getOpBit()))
+        {
+            state_ = state;
+            state_->activeOps |= getOpBit();
+            exceptionCount_ = getUncaughtExceptionCount();
+            startTime_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~IoOperationTimer()
+    {
+        if (state_)
+        {
+            const int64_t timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime_).count();
+            const uint64_t timeUs = timeNs / 1000;
+
+            size_t bucket = 0;
+            while (bucket + 1 < IO_LATENCY_BUCKETS && (timeUs >> bucket) != 0)
+                ++bucket;
+
+            IoOperationStats& stats = state_->stats[static_cast<size_t>(op_)];
+            ++stats.callCount;
+            if (getUncaughtExceptionCount() > exceptionCount_)
+                ++stats.errorCount;
+            stats.bytes       += bytes_;
+            stats.timeTotalNs += timeNs;
+            ++stats.latencyHistogram[bucket];
+
+            state_->activeOps &= ~getOpBit();
+        }
+    }
+
+    void addBytes(uint64_t bytes) { bytes_ += bytes; }
+
+private:
+    IoOperationTimer           (const IoOperationTimer&) = delete;
+    IoOperationTimer& operator=(const IoOperationTimer&) = delete;
+
+    unsigned int getOpBit() const { return 1U << static_cast<unsigned int>(op_); }
+
+    const IoOperation op_;
+    impl::IoThreadState* state_ = nullptr; //nullptr: not measuring
+    int exceptionCount_ = 0;
+    std::chrono::steady_clock::time_point startTime_;
+    uint64_t bytes_ = 0;
+};
+}
+
+#endif //IO_STATS_H_3487209457203845723
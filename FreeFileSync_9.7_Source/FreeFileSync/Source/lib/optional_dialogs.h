@@ -0,0 +1,32 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef OPTIONAL_DIALOGS_H_3740185921067482
+#define OPTIONAL_DIALOGS_H_3740185921067482
+
+//no wxWidgets dependency: used by comparison/synchronization core, see benchmark/benchmark.cpp
+
+namespace xmlAccess
+{
+struct OptionalDialogs
+{
+    bool warnDependentFolderPair          = true;
+    bool warnDependentBaseFolders         = true;
+    bool warnSignificantDifference        = true;
+    bool warnNotEnoughDiskSpace           = true;
+    bool warnUnresolvedConflicts          = true;
+    bool warnModificationTimeError        = true;
+    bool warnRecyclerMissing              = true;
+    bool warnInputFieldEmpty              = true;
+    bool warnDirectoryLockFailed          = true;
+    bool warnVersioningFolderPartOfSync   = true;
+    bool popupOnConfigChange              = true;
+    bool confirmSyncStart                 = true;
+    bool confirmExternalCommandMassInvoke = true;
+};
+}
+
+#endif //OPTIONAL_DIALOGS_H_3740185921067482
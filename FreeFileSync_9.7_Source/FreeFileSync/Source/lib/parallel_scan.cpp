@@ -6,6 +6,7 @@
 
 #include "parallel_scan.h"
 #include <chrono>
+#include <deque>
 #include <zen/file_error.h>
 #include <zen/basic_math.h>
 #include <zen/thread.h>
@@ -273,6 +274,49 @@ private:
 
 //-------------------------------------------------------------------------------------------------
 
+class FolderWorkload;
+
+
+class IncrementalReader
+{
+public:
+    explicit IncrementalReader(const IncrementalScan& incScan) :
+        lastSyncState_(incScan.lastSyncState),
+        side_(incScan.side),
+        changedItems_(incScan.changedRelPaths)
+    {
+        for (const Zstring& itemRelPath : changedItems_)
+        {
+            Zstring folderRelPath = beforeLast(itemRelPath, FILE_NAME_SEPARATOR, IF_MISSING_RETURN_NONE);
+            foldersToRead_.insert(folderRelPath);
+
+            for (;;) //include base folder: empty path
+            {
+                if (!foldersOnPath_.insert(folderRelPath).second)
+                    break; //parents already inserted
+                if (folderRelPath.empty())
+                    break;
+                folderRelPath = beforeLast(folderRelPath, FILE_NAME_SEPARATOR, IF_MISSING_RETURN_NONE);
+            }
+        }
+    }
+
+    const InSyncFolder& getLastSyncState() const { return *lastSyncState_; }
+    SelectedSide getSide() const { return side_; }
+
+    bool isChangedItem   (const Zstring& itemRelPath  ) const { return changedItems_ .find(itemRelPath)   != changedItems_ .end(); } //=> read completely
+    bool mustReadFolder  (const Zstring& folderRelPath) const { return foldersToRead_.find(folderRelPath) != foldersToRead_.end(); } //=> read folder listing
+    bool isOnChangedPath (const Zstring& folderRelPath) const { return foldersOnPath_.find(folderRelPath) != foldersOnPath_.end(); } //=> check subfolders
+
+private:
+    const std::shared_ptr<const InSyncFolder> lastSyncState_;
+    const SelectedSide side_;
+    const std::set<Zstring, LessFilePath> changedItems_;
+    std::set<Zstring, LessFilePath> foldersToRead_; //parent folders of changed items
+    std::set<Zstring, LessFilePath> foldersOnPath_; //foldersToRead_ including all their parents
+};
+
+
 struct TraverserConfig
 {
 public:
@@ -282,39 +326,168 @@ public:
                     SymLinkHandling handleSymlinks,
                     std::map<Zstring, std::wstring, LessFilePath>& failedFolderReads,
                     std::map<Zstring, std::wstring, LessFilePath>& failedItemReads,
-                    AsyncCallback& acb) :
+                    std::mutex& lockFailedReads,
+                    AsyncCallback& acb,
+                    ScanArena& arena,
+                    FolderWorkload* workload, //optional: nullptr for recursive traversal
+                    const IncrementalReader* incReader, //optional: nullptr for full traversal
+                    size_t workerIdx) :
         baseFolderPath_(baseFolderPath),
         filter_(filter),
         handleSymlinks_(handleSymlinks),
         failedDirReads_ (failedFolderReads),
         failedItemReads_(failedItemReads),
+        lockFailedReads_(lockFailedReads),
         acb_(acb),
+        arena_(arena),
+        workload_(workload),
+        incReader_(incReader),
+        workerIdx_(workerIdx),
         threadID_(threadID) {}
 
     const AbstractPath baseFolderPath_;
     const HardFilter::FilterRef filter_; //always bound!
     const SymLinkHandling handleSymlinks_;
 
-    std::map<Zstring, std::wstring, LessFilePath>& failedDirReads_;
-    std::map<Zstring, std::wstring, LessFilePath>& failedItemReads_;
+    std::map<Zstring, std::wstring, LessFilePath>& failedDirReads_;  //shared by all traverser threads of the same base folder
+    std::map<Zstring, std::wstring, LessFilePath>& failedItemReads_; //
+    std::mutex& lockFailedReads_;                                    //=> serialize access
 
     AsyncCallback& acb_;
+    ScanArena& arena_; //owned by this traverser thread only
+    FolderWorkload* const workload_;
+    const IncrementalReader* const incReader_;
+    const size_t workerIdx_;
     const int threadID_;
     std::chrono::steady_clock::time_point lastReportTime_;
 };
 
 
+/*
+work-stealing traversal of a single base folder: each traverser thread owns one deque of folders yet to be read
+    - owner pushes/pops at the back => depth-first, keeps the working set small
+    - idle threads steal from the front of other deques => large, unexplored subtrees
+    - subfolder results are written directly into the FolderContainer created by the parent folder's traversal:
+      ScanArena does not move its containers => no need to stitch per-thread results together later
+*/
+class FolderWorkload
+{
+public:
+    struct Job
+    {
+        Zstring folderRelPath; //empty for base folder
+        FolderContainer* folderCont; //always bound!
+        int level;
+    };
+
+    explicit FolderWorkload(size_t threadCount) : queues_(threadCount) { assert(threadCount > 0); }
+
+    size_t getThreadCount() const { return queues_.size(); }
+
+    //context of worker thread (or main thread before workers are started)
+    void push(size_t workerIdx, const Job& job)
+    {
+        {
+            std::lock_guard<std::mutex> dummy(lockStatus_);
+            ++jobsQueued_;
+            ++jobsPending_;
+        }
+        {
+            std::lock_guard<std::mutex> dummy(queues_[workerIdx].lockJobs);
+            queues_[workerIdx].jobs.push_back(job);
+        }
+        conditionNewJob_.notify_one();
+    }
+
+    //context of worker thread: blocks until a job is available; returns NoValue() when the whole folder hierarchy has been traversed
+    Opt<Job> pop(size_t workerIdx) //throw ThreadInterruption
+    {
+        for (;;)
+        {
+            if (Opt<Job> job = tryPop(workerIdx))
+                return job;
+
+            std::unique_lock<std::mutex> dummy(lockStatus_);
+            interruptibleWait(conditionNewJob_, dummy, [this] { return jobsQueued_ > 0 || jobsPending_ == 0; }); //throw ThreadInterruption
+            if (jobsPending_ == 0)
+                return NoValue();
+        }
+    }
+
+    //context of worker thread: call after *all* subfolders of the job have been pushed!
+    void jobDone()
+    {
+        {
+            std::lock_guard<std::mutex> dummy(lockStatus_);
+            assert(jobsPending_ > 0);
+            if (--jobsPending_ != 0)
+                return;
+        }
+        conditionNewJob_.notify_all(); //wake up idle threads to quit
+    }
+
+private:
+    FolderWorkload           (const FolderWorkload&) = delete;
+    FolderWorkload& operator=(const FolderWorkload&) = delete;
+
+    Opt<Job> tryPop(size_t workerIdx)
+    {
+        auto takeJob = [&](size_t queueIdx, bool fromBack) -> Opt<Job>
+        {
+            Opt<Job> job;
+            {
+                WorkQueue& wq = queues_[queueIdx];
+                std::lock_guard<std::mutex> dummy(wq.lockJobs);
+                if (wq.jobs.empty())
+                    return NoValue();
+
+                job = fromBack ? wq.jobs.back() : wq.jobs.front();
+                if (fromBack) wq.jobs.pop_back(); else wq.jobs.pop_front();
+            }
+            std::lock_guard<std::mutex> dummy(lockStatus_);
+            --jobsQueued_;
+            return job;
+        };
+
+        if (Opt<Job> job = takeJob(workerIdx, true /*fromBack*/)) //own deque first
+            return job;
+
+        for (size_t i = 1; i < queues_.size(); ++i) //then try stealing
+            if (Opt<Job> job = takeJob((workerIdx + i) % queues_.size(), false /*fromBack*/))
+                return job;
+
+        return NoValue();
+    }
+
+    struct WorkQueue
+    {
+        std::mutex lockJobs;
+        std::deque<Job> jobs;
+    };
+    std::vector<WorkQueue> queues_; //one per traverser thread
+
+    std::mutex lockStatus_;
+    std::condition_variable conditionNewJob_;
+    size_t jobsQueued_  = 0; //jobs waiting in any of the deques
+    size_t jobsPending_ = 0; //jobs queued or currently being traversed
+};
+
+
 class DirCallback : public AFS::TraverserCallback
 {
 public:
     DirCallback(TraverserConfig& config,
                 const Zstring& parentRelPathPf, //postfixed with FILE_NAME_SEPARATOR!
                 FolderContainer& output,
-                int level) :
+                int level,
+                const InSyncFolder* dbFolder = nullptr) : //incremental scan: last synchronous state of the folder being read
         cfg(config),
         parentRelPathPf_(parentRelPathPf),
         output_(output),
-        level_(level) {}
+        level_(level),
+        dbFolder_(dbFolder) {}
+
+    ~DirCallback() { output_.sortItems(); } //folder has been read completely (including retries) when its callback goes out of scope
 
     virtual void                               onFile   (const FileInfo&    fi) override; //
     virtual std::unique_ptr<TraverserCallback> onFolder (const FolderInfo&  fi) override; //throw ThreadInterruption
@@ -328,9 +501,13 @@ private:
     const Zstring parentRelPathPf_;
     FolderContainer& output_;
     const int level_;
+    const InSyncFolder* const dbFolder_;
 };
 
 
+void readFolderIncremental(TraverserConfig& cfg, const Zstring& folderRelPath, const InSyncFolder& dbFolder, FolderContainer& output, int level); //throw ThreadInterruption
+
+
 void DirCallback::onFile(const FileInfo& fi) //throw ThreadInterruption
 {
     interruptionPoint(); //throw ThreadInterruption
@@ -348,7 +525,8 @@ void DirCallback::onFile(const FileInfo& fi) //throw ThreadInterruption
 
     //------------------------------------------------------------------------------------
     //apply filter before processing (use relative name!)
-    if (!cfg.filter_->passFileFilter(fileRelPath))
+    const bool passFilter = [&] { IoOperationTimer dummy(IoOperation::FILTER); return cfg.filter_->passFileFilter(fileRelPath); }();
+    if (!passFilter)
         return;
 
     //    std::string fileId = details.fileSize >=  1024 * 1024U ? util::retrieveFileID(filepath) : std::string();
@@ -362,7 +540,7 @@ void DirCallback::onFile(const FileInfo& fi) //throw ThreadInterruption
         Linux: retrieveFileID takes about 50% longer in VM! (avoidable because of redundant stat() call!)
     */
 
-    output_.addSubFile(fi.itemName, FileAttributes(fi.modTime, fi.fileSize, fi.fileId, fi.symlinkInfo != nullptr));
+    output_.addSubFile(cfg.arena_, fi.itemName, FileAttributes(fi.modTime, fi.fileSize, fi.fileId, fi.symlinkInfo != nullptr));
 
     cfg.acb_.incItemsScanned(); //add 1 element to the progress indicator
 }
@@ -381,12 +559,13 @@ std::unique_ptr<AFS::TraverserCallback> DirCallback::onFolder(const FolderInfo&
     //------------------------------------------------------------------------------------
     //apply filter before processing (use relative name!)
     bool childItemMightMatch = true;
-    const bool passFilter = cfg.filter_->passDirFilter(folderRelPath, &childItemMightMatch);
+    const bool passFilter = [&] { IoOperationTimer dummy(IoOperation::FILTER); return cfg.filter_->passDirFilter(folderRelPath, &childItemMightMatch); }();
     if (!passFilter && !childItemMightMatch)
         return nullptr; //do NOT traverse subdirs
     //else: attention! ensure directory filtering is applied later to exclude actually filtered directories
 
-    FolderContainer& subFolder = output_.addSubFolder(fi.itemName, fi.symlinkInfo != nullptr);
+    //folder traversal retried after error: a duplicate entry is superseded by FolderContainer::sortItems() => each thread fills its own FolderContainer
+    FolderContainer& subFolder = output_.addSubFolder(cfg.arena_, fi.itemName, fi.symlinkInfo != nullptr);
     if (passFilter)
         cfg.acb_.incItemsScanned(); //add 1 element to the progress indicator
 
@@ -399,6 +578,24 @@ std::unique_ptr<AFS::TraverserCallback> DirCallback::onFolder(const FolderInfo&
         }, *this, fi.itemName))
     return nullptr;
 
+    if (dbFolder_) //incremental scan: reuse last synchronous state unless the folder itself was reported as changed (e.g. created or renamed)
+    {
+        auto it = dbFolder_->folders.find(fi.itemName);
+        if (it != dbFolder_->folders.end() && it->second.status == InSyncFolder::DIR_STATUS_IN_SYNC)
+            if (!cfg.incReader_->isChangedItem(folderRelPath))
+            {
+                readFolderIncremental(cfg, folderRelPath, it->second, subFolder, level_ + 1); //throw ThreadInterruption
+                return nullptr;
+            }
+        //else: folder unknown => read completely
+    }
+
+    if (cfg.workload_) //parallel traversal: let any idle traverser thread pick up the subfolder
+    {
+        cfg.workload_->push(cfg.workerIdx_, { folderRelPath, &subFolder, level_ + 1 });
+        return nullptr;
+    }
+
     return std::make_unique<DirCallback>(cfg, folderRelPath + FILE_NAME_SEPARATOR, subFolder, level_ + 1);
 }
 
@@ -421,7 +618,7 @@ DirCallback::HandleLink DirCallback::onSymlink(const SymlinkInfo& si) //throw Th
         case SymLinkHandling::DIRECT:
             if (cfg.filter_->passFileFilter(linkRelPath)) //always use file filter: Link type may not be "stable" on Linux!
             {
-                output_.addSubLink(si.itemName, LinkAttributes(si.modTime));
+                output_.addSubLink(cfg.arena_, si.itemName, LinkAttributes(si.modTime));
                 cfg.acb_.incItemsScanned(); //add 1 element to the progress indicator
             }
             return LINK_SKIP;
@@ -449,8 +646,11 @@ DirCallback::HandleError DirCallback::reportDirError(const std::wstring& msg, si
     switch (cfg.acb_.reportError(msg, retryNumber)) //throw ThreadInterruption
     {
         case FillBufferCallback::ON_ERROR_CONTINUE:
+        {
+            std::lock_guard<std::mutex> dummy(cfg.lockFailedReads_);
             cfg.failedDirReads_[beforeLast(parentRelPathPf_, FILE_NAME_SEPARATOR, IF_MISSING_RETURN_NONE)] = msg;
-            return ON_ERROR_CONTINUE;
+        }
+        return ON_ERROR_CONTINUE;
 
         case FillBufferCallback::ON_ERROR_RETRY:
             return ON_ERROR_RETRY;
@@ -465,8 +665,11 @@ DirCallback::HandleError DirCallback::reportItemError(const std::wstring& msg, s
     switch (cfg.acb_.reportError(msg, retryNumber)) //throw ThreadInterruption
     {
         case FillBufferCallback::ON_ERROR_CONTINUE:
+        {
+            std::lock_guard<std::mutex> dummy(cfg.lockFailedReads_);
             cfg.failedItemReads_[parentRelPathPf_ + itemName] =  msg;
-            return ON_ERROR_CONTINUE;
+        }
+        return ON_ERROR_CONTINUE;
 
         case FillBufferCallback::ON_ERROR_RETRY:
             return ON_ERROR_RETRY;
@@ -477,6 +680,67 @@ DirCallback::HandleError DirCallback::reportItemError(const std::wstring& msg, s
 
 //------------------------------------------------------------------------------------------
 
+//take unchanged items from the last synchronous state: only items that were in sync are known => all of them exist on *both* sides!
+void fillFromLastSyncState(TraverserConfig& cfg, const Zstring& parentRelPathPf, const InSyncFolder& dbFolder, FolderContainer& output, bool onChangedPath, int level) //throw ThreadInterruption
+{
+    interruptionPoint(); //throw ThreadInterruption
+
+    const IncrementalReader& incReader = *cfg.incReader_;
+
+    for (const auto& item : dbFolder.files)
+        if (cfg.filter_->passFileFilter(parentRelPathPf + item.first))
+        {
+            const InSyncDescrFile& descr = incReader.getSide() == LEFT_SIDE ? item.second.left : item.second.right;
+            output.addSubFile(cfg.arena_, item.first, FileAttributes(descr.modTime, item.second.fileSize, descr.fileId, false /*isSymlink*/));
+            cfg.acb_.incItemsScanned(); //add 1 element to the progress indicator
+        }
+
+    if (cfg.handleSymlinks_ == SymLinkHandling::DIRECT)
+        for (const auto& item : dbFolder.symlinks)
+            if (cfg.filter_->passFileFilter(parentRelPathPf + item.first))
+            {
+                const InSyncDescrLink& descr = incReader.getSide() == LEFT_SIDE ? item.second.left : item.second.right;
+                output.addSubLink(cfg.arena_, item.first, LinkAttributes(descr.modTime));
+                cfg.acb_.incItemsScanned(); //add 1 element to the progress indicator
+            }
+
+    for (const auto& item : dbFolder.folders)
+        if (item.second.status == InSyncFolder::DIR_STATUS_IN_SYNC) //straw man: no evidence the folder exists on both sides
+        {
+            const Zstring folderRelPath = parentRelPathPf + item.first;
+
+            bool childItemMightMatch = true;
+            const bool passFilter = cfg.filter_->passDirFilter(folderRelPath, &childItemMightMatch);
+            if (!passFilter && !childItemMightMatch)
+                continue;
+
+            FolderContainer& subFolder = output.addSubFolder(cfg.arena_, item.first, false /*isSymlink*/);
+            if (passFilter)
+                cfg.acb_.incItemsScanned(); //add 1 element to the progress indicator
+
+            if (onChangedPath && incReader.isOnChangedPath(folderRelPath))
+                readFolderIncremental(cfg, folderRelPath, item.second, subFolder, level + 1); //throw ThreadInterruption
+            else
+                fillFromLastSyncState(cfg, folderRelPath + FILE_NAME_SEPARATOR, item.second, subFolder, false /*onChangedPath*/, level + 1); //throw ThreadInterruption
+        }
+}
+
+
+void readFolderIncremental(TraverserConfig& cfg, const Zstring& folderRelPath, const InSyncFolder& dbFolder, FolderContainer& output, int level) //throw ThreadInterruption
+{
+    const Zstring folderRelPathPf = folderRelPath.empty() ? Zstring() : folderRelPath + FILE_NAME_SEPARATOR;
+
+    if (cfg.incReader_->mustReadFolder(folderRelPath))
+    {
+        DirCallback cb(cfg, folderRelPathPf, output, level, &dbFolder);
+
+        AFS::traverseFolder(AFS::appendRelPath(cfg.baseFolderPath_, folderRelPath), cb); //throw ThreadInterruption
+    }
+    else
+        fillFromLastSyncState(cfg, folderRelPathPf, dbFolder, output, cfg.incReader_->isOnChangedPath(folderRelPath), level); //throw ThreadInterruption
+}
+
+
 class WorkerThread
 {
 public:
@@ -485,20 +749,36 @@ public:
                  const AbstractPath& baseFolderPath,  //always bound!
                  const HardFilter::FilterRef& filter, //
                  SymLinkHandling handleSymlinks,
-                 DirectoryValue& dirOutput) :
+                 DirectoryValue& dirOutput,
+                 ScanArena& arena,
+                 const std::shared_ptr<std::mutex>& lockFailedReads,
+                 const std::shared_ptr<FolderWorkload>& workload, //optional
+                 const std::shared_ptr<IncrementalReader>& incReader, //optional
+                 size_t workerIdx,
+                 IoCounters* ioCounters) : //optional
         acb_(acb),
+        ioCounters_(ioCounters),
         outputContainer_(dirOutput.folderCont),
+        lockFailedReads_(lockFailedReads),
+        workload_(workload),
+        incReader_(incReader),
         travCfg_(threadID,
                  baseFolderPath,
                  filter,
                  handleSymlinks, //shared by all(!) instances of DirCallback while traversing a folder hierarchy
                  dirOutput.failedFolderReads,
                  dirOutput.failedItemReads,
-                 *acb_) {}
+                 *lockFailedReads_,
+                 *acb_,
+                 arena,
+                 workload_.get(),
+                 incReader_.get(),
+                 workerIdx) {}
 
     void operator()() //thread entry
     {
         setCurrentThreadName("Folder Traverser");
+        IoCountersScope ioScope(ioCounters_);
 
         acb_->incActiveWorker();
         ZEN_ON_SCOPE_EXIT(acb_->decActiveWorker());
@@ -506,27 +786,50 @@ public:
         if (acb_->mayReportCurrentFile(travCfg_.threadID_, travCfg_.lastReportTime_))
             acb_->reportCurrentFile(AFS::getDisplayPath(travCfg_.baseFolderPath_)); //just in case first directory access is blocking
 
-        DirCallback cb(travCfg_, Zstring(), outputContainer_, 0);
+        if (incReader_)
+            readFolderIncremental(travCfg_, Zstring(), incReader_->getLastSyncState(), outputContainer_, 0); //throw ThreadInterruption
+        else if (!workload_)
+        {
+            DirCallback cb(travCfg_, Zstring(), outputContainer_, 0);
 
-        AFS::traverseFolder(travCfg_.baseFolderPath_, cb); //throw ThreadInterruption
+            AFS::traverseFolder(travCfg_.baseFolderPath_, cb); //throw ThreadInterruption
+        }
+        else
+            while (Opt<FolderWorkload::Job> job = workload_->pop(travCfg_.workerIdx_)) //throw ThreadInterruption
+            {
+                {
+                    DirCallback cb(travCfg_, job->folderRelPath.empty() ? Zstring() : job->folderRelPath + FILE_NAME_SEPARATOR, *job->folderCont, job->level);
+
+                    AFS::traverseFolder(AFS::appendRelPath(travCfg_.baseFolderPath_, job->folderRelPath), cb); //throw ThreadInterruption
+                }
+                workload_->jobDone();
+            }
     }
 
 private:
     std::shared_ptr<AsyncCallback> acb_;
+    IoCounters* const ioCounters_;
     FolderContainer& outputContainer_;
+    std::shared_ptr<std::mutex> lockFailedReads_;
+    std::shared_ptr<FolderWorkload> workload_;
+    std::shared_ptr<IncrementalReader> incReader_;
     TraverserConfig travCfg_;
 };
 }
 
 
 void zen::fillBuffer(const std::set<DirectoryKey>& keysToRead, //in
+                     const std::map<DirectoryKey, IncrementalScan>& incrementalScans, //in
+                     const std::map<DirectoryKey, IoCounters*>& ioCounters, //in
                      std::map<DirectoryKey, DirectoryValue>& buf, //out
                      FillBufferCallback& callback,
+                     size_t threadsPerFolder,
                      size_t updateIntervalMs)
 {
     buf.clear();
 
     FixedList<InterruptibleThread> worker;
+    std::vector<int> workerThreadIds; //traverser threads of the same base folder share one thread ID
 
     ZEN_ON_SCOPE_FAIL
     (
@@ -540,21 +843,51 @@ void zen::fillBuffer(const std::set<DirectoryKey>& keysToRead, //in
     auto acb = std::make_shared<AsyncCallback>(updateIntervalMs / 2 /*reportingIntervalMs*/);
 
     //init worker threads
+    int threadId = 0;
     for (const DirectoryKey& key : keysToRead)
     {
         assert(buf.find(key) == buf.end());
         DirectoryValue& dirOutput = buf[key];
 
-        const int threadId = static_cast<int>(worker.size());
-        worker.emplace_back(WorkerThread(threadId,
-                                         acb,
-                                         key.folderPath_, //AbstractPath is thread-safe like an int! :)
-                                         key.filter_,
-                                         key.handleSymlinks_,
-                                         dirOutput));
+        auto lockFailedReads = std::make_shared<std::mutex>();
+
+        std::shared_ptr<IncrementalReader> incReader;
+        auto itInc = incrementalScans.find(key);
+        if (itInc != incrementalScans.end())
+            incReader = std::make_shared<IncrementalReader>(itInc->second);
+
+        auto itIo = ioCounters.find(key);
+
+        std::shared_ptr<FolderWorkload> workload;
+        if (threadsPerFolder > 1 && !incReader) //incremental scan: few folders to read => single thread
+        {
+            workload = std::make_shared<FolderWorkload>(threadsPerFolder);
+            workload->push(0, { Zstring(), &dirOutput.folderCont, 0 });
+        }
+
+        for (size_t workerIdx = 0; workerIdx < (workload ? workload->getThreadCount() : 1); ++workerIdx)
+        {
+            dirOutput.scanArenas.emplace_back();
+
+            worker.emplace_back(WorkerThread(threadId,
+                                             acb,
+                                             key.folderPath_, //AbstractPath is thread-safe like an int! :)
+                                             key.filter_,
+                                             key.handleSymlinks_,
+                                             dirOutput,
+                                             dirOutput.scanArenas.back(),
+                                             lockFailedReads,
+                                             workload,
+                                             incReader,
+                                             workerIdx,
+                                             itIo != ioCounters.end() ? itIo->second : nullptr));
+            workerThreadIds.push_back(threadId);
+        }
+        ++threadId;
     }
 
     //wait until done
+    auto itThreadId = workerThreadIds.begin();
     for (InterruptibleThread& wt : worker)
     {
         do
@@ -567,6 +900,8 @@ void zen::fillBuffer(const std::set<DirectoryKey>& keysToRead, //in
         }
         while (!wt.tryJoinFor(std::chrono::milliseconds(updateIntervalMs)));
 
-        acb->incrementNotifyingThreadId(); //process info messages of one thread at a time only
+        const int finishedId = *itThreadId++;
+        if (itThreadId == workerThreadIds.end() || *itThreadId != finishedId)
+            acb->incrementNotifyingThreadId(); //process info messages of one base folder at a time only
     }
 }
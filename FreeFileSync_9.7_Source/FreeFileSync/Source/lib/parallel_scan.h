@@ -16,6 +16,8 @@
 
 namespace zen
 {
+struct InSyncFolder;
+
 struct DirectoryKey
 {
     DirectoryKey(const AbstractPath& folderPath,
@@ -49,6 +51,8 @@ bool operator<(const DirectoryKey& lhs, const DirectoryKey& rhs)
 struct DirectoryValue
 {
     FolderContainer folderCont;
+    FixedList<ScanArena> scanArenas; //one per traverser thread: item names and subfolder containers of folderCont
+
     //relative names (or empty string for root) for directories that could not be read (completely), e.g. access denied, or temporal network drop
     std::map<Zstring, std::wstring, LessFilePath> failedFolderReads; //with corresponding error message
 
@@ -70,11 +74,22 @@ struct FillBufferCallback
     virtual void        reportStatus(const std::wstring& msg, int    itemsTotal ) = 0; //
 };
 
+//incremental scan: re-read only folders affected by known changes, take all other items from the last synchronous state
+struct IncrementalScan
+{
+    std::shared_ptr<const InSyncFolder> lastSyncState; //always bound!
+    SelectedSide side = LEFT_SIDE;
+    std::set<Zstring, LessFilePath> changedRelPaths; //items changed on *either* side of the folder pair
+};
+
 //attention: ensure directory filtering is applied later to exclude filtered directories which have been kept as parent folders
 
 void fillBuffer(const std::set<DirectoryKey>& keysToRead, //in
+                const std::map<DirectoryKey, IncrementalScan>& incrementalScans, //in: subset of keysToRead
+                const std::map<DirectoryKey, IoCounters*>& ioCounters, //in: I/O statistics per folder; optional, subset of keysToRead
                 std::map<DirectoryKey, DirectoryValue>& buf, //out
                 FillBufferCallback& callback,
+                size_t threadsPerFolder, //> 1: traverse subfolders of each base folder in parallel (work-stealing)
                 size_t updateIntervalMs); //unit: [ms]
 }
 
@@ -919,6 +919,12 @@ void readConfig(const XmlIn& in, SyncConfig& syncCfg)
     in["DeletionPolicy"  ](syncCfg.handleDeletion);
     in["VersioningFolder"](syncCfg.versioningFolderPhrase);
     in["VersioningFolder"].attribute("Style", syncCfg.versioningStyle);
+    //TODO: remove if clause after migration! 2026-10-18
+    if (in["VersioningLimit"])
+    {
+        in["VersioningLimit"].attribute("MaxCount",   syncCfg.versionCountMax);
+        in["VersioningLimit"].attribute("MaxAgeDays", syncCfg.versionMaxAgeDays);
+    }
 }
 
 
@@ -1102,6 +1108,12 @@ void readConfig(const XmlIn& in, BatchExclusiveConfig& config, int formatVer)
     inBatchCfg["RunMinimized" ](config.runMinimized);
     inBatchCfg["LogfileFolder"](config.logFolderPathPhrase);
     inBatchCfg["LogfileFolder"].attribute("Limit", config.logfilesCountLimit);
+    //TODO: remove if clause after migration! 2026-10-18
+    if (inBatchCfg["CleanupVersionsOnly"])
+        inBatchCfg["CleanupVersionsOnly"](config.cleanupVersionsOnly);
+    //TODO: remove if clause after migration! 2026-10-18
+    if (inBatchCfg["IoStatistics"])
+        inBatchCfg["IoStatistics"](config.saveIoStatistics);
 }
 
 
@@ -1162,6 +1174,22 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& config, int formatVer)
     inGeneral["AutomaticRetry"           ].attribute("Delay",   config.automaticRetryDelay);
     inGeneral["FileTimeTolerance"        ].attribute("Seconds", config.fileTimeTolerance);
     inGeneral["FolderAccessTimeout"      ].attribute("Seconds", config.folderAccessTimeout);
+    //TODO: remove if clause after migration! 2026-10-18
+    if (inGeneral["FolderTraversal"])
+        inGeneral["FolderTraversal"].attribute("ThreadsPerFolder", config.traverserThreadsPerFolder);
+    //TODO: remove if clause after migration! 2026-10-18
+    if (inGeneral["CompareContent"])
+    {
+        inGeneral["CompareContent"].attribute("Threads",       config.contentCompareThreads);
+        inGeneral["CompareContent"].attribute("SkipUnchanged", config.contentCompareSkipUnchanged);
+    }
+    //TODO: remove if clause after migration! 2026-10-18
+    if (inGeneral["Synchronization"])
+    {
+        inGeneral["Synchronization"].attribute("ThreadsPerFolderPair", config.syncThreadsPerFolderPair);
+        inGeneral["Synchronization"].attribute("ParallelFolderPairs",  config.syncParallelFolderPairs);
+        inGeneral["Synchronization"].attribute("PipelineFolderPairs",  config.syncPipelineFolderPairs);
+    }
     inGeneral["RunWithBackgroundPriority"].attribute("Enabled", config.runWithBackgroundPriority);
     inGeneral["LockDirectoriesDuringSync"].attribute("Enabled", config.createLockFile);
     inGeneral["VerifyCopiedFiles"        ].attribute("Enabled", config.verifyFileCopy);
@@ -1531,6 +1559,8 @@ void writeConfig(const SyncConfig& syncCfg, XmlOut& out)
     out["DeletionPolicy"  ](syncCfg.handleDeletion);
     out["VersioningFolder"](syncCfg.versioningFolderPhrase);
     out["VersioningFolder"].attribute("Style", syncCfg.versioningStyle);
+    out["VersioningLimit"].attribute("MaxCount",   syncCfg.versionCountMax);
+    out["VersioningLimit"].attribute("MaxAgeDays", syncCfg.versionMaxAgeDays);
 }
 
 
@@ -1639,6 +1669,8 @@ void writeConfig(const BatchExclusiveConfig& config, XmlOut& out)
     outBatchCfg["RunMinimized" ](config.runMinimized);
     outBatchCfg["LogfileFolder"](config.logFolderPathPhrase);
     outBatchCfg["LogfileFolder"].attribute("Limit", config.logfilesCountLimit);
+    outBatchCfg["CleanupVersionsOnly"](config.cleanupVersionsOnly);
+    outBatchCfg["IoStatistics"](config.saveIoStatistics);
 }
 
 
@@ -1662,6 +1694,12 @@ void writeConfig(const XmlGlobalSettings& config, XmlOut& out)
     outGeneral["AutomaticRetry"           ].attribute("Delay",   config.automaticRetryDelay);
     outGeneral["FileTimeTolerance"        ].attribute("Seconds", config.fileTimeTolerance);
     outGeneral["FolderAccessTimeout"      ].attribute("Seconds", config.folderAccessTimeout);
+    outGeneral["FolderTraversal"          ].attribute("ThreadsPerFolder", config.traverserThreadsPerFolder);
+    outGeneral["CompareContent"           ].attribute("Threads",       config.contentCompareThreads);
+    outGeneral["CompareContent"           ].attribute("SkipUnchanged", config.contentCompareSkipUnchanged);
+    outGeneral["Synchronization"          ].attribute("ThreadsPerFolderPair", config.syncThreadsPerFolderPair);
+    outGeneral["Synchronization"          ].attribute("ParallelFolderPairs",  config.syncParallelFolderPairs);
+    outGeneral["Synchronization"          ].attribute("PipelineFolderPairs",  config.syncPipelineFolderPairs);
     outGeneral["RunWithBackgroundPriority"].attribute("Enabled", config.runWithBackgroundPriority);
     outGeneral["LockDirectoriesDuringSync"].attribute("Enabled", config.createLockFile);
     outGeneral["VerifyCopiedFiles"        ].attribute("Enabled", config.verifyFileCopy);
@@ -14,6 +14,7 @@
 #include "../ui/file_grid_attr.h"
 #include "../ui/tree_grid_attr.h" //RTS: avoid tree grid's "file_hierarchy.h" dependency!
 #include "../ui/cfg_grid.h"
+#include "optional_dialogs.h"
 
 
 namespace xmlAccess
@@ -72,6 +73,8 @@ struct BatchExclusiveConfig
     PostSyncAction postSyncAction = PostSyncAction::SUMMARY;
     Zstring logFolderPathPhrase;
     int logfilesCountLimit = -1; //max logfiles; 0 := don't save logfiles; < 0 := no limit
+    bool cleanupVersionsOnly = false; //don't compare and sync: remove obsolete versions from the versioning folders only (see SyncConfig::versionCountMax)
+    bool saveIoStatistics = false; //time file system operations per folder pair: summary in log file + "<log file name>.json"
 };
 
 
@@ -82,24 +85,6 @@ struct XmlBatchConfig
 };
 
 
-struct OptionalDialogs
-{
-    bool warnDependentFolderPair          = true;
-    bool warnDependentBaseFolders         = true;
-    bool warnSignificantDifference        = true;
-    bool warnNotEnoughDiskSpace           = true;
-    bool warnUnresolvedConflicts          = true;
-    bool warnModificationTimeError        = true;
-    bool warnRecyclerMissing              = true;
-    bool warnInputFieldEmpty              = true;
-    bool warnDirectoryLockFailed          = true;
-    bool warnVersioningFolderPartOfSync   = true;
-    bool popupOnConfigChange              = true;
-    bool confirmSyncStart                 = true;
-    bool confirmExternalCommandMassInvoke = true;
-};
-
-
 enum FileIconSize
 {
     ICON_SIZE_SMALL,
@@ -159,6 +144,12 @@ struct XmlGlobalSettings
 
     int fileTimeTolerance = 2; //max. allowed file time deviation; < 0 means unlimited tolerance; default 2s: FAT vs NTFS
     int folderAccessTimeout = 20; //unit: [s]; consider CD-ROM insert or hard disk spin up time from sleep
+    size_t traverserThreadsPerFolder = 1; //> 1: read subfolders of a single base folder in parallel; helps with high-latency storage
+    size_t contentCompareThreads = 1; //number of file pairs compared in parallel during "compare by content"
+    bool contentCompareSkipUnchanged = true; //trust sync database: don't read files again that are unchanged since found equal
+    size_t syncThreadsPerFolderPair = 1; //number of file operations executed in parallel during synchronization of a folder pair
+    size_t syncParallelFolderPairs = 1; //number of folder pairs synchronized in parallel; folder pairs writing to the same device are always synchronized one after another
+    bool syncPipelineFolderPairs = false; //batch mode: synchronize each folder pair as soon as it is compared, while the following folder pairs are still being compared
     bool runWithBackgroundPriority = false;
     bool createLockFile = true;
     bool verifyFileCopy = false;
@@ -10,6 +10,7 @@
 #include <zen/optional.h>
 #include <zen/file_error.h>
 #include "../process_callback.h"
+#include "../fs/abstract.h"
 
 
 namespace zen
@@ -85,6 +86,16 @@ private:
     ProcessCallback& cb_;
     const int exeptionCount_ = getUncaughtExceptionCount();
 };
+
+
+//I/O statistics of a folder pair; nullptr if not collected
+inline
+IoCounters* getIoCounters(const AbstractPath& folderPathL, const AbstractPath& folderPathR, ProcessCallback& callback)
+{
+    if (IoStatistics* ioStats = callback.getIoStatistics())
+        return &ioStats->getFolderPairCounters(AbstractFileSystem::getDisplayPath(folderPathL), AbstractFileSystem::getDisplayPath(folderPathR));
+    return nullptr;
+}
 }
 
 #endif //STATUS_HANDLER_IMPL_H_07682758976
@@ -0,0 +1,298 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "sync_pipeline.h"
+#include <zen/scope_guard.h>
+#include <zen/thread.h>
+#include "async_process_callback.h"
+#include "../algorithm.h"
+#include "../comparison.h"
+#include "../synchronization.h"
+#include "../fs/concrete.h"
+
+using namespace zen;
+using namespace xmlAccess;
+
+
+namespace
+{
+//group folder pairs into stages that are compared and synchronized together: returns index of first folder pair of each stage
+//a stage must not depend on any of the previous stages: these may still be synchronizing while it is compared
+std::vector<size_t> getPipelineStages(const std::vector<FolderPairCfg>& cmpConfig, const std::vector<FolderPairSyncCfg>& syncConfig)
+{
+    assert(cmpConfig.size() == syncConfig.size());
+    const NullFilter nullFilter;
+
+    struct FolderAccess
+    {
+        AbstractPath folderPath;
+        const HardFilter* filter;
+    };
+    std::vector<std::vector<FolderAccess>> folderPairs;
+
+    for (size_t i = 0; i < cmpConfig.size(); ++i)
+    {
+        std::vector<FolderAccess> folders;
+        auto addFolder = [&](const Zstring& folderPathPhrase, const HardFilter& filter)
+        {
+            const AbstractPath folderPath = createAbstractPath(folderPathPhrase);
+            if (!AFS::isNullPath(folderPath))
+                folders.push_back({ folderPath, &filter });
+        };
+        addFolder(cmpConfig[i].folderPathPhraseLeft_,  *cmpConfig[i].filter.nameFilter);
+        addFolder(cmpConfig[i].folderPathPhraseRight_, *cmpConfig[i].filter.nameFilter);
+
+        if (syncConfig[i].handleDeletion == DeletionPolicy::VERSIONING)
+            addFolder(syncConfig[i].versioningFolderPhrase, nullFilter);
+
+        folderPairs.push_back(folders);
+    }
+
+    auto dependsOn = [&](size_t lhs, size_t rhs)
+    {
+        for (const FolderAccess& folderL : folderPairs[lhs])
+            for (const FolderAccess& folderR : folderPairs[rhs])
+                if (getPathDependency(folderL.folderPath, *folderL.filter,
+                                      folderR.folderPath, *folderR.filter))
+                    return true;
+        return false;
+    };
+
+    std::vector<size_t> stageBegins;
+    for (size_t i = 0; i < folderPairs.size(); ++i)
+    {
+        size_t firstDependency = i;
+        for (size_t j = 0; j < i; ++j)
+            if (dependsOn(j, i))
+            {
+                firstDependency = j;
+                break;
+            }
+
+        if (firstDependency == i)
+            stageBegins.push_back(i);
+        else //merge all stages from the one containing the dependency up to this folder pair
+            while (stageBegins.back() > firstDependency)
+                stageBegins.pop_back();
+    }
+    return stageBegins;
+}
+
+
+//relay callbacks of comparison and synchronization running at the same time: synchronization takes over progress reporting as soon as it starts
+class PipelineCallback : public ProcessCallback
+{
+public:
+    PipelineCallback(ProcessCallback& callback, bool reportsSync, bool& syncStarted) : callback_(callback), reportsSync_(reportsSync), syncStarted_(syncStarted) {}
+
+    void initNewPhase(int itemsTotal, int64_t bytesTotal, Phase phaseId) override //throw X
+    {
+        if (reportsSync_ && syncStarted_) //synchronization of the next stage: continue the current phase
+            callback_.updateTotalData(itemsTotal, bytesTotal);
+        else if (showProgress())
+        {
+            callback_.initNewPhase(itemsTotal, bytesTotal, phaseId); //throw X
+            if (reportsSync_)
+                syncStarted_ = true;
+        }
+    }
+
+    void updateProcessedData(int itemsDelta, int64_t bytesDelta) override { if (showProgress()) callback_.updateProcessedData(itemsDelta, bytesDelta); } //noexcept
+    void updateTotalData    (int itemsDelta, int64_t bytesDelta) override { if (showProgress()) callback_.updateTotalData    (itemsDelta, bytesDelta); } //
+
+    void requestUiRefresh() override { callback_.requestUiRefresh(); } //throw X
+    void forceUiRefresh  () override { callback_.forceUiRefresh  (); } //
+
+    void reportStatus(const std::wstring& text) override //throw X
+    {
+        if (showProgress())
+            callback_.reportStatus(text); //throw X
+        else
+            callback_.requestUiRefresh(); //throw X
+    }
+    void reportInfo(const std::wstring& text) override { callback_.reportInfo(text); } //throw X
+
+    void reportWarning(const std::wstring& warningMessage, bool& warningActive) override { callback_.reportWarning(warningMessage, warningActive); } //throw X
+
+    Response reportError     (const std::wstring& errorMessage, size_t retryNumber) override { return callback_.reportError(errorMessage, retryNumber); } //throw X
+    void     reportFatalError(const std::wstring& errorMessage)                     override { callback_.reportFatalError(errorMessage); }                 //
+
+    void abortProcessNow() override { callback_.abortProcessNow(); } //throw X
+
+    IoStatistics* getIoStatistics() override { return callback_.getIoStatistics(); }
+
+private:
+    //comparison after synchronization has started: show errors and log messages, but not its progress
+    bool showProgress() const { return reportsSync_ || !syncStarted_; }
+
+    ProcessCallback& callback_;
+    const bool reportsSync_;
+    bool& syncStarted_;
+};
+}
+
+
+std::vector<Zstring> zen::compareAndSynchronize(const std::chrono::system_clock::time_point& syncStartTime,
+                                                XmlGlobalSettings& globalCfg,
+                                                bool allowUserInteraction,
+                                                const ChangeList* changeList,
+                                                const MainConfiguration& mainCfg,
+                                                ProcessCallback& callback)
+{
+    const std::vector<FolderPairCfg>     cmpConfig  = extractCompareCfg(mainCfg);
+    const std::vector<FolderPairSyncCfg> syncConfig = extractSyncCfg   (mainCfg);
+    if (cmpConfig.size() != syncConfig.size())
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ":" + numberTo<std::string>(__LINE__));
+
+    const std::vector<size_t> stageBegins = getPipelineStages(cmpConfig, syncConfig);
+    const size_t stageCount = stageBegins.size();
+
+    //batch mode: place directory locks on directories during both comparison AND synchronization
+    std::vector<std::unique_ptr<LockHolder>> dirLocks(stageCount);
+
+    std::vector<Zstring> outOfSyncItemPaths; //written by synchronizeStage() only
+
+    auto compareStage = [&](size_t stageIdx, ProcessCallback& cb)
+    {
+        const size_t stageEnd = stageIdx + 1 < stageCount ? stageBegins[stageIdx + 1] : cmpConfig.size();
+
+        return compare(globalCfg.optDialogs,
+                       globalCfg.fileTimeTolerance,
+                       allowUserInteraction,
+                       globalCfg.runWithBackgroundPriority,
+                       globalCfg.folderAccessTimeout,
+                       globalCfg.traverserThreadsPerFolder,
+                       globalCfg.contentCompareThreads,
+                       globalCfg.contentCompareSkipUnchanged,
+                       changeList,
+                       globalCfg.createLockFile,
+                       dirLocks[stageIdx],
+                       std::vector<FolderPairCfg>(cmpConfig.begin() + stageBegins[stageIdx], cmpConfig.begin() + stageEnd),
+                       cb); //throw X
+    };
+
+    auto synchronizeStage = [&](size_t stageIdx, FolderComparison& folderCmp, ProcessCallback& cb)
+    {
+        const size_t stageEnd = stageIdx + 1 < stageCount ? stageBegins[stageIdx + 1] : syncConfig.size();
+
+        synchronize(syncStartTime,
+                    globalCfg.verifyFileCopy,
+                    globalCfg.copyLockedFiles,
+                    globalCfg.copyFilePermissions,
+                    globalCfg.failSafeFileCopy,
+                    globalCfg.runWithBackgroundPriority,
+                    globalCfg.folderAccessTimeout,
+                    globalCfg.syncThreadsPerFolderPair,
+                    globalCfg.syncParallelFolderPairs,
+                    std::vector<FolderPairSyncCfg>(syncConfig.begin() + stageBegins[stageIdx], syncConfig.begin() + stageEnd),
+                    folderCmp,
+                    globalCfg.optDialogs,
+                    cb); //throw X
+
+        const std::vector<Zstring> itemPaths = getOutOfSyncItemPaths(folderCmp);
+        outOfSyncItemPaths.insert(outOfSyncItemPaths.end(), itemPaths.begin(), itemPaths.end());
+    };
+
+    if (stageCount <= 1) //nothing to overlap
+    {
+        FolderComparison folderCmp = compareStage(0, callback); //throw X
+        synchronizeStage(0, folderCmp, callback); //throw X
+        return outOfSyncItemPaths;
+    }
+
+    //comparison and synchronization run on worker threads, callbacks are forwarded by the main thread
+    std::vector<FolderComparison> folderCmpStages(stageCount);
+    std::mutex lockStages; //protects the following:
+    std::condition_variable conditionStageCompared;
+    size_t stagesCompared = 0;
+    bool comparisonDone = false;
+
+    bool syncStarted = false;
+    PipelineCallback cbCompare(callback, false /*reportsSync*/, syncStarted);
+    PipelineCallback cbSync   (callback, true  /*reportsSync*/, syncStarted);
+    AsyncProcessCallback acbCompare(callback.getIoStatistics());
+    AsyncProcessCallback acbSync   (callback.getIoStatistics());
+
+    std::exception_ptr errorCompare; //e.g. std::bad_alloc
+    std::exception_ptr errorSync;    //
+
+    std::vector<InterruptibleThread> worker;
+    ZEN_ON_SCOPE_FAIL
+    (
+        for (InterruptibleThread& wt : worker)
+        wt.interrupt(); //interrupt all first, then join
+        for (InterruptibleThread& wt : worker)
+            if (wt.joinable()) //= precondition of thread::join(), which throws an exception if violated!
+                wt.join();     //in this context it is possible a thread is *not* joinable anymore due to the thread::try_join_for() below!
+            );
+
+    worker.emplace_back([&]
+    {
+        setCurrentThreadName("Pipeline Compare");
+        try
+        {
+            for (size_t stageIdx = 0; stageIdx < stageCount; ++stageIdx)
+            {
+                FolderComparison folderCmp = compareStage(stageIdx, acbCompare); //throw ThreadInterruption
+                {
+                    std::lock_guard<std::mutex> dummy(lockStages);
+                    folderCmpStages[stageIdx] = std::move(folderCmp);
+                    ++stagesCompared;
+                }
+                conditionStageCompared.notify_all();
+            }
+        }
+        catch (ThreadInterruption&) { throw; } //main thread interrupts both workers
+        catch (...) { errorCompare = std::current_exception(); }
+
+        {
+            std::lock_guard<std::mutex> dummy(lockStages);
+            comparisonDone = true;
+        }
+        conditionStageCompared.notify_all();
+    });
+
+    worker.emplace_back([&]
+    {
+        setCurrentThreadName("Pipeline Sync");
+        try
+        {
+            for (size_t stageIdx = 0; stageIdx < stageCount; ++stageIdx)
+            {
+                FolderComparison folderCmp;
+                {
+                    std::unique_lock<std::mutex> dummy(lockStages);
+                    interruptibleWait(conditionStageCompared, dummy, [&] { return stagesCompared > stageIdx || comparisonDone; }); //throw ThreadInterruption
+                    if (stagesCompared <= stageIdx)
+                        return; //comparison failed
+                    folderCmp.swap(folderCmpStages[stageIdx]); //release memory right after synchronization
+                }
+                synchronizeStage(stageIdx, folderCmp, acbSync); //throw ThreadInterruption
+            }
+        }
+        catch (ThreadInterruption&) { throw; }
+        catch (...) { errorSync = std::current_exception(); }
+    });
+
+    //wait until done
+    for (InterruptibleThread& wt : worker)
+        while (!wt.tryJoinFor(std::chrono::milliseconds(UI_UPDATE_INTERVAL_MS / 2)))
+        {
+            acbCompare.forwardRequests(cbCompare); //throw X
+            acbSync   .forwardRequests(cbSync);    //throw X
+            callback.requestUiRefresh(); //throw X
+        }
+
+    acbCompare.forwardRequests(cbCompare); //throw X: remaining statistics and messages
+    acbSync   .forwardRequests(cbSync);    //
+
+    if (errorCompare)
+        std::rethrow_exception(errorCompare);
+    if (errorSync)
+        std::rethrow_exception(errorSync);
+
+    return outOfSyncItemPaths;
+}
@@ -0,0 +1,33 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef SYNC_PIPELINE_H_3470598237450982374
+#define SYNC_PIPELINE_H_3470598237450982374
+
+#include <chrono>
+#include "process_xml.h"
+#include "change_list.h"
+#include "../process_callback.h"
+
+
+namespace zen
+{
+/*
+compare and synchronize folder pairs as a pipeline: each folder pair is synchronized as soon as it is compared, while comparison of the following folder pairs continues
+
+    - folder pairs depending on each other (e.g. target of one is source of another) are compared and synchronized together
+    - callback sees the phases of the first folder pairs, then one synchronization phase with the totals of all folder pairs compared so far
+    - returns the items still not in sync afterwards: see getOutOfSyncItemPaths()
+*/
+std::vector<Zstring> compareAndSynchronize(const std::chrono::system_clock::time_point& syncStartTime,
+                                           xmlAccess::XmlGlobalSettings& globalCfg, //in/out: optDialogs
+                                           bool allowUserInteraction,
+                                           const ChangeList* changeList, //optional: compare incrementally
+                                           const MainConfiguration& mainCfg,
+                                           ProcessCallback& callback);
+}
+
+#endif //SYNC_PIPELINE_H_3470598237450982374
@@ -1,6 +1,9 @@
 #include <zen/warn_static.h> //GS added 
 #include "versioning.h"
 #include <cstddef> //required by GCC 4.8.1 to find ptrdiff_t
+#include <deque>
+#include <zen/thread.h>
+#include <zen/scope_guard.h>
 
 using namespace zen;
 
@@ -63,6 +66,25 @@ bool impl::isMatchingVersion(const Zstring& shortname, const Zstring& shortnameV
 }
 
 
+Opt<std::pair<Zstring, Zstring>> impl::parseVersionName(const Zstring& shortnameVersioned) //e.g. "Sample.txt 2012-05-15 131513.txt" -> ("Sample.txt", "2012-05-15 131513")
+{
+    const size_t timeStampLen = 17; //"2012-05-15 131513"
+
+    //scheme: <filename>.<ext> YYYY-MM-DD HHMMSS.<ext> => try with and without extension
+    const Zstring extension = getFileExtension(shortnameVersioned);
+    for (const size_t extLen : { extension.empty() ? 0 : extension.size() + 1, static_cast<size_t>(0) })
+        if (shortnameVersioned.size() > extLen + timeStampLen + 1)
+        {
+            const size_t timeStampPos = shortnameVersioned.size() - extLen - timeStampLen;
+            const Zstring shortname(shortnameVersioned.c_str(), timeStampPos - 1);
+
+            if (impl::isMatchingVersion(shortname, shortnameVersioned))
+                return std::make_pair(shortname, Zstring(shortnameVersioned.c_str() + timeStampPos, timeStampLen));
+        }
+    return NoValue();
+}
+
+
 AbstractPath FileVersioner::generateVersionedPath(const Zstring& relativePath) const
 {
     assert(!startsWith(relativePath, FILE_NAME_SEPARATOR));
@@ -130,9 +152,23 @@ void moveExistingItemToVersioning(const AbstractPath& sourcePath, const Abstract
             {
                 AbstractPath intermediatePath = pd->existingPath;
                 for (const Zstring& itemName : std::vector<Zstring>(pd->relPath.begin(), pd->relPath.end() - 1))
-                    AFS::createFolderPlain(intermediatePath = AFS::appendRelPath(intermediatePath, itemName)); //throw FileError
+                    try
+                    {
+                        AFS::createFolderPlain(intermediatePath = AFS::appendRelPath(intermediatePath, itemName)); //throw FileError
+                    }
+                    catch (FileError&) //parallel file operations may create the same parent folder: fine if it exists now
+                    {
+                        Opt<AFS::ItemType> type;
+                        try { type = AFS::getItemTypeIfExists(intermediatePath); /*throw FileError*/ }
+                        catch (FileError&) {} //previous exception is more relevant
+
+                        if (!type || *type == AFS::ItemType::FILE)
+                            throw;
+                    }
                 return true;
             }
+            else //parent folder existing: may have been created by a parallel file operation after the first attempt failed => retry once
+                return true;
         }
         return false;
     };
@@ -221,6 +257,7 @@ bool FileVersioner::revisionFile(const FileDescriptor& fileDescr, const Zstring&
                                                                               nullptr /*onDeleteTargetFile*/, notifyUnbufferedIO);
             //result.errorModTime? => irrelevant for versioning!
         });
+        recordRevisionedItem(relativePath);
         return true;
     }
     else
@@ -228,12 +265,24 @@ bool FileVersioner::revisionFile(const FileDescriptor& fileDescr, const Zstring&
 }
 
 
+void FileVersioner::recordRevisionedItem(const Zstring& relativePath)
+{
+    if (versioningStyle_ == VersioningStyle::ADD_TIMESTAMP) //other styles have at most one version per item
+    {
+        std::lock_guard<std::mutex> dummy(lockRevisionedItems_);
+        revisionedItems_[beforeLast(relativePath, FILE_NAME_SEPARATOR, IF_MISSING_RETURN_NONE)].
+        insert(afterLast(relativePath, FILE_NAME_SEPARATOR, IF_MISSING_RETURN_ALL));
+    }
+}
+
+
 bool FileVersioner::revisionSymlink(const AbstractPath& linkPath, const Zstring& relativePath) //throw FileError
 {
     if (AFS::getItemTypeIfExists(linkPath)) //throw FileError
     {
         const AbstractPath targetPath = generateVersionedPath(relativePath);
         moveExistingItemToVersioning(linkPath, targetPath, [&] { AFS::copySymlink(linkPath, targetPath, false /*copy filesystem permissions*/); }); //throw FileError
+        recordRevisionedItem(relativePath);
         return true;
     }
     else
@@ -255,6 +304,7 @@ void FileVersioner::revisionFolder(const AbstractPath& folderPath, const Zstring
                 onBeforeFileMove(AFS::getDisplayPath(folderPath), AFS::getDisplayPath(targetPath));
 
             moveExistingItemToVersioning(folderPath, targetPath, [&] { AFS::copySymlink(folderPath, targetPath, false /*copy filesystem permissions*/); }); //throw FileError
+            recordRevisionedItem(relativePath);
         }
         else
             revisionFolderImpl(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); //throw FileError
@@ -294,6 +344,7 @@ void FileVersioner::revisionFolderImpl(const AbstractPath& folderPath, const Zst
                                                                               nullptr /*onDeleteTargetFile*/, notifyUnbufferedIO);
             //result.errorModTime? => irrelevant for versioning!
         });
+        recordRevisionedItem(relPathPf + fileInfo.itemName);
     }
 
     for (const auto& linkInfo: ft.refSymlinks())
@@ -305,6 +356,7 @@ void FileVersioner::revisionFolderImpl(const AbstractPath& folderPath, const Zst
             onBeforeFileMove(AFS::getDisplayPath(sourcePath), AFS::getDisplayPath(targetPath));
 
         moveExistingItemToVersioning(sourcePath, targetPath, [&] { AFS::copySymlink(sourcePath, targetPath, false /*copy filesystem permissions*/); }); //throw FileError
+        recordRevisionedItem(relPathPf + linkInfo.itemName);
     }
 
     //move folders recursively
@@ -320,71 +372,202 @@ void FileVersioner::revisionFolderImpl(const AbstractPath& folderPath, const Zst
 }
 
 
-/*
-void FileVersioner::limitVersions(std::function<void()> updateUI) //throw FileError
+namespace
 {
-    if (versionCountLimit_ < 0) //no limit!
-        return;
+struct CleanupTask
+{
+    Zstring relPath; //folder relative to versioning folder
+    std::set<Zstring, LessFilePath> itemNames; //limit versions of these items only; empty: all items and subfolders
+};
 
-    //buffer map "directory |-> list of immediate child file and symlink short names"
-    std::map<Zstring, std::vector<Zstring>, LessFilePath> dirBuffer;
 
-    auto getVersionsBuffered = [&](const Zstring& dirpath) -> const std::vector<Zstring>&
+//clean up versioning folders in parallel: each task lists one folder and removes its obsolete versions as a batch
+class VersionCleanup
+{
+public:
+    VersionCleanup(const AbstractPath& versioningFolderPath, int versionCountMax, int versionMaxAgeDays) :
+        versioningFolderPath_(versioningFolderPath),
+        versionCountMax_(versionCountMax),
+        //take advantage of version naming convention: time stamps compare lexicographically
+        timeStampMin_(versionMaxAgeDays <= 0 ? Zstring() :
+                      formatTime<Zstring>(Zstr("%Y-%m-%d %H%M%S"), getLocalTime(std::time(nullptr) - static_cast<time_t>(versionMaxAgeDays) * 24 * 3600))) {}
+
+    void run(std::deque<CleanupTask>&& tasks, size_t threadCount, //throw FileError, X
+             const std::function<void(const std::wstring& displayPath)>& onBeforeVersionDelete)
     {
-        auto it = dirBuffer.find(dirpath);
-        if (it != dirBuffer.end())
-            return it->second;
+        if (versionCountMax_ <= 0 && timeStampMin_.empty())
+            return;
 
-        std::vector<Zstring> fileShortNames;
-        TraverseVersionsOneLevel tol(fileShortNames, updateUI); //throw FileError
-        traverseFolder(dirpath, tol);
+        tasks_ = std::move(tasks);
+        tasksPending_ = tasks_.size();
 
-        auto& newEntry = dirBuffer[dirpath]; //transactional behavior!!!
-        newEntry.swap(fileShortNames);       //-> until C++11 emplace is available
+        std::vector<InterruptibleThread> worker;
+        ZEN_ON_SCOPE_EXIT(
+            for (InterruptibleThread& wt : worker) wt.interrupt(); //interrupt all first, then join
+            for (InterruptibleThread& wt : worker) wt.join();
+        );
 
-        return newEntry;
-    };
+        for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i)
+            worker.emplace_back([this, ioCounters = getCurrentIoCounters()]
+        {
+            setCurrentThreadName("Version Cleanup");
+            IoCountersScope ioScope(ioCounters);
+            runWorker(); //throw ThreadInterruption
+        });
 
-    std::for_each(fileRelNames.begin(), fileRelNames.end(),
-                  [&](const Zstring& relativePath) //e.g. "subdir\Sample.txt"
+        for (;;)
+        {
+            std::wstring displayPath;
+            {
+                std::unique_lock<std::mutex> dummy(lockTasks_);
+                conditionStatus_.wait_for(dummy, std::chrono::milliseconds(100), [this] { return tasksPending_ == 0 || !currentItem_.empty(); });
+
+                if (tasksPending_ == 0)
+                {
+                    if (error_)
+                        throw* error_;
+                    return;
+                }
+                displayPath.swap(currentItem_);
+            }
+
+            if (onBeforeVersionDelete)
+                onBeforeVersionDelete(displayPath); //throw X; empty path: just update UI
+        }
+    }
+
+private:
+    void runWorker() //throw ThreadInterruption
     {
-        const Zstring filepath = appendSeparator(versioningDirectory_) + relativePath; //e.g. "D:\Revisions\subdir\Sample.txt"
-        const Zstring parentDir = beforeLast(filepath, FILE_NAME_SEPARATOR);    //e.g. "D:\Revisions\subdir"
-        const Zstring shortname = afterLast(relativePath, FILE_NAME_SEPARATOR); //e.g. "Sample.txt"; returns the whole string if seperator not found
+        for (;;)
+        {
+            CleanupTask task;
+            {
+                std::unique_lock<std::mutex> dummy(lockTasks_);
+                interruptibleWait(conditionNewTask_, dummy, [this] { return !tasks_.empty(); }); //throw ThreadInterruption
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
 
-        const std::vector<Zstring>& allVersions = getVersionsBuffered(parentDir);
+            std::vector<CleanupTask> subTasks;
+            Opt<FileError> error;
+            try
+            {
+                cleanFolder(task, subTasks); //throw FileError, ThreadInterruption
+            }
+            catch (const FileError& e) { error = e; }
+
+            std::lock_guard<std::mutex> dummy(lockTasks_);
+            if (error && !error_)
+                error_ = error;
+
+            if (!error_) //stop on first error
+                for (CleanupTask& subTask : subTasks)
+                {
+                    tasks_.push_back(std::move(subTask));
+                    ++tasksPending_;
+                    conditionNewTask_.notify_one();
+                }
+            if (--tasksPending_ == 0 || error_)
+            {
+                tasksPending_ -= tasks_.size();
+                tasks_.clear();
+                conditionStatus_.notify_all();
+            }
+        }
+    }
 
-        //filter out only those versions that match the given relative name
-        std::vector<Zstring> matches; //e.g. "Sample.txt 2012-05-15 131513.txt"
+    void cleanFolder(const CleanupTask& task, std::vector<CleanupTask>& subTasks) //throw FileError, ThreadInterruption
+    {
+        const AbstractPath folderPath = task.relPath.empty() ? versioningFolderPath_ : AFS::appendRelPath(versioningFolderPath_, task.relPath);
 
-        std::copy_if(allVersions.begin(), allVersions.end(), std::back_inserter(matches),
-        [&](const Zstring& shortnameVer) { return impl::isMatchingVersion(shortname, shortnameVer); });
+        FlatTraverserCallback ft(folderPath); //traverse versioning folder one level deep
+        AFS::traverseFolder(folderPath, ft); //throw FileError
 
-        //take advantage of version naming convention to find oldest versions
-        if (matches.size() <= static_cast<size_t>(versionCountLimit_))
-            return;
-        std::nth_element(matches.begin(), matches.end() - versionCountLimit_, matches.end(), LessFilePath()); //windows: ignore case!
+        struct VersionItem
+        {
+            Zstring timeStamp;
+            Zstring itemName;
+            bool isSymlink;
+        };
+        std::map<Zstring, std::vector<VersionItem>, LessFilePath> versions; //original short name |-> versions
 
-        //delete obsolete versions
-        std::for_each(matches.begin(), matches.end() - versionCountLimit_,
-                      [&](const Zstring& shortnameVer)
+        auto addVersion = [&](const Zstring& shortnameVersioned, bool isSymlink)
         {
-            updateUI();
-            const Zstring fullnameVer = parentDir + FILE_NAME_SEPARATOR + shortnameVer;
-            try
-            {
-                removeFile(fullnameVer); //throw FileError
-            }
-            catch (FileError&)
+            if (Opt<std::pair<Zstring, Zstring>> parsed = impl::parseVersionName(shortnameVersioned))
+                if (task.itemNames.empty() || task.itemNames.find(parsed->first) != task.itemNames.end())
+                    versions[parsed->first].push_back({ parsed->second, shortnameVersioned, isSymlink });
+        };
+        for (const auto& fileInfo : ft.refFiles())
+            addVersion(fileInfo.itemName, false);
+        for (const auto& linkInfo : ft.refSymlinks())
+            addVersion(linkInfo.itemName, true);
+
+        for (auto& item : versions)
+        {
+            std::vector<VersionItem>& itemVersions = item.second;
+            std::sort(itemVersions.begin(), itemVersions.end(), [](const VersionItem& lhs, const VersionItem& rhs) { return rhs.timeStamp < lhs.timeStamp; }); //newest first
+
+            for (size_t i = 0; i < itemVersions.size(); ++i)
             {
-#ifdef ZEN_WIN //if it's a directory symlink:
-                if (symlinkExists(fullnameVer) && dirExists(fullnameVer))
-                    removeDirectory(fullnameVer); //throw FileError
-                else
-#endif
-                    throw;
+                const VersionItem& vi = itemVersions[i];
+                if ((versionCountMax_ > 0 && i >= static_cast<size_t>(versionCountMax_)) ||
+                    vi.timeStamp < timeStampMin_)
+                {
+                    const AbstractPath versionPath = AFS::appendRelPath(folderPath, vi.itemName);
+                    {
+                        std::lock_guard<std::mutex> dummy(lockTasks_);
+                        currentItem_ = AFS::getDisplayPath(versionPath);
+                        conditionStatus_.notify_all();
+                    }
+                    if (vi.isSymlink)
+                        AFS::removeSymlinkPlain(versionPath); //throw FileError
+                    else
+                        AFS::removeFilePlain(versionPath); //throw FileError
+                    interruptionPoint(); //throw ThreadInterruption
+                }
             }
-        });
-    });
+        }
+
+        if (task.itemNames.empty())
+            for (const auto& folderInfo : ft.refFolders())
+                subTasks.push_back({ task.relPath.empty() ? folderInfo.itemName : appendSeparator(task.relPath) + folderInfo.itemName, {} });
+    }
+
+    const AbstractPath versioningFolderPath_;
+    const int versionCountMax_;
+    const Zstring timeStampMin_; //empty: no age limit
+
+    std::mutex lockTasks_; //protects the following:
+    std::condition_variable conditionNewTask_;
+    std::condition_variable conditionStatus_;
+    std::deque<CleanupTask> tasks_;
+    size_t tasksPending_ = 0; //queued + running
+    Opt<FileError> error_;
+    std::wstring currentItem_;
+};
+}
+
+
+void FileVersioner::limitVersions(int versionCountMax, int versionMaxAgeDays, size_t threadCount, //throw FileError, X
+                                  const std::function<void(const std::wstring& displayPath)>& onBeforeVersionDelete)
+{
+    std::deque<CleanupTask> tasks;
+    for (const auto& item : revisionedItems_)
+        tasks.push_back({ item.first, item.second });
+
+    VersionCleanup(versioningFolderPath_, versionCountMax, versionMaxAgeDays).run(std::move(tasks), threadCount, onBeforeVersionDelete); //throw FileError, X
+
+    revisionedItems_.clear(); //not before success: keep the items for a retry
+}
+
+
+void zen::limitVersions(const AbstractPath& versioningFolderPath, //throw FileError, X
+                        int versionCountMax, int versionMaxAgeDays, size_t threadCount,
+                        const std::function<void(const std::wstring& displayPath)>& onBeforeVersionDelete)
+{
+    std::deque<CleanupTask> tasks;
+    tasks.push_back({ Zstring(), {} });
+
+    VersionCleanup(versioningFolderPath, versionCountMax, versionMaxAgeDays).run(std::move(tasks), threadCount, onBeforeVersionDelete); //throw FileError, X
 }
-*/
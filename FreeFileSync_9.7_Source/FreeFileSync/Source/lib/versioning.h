@@ -8,6 +8,9 @@
 #define VERSIONING_H_8760247652438056
 
 #include <functional>
+#include <map>
+#include <set>
+#include <mutex>
 #include <zen/time.h>
 #include <zen/file_error.h>
 #include "../structures.h"
@@ -25,6 +28,7 @@ namespace zen
     - does not create empty directories
     - handles symlinks
     - replaces already existing target files/dirs (supports retry)
+    - revision*() may be called concurrently for different items (parallel file operations)
         => (unlikely) risk of data loss for naming convention "versioning":
         race-condition if two FFS instances start at the very same second OR multiple folder pairs process the same filepath!!
 */
@@ -61,7 +65,10 @@ public:
                         //called frequently if move has to revert to copy + delete => see zen::copyFile for limitations when throwing exceptions!
                         const IOCallback& notifyUnbufferedIO);
 
-    //void limitVersions(std::function<void()> updateUI); //throw FileError; call when done revisioning!
+    //remove obsolete versions of the items revisioned so far: call when done revisioning!
+    //only the versioning folders of these items are read (one level deep, in parallel); no-op for VersioningStyle::REPLACE
+    void limitVersions(int versionCountMax, int versionMaxAgeDays, size_t threadCount, //throw FileError, X
+                       const std::function<void(const std::wstring& displayPath)>& onBeforeVersionDelete); //may be nullptr; called on calling thread only!
 
 private:
     void revisionFolderImpl(const AbstractPath& folderPath, const Zstring& relativePath,
@@ -70,17 +77,27 @@ private:
                             const IOCallback& notifyUnbufferedIO); //throw FileError
 
     AbstractPath generateVersionedPath(const Zstring& relativePath) const;
+    void recordRevisionedItem(const Zstring& relativePath);
 
     const AbstractPath versioningFolderPath_;
     const VersioningStyle versioningStyle_;
     const Zstring timeStamp_;
 
-    //std::vector<Zstring> fileRelNames; //store list of revisioned file and symlink relative names for limitVersions()
+    //revisioned file and symlink names for limitVersions(): folder relative path |-> item names
+    std::mutex lockRevisionedItems_; //revision*() may be called by parallel file operations
+    std::map<Zstring, std::set<Zstring, LessFilePath>, LessFilePath> revisionedItems_;
 };
 
+
+//standalone clean-up (e.g. scheduled batch job): traverse the complete versioning folder and remove obsolete versions of all items
+void limitVersions(const AbstractPath& versioningFolderPath, //throw FileError, X
+                   int versionCountMax, int versionMaxAgeDays, size_t threadCount,
+                   const std::function<void(const std::wstring& displayPath)>& onBeforeVersionDelete); //may be nullptr; called on calling thread only!
+
 namespace impl //declare for unit tests:
 {
 bool isMatchingVersion(const Zstring& shortname, const Zstring& shortnameVersion);
+Opt<std::pair<Zstring, Zstring>> parseVersionName(const Zstring& shortnameVersion); //return (original short name, time stamp)
 }
 }
 
@@ -10,6 +10,7 @@
 #include <string>
 #include <cstdint>
 
+namespace zen { class IoStatistics; }
 
 //interface for comparison and synchronization process status updates (used by GUI or Batch mode)
 const int UI_UPDATE_INTERVAL_MS = 100; //unit: [ms]; perform ui updates not more often than necessary,
@@ -72,6 +73,9 @@ struct ProcessCallback
     virtual void     reportFatalError(const std::wstring& errorMessage) = 0; //throw X; non-recoverable error situation
 
     virtual void abortProcessNow() = 0; //will throw an exception => don't call while in a C GUI callstack
+
+    //optional: collect timing and I/O counters per folder pair (see io_stats.h); nullptr: not collecting
+    virtual zen::IoStatistics* getIoStatistics() { return nullptr; }
 };
 
 #endif //PROCESS_CALLBACK_H_48257827842345454545
@@ -210,7 +210,9 @@ struct SyncConfig
     //versioning options
     VersioningStyle versioningStyle = VersioningStyle::REPLACE;
     Zstring versioningFolderPhrase;
-    //int versionCountLimit; //max versions per file (DeletionPolicy::VERSIONING); < 0 := no limit
+    //limit versions per file (VersioningStyle::ADD_TIMESTAMP only):
+    int versionCountMax   = 0; //keep newest versions only; 0 := no limit
+    int versionMaxAgeDays = 0; //remove older versions; 0 := no limit
 };
 
 
@@ -220,7 +222,9 @@ bool operator==(const SyncConfig& lhs, const SyncConfig& rhs)
     return lhs.directionCfg           == rhs.directionCfg   &&
            lhs.handleDeletion         == rhs.handleDeletion &&
            lhs.versioningStyle        == rhs.versioningStyle &&
-           lhs.versioningFolderPhrase == rhs.versioningFolderPhrase;
+           lhs.versioningFolderPhrase == rhs.versioningFolderPhrase &&
+           lhs.versionCountMax        == rhs.versionCountMax &&
+           lhs.versionMaxAgeDays      == rhs.versionMaxAgeDays;
     //adapt effectivelyEqual() on changes, too!
 }
 
@@ -232,7 +236,10 @@ bool effectivelyEqual(const SyncConfig& lhs, const SyncConfig& rhs)
            lhs.handleDeletion == rhs.handleDeletion &&
            (lhs.handleDeletion != DeletionPolicy::VERSIONING || //only compare deletion directory if required!
             (lhs.versioningStyle   == rhs.versioningStyle &&
-             lhs.versioningFolderPhrase == rhs.versioningFolderPhrase));
+             lhs.versioningFolderPhrase == rhs.versioningFolderPhrase &&
+             (lhs.versioningStyle != VersioningStyle::ADD_TIMESTAMP || //version limits apply to time-stamped versions only
+              (lhs.versionCountMax   == rhs.versionCountMax &&
+               lhs.versionMaxAgeDays == rhs.versionMaxAgeDays))));
 }
 
 
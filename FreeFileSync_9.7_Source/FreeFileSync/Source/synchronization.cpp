@@ -6,14 +6,20 @@
 
 #include "synchronization.h"
 #include <tuple>
+#include <list>
+#include <deque>
+#include <atomic>
 #include <zen/process_priority.h>
 #include <zen/perf.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/thread.h>
+#include <zen/file_access.h>
 #include "algorithm.h"
 #include "lib/db_file.h"
 #include "lib/dir_exist_async.h"
 #include "lib/status_handler_impl.h"
+#include "lib/async_process_callback.h"
 #include "lib/versioning.h"
 #include "lib/binary.h"
 #include "fs/concrete.h"
@@ -262,6 +268,8 @@ std::vector<zen::FolderPairSyncCfg> zen::extractSyncCfg(const MainConfiguration&
                               syncCfg.handleDeletion,
                               syncCfg.versioningStyle,
                               syncCfg.versioningFolderPhrase,
+                              syncCfg.versionCountMax,
+                              syncCfg.versionMaxAgeDays,
                               syncCfg.directionCfg.var));
     }
     return output;
@@ -329,6 +337,9 @@ public:
                      DeletionPolicy handleDel, //nothrow!
                      const Zstring& versioningFolderPhrase,
                      VersioningStyle versioningStyle,
+                     int versionCountMax,
+                     int versionMaxAgeDays,
+                     size_t threadCount,
                      const TimeComp& timeStamp,
                      ProcessCallback& procCallback);
     ~DeletionHandling()
@@ -346,7 +357,7 @@ public:
         */
     }
 
-    //clean-up temporary directory (recycle bin optimization)
+    //clean-up temporary directory (recycle bin optimization) and remove obsolete versions
     void tryCleanup(bool allowUserCallback); //throw FileError; throw X -> call this in non-exceptional coding, i.e. somewhere after sync!
 
     template <class Function> void removeFileWithCallback (const FileDescriptor& fileDescr, const Zstring& relativePath, Function onNotifyItemDeletion, const IOCallback& notifyUnbufferedIO); //
@@ -364,6 +375,7 @@ private:
     AFS::RecycleSession& getOrCreateRecyclerSession() //throw FileError => dont create in constructor!!!
     {
         assert(deletionPolicy_ == DeletionPolicy::RECYCLER);
+        std::lock_guard<std::mutex> dummy(lockSessions_);
         if (!recyclerSession_.get())
             recyclerSession_ =  AFS::createRecyclerSession(baseFolderPath_); //throw FileError
         return *recyclerSession_;
@@ -372,6 +384,7 @@ private:
     FileVersioner& getOrCreateVersioner() //throw FileError => dont create in constructor!!!
     {
         assert(deletionPolicy_ == DeletionPolicy::VERSIONING);
+        std::lock_guard<std::mutex> dummy(lockSessions_);
         if (!versioner_.get())
             versioner_ = std::make_unique<FileVersioner>(versioningFolderPath_, versioningStyle_, timeStamp_); //throw FileError
         return *versioner_;
@@ -381,12 +394,17 @@ private:
 
     const DeletionPolicy deletionPolicy_; //keep it invariant! e.g. consider getOrCreateVersioner() one-time construction!
 
+    std::mutex lockSessions_; //file deletions may run on worker threads: protect one-time creation of recycler and versioner (both are thread-safe)
+
     const AbstractPath baseFolderPath_;
     std::unique_ptr<AFS::RecycleSession> recyclerSession_;
 
     //used only for DeletionPolicy::VERSIONING:
     const AbstractPath versioningFolderPath_;
     const VersioningStyle versioningStyle_;
+    const int versionCountMax_;
+    const int versionMaxAgeDays_;
+    const size_t threadCount_;
     const TimeComp timeStamp_;
     std::unique_ptr<FileVersioner> versioner_; //throw FileError in constructor => create on demand!
 
@@ -404,6 +422,9 @@ DeletionHandling::DeletionHandling(const AbstractPath& baseFolderPath,
                                    DeletionPolicy handleDel, //nothrow!
                                    const Zstring& versioningFolderPhrase,
                                    VersioningStyle versioningStyle,
+                                   int versionCountMax,
+                                   int versionMaxAgeDays,
+                                   size_t threadCount,
                                    const TimeComp& timeStamp,
                                    ProcessCallback& procCallback) :
     procCallback_(procCallback),
@@ -411,6 +432,9 @@ DeletionHandling::DeletionHandling(const AbstractPath& baseFolderPath,
     baseFolderPath_(baseFolderPath),
     versioningFolderPath_(createAbstractPath(versioningFolderPhrase)),
     versioningStyle_(versioningStyle),
+    versionCountMax_(versionCountMax),
+    versionMaxAgeDays_(versionMaxAgeDays),
+    threadCount_(threadCount),
     timeStamp_(timeStamp),
     txtMovingFile_  (_("Moving file %x to %y")),
     txtMovingFolder_(_("Moving folder %x to %y"))
@@ -465,16 +489,19 @@ void DeletionHandling::tryCleanup(bool allowUserCallback) //throw FileError; thr
             break;
 
         case DeletionPolicy::VERSIONING:
-            //if (versioner.get())
-            //{
-            //    if (allowUserCallback)
-            //    {
-            //        procCallback_.reportStatus(_("Removing old versions...")); //throw ?
-            //        versioner->limitVersions([&] { procCallback_.requestUiRefresh(); /*throw ? */ }); //throw FileError
-            //    }
-            //    else
-            //        versioner->limitVersions([] {}); //throw FileError
-            //}
+            //don't delete old versions without user callback: sync was aborted or is being cleaned up after an error
+            if (versioner_.get() && allowUserCallback)
+            {
+                procCallback_.reportStatus(_("Removing old versions...")); //throw ?
+
+                versioner_->limitVersions(versionCountMax_, versionMaxAgeDays_, threadCount_, [&](const std::wstring& displayPath) //throw FileError
+                {
+                    if (!displayPath.empty())
+                        procCallback_.reportStatus(replaceCpy(_("Deleting file %x"), L"%x", fmtPath(displayPath))); //throw ?
+                    else
+                        procCallback_.requestUiRefresh(); //throw ?
+                });
+            }
             break;
     }
 }
@@ -659,6 +686,162 @@ private:
 
 //----------------------------------------------------------------------------------------
 
+//run file I/O of a folder pair sync on worker threads:
+//- operations must not access the file hierarchy or ProcessCallback: both are owned by the main thread
+//- progress is buffered per operation and forwarded by the main thread
+class AsyncFileOperations
+{
+public:
+    struct Result
+    {
+        Opt<AFS::FileCopyResult> copyResult; //file created or overwritten
+        bool sourceWasDeleted = false;       //source deleted meanwhile: nothing was done
+    };
+    using NotifyProgress = std::function<void(int itemsDelta, int64_t bytesDelta)>; //throw ThreadInterruption
+    using Operation      = std::function<Result(const NotifyProgress& notifyProgress)>; //throw FileError, ThreadInterruption
+
+    using OpId = size_t;
+
+    struct Status
+    {
+        int     itemsDelta = 0; //progress since last call to fetchStatus()
+        int64_t bytesDelta = 0; //
+        bool done = false;
+    };
+
+    explicit AsyncFileOperations(size_t threadCount)
+    {
+        for (size_t i = 0; i < threadCount; ++i)
+            worker_.emplace_back([shared = shared_, ioCounters = getCurrentIoCounters()]
+            {
+                setCurrentThreadName("Sync Worker");
+                IoCountersScope ioScope(ioCounters);
+
+                for (;;)
+                {
+                    OpId opId = 0;
+                    Operation op;
+                    {
+                        std::unique_lock<std::mutex> dummy(shared->lockOps);
+                        interruptibleWait(shared->conditionNewOp, dummy, [&] { return !shared->opsQueued.empty(); }); //throw ThreadInterruption
+                        opId = shared->opsQueued.front();
+                        shared->opsQueued.pop_front();
+                        std::swap(op, shared->ops.find(opId)->second.op);
+                    }
+
+                    auto notifyProgress = [&](int itemsDelta, int64_t bytesDelta)
+                    {
+                        {
+                            std::lock_guard<std::mutex> dummy(shared->lockOps);
+                            SharedData::OpStatus& os = shared->ops.find(opId)->second;
+                            os.itemsDelta += itemsDelta;
+                            os.bytesDelta += bytesDelta;
+                        }
+                        interruptionPoint(); //throw ThreadInterruption
+                    };
+
+                    Result result;
+                    Opt<FileError> error;
+                    try
+                    {
+                        result = op(notifyProgress); //throw FileError, ThreadInterruption
+                    }
+                    catch (const FileError& e) { error = e; }
+
+                    std::lock_guard<std::mutex> dummy(shared->lockOps);
+                    SharedData::OpStatus& os = shared->ops.find(opId)->second;
+                    os.result = result;
+                    os.error  = error;
+                    os.done   = true;
+                    ++shared->opsDoneUnreported;
+                    shared->conditionOpDone.notify_all();
+                }
+            });
+    }
+
+    ~AsyncFileOperations()
+    {
+        for (InterruptibleThread& wt : worker_)
+            wt.interrupt(); //interrupt all first, then join
+        for (InterruptibleThread& wt : worker_)
+            wt.join();
+    }
+
+    OpId addOperation(const Operation& op)
+    {
+        std::lock_guard<std::mutex> dummy(shared_->lockOps);
+        const OpId opId = shared_->nextOpId++;
+        shared_->ops[opId].op = op;
+        shared_->opsQueued.push_back(opId);
+        shared_->conditionNewOp.notify_one();
+        return opId;
+    }
+
+    //return early if some operation is done
+    void waitForProgress(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> dummy(shared_->lockOps);
+        shared_->conditionOpDone.wait_for(dummy, timeout, [&] { return shared_->opsDoneUnreported > 0; });
+    }
+
+    Status fetchStatus(OpId opId)
+    {
+        std::lock_guard<std::mutex> dummy(shared_->lockOps);
+        SharedData::OpStatus& os = shared_->ops.find(opId)->second;
+
+        Status status;
+        status.itemsDelta = os.itemsDelta;
+        status.bytesDelta = os.bytesDelta;
+        status.done       = os.done;
+        os.itemsDelta = 0;
+        os.bytesDelta = 0;
+        return status;
+    }
+
+    Result retrieveResult(OpId opId) //throw FileError; precondition: fetchStatus() reported "done"
+    {
+        std::lock_guard<std::mutex> dummy(shared_->lockOps);
+        auto it = shared_->ops.find(opId);
+        assert(it->second.done);
+        const SharedData::OpStatus os = std::move(it->second);
+        shared_->ops.erase(it);
+        --shared_->opsDoneUnreported;
+
+        if (os.error)
+            throw* os.error;
+        return os.result;
+    }
+
+private:
+    AsyncFileOperations           (const AsyncFileOperations&) = delete;
+    AsyncFileOperations& operator=(const AsyncFileOperations&) = delete;
+
+    struct SharedData
+    {
+        struct OpStatus
+        {
+            Operation op; //empty after worker thread took it
+            int     itemsDelta = 0;
+            int64_t bytesDelta = 0;
+            bool done = false;
+            Result result;
+            Opt<FileError> error;
+        };
+
+        std::mutex lockOps; //protects the following:
+        std::condition_variable conditionNewOp;
+        std::condition_variable conditionOpDone;
+        std::map<OpId, OpStatus> ops;
+        std::deque<OpId> opsQueued; //FIFO: process in order of traversal
+        OpId nextOpId = 0;
+        size_t opsDoneUnreported = 0;
+    };
+    const std::shared_ptr<SharedData> shared_ = std::make_shared<SharedData>();
+    std::vector<InterruptibleThread> worker_;
+};
+
+//----------------------------------------------------------------------------------------
+
 class SynchronizeFolderPair
 {
 public:
@@ -666,6 +849,7 @@ public:
                           bool verifyCopiedFiles,
                           bool copyFilePermissions,
                           bool failSafeFileCopy,
+                          size_t threadCount,
                           std::vector<FileError>& errorsModTime,
                           DeletionHandling& delHandlingLeft,
                           DeletionHandling& delHandlingRight) :
@@ -675,13 +859,20 @@ public:
         delHandlingRight_(delHandlingRight),
         verifyCopiedFiles_(verifyCopiedFiles),
         copyFilePermissions_(copyFilePermissions),
-        failSafeFileCopy_(failSafeFileCopy) {}
+        failSafeFileCopy_(failSafeFileCopy),
+        asyncOpsMax_(2 * threadCount) //keep workers busy while main thread is reporting
+    {
+        if (threadCount > 1)
+            asyncOps_ = std::make_unique<AsyncFileOperations>(threadCount);
+    }
 
     void startSync(BaseFolderPair& baseFolder)
     {
         runZeroPass(baseFolder);       //first process file moves
         runPass<PASS_ONE>(baseFolder); //delete files (or overwrite big ones with smaller ones)
+        processAsyncResults(0);        //all deletions must be finished before copying starts
         runPass<PASS_TWO>(baseFolder); //copy rest
+        processAsyncResults(0);
     }
 
 private:
@@ -709,6 +900,10 @@ private:
     void synchronizeFile(FilePair& file);
     template <SelectedSide side> void synchronizeFileInt(FilePair& file, SyncOperation syncOp);
 
+    bool synchronizeFileAsync(FilePair& file); //return false if operation needs to run synchronously
+    template <SelectedSide side> bool synchronizeFileAsyncInt(FilePair& file, SyncOperation syncOp);
+    void processAsyncResults(size_t pendingMax); //throw X; wait until at most "pendingMax" operations are pending
+
     void synchronizeLink(SymlinkPair& link);
     template <SelectedSide sideTrg> void synchronizeLinkInt(SymlinkPair& link, SyncOperation syncOp);
 
@@ -730,6 +925,14 @@ private:
                                              const std::function<void()>& onDeleteTargetFile,
                                              const IOCallback& notifyUnbufferedIO) const;
 
+    //thread-safe: no access to file hierarchy or ProcessCallback
+    AFS::FileCopyResult copyFileWithVerification(const FileDescriptor& sourceDescr, //throw FileError
+                                                 const AbstractPath& targetPath,
+                                                 const std::function<void()>& onDeleteTargetFile,
+                                                 const IOCallback& notifyUnbufferedIO,
+                                                 const std::function<void()>& onBeforeVerification, //optional
+                                                 const IOCallback& notifyVerificationIO) const;
+
     template <SelectedSide side>
     DeletionHandling& getDelHandling();
 
@@ -752,6 +955,17 @@ private:
     const std::wstring txtVerifying        {_("Verifying file %x"        )};
     const std::wstring txtWritingAttributes{_("Updating attributes of %x")};
     const std::wstring txtMovingFile       {_("Moving file %x to %y"     )};
+
+    struct AsyncFileOp
+    {
+        AsyncFileOperations::OpId opId = 0;
+        FilePair* file = nullptr;
+        std::unique_ptr<StatisticsReporter> statReporter;
+        std::function<void(const AsyncFileOperations::Result& result, StatisticsReporter& statReporter)> onSuccess; //update FilePair
+    };
+    const size_t asyncOpsMax_;
+    std::list<AsyncFileOp> asyncOpsPending_;
+    std::unique_ptr<AsyncFileOperations> asyncOps_; //optional; destroy first: join worker threads before anything else!
 };
 
 //---------------------------------------------------------------------------------------------------------------
@@ -1105,7 +1319,8 @@ void SynchronizeFolderPair::runPass(ContainerObject& hierObj) //throw X
     //synchronize files:
     for (FilePair& file : hierObj.refSubFiles())
         if (pass == this->getPass(file)) //"this->" required by two-pass lookup as enforced by GCC 4.7
-            tryReportingError([&] { synchronizeFile(file); }, procCallback_); //throw X
+            if (!synchronizeFileAsync(file)) //throw X
+                tryReportingError([&] { synchronizeFile(file); }, procCallback_); //throw X
 
     //synchronize symbolic links:
     for (SymlinkPair& symlink : hierObj.refSubLinks())
@@ -1349,6 +1564,244 @@ void SynchronizeFolderPair::synchronizeFileInt(FilePair& file, SyncOperation syn
     procCallback_.requestUiRefresh(); //may throw
 }
 
+//---------------------------------------------------------------------------------------------------------------
+
+/*
+parallel file operations: order requirements are met by the main thread
+- walks the hierarchy and creates/deletes folders synchronously *before* queueing child items
+- waits for all operations of PASS_ONE before starting PASS_TWO
+- file moves (0th pass) and their PASS_TWO completion (SO_MOVE_LEFT_TO/SO_MOVE_RIGHT_TO) are not run in parallel
+=> FilePair references stay valid while an operation is pending: the main thread never removes folders containing queued items
+*/
+inline
+bool SynchronizeFolderPair::synchronizeFileAsync(FilePair& file)
+{
+    if (!asyncOps_)
+        return false;
+
+    const SyncOperation syncOp = file.getSyncOperation();
+
+    if (Opt<SelectedSide> sideTrg = getTargetDirection(syncOp))
+    {
+        if (*sideTrg == LEFT_SIDE)
+            return synchronizeFileAsyncInt<LEFT_SIDE>(file, syncOp);
+        else
+            return synchronizeFileAsyncInt<RIGHT_SIDE>(file, syncOp);
+    }
+    return false;
+}
+
+
+template <SelectedSide sideTrg>
+bool SynchronizeFolderPair::synchronizeFileAsyncInt(FilePair& file, SyncOperation syncOp)
+{
+    static const SelectedSide sideSrc = OtherSide<sideTrg>::result;
+
+    //worker threads may only use data copied here! => see synchronizeFileInt() for the synchronous equivalent
+    AsyncFileOp asyncOp;
+    int64_t bytesExpected = 0;
+    AsyncFileOperations::Operation op;
+
+    switch (syncOp)
+    {
+        case SO_CREATE_NEW_LEFT:
+        case SO_CREATE_NEW_RIGHT:
+        {
+            if (auto parentFolder = dynamic_cast<const FolderPair*>(&file.parent()))
+                if (parentFolder->isEmpty<sideTrg>()) //parent directory creation failed: no need to show more errors
+                    return true;
+
+            const FileDescriptor sourceDescr{ file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>() };
+            const AbstractPath targetPath = file.getAbstractPath<sideTrg>();
+            reportInfo(txtCreatingFile, AFS::getDisplayPath(targetPath));
+
+            bytesExpected = file.getFileSize<sideSrc>();
+
+            op = [this, sourceDescr, targetPath](const AsyncFileOperations::NotifyProgress& notifyProgress)
+            {
+                AsyncFileOperations::Result result;
+                try
+                {
+                    result.copyResult = copyFileWithVerification(sourceDescr, targetPath,
+                                                                 nullptr, //onDeleteTargetFile: nothing to delete
+                    [&](int64_t bytesDelta) { notifyProgress(0, bytesDelta); },
+                    nullptr,
+                    [&](int64_t bytesDelta) { notifyProgress(0, 0); }); //throw FileError
+                }
+                catch (FileError&)
+                {
+                    bool sourceWasDeleted = false;
+                    try { sourceWasDeleted = !AFS::getItemTypeIfExists(sourceDescr.path); /*throw FileError*/ }
+                    catch (FileError&) {} //previous exception is more relevant
+
+                    if (!sourceWasDeleted)
+                        throw;
+                    result.sourceWasDeleted = true;
+                }
+                return result;
+            };
+
+            asyncOp.onSuccess = [this, &file](const AsyncFileOperations::Result& result, StatisticsReporter& statReporter)
+            {
+                if (result.sourceWasDeleted)
+                    file.removeObject<sideSrc>(); //source deleted meanwhile...nothing was done (logical point of view!)
+                else
+                {
+                    if (result.copyResult->errorModTime)
+                        errorsModTime_.push_back(*result.copyResult->errorModTime); //show all warnings later as a single message
+
+                    statReporter.reportDelta(1, 0);
+
+                    file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), result.copyResult->fileSize,
+                                              result.copyResult->modTime, //target time set from source
+                                              result.copyResult->modTime,
+                                              result.copyResult->targetFileId,
+                                              result.copyResult->sourceFileId,
+                                              false, file.isFollowedSymlink<sideSrc>());
+                }
+            };
+        }
+        break;
+
+        case SO_DELETE_LEFT:
+        case SO_DELETE_RIGHT:
+        {
+            const FileDescriptor targetDescr{ file.getAbstractPath<sideTrg>(), file.getAttributes<sideTrg>() };
+            const Zstring relPath = file.getPairRelativePath();
+            DeletionHandling& delHandling = getDelHandling<sideTrg>(); //thread-safe
+
+            reportInfo(delHandling.getTxtRemovingFile(), AFS::getDisplayPath(targetDescr.path));
+
+            op = [&delHandling, targetDescr, relPath](const AsyncFileOperations::NotifyProgress& notifyProgress)
+            {
+                delHandling.removeFileWithCallback(targetDescr, relPath,
+                                                   [&] { notifyProgress(1, 0); },
+                [&](int64_t bytesDelta) { notifyProgress(0, bytesDelta); }); //throw FileError
+                return AsyncFileOperations::Result();
+            };
+
+            asyncOp.onSuccess = [&file](const AsyncFileOperations::Result&, StatisticsReporter&)
+            {
+                file.removeObject<sideTrg>(); //update FilePair
+            };
+        }
+        break;
+
+        case SO_OVERWRITE_LEFT:
+        case SO_OVERWRITE_RIGHT:
+        {
+            if (file.isFollowedSymlink<sideTrg>()) //requires resolving and renaming the symlink first: rare => run synchronously
+                return false;
+
+            const FileDescriptor sourceDescr{ file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>() };
+            const FileDescriptor targetDescrOld{ file.getAbstractPath<sideTrg>(), file.getAttributes<sideTrg>() };
+            //respect differences in case of source object:
+            const AbstractPath targetPathNew = AFS::appendRelPath(file.parent().getAbstractPath<sideTrg>(), file.getItemName<sideSrc>());
+            const Zstring relPath = file.getPairRelativePath();
+            DeletionHandling& delHandling = getDelHandling<sideTrg>(); //thread-safe
+
+            reportInfo(txtOverwritingFile, AFS::getDisplayPath(targetDescrOld.path));
+
+            bytesExpected = file.getFileSize<sideSrc>();
+
+            op = [this, &delHandling, sourceDescr, targetDescrOld, targetPathNew, relPath](const AsyncFileOperations::NotifyProgress& notifyProgress)
+            {
+                auto notifyUnbufferedIO = [&](int64_t bytesDelta) { notifyProgress(0, bytesDelta); };
+
+                auto onDeleteTargetFile = [&] //delete target at appropriate time
+                {
+                    delHandling.removeFileWithCallback(targetDescrOld, relPath, [] {}, notifyUnbufferedIO); //throw FileError
+                    //no (logical) item count update desired - but total byte count may change, e.g. move(copy) deleted file to versioning dir
+                };
+
+                AsyncFileOperations::Result result;
+                result.copyResult = copyFileWithVerification(sourceDescr, targetPathNew,
+                                                             onDeleteTargetFile,
+                                                             notifyUnbufferedIO,
+                                                             nullptr,
+                [&](int64_t bytesDelta) { notifyProgress(0, 0); }); //throw FileError
+                return result;
+            };
+
+            asyncOp.onSuccess = [this, &file](const AsyncFileOperations::Result& result, StatisticsReporter& statReporter)
+            {
+                if (result.copyResult->errorModTime)
+                    errorsModTime_.push_back(*result.copyResult->errorModTime); //show all warnings later as a single message
+
+                statReporter.reportDelta(1, 0); //we model "delete + copy" as ONE logical operation
+
+                file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), result.copyResult->fileSize,
+                                          result.copyResult->modTime, //target time set from source
+                                          result.copyResult->modTime,
+                                          result.copyResult->targetFileId,
+                                          result.copyResult->sourceFileId,
+                                          false,
+                                          file.isFollowedSymlink<sideSrc>());
+            };
+        }
+        break;
+
+        case SO_MOVE_LEFT_TO:           //
+        case SO_MOVE_RIGHT_TO:          //updates "move source" elsewhere in the hierarchy
+        case SO_COPY_METADATA_TO_LEFT:  //
+        case SO_COPY_METADATA_TO_RIGHT: //cheap: no need for parallel execution
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_RIGHT_FROM:
+        case SO_DO_NOTHING:
+        case SO_EQUAL:
+        case SO_UNRESOLVED_CONFLICT:
+            return false;
+    }
+
+    asyncOp.file = &file;
+    asyncOp.statReporter = std::make_unique<StatisticsReporter>(1, bytesExpected, procCallback_);
+    asyncOp.opId = asyncOps_->addOperation(op);
+    asyncOpsPending_.push_back(std::move(asyncOp));
+
+    processAsyncResults(asyncOpsMax_); //throw X
+    return true;
+}
+
+
+void SynchronizeFolderPair::processAsyncResults(size_t pendingMax) //throw X
+{
+    for (;;)
+    {
+        for (auto it = asyncOpsPending_.begin(); it != asyncOpsPending_.end();)
+        {
+            const AsyncFileOperations::Status status = asyncOps_->fetchStatus(it->opId);
+            if (status.itemsDelta != 0 || status.bytesDelta != 0)
+                it->statReporter->reportDelta(status.itemsDelta, status.bytesDelta); //throw X
+
+            if (status.done)
+            {
+                AsyncFileOp asyncOp = std::move(*it);
+                it = asyncOpsPending_.erase(it);
+
+                bool firstAttempt = true;
+                tryReportingError([&]
+                {
+                    if (!firstAttempt) //retry synchronously
+                        return synchronizeFile(*asyncOp.file); //throw FileError
+                    firstAttempt = false;
+
+                    const std::unique_ptr<StatisticsReporter> statReporter = std::move(asyncOp.statReporter); //on error: fix statistics total during stack unwinding
+                    const AsyncFileOperations::Result result = asyncOps_->retrieveResult(asyncOp.opId); //throw FileError
+                    asyncOp.onSuccess(result, *statReporter);
+                }, procCallback_); //throw X
+            }
+            else
+                ++it;
+        }
+
+        if (asyncOpsPending_.size() <= pendingMax)
+            return;
+
+        asyncOps_->waitForProgress(std::chrono::milliseconds(UI_UPDATE_INTERVAL_MS / 2));
+        procCallback_.requestUiRefresh(); //throw X
+    }
+}
+
 
 inline
 void SynchronizeFolderPair::synchronizeLink(SymlinkPair& link)
@@ -1652,11 +2105,24 @@ AFS::FileCopyResult SynchronizeFolderPair::copyFileWithCallback(const FileDescri
                                                                 const AbstractPath& targetPath,
                                                                 const std::function<void()>& onDeleteTargetFile,
                                                                 const IOCallback& notifyUnbufferedIO) const //returns current attributes of source file
+{
+    return copyFileWithVerification(sourceDescr, targetPath, onDeleteTargetFile, notifyUnbufferedIO,
+    [&] { procCallback_.reportInfo(replaceCpy(txtVerifying, L"%x", fmtPath(AFS::getDisplayPath(targetPath)))); },
+    [&](int64_t bytesDelta) { procCallback_.requestUiRefresh(); });
+}
+
+
+AFS::FileCopyResult SynchronizeFolderPair::copyFileWithVerification(const FileDescriptor& sourceDescr, //throw FileError
+                                                                    const AbstractPath& targetPath,
+                                                                    const std::function<void()>& onDeleteTargetFile,
+                                                                    const IOCallback& notifyUnbufferedIO,
+                                                                    const std::function<void()>& onBeforeVerification,
+                                                                    const IOCallback& notifyVerificationIO) const
 {
     const AbstractPath& sourcePath = sourceDescr.path;
     const AFS::StreamAttributes sourceAttr{ sourceDescr.attr.modTime, sourceDescr.attr.fileSize, sourceDescr.attr.fileId };
 
-    auto copyOperation = [this, &sourceAttr, &targetPath, &onDeleteTargetFile, &notifyUnbufferedIO](const AbstractPath& sourcePathTmp)
+    auto copyOperation = [&](const AbstractPath& sourcePathTmp)
     {
         //target existing after onDeleteTargetFile(): undefined behavior! (fail/overwrite/auto-rename)
         const AFS::FileCopyResult result = AFS::copyFileTransactional(sourcePathTmp, sourceAttr, //throw FileError, ErrorFileLocked
@@ -1671,8 +2137,9 @@ AFS::FileCopyResult SynchronizeFolderPair::copyFileWithCallback(const FileDescri
             ZEN_ON_SCOPE_FAIL(try { AFS::removeFilePlain(targetPath); }
             catch (FileError&) {}); //delete target if verification fails
 
-            procCallback_.reportInfo(replaceCpy(txtVerifying, L"%x", fmtPath(AFS::getDisplayPath(targetPath))));
-            verifyFiles(sourcePathTmp, targetPath, [&](int64_t bytesDelta) { procCallback_.requestUiRefresh(); }); //throw FileError
+            if (onBeforeVerification)
+                onBeforeVerification();
+            verifyFiles(sourcePathTmp, targetPath, notifyVerificationIO); //throw FileError
         }
         //#################### /Verification #############################
 
@@ -1757,6 +2224,179 @@ enum class FolderPairJobType
     ALREADY_IN_SYNC,
     SKIP,
 };
+
+
+//the device a folder is stored on: volume ID for native paths (e.g. NAS mount points), device root otherwise
+struct SyncDevice
+{
+    AbstractPath deviceRoot;
+    VolumeId volumeId = 0;
+};
+bool operator==(const SyncDevice& lhs, const SyncDevice& rhs) { return AFS::equalAbstractPath(lhs.deviceRoot, rhs.deviceRoot) && lhs.volumeId == rhs.volumeId; }
+
+
+SyncDevice getSyncDevice(const AbstractPath& folderPath) //noexcept
+{
+    SyncDevice device = { AFS::getPathComponents(folderPath).rootPath };
+
+    for (Opt<AbstractPath> itemPath = folderPath; itemPath; itemPath = AFS::getParentFolderPath(*itemPath))
+        if (const Opt<Zstring> nativePath = AFS::getNativeItemPath(*itemPath))
+            try
+            {
+                device.volumeId = getVolumeId(*nativePath); //throw FileError
+                break;
+            }
+            catch (FileError&) {} //e.g. target folder not yet existing: use device of parent folder
+    return device;
+}
+
+
+//getVolumeId() may hang for non-existent network drives => run asynchronously with time-out: see getFolderStatusNonBlocking()
+std::map<AbstractPath, SyncDevice, AFS::LessAbstractPath> getSyncDevicesNonBlocking(const std::set<AbstractPath, AFS::LessAbstractPath>& folderPaths,
+                                                                                   int folderAccessTimeout, ProcessCallback& callback) //throw X
+{
+    std::list<std::pair<AbstractPath, std::future<SyncDevice>>> futureInfo;
+
+    for (const AbstractPath& folderPath : folderPaths)
+        futureInfo.emplace_back(folderPath, runAsync([folderPath] { return getSyncDevice(folderPath); })); //AbstractPath is thread-safe like an int!
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::map<AbstractPath, SyncDevice, AFS::LessAbstractPath> output;
+    for (auto& fi : futureInfo)
+    {
+        while (numeric::dist(std::chrono::steady_clock::now(), startTime) < std::chrono::seconds(folderAccessTimeout) && //handle potential chrono wrap-around!
+               fi.second.wait_for(std::chrono::milliseconds(UI_UPDATE_INTERVAL_MS / 2)) != std::future_status::ready)
+            callback.requestUiRefresh(); //throw X
+
+        if (isReady(fi.second))
+            output.emplace(fi.first, fi.second.get());
+        else //timeout: assume device root only => sync sequentially with all folders on the same root
+            output.emplace(fi.first, SyncDevice{ AFS::getPathComponents(fi.first).rootPath });
+    }
+    return output;
+}
+
+
+/*
+groups of folder pairs that may be synchronized in parallel: folder pairs within a group are synchronized sequentially
+    - folder pairs writing to the same device: parallel I/O on a single disk (or network share) would only slow down both
+    - folder pairs with dependent base folders, e.g. target of one is source of the other: keep behavior of sequential synchronization
+*/
+std::vector<std::vector<size_t>> getParallelSyncGroups(const FolderComparison& folderCmp, //returns folder pair indexes; groups ordered by their first folder pair
+                                                         const std::vector<FolderPairSyncCfg>& syncConfig,
+                                                         const std::vector<SyncStatistics>& folderPairStats,
+                                                         const std::vector<FolderPairJobType>& jobType,
+                                                         int folderAccessTimeout,
+                                                         ProcessCallback& callback) //throw X
+{
+    const NullFilter nullFilter;
+
+    struct FolderAccess
+    {
+        AbstractPath folderPath;
+        const HardFilter* filter;
+        bool writeAccess;
+    };
+    struct FolderPairAccess
+    {
+        size_t folderIndex;
+        std::vector<FolderAccess> folders;
+        std::vector<AbstractPath> targetFolders;
+        std::vector<AbstractPath> dbFolders; //sync.ffs_db is shared by all folder pairs of a base folder
+    };
+    std::vector<FolderPairAccess> folderPairs;
+
+    for (size_t folderIndex = 0; folderIndex < folderCmp.size(); ++folderIndex)
+        if (jobType[folderIndex] != FolderPairJobType::SKIP)
+        {
+            const BaseFolderPair& baseFolder = *folderCmp[folderIndex];
+            const FolderPairSyncCfg& folderPairCfg  = syncConfig     [folderIndex];
+            const SyncStatistics&    folderPairStat = folderPairStats[folderIndex];
+
+            FolderPairAccess fpAccess = { folderIndex };
+
+            auto addFolder = [&](const AbstractPath& folderPath, const HardFilter& filter, bool writeAccess)
+            {
+                if (!AFS::isNullPath(folderPath))
+                {
+                    fpAccess.folders.push_back({ folderPath, &filter, writeAccess });
+                    if (writeAccess)
+                        fpAccess.targetFolders.push_back(folderPath);
+                }
+            };
+            addFolder(baseFolder.getAbstractPath< LEFT_SIDE>(), baseFolder.getFilter(), folderPairStat.createCount< LEFT_SIDE>() +
+                      folderPairStat.updateCount< LEFT_SIDE>() +
+                      folderPairStat.deleteCount< LEFT_SIDE>() > 0);
+            addFolder(baseFolder.getAbstractPath<RIGHT_SIDE>(), baseFolder.getFilter(), folderPairStat.createCount<RIGHT_SIDE>() +
+                      folderPairStat.updateCount<RIGHT_SIDE>() +
+                      folderPairStat.deleteCount<RIGHT_SIDE>() > 0);
+
+            if (folderPairCfg.handleDeletion == DeletionPolicy::VERSIONING)
+                addFolder(createAbstractPath(folderPairCfg.versioningFolderPhrase), nullFilter, folderPairStat.updateCount() + folderPairStat.deleteCount() > 0);
+
+            if (folderPairCfg.saveSyncDB_)
+            {
+                fpAccess.dbFolders.push_back(baseFolder.getAbstractPath< LEFT_SIDE>());
+                fpAccess.dbFolders.push_back(baseFolder.getAbstractPath<RIGHT_SIDE>());
+            }
+            folderPairs.push_back(fpAccess);
+        }
+
+    std::set<AbstractPath, AFS::LessAbstractPath> targetFolders;
+    for (const FolderPairAccess& fpAccess : folderPairs)
+        targetFolders.insert(fpAccess.targetFolders.begin(), fpAccess.targetFolders.end());
+
+    const std::map<AbstractPath, SyncDevice, AFS::LessAbstractPath> targetDevices = getSyncDevicesNonBlocking(targetFolders, folderAccessTimeout, callback); //throw X
+
+    auto mustSyncSequentially = [&](const FolderPairAccess& lhs, const FolderPairAccess& rhs)
+    {
+        for (const AbstractPath& folderL : lhs.targetFolders)
+            for (const AbstractPath& folderR : rhs.targetFolders)
+                if (targetDevices.find(folderL)->second == targetDevices.find(folderR)->second)
+                    return true;
+
+        for (const FolderAccess& folderL : lhs.folders)
+            for (const FolderAccess& folderR : rhs.folders)
+                if (folderL.writeAccess || folderR.writeAccess)
+                    if (getPathDependency(folderL.folderPath, *folderL.filter,
+                                          folderR.folderPath, *folderR.filter))
+                        return true;
+
+        for (const AbstractPath& dbFolderL : lhs.dbFolders)
+            for (const AbstractPath& dbFolderR : rhs.dbFolders)
+                if (AFS::equalAbstractPath(dbFolderL, dbFolderR))
+                    return true;
+        return false;
+    };
+
+    //merge groups: a folder pair may link two groups that are otherwise independent
+    std::vector<size_t> groupIds(folderPairs.size()); //index of first folder pair in group
+    for (size_t i = 0; i < folderPairs.size(); ++i)
+    {
+        groupIds[i] = i;
+        for (size_t j = 0; j < i; ++j)
+            if (groupIds[j] != groupIds[i] && mustSyncSequentially(folderPairs[j], folderPairs[i]))
+            {
+                const size_t groupIdOld = std::max(groupIds[i], groupIds[j]);
+                const size_t groupIdNew = std::min(groupIds[i], groupIds[j]);
+                for (size_t& groupId : groupIds)
+                    if (groupId == groupIdOld)
+                        groupId = groupIdNew;
+            }
+    }
+
+    std::vector<std::vector<size_t>> groups;
+    std::map<size_t, size_t> groupPositions; //group ID => position in "groups"
+    for (size_t i = 0; i < folderPairs.size(); ++i)
+    {
+        auto it = groupPositions.emplace(groupIds[i], groups.size()).first;
+        if (it->second == groups.size())
+            groups.emplace_back();
+        groups[it->second].push_back(folderPairs[i].folderIndex);
+    }
+    return groups;
+}
 }
 
 
@@ -1767,6 +2407,8 @@ void zen::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                       bool failSafeFileCopy,
                       bool runWithBackgroundPriority,
                       int folderAccessTimeout,
+                      size_t syncThreadsPerFolderPair,
+                      size_t parallelFolderPairs,
                       const std::vector<FolderPairSyncCfg>& syncConfig,
                       FolderComparison& folderCmp,
                       xmlAccess::OptionalDialogs& warnings,
@@ -2100,37 +2742,39 @@ void zen::synchronize(const std::chrono::system_clock::time_point& syncStartTime
 
     //-------------------end of basic checks------------------------------------------
 
-    std::vector<FileError> errorsModTime; //show all warnings as a single message
+    std::vector<std::vector<FileError>> errorsModTime(folderCmp.size()); //show all warnings as a single message
 
     try
     {
-        //loop through all directory pairs
-        for (auto itBase = begin(folderCmp); itBase != end(folderCmp); ++itBase)
+        //context of main thread or folder pair worker thread: "cb" is the corresponding callback
+        auto synchronizeFolderPair = [&](size_t folderIndex, ProcessCallback& cb)
         {
-            BaseFolderPair& baseFolder = *itBase;
-            const size_t folderIndex = itBase - begin(folderCmp);
+            BaseFolderPair& baseFolder = *folderCmp[folderIndex];
             const FolderPairSyncCfg& folderPairCfg  = syncConfig     [folderIndex];
             const SyncStatistics&    folderPairStat = folderPairStats[folderIndex];
 
             if (jobType[folderIndex] == FolderPairJobType::SKIP) //folder pairs may be skipped after fatal errors were found
-                continue;
+                return;
+
+            //I/O statistics: this thread, sync and versioning worker threads inherit the binding
+            IoCountersScope ioScope(getIoCounters(baseFolder.getAbstractPath<LEFT_SIDE>(), baseFolder.getAbstractPath<RIGHT_SIDE>(), cb));
 
             //------------------------------------------------------------------------------------------
-            callback.reportInfo(_("Synchronizing folder pair:") + L" [" + getVariantName(folderPairCfg.syncVariant_) + L"]\n" +
-                                L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath< LEFT_SIDE>()) + L"\n" +
-                                L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath<RIGHT_SIDE>()));
+            cb.reportInfo(_("Synchronizing folder pair:") + L" [" + getVariantName(folderPairCfg.syncVariant_) + L"]\n" +
+                          L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath< LEFT_SIDE>()) + L"\n" +
+                          L"    " + AFS::getDisplayPath(baseFolder.getAbstractPath<RIGHT_SIDE>()));
             //------------------------------------------------------------------------------------------
 
             //checking a second time: (a long time may have passed since folder comparison!)
-            if (baseFolderDrop< LEFT_SIDE>(baseFolder, folderAccessTimeout, callback) ||
-                baseFolderDrop<RIGHT_SIDE>(baseFolder, folderAccessTimeout, callback))
-                continue;
+            if (baseFolderDrop< LEFT_SIDE>(baseFolder, folderAccessTimeout, cb) ||
+                baseFolderDrop<RIGHT_SIDE>(baseFolder, folderAccessTimeout, cb))
+                return;
 
             //create base folders if not yet existing
             if (folderPairStat.createCount() > 0 || folderPairCfg.saveSyncDB_) //else: temporary network drop leading to deletions already caught by "sourceFolderMissing" check!
-                if (!createBaseFolder< LEFT_SIDE>(baseFolder, folderAccessTimeout, callback) || //+ detect temporary network drop!!
-                    !createBaseFolder<RIGHT_SIDE>(baseFolder, folderAccessTimeout, callback))   //
-                    continue;
+                if (!createBaseFolder< LEFT_SIDE>(baseFolder, folderAccessTimeout, cb) || //+ detect temporary network drop!!
+                    !createBaseFolder<RIGHT_SIDE>(baseFolder, folderAccessTimeout, cb))   //
+                    return;
 
             //------------------------------------------------------------------------------------------
             //execute synchronization recursively
@@ -2159,7 +2803,7 @@ void zen::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                     !AFS::isNullPath(baseFolder.getAbstractPath<RIGHT_SIDE>()) && //
                     AFS::supportPermissionCopy(baseFolder.getAbstractPath<LEFT_SIDE>(),
                                                baseFolder.getAbstractPath<RIGHT_SIDE>()); //throw FileError
-                }, callback); //throw X?
+                }, cb); //throw X?
 
 
                 auto getEffectiveDeletionPolicy = [&](const AbstractPath& baseFolderPath) -> DeletionPolicy
@@ -2180,39 +2824,111 @@ void zen::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                                              getEffectiveDeletionPolicy(baseFolder.getAbstractPath<LEFT_SIDE>()),
                                              folderPairCfg.versioningFolderPhrase,
                                              folderPairCfg.versioningStyle_,
+                                             folderPairCfg.versionCountMax_,
+                                             folderPairCfg.versionMaxAgeDays_,
+                                             syncThreadsPerFolderPair,
                                              timeStamp,
-                                             callback);
+                                             cb);
 
                 DeletionHandling delHandlerR(baseFolder.getAbstractPath<RIGHT_SIDE>(),
                                              getEffectiveDeletionPolicy(baseFolder.getAbstractPath<RIGHT_SIDE>()),
                                              folderPairCfg.versioningFolderPhrase,
                                              folderPairCfg.versioningStyle_,
+                                             folderPairCfg.versionCountMax_,
+                                             folderPairCfg.versionMaxAgeDays_,
+                                             syncThreadsPerFolderPair,
                                              timeStamp,
-                                             callback);
+                                             cb);
 
 
-                SynchronizeFolderPair syncFP(callback, verifyCopiedFiles, copyPermissionsFp, failSafeFileCopy,
-                                             errorsModTime,
+                SynchronizeFolderPair syncFP(cb, verifyCopiedFiles, copyPermissionsFp, failSafeFileCopy,
+                                             syncThreadsPerFolderPair,
+                                             errorsModTime[folderIndex],
                                              delHandlerL, delHandlerR);
                 syncFP.startSync(baseFolder);
 
                 //(try to gracefully) cleanup temporary Recycle bin folders and versioning -> will be done in ~DeletionHandling anyway...
-                tryReportingError([&] { delHandlerL.tryCleanup(true /*allowUserCallback*/); /*throw FileError*/}, callback); //throw X?
-                tryReportingError([&] { delHandlerR.tryCleanup(true                      ); /*throw FileError*/}, callback); //throw X?
+                tryReportingError([&] { delHandlerL.tryCleanup(true /*allowUserCallback*/); /*throw FileError*/}, cb); //throw X?
+                tryReportingError([&] { delHandlerR.tryCleanup(true                      ); /*throw FileError*/}, cb); //throw X?
             }
 
             //(try to gracefully) write database file
             if (folderPairCfg.saveSyncDB_)
             {
-                callback.reportStatus(_("Generating database..."));
-                callback.forceUiRefresh();
+                cb.reportStatus(_("Generating database..."));
+                cb.forceUiRefresh();
 
                 tryReportingError([&]
                 {
                     zen::saveLastSynchronousState(baseFolder, //throw FileError
-                    [&](const std::wstring& statusMsg) { callback.reportStatus(statusMsg); /*throw X*/});
-                }, callback); //throw X
+                    [&](const std::wstring& statusMsg) { cb.reportStatus(statusMsg); /*throw X*/});
+                }, cb); //throw X
+            }
+        };
+
+        std::vector<std::vector<size_t>> syncGroups;
+        if (parallelFolderPairs > 1 && folderCmp.size() > 1)
+            syncGroups = getParallelSyncGroups(folderCmp, syncConfig, folderPairStats, jobType, folderAccessTimeout, callback); //throw X
+
+        if (syncGroups.size() <= 1)
+        {
+            //loop through all directory pairs
+            for (size_t folderIndex = 0; folderIndex < folderCmp.size(); ++folderIndex)
+                synchronizeFolderPair(folderIndex, callback); //throw X
+        }
+        else //synchronize groups of independent folder pairs in parallel: callbacks are forwarded by the main thread
+        {
+            const size_t threadCount = std::min(parallelFolderPairs, syncGroups.size());
+
+            std::vector<std::unique_ptr<AsyncProcessCallback>> asyncCallbacks;
+            std::vector<std::exception_ptr> workerErrors(threadCount); //e.g. std::bad_alloc
+            std::atomic<size_t> nextGroup{ 0 }; //std:atomic is uninitialized by default!
+
+            std::vector<InterruptibleThread> worker;
+            ZEN_ON_SCOPE_FAIL
+            (
+                for (InterruptibleThread& wt : worker)
+                wt.interrupt(); //interrupt all first, then join
+                for (InterruptibleThread& wt : worker)
+                    if (wt.joinable()) //= precondition of thread::join(), which throws an exception if violated!
+                        wt.join();     //in this context it is possible a thread is *not* joinable anymore due to the thread::try_join_for() below!
+                    );
+
+            for (size_t threadIdx = 0; threadIdx < threadCount; ++threadIdx)
+            {
+                asyncCallbacks.push_back(std::make_unique<AsyncProcessCallback>(callback.getIoStatistics()));
+                AsyncProcessCallback& acb = *asyncCallbacks.back();
+                std::exception_ptr& workerError = workerErrors[threadIdx];
+
+                worker.emplace_back([&]
+                {
+                    setCurrentThreadName("Sync Folder Pairs");
+                    try
+                    {
+                        for (size_t groupIdx = nextGroup++; groupIdx < syncGroups.size(); groupIdx = nextGroup++)
+                            for (size_t folderIndex : syncGroups[groupIdx])
+                                synchronizeFolderPair(folderIndex, acb); //throw ThreadInterruption
+                    }
+                    catch (ThreadInterruption&) { throw; }
+                    catch (...) { workerError = std::current_exception(); }
+                });
             }
+
+            //wait until done
+            for (InterruptibleThread& wt : worker)
+                while (!wt.tryJoinFor(std::chrono::milliseconds(UI_UPDATE_INTERVAL_MS / 2)))
+                {
+                    for (const std::unique_ptr<AsyncProcessCallback>& acb : asyncCallbacks)
+                        acb->forwardRequests(callback); //throw X
+                    callback.requestUiRefresh(); //throw X
+                }
+
+            for (const std::unique_ptr<AsyncProcessCallback>& acb : asyncCallbacks)
+                acb->forwardRequests(callback); //throw X: remaining statistics and messages
+
+            for (const std::exception_ptr& workerError : workerErrors)
+                if (workerError)
+                    std::rethrow_exception(workerError);
         }
 
         //------------------- show warnings after end of synchronization --------------------------------------
@@ -2220,14 +2936,15 @@ void zen::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         //TODO: mod time warnings are not shown if user cancelled sync before batch-reporting the warnings: problem?
 
         //show errors when setting modification time: warning, not an error
-        if (!errorsModTime.empty())
-        {
-            std::wstring msg;
-            for (const FileError& e : errorsModTime)
+        std::wstring msg;
+        for (const std::vector<FileError>& errorsFp : errorsModTime) //in order of folder pairs, even if synchronized in parallel
+            for (const FileError& e : errorsFp)
             {
                 std::wstring singleMsg = replaceCpy(e.toString(), L"\n\n", L"\n");
                 msg += singleMsg + L"\n\n";
             }
+        if (!msg.empty())
+        {
             msg.resize(msg.size() - 2);
 
             callback.reportWarning(msg, warnings.warnModificationTimeError); //throw X
@@ -2240,3 +2957,39 @@ void zen::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         throw std::logic_error("Contract violation! " + std::string(__FILE__) + ":" + numberTo<std::string>(__LINE__));
     }
 }
+
+
+void zen::limitVersions(const std::vector<FolderPairSyncCfg>& syncConfig, size_t threadCount, ProcessCallback& callback)
+{
+    callback.initNewPhase(-1, 0, ProcessCallback::PHASE_SYNCHRONIZING); //throw X; number of versions is not known in advance
+
+    std::set<AbstractPath, AFS::LessAbstractPath> versioningFoldersDone; //folder pairs may share a versioning folder
+
+    for (const FolderPairSyncCfg& folderPairCfg : syncConfig)
+        if (folderPairCfg.handleDeletion == DeletionPolicy::VERSIONING &&
+            folderPairCfg.versioningStyle_ == VersioningStyle::ADD_TIMESTAMP &&
+            (folderPairCfg.versionCountMax_ > 0 || folderPairCfg.versionMaxAgeDays_ > 0))
+        {
+            const AbstractPath versioningFolderPath = createAbstractPath(folderPairCfg.versioningFolderPhrase);
+            if (AFS::isNullPath(versioningFolderPath) || !versioningFoldersDone.insert(versioningFolderPath).second)
+                continue;
+
+            callback.reportInfo(_("Removing old versions...") + L" " + fmtPath(AFS::getDisplayPath(versioningFolderPath))); //throw X
+
+            //no folder pair involved: collect I/O statistics per versioning folder
+            IoStatistics* ioStats = callback.getIoStatistics();
+            IoCountersScope ioScope(ioStats ? &ioStats->getFolderPairCounters(AFS::getDisplayPath(versioningFolderPath), std::wstring()) : nullptr);
+
+            tryReportingError([&]
+            {
+                limitVersions(versioningFolderPath, folderPairCfg.versionCountMax_, folderPairCfg.versionMaxAgeDays_, threadCount, //throw FileError
+                              [&](const std::wstring& displayPath)
+                {
+                    if (!displayPath.empty())
+                        callback.reportStatus(replaceCpy(_("Deleting file %x"), L"%x", fmtPath(displayPath))); //throw X
+                    else
+                        callback.requestUiRefresh(); //throw X
+                });
+            }, callback); //throw X
+        }
+}
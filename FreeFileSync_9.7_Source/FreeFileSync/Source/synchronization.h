@@ -10,7 +10,7 @@
 //#include <zen/time.h>
 #include <chrono>
 #include "file_hierarchy.h"
-#include "lib/process_xml.h"
+#include "lib/optional_dialogs.h"
 #include "process_callback.h"
 
 
@@ -78,17 +78,23 @@ struct FolderPairSyncCfg
                       const DeletionPolicy handleDel,
                       VersioningStyle versioningStyle,
                       const Zstring& versioningPhrase,
+                      int versionCountMax,
+                      int versionMaxAgeDays,
                       DirectionConfig::Variant syncVariant) :
         saveSyncDB_(saveSyncDB),
         handleDeletion(handleDel),
         versioningStyle_(versioningStyle),
         versioningFolderPhrase(versioningPhrase),
+        versionCountMax_(versionCountMax),
+        versionMaxAgeDays_(versionMaxAgeDays),
         syncVariant_(syncVariant) {}
 
     bool saveSyncDB_; //save database if in automatic mode or dection of moved files is active
     DeletionPolicy handleDeletion;
     VersioningStyle versioningStyle_;
     Zstring versioningFolderPhrase; //unresolved directory names as entered by user!
+    int versionCountMax_;
+    int versionMaxAgeDays_;
     DirectionConfig::Variant syncVariant_;
 };
 std::vector<FolderPairSyncCfg> extractSyncCfg(const MainConfiguration& mainCfg);
@@ -102,10 +108,15 @@ void synchronize(const std::chrono::system_clock::time_point& syncStartTime,
                  bool failSafeFileCopy,
                  bool runWithBackgroundPriority,
                  int folderAccessTimeout,
+                 size_t syncThreadsPerFolderPair, //> 1: run file create/update/delete operations of a folder pair in parallel
+                 size_t parallelFolderPairs,      //> 1: synchronize folder pairs writing to different devices in parallel
                  const std::vector<FolderPairSyncCfg>& syncConfig, //CONTRACT: syncConfig and folderCmp correspond row-wise!
                  FolderComparison& folderCmp,                      //
                  xmlAccess::OptionalDialogs& warnings,
                  ProcessCallback& callback);
+
+//remove obsolete versions from the versioning folders without synchronizing, e.g. batch job scheduled separately
+void limitVersions(const std::vector<FolderPairSyncCfg>& syncConfig, size_t threadCount, ProcessCallback& callback);
 }
 
 #endif //SYNCHRONIZATION_H_8913470815943295
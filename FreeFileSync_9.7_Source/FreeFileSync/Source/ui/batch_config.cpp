@@ -162,6 +162,9 @@ BatchDialogConfig BatchDialog::getConfig() const
     dlgCfg.batchExCfg.logfilesCountLimit  = m_checkBoxSaveLog->GetValue() ? (m_checkBoxLogfilesLimit->GetValue() ? m_spinCtrlLogfileLimit->GetValue() : -1) : 0;
     //get single parameter "logfiles limit" from all three checkboxes and spin ctrl
 
+    dlgCfg.batchExCfg.cleanupVersionsOnly = dlgCfgOut_.batchExCfg.cleanupVersionsOnly; //not (yet) on GUI: keep value
+    dlgCfg.batchExCfg.saveIoStatistics    = dlgCfgOut_.batchExCfg.saveIoStatistics;    //
+
     return dlgCfg;
 }
 
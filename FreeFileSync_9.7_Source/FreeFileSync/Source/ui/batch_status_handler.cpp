@@ -30,6 +30,7 @@ std::unique_ptr<AFS::OutputStream> prepareNewLogfile(const AbstractPath& logFold
                                                      const std::wstring& jobName,
                                                      const std::chrono::system_clock::time_point& batchStartTime,
                                                      const std::wstring& failStatus,
+                                                     const Zchar* fileEnding, //".log" or ".json" (I/O statistics)
                                                      ProcessCallback& pc)
 {
     assert(!jobName.empty());
@@ -49,7 +50,7 @@ std::unique_ptr<AFS::OutputStream> prepareNewLogfile(const AbstractPath& logFold
                           Zstr(".") + printNumber<Zstring>(Zstr("%03d"), static_cast<int>(timeMs)); //[ms] should yield a fairly unique name
     if (!failStatus.empty())
         logFileName += utfTo<Zstring>(L" [" + failStatus + L"]");
-    logFileName += Zstr(".log");
+    logFileName += fileEnding;
 
     const AbstractPath logFilePath = AFS::appendRelPath(logFolderPath, logFileName);
 
@@ -115,6 +116,7 @@ void limitLogfileCount(const AbstractPath& logFolderPath, const std::wstring& jo
             try
             {
                 AFS::removeFilePlain(AFS::appendRelPath(logFolderPath, logFileName)); //throw FileError
+                AFS::removeFileIfExists(AFS::appendRelPath(logFolderPath, beforeLast(logFileName, Zstr('.'), IF_MISSING_RETURN_ALL) + Zstr(".json"))); //throw FileError; I/O statistics
             }
             catch (const FileError& e) { if (!lastError) lastError = e; };
 
@@ -143,7 +145,8 @@ BatchStatusHandler::BatchStatusHandler(bool showProgress,
                                        FfsReturnCode& returnCode,
                                        const Zstring& postSyncCommand,
                                        PostSyncCondition postSyncCondition,
-                                       PostSyncAction postSyncAction) :
+                                       PostSyncAction postSyncAction,
+                                       bool saveIoStatistics) :
     logfilesCountLimit_(logfilesCountLimit),
     lastSyncsLogFileSizeMax_(lastSyncsLogFileSizeMax),
     batchErrorDialog_(batchErrorDialog),
@@ -162,7 +165,8 @@ postSyncAction)),
                batchStartTime_(batchStartTime),
                logFolderPathPhrase_(logFolderPathPhrase),
                postSyncCommand_(postSyncCommand),
-               postSyncCondition_(postSyncCondition)
+               postSyncCondition_(postSyncCondition),
+               ioStats_(saveIoStatistics ? std::make_unique<IoStatistics>() : nullptr)
 {
     //ATTENTION: "progressDlg_" is an unmanaged resource!!! However, at this point we already consider construction complete! =>
     //ZEN_ON_SCOPE_FAIL( cleanup(); ); //destructor call would lead to member double clean-up!!!
@@ -179,6 +183,15 @@ BatchStatusHandler::~BatchStatusHandler()
     const int totalErrors   = errorLog_.getItemCount(TYPE_ERROR | TYPE_FATAL_ERROR); //evaluate before finalizing log
     const int totalWarnings = errorLog_.getItemCount(TYPE_WARNING);
 
+    //I/O statistics per folder pair: all worker threads have finished at this point
+    std::vector<IoStatistics::FolderPairStats> ioStats;
+    if (ioStats_)
+    {
+        ioStats = ioStats_->getStats();
+        for (const IoStatistics::FolderPairStats& fpStats : ioStats)
+            errorLog_.logMsg(formatIoStatistics(fpStats), TYPE_INFO);
+    }
+
     //finalize error log
     SyncProgressDialog::SyncResult finalStatus = SyncProgressDialog::RESULT_FINISHED_WITH_SUCCESS;
     std::wstring finalStatusMsg;
@@ -265,10 +278,19 @@ BatchStatusHandler::~BatchStatusHandler()
         {
             tryReportingError([&] //errors logged here do not impact final status calculation above! => not a problem!
             {
-                std::unique_ptr<AFS::OutputStream> logFileStream = prepareNewLogfile(logFolderPath, jobName_, batchStartTime_, failStatus, *this); //throw FileError; return value always bound!
+                std::unique_ptr<AFS::OutputStream> logFileStream = prepareNewLogfile(logFolderPath, jobName_, batchStartTime_, failStatus, Zstr(".log"), *this); //throw FileError; return value always bound!
 
                 streamToLogFile(summary, errorLog_, *logFileStream); //throw FileError, (X)
                 logFileStream->finalize();                           //throw FileError, (X)
+
+                if (ioStats_) //machine-readable side file next to the log file
+                {
+                    std::unique_ptr<AFS::OutputStream> jsonFileStream = prepareNewLogfile(logFolderPath, jobName_, batchStartTime_, failStatus, Zstr(".json"), *this); //throw FileError
+
+                    const std::string jsonStream = serializeIoStatisticsJson(ioStats);
+                    jsonFileStream->write(jsonStream.c_str(), jsonStream.size()); //throw FileError, (X)
+                    jsonFileStream->finalize();                                   //throw FileError, (X)
+                }
             }, *this); //throw X! by ProcessCallback!
         }
         catch (...) {}
@@ -359,6 +381,12 @@ BatchStatusHandler::~BatchStatusHandler()
 }
 
 
+IoStatistics* BatchStatusHandler::getIoStatistics()
+{
+    return ioStats_.get();
+}
+
+
 void BatchStatusHandler::initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessCallback::Phase phaseID)
 {
     StatusHandler::initNewPhase(itemsTotal, bytesTotal, phaseID);
@@ -14,6 +14,7 @@
 #include "../lib/status_handler.h"
 #include "../lib/process_xml.h"
 #include "../lib/return_codes.h"
+#include "../lib/io_stats.h"
 
 
 class BatchRequestSwitchToMainDialog {};
@@ -37,7 +38,8 @@ public:
                        zen::FfsReturnCode& returnCode,
                        const Zstring& postSyncCommand,
                        zen::PostSyncCondition postSyncCondition,
-                       xmlAccess::PostSyncAction postSyncAction);
+                       xmlAccess::PostSyncAction postSyncAction,
+                       bool saveIoStatistics);
     ~BatchStatusHandler();
 
     void initNewPhase       (int itemsTotal, int64_t bytesTotal, Phase phaseID) override;
@@ -49,6 +51,8 @@ public:
     Response reportError     (const std::wstring& errorMessage, size_t retryNumber   ) override;
     void     reportFatalError(const std::wstring& errorMessage                       ) override;
 
+    zen::IoStatistics* getIoStatistics() override;
+
 private:
     void onProgressDialogTerminate();
 
@@ -71,6 +75,8 @@ private:
     const Zstring logFolderPathPhrase_;
     const Zstring postSyncCommand_;
     const zen::PostSyncCondition postSyncCondition_;
+
+    const std::unique_ptr<zen::IoStatistics> ioStats_; //optional
 };
 
 #endif //BATCH_STATUS_HANDLER_H_857390451451234566
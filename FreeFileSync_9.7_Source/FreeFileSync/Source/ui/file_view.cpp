@@ -5,10 +5,14 @@
 // *****************************************************************************
 
 #include "file_view.h"
+#include <numeric>
+#include <limits>
 #include "sorting.h"
 #include "../synchronization.h"
 #include <zen/stl_tools.h>
 #include <zen/perf.h>
+#include <zen/thread.h>
+#include <zen/scope_guard.h>
 
 using namespace zen;
 
@@ -262,16 +266,21 @@ void FileView::removeInvalidRows()
 
     //remove rows that have been deleted meanwhile
     erase_if(sortedRef_, [&](const RefIndex& refIdx) { return !FileSystemObject::retrieve(refIdx.objId); });
+
+    //item names may have changed, too (e.g. after synchronization)
+    sortKeys_.clear();
+    for (size_t i = 0; i < sortedRef_.size(); ++i)
+        sortedRef_[i].keyIndex = static_cast<uint32_t>(i);
 }
 
 
 class FileView::SerializeHierarchy
 {
 public:
-    static void execute(ContainerObject& hierObj, std::vector<FileView::RefIndex>& sortedRef, size_t index) { SerializeHierarchy(sortedRef, index).recurse(hierObj); }
+    static void execute(ContainerObject& hierObj, std::vector<FileView::RefIndex>& sortedRef, uint32_t index) { SerializeHierarchy(sortedRef, index).recurse(hierObj); }
 
 private:
-    SerializeHierarchy(std::vector<FileView::RefIndex>& sortedRef, size_t index) :
+    SerializeHierarchy(std::vector<FileView::RefIndex>& sortedRef, uint32_t index) :
         index_(index),
         output_(sortedRef) {}
 #if  0
@@ -299,19 +308,19 @@ private:
     void recurse(ContainerObject& hierObj)
     {
         for (FilePair& file : hierObj.refSubFiles())
-            output_.push_back({ index_, file.getId() });
+            output_.push_back({ index_, static_cast<uint32_t>(output_.size()), file.getId() });
 
         for (SymlinkPair& symlink : hierObj.refSubLinks())
-            output_.push_back({ index_, symlink.getId() });
+            output_.push_back({ index_, static_cast<uint32_t>(output_.size()), symlink.getId() });
 
         for (FolderPair& folder : hierObj.refSubFolders())
         {
-            output_.push_back({ index_, folder.getId() });
+            output_.push_back({ index_, static_cast<uint32_t>(output_.size()), folder.getId() });
             recurse(folder); //add recursion here to list sub-objects directly below parent!
         }
     }
 
-    const size_t index_;
+    const uint32_t index_;
     std::vector<FileView::RefIndex>& output_;
 };
 
@@ -321,6 +330,7 @@ void FileView::setData(FolderComparison& folderCmp)
     //clear everything
     std::vector<FileSystemObject::ObjectId>().swap(viewRef_); //free mem
     std::vector<RefIndex>().swap(sortedRef_);                 //
+    sortKeys_.clear();                                        //
     currentSort_ = NoValue();
 
     folderPairCount_ = std::count_if(begin(folderCmp), end(folderCmp),
@@ -335,149 +345,302 @@ void FileView::setData(FolderComparison& folderCmp)
 }
 
 
-//------------------------------------ SORTING TEMPLATES ------------------------------------------------
-template <bool ascending, SelectedSide side>
-struct FileView::LessFullPath
+namespace
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+//don't bother with threads for small lists
+size_t getSortThreadCount(size_t itemCount) { return std::max<size_t>(std::min<size_t>(itemCount / 10000, std::thread::hardware_concurrency()), 1); }
 
-        return lessFullPath<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
 
+//call fun(0), ..., fun(threadCount - 1) in parallel: current thread executes fun(0)
+template <class Function>
+void runParallel(size_t threadCount, Function fun)
+{
+    std::vector<InterruptibleThread> worker;
+    ZEN_ON_SCOPE_EXIT(for (InterruptibleThread& wt : worker) wt.join());
 
-template <bool ascending>
-struct FileView::LessRelativeFolder
+    for (size_t i = 1; i < threadCount; ++i)
+        worker.emplace_back([fun, i]
+        {
+            setCurrentThreadName("Grid sort");
+            fun(i);
+        });
+    fun(0);
+}
+
+
+//sort ranges in parallel, then merge neighboring ranges (in parallel): stable if "sortRange" is stable
+template <class RandomAccessIterator, class SortRange, class Predicate>
+void parallelMergeSort(RandomAccessIterator first, RandomAccessIterator last, SortRange sortRange, Predicate less)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
-    {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+    const size_t itemCount = last - first;
+    const size_t threadCount = getSortThreadCount(itemCount);
 
-        //presort by folder pair
-        if (a.folderIndex != b.folderIndex)
-            return ascending ?
-                   a.folderIndex < b.folderIndex :
-                   a.folderIndex > b.folderIndex;
+    std::vector<size_t> bounds; //range i := [bounds[i], bounds[i + 1])
+    for (size_t i = 0; i <= threadCount; ++i)
+        bounds.push_back(itemCount * i / threadCount);
 
-        return lessRelativeFolder<ascending>(*fsObjA, *fsObjB);
+    runParallel(threadCount, [&](size_t i) { sortRange(first + bounds[i], first + bounds[i + 1], less); });
+
+    while (bounds.size() > 2)
+    {
+        runParallel((bounds.size() - 1) / 2, [&](size_t i)
+        {
+            std::inplace_merge(first + bounds[2 * i], first + bounds[2 * i + 1], first + bounds[2 * i + 2], less);
+        });
+
+        std::vector<size_t> boundsMerged;
+        for (size_t i = 0; i < bounds.size(); i += 2)
+            boundsMerged.push_back(bounds[i]);
+        if (boundsMerged.back() != itemCount) //odd number of ranges: last one wasn't merged
+            boundsMerged.push_back(itemCount);
+        bounds.swap(boundsMerged);
     }
+}
+
+
+struct NaturalSortItem
+{
+    uint64_t keyPrefix   = 0; //see getKeyPrefix()
+    uint32_t keyIndex    = 0;
+    uint32_t pos         = 0; //position in sortedRef_
+    uint32_t folderIndex = 0;
+    uint8_t  rank        = 0;
+    uint8_t  subRank     = 0;
 };
 
+//first 8 bytes of a key (big endian, zero-padded): prefixes are ordered like their keys unless equal
+//=> most comparisons are resolved without accessing the key list
+uint64_t getKeyPrefix(NaturalSortKeyRef key)
+{
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < sizeof(prefix); ++i)
+        prefix = prefix << 8 | (i < key.size ? static_cast<unsigned char>(key.data[i]) : 0);
+    return prefix;
+}
+
+
+struct RadixSortItem
+{
+    FixedSortKey key;
+    uint32_t pos = 0; //position in sortedRef_
+};
 
-template <bool ascending, SelectedSide side>
-struct FileView::LessShortFileName
+//LSD radix sort: stable, linear time; ~ 10x faster than std::sort() on FileSystemObject for large lists
+void radixSort(std::vector<RadixSortItem>& items)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
+    std::vector<RadixSortItem> buffer(items.size());
+
+    auto sortByByte = [&](auto getByte)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        size_t bucketPos[256] = {};
+        for (const RadixSortItem& item : items)
+            ++bucketPos[getByte(item)];
 
-        return lessShortFileName<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        if (std::any_of(std::begin(bucketPos), std::end(bucketPos), [&](size_t count) { return count == items.size(); }))
+            return; //all items in a single bucket: nothing to do, e.g. high bytes of file sizes
+
+        size_t offset = 0;
+        for (size_t& pos : bucketPos)
+            offset += std::exchange(pos, offset); //bucket count => bucket begin
 
+        for (const RadixSortItem& item : items)
+            buffer[bucketPos[getByte(item)]++] = item;
+        items.swap(buffer);
+    };
 
-template <bool ascending, SelectedSide side>
-struct FileView::LessFilesize
+    for (int i = 0; i < 8; ++i)
+        sortByByte([i](const RadixSortItem& item) { return static_cast<uint8_t>(item.key.value >> (8 * i)); });
+    sortByByte([](const RadixSortItem& item) { return item.key.rank; });
+}
+}
+
+
+template <SelectedSide side>
+void FileView::appendSortKey(const FileSystemObject& fsObj, SortKeyType type, std::string& keys)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
+    auto appendKey = [&](const Zstring& str) { appendNaturalSortKey(str.c_str(), str.size(), keys); };
+    switch (type)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
-
-        return lessFilesize<ascending, side>(*fsObjA, *fsObjB);
+        case SortKeyType::ITEM_NAME:
+            appendKey(fsObj.getItemName<side>());
+            break;
+        case SortKeyType::EXTENSION:
+            if (!isDirectoryPair(fsObj)) //directories are not sorted by extension
+                appendKey(afterLast(fsObj.getItemName<side>(), Zchar('.'), zen::IF_MISSING_RETURN_NONE));
+            break;
+        case SortKeyType::FULL_PATH:
+            if (!fsObj.isEmpty<side>())
+                appendKey(utfTo<Zstring>(AFS::getDisplayPath(fsObj.getAbstractPath<side>())));
+            break;
+        case SortKeyType::RELATIVE_FOLDER:
+            appendKey(isDirectoryPair(fsObj) ? fsObj.getPairRelativePath() : fsObj.parent().getPairRelativePath());
+            break;
+        case SortKeyType::PAIR_ITEM_NAME:
+            appendKey(fsObj.getPairItemName());
+            break;
     }
-};
+}
 
 
-template <bool ascending, SelectedSide side>
-struct FileView::LessFiletime
+const FileView::SortKeyList& FileView::getSortKeys(SortKeyType type, SelectedSide side)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
+    auto it = sortKeys_.find({ type, side });
+    if (it != sortKeys_.end())
+        return it->second;
+
+    std::vector<const FileSystemObject*> keyObjects(sortedRef_.size()); //keyIndex => FileSystemObject; nullptr for invalid rows
+    for (const RefIndex& ref : sortedRef_)
+        keyObjects[ref.keyIndex] = FileSystemObject::retrieve(ref.objId);
+
+    //build keys in parallel: each thread creates a consecutive range of keys
+    const size_t threadCount = getSortThreadCount(keyObjects.size());
+    std::vector<SortKeyList> keyRanges(threadCount);
+
+    runParallel(threadCount, [&](size_t rangeIdx)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        SortKeyList& range = keyRanges[rangeIdx];
+        const size_t first = keyObjects.size() *  rangeIdx      / threadCount;
+        const size_t last  = keyObjects.size() * (rangeIdx + 1) / threadCount;
+        range.keyEnds.reserve(last - first);
 
-        return lessFiletime<ascending, side>(*fsObjA, *fsObjB);
+        for (size_t i = first; i < last; ++i)
+        {
+            if (const FileSystemObject* fsObj = keyObjects[i])
+            {
+                if (side == LEFT_SIDE)
+                    appendSortKey<LEFT_SIDE>(*fsObj, type, range.keys);
+                else
+                    appendSortKey<RIGHT_SIDE>(*fsObj, type, range.keys);
+            }
+            range.keyEnds.push_back(range.keys.size());
+        }
+    });
+
+    SortKeyList& keyList = sortKeys_[{ type, side }];
+    keyList.keys.reserve(std::accumulate(keyRanges.begin(), keyRanges.end(), size_t(), [](size_t sum, const SortKeyList& range) { return sum + range.keys.size(); }));
+    keyList.keyEnds.reserve(keyObjects.size());
+
+    for (SortKeyList& range : keyRanges)
+    {
+        const size_t offset = keyList.keys.size();
+        keyList.keys += range.keys;
+        for (size_t keyEnd : range.keyEnds)
+            keyList.keyEnds.push_back(offset + keyEnd);
+        std::string().swap(range.keys); //free mem early
     }
-};
+    return keyList;
+}
 
+//------------------------------------ SORTING ------------------------------------------------
 
-template <bool ascending, SelectedSide side>
-struct FileView::LessExtension
+template <class Item, class InitItem>
+std::vector<Item> FileView::getSortItems(InitItem initItem) const
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
+    std::vector<Item> items(sortedRef_.size());
+
+    //resolve each FileSystemObject once instead of twice per comparison
+    const size_t threadCount = getSortThreadCount(items.size());
+    runParallel(threadCount, [&](size_t rangeIdx)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        const size_t first = items.size() *  rangeIdx      / threadCount;
+        const size_t last  = items.size() * (rangeIdx + 1) / threadCount;
+
+        for (size_t i = first; i < last; ++i)
+        {
+            items[i].pos = static_cast<uint32_t>(i);
+            initItem(items[i], FileSystemObject::retrieve(sortedRef_[i].objId), sortedRef_[i]);
+        }
+    });
+    return items;
+}
 
-        return lessExtension<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+
+template <class Item>
+void FileView::applySortOrder(const std::vector<Item>& sortedItems)
+{
+    std::vector<RefIndex> sortedRef;
+    sortedRef.reserve(sortedItems.size());
+    for (const Item& item : sortedItems)
+        sortedRef.push_back(sortedRef_[item.pos]);
+    sortedRef_.swap(sortedRef);
+}
 
 
-template <bool ascending>
-struct FileView::LessCmpResult
+void FileView::sortByNaturalKeys(GetSortRank getRank,    const SortKeyList& keys,
+                                 GetSortRank getSubRank, const SortKeyList* subKeys,
+                                 bool byFolderPair, bool ascending, bool stable)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
+    std::vector<NaturalSortItem> items = getSortItems<NaturalSortItem>([&](NaturalSortItem& item, const FileSystemObject* fsObj, const RefIndex& ref)
+    {
+        item.keyIndex    = ref.keyIndex;
+        item.folderIndex = ref.folderIndex;
+        item.keyPrefix   = getKeyPrefix(keys.getKey(ref.keyIndex));
+
+        if (!fsObj)
+            item.rank = std::numeric_limits<uint8_t>::max(); //invalid rows shall appear at the end
+        else
+        {
+            item.rank = getRank(*fsObj);
+            if (subKeys)
+                item.subRank = getSubRank(*fsObj);
+        }
+    });
+
+    auto compareKeys = [&](const NaturalSortItem& lhs, const NaturalSortItem& rhs)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
+        if (lhs.keyPrefix != rhs.keyPrefix)
+            return lhs.keyPrefix < rhs.keyPrefix ? -1 : 1;
+        return compareNaturalSortKeys(keys.getKey(lhs.keyIndex), keys.getKey(rhs.keyIndex));
+    };
+
+    auto less = [&](const NaturalSortItem& lhs, const NaturalSortItem& rhs)
+    {
+        if (lhs.rank != rhs.rank)
+            return lhs.rank < rhs.rank;
+        if (lhs.rank == std::numeric_limits<uint8_t>::max()) //invalid rows: no keys
             return false;
-        else if (!fsObjB)
-            return true;
 
-        return lessCmpResult<ascending>(*fsObjA, *fsObjB);
-    }
-};
+        if (byFolderPair && lhs.folderIndex != rhs.folderIndex)
+            return ascending ?
+                   lhs.folderIndex < rhs.folderIndex :
+                   lhs.folderIndex > rhs.folderIndex;
+
+        int rv = ascending ? compareKeys(lhs, rhs) : compareKeys(rhs, lhs);
+        if (rv != 0 || !subKeys)
+            return rv < 0;
+
+        if (lhs.subRank != rhs.subRank)
+            return lhs.subRank < rhs.subRank;
 
+        rv = compareNaturalSortKeys(subKeys->getKey(lhs.keyIndex), subKeys->getKey(rhs.keyIndex));
+        return ascending ? rv < 0 : rv > 0;
+    };
+
+    if (stable)
+        parallelMergeSort(items.begin(), items.end(), [](auto first, auto last, auto lessRange) { std::stable_sort(first, last, lessRange); }, less);
+    else
+        parallelMergeSort(items.begin(), items.end(), [](auto first, auto last, auto lessRange) { std::sort(first, last, lessRange); }, less);
+
+    applySortOrder(items);
+}
 
-template <bool ascending>
-struct FileView::LessSyncDirection
+
+template <class GetSortKey>
+void FileView::sortByFixedKey(GetSortKey getSortKey)
 {
-    bool operator()(const RefIndex a, const RefIndex b) const
+    std::vector<RadixSortItem> items = getSortItems<RadixSortItem>([&](RadixSortItem& item, const FileSystemObject* fsObj, const RefIndex& ref)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(a.objId);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(b.objId);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        if (fsObj)
+            item.key = getSortKey(*fsObj);
+        else
+            item.key.rank = std::numeric_limits<uint8_t>::max(); //invalid rows shall appear at the end
+    });
 
-        return lessSyncDirection<ascending>(*fsObjA, *fsObjB);
-    }
-};
+    radixSort(items);
+
+    applySortOrder(items);
+}
 
-//-------------------------------------------------------------------------------------------------------
 
 void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft, bool ascending)
 {
@@ -486,49 +649,49 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
     rowPositionsFirstChild_.clear();
     currentSort_ = SortInfo({ type, onLeft, ascending });
 
+    const SelectedSide side = onLeft ? LEFT_SIDE : RIGHT_SIDE;
+
     switch (type)
     {
         case ColumnTypeRim::ITEM_PATH:
             switch (pathFmt)
             {
                 case ItemPathFormat::FULL_PATH:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  LEFT_SIDE >());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  RIGHT_SIDE>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, LEFT_SIDE >());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, RIGHT_SIDE>());
+                    sortByNaturalKeys(onLeft ? getFullPathRank<LEFT_SIDE> : getFullPathRank<RIGHT_SIDE>, getSortKeys(SortKeyType::FULL_PATH, side),
+                                      nullptr, nullptr, false /*byFolderPair*/, ascending, false /*stable*/);
                     break;
 
                 case ItemPathFormat::RELATIVE_PATH:
-                    if      ( ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<true>());
-                    else if (!ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<false>());
-                    break;
+                {
+                    const SortKeyList& relFolderKeys = getSortKeys(SortKeyType::RELATIVE_FOLDER, LEFT_SIDE); //side doesn't matter
+                    const SortKeyList& nameKeys      = getSortKeys(SortKeyType::PAIR_ITEM_NAME,  LEFT_SIDE); //
+                    sortByNaturalKeys([](const FileSystemObject&) -> uint8_t { return 0; }, relFolderKeys,
+                                      getRelativeFolderSubRank, &nameKeys, true /*byFolderPair*/, ascending, false /*stable*/);
+                }
+                break;
 
                 case ItemPathFormat::ITEM_NAME:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<true,  LEFT_SIDE >());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<true,  RIGHT_SIDE>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<false, LEFT_SIDE >());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessShortFileName<false, RIGHT_SIDE>());
+                    sortByNaturalKeys(onLeft ? getShortFileNameRank<LEFT_SIDE> : getShortFileNameRank<RIGHT_SIDE>, getSortKeys(SortKeyType::ITEM_NAME, side),
+                                      nullptr, nullptr, false /*byFolderPair*/, ascending, false /*stable*/);
                     break;
             }
             break;
 
         case ColumnTypeRim::SIZE:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  LEFT_SIDE >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  RIGHT_SIDE>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, LEFT_SIDE >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, RIGHT_SIDE>());
+            if      ( ascending &&  onLeft) sortByFixedKey(getFilesizeSortKey<true,  LEFT_SIDE >);
+            else if ( ascending && !onLeft) sortByFixedKey(getFilesizeSortKey<true,  RIGHT_SIDE>);
+            else if (!ascending &&  onLeft) sortByFixedKey(getFilesizeSortKey<false, LEFT_SIDE >);
+            else if (!ascending && !onLeft) sortByFixedKey(getFilesizeSortKey<false, RIGHT_SIDE>);
             break;
         case ColumnTypeRim::DATE:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  LEFT_SIDE >());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  RIGHT_SIDE>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, LEFT_SIDE >());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, RIGHT_SIDE>());
+            if      ( ascending &&  onLeft) sortByFixedKey(getFiletimeSortKey<true,  LEFT_SIDE >);
+            else if ( ascending && !onLeft) sortByFixedKey(getFiletimeSortKey<true,  RIGHT_SIDE>);
+            else if (!ascending &&  onLeft) sortByFixedKey(getFiletimeSortKey<false, LEFT_SIDE >);
+            else if (!ascending && !onLeft) sortByFixedKey(getFiletimeSortKey<false, RIGHT_SIDE>);
             break;
         case ColumnTypeRim::EXTENSION:
-            if      ( ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  LEFT_SIDE >());
-            else if ( ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  RIGHT_SIDE>());
-            else if (!ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, LEFT_SIDE >());
-            else if (!ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, RIGHT_SIDE>());
+            sortByNaturalKeys(onLeft ? getExtensionRank<LEFT_SIDE> : getExtensionRank<RIGHT_SIDE>, getSortKeys(SortKeyType::EXTENSION, side),
+                              nullptr, nullptr, false /*byFolderPair*/, ascending, true /*stable*/);
             break;
     }
 }
@@ -8,6 +8,7 @@
 #define GRID_VIEW_H_9285028345703475842569
 
 #include <vector>
+#include <map>
 #include <unordered_map>
 #include "file_grid_attr.h"
 #include "../file_hierarchy.h"
@@ -99,6 +100,7 @@ public:
 
     void setData(FolderComparison& newData);
     void removeInvalidRows(); //remove references to rows that have been deleted meanwhile: call after manual deletion and synchronization!
+    void invalidateSortKeys() { sortKeys_.clear(); } //call after item names were changed by other means, e.g. zen::swapGrids()
 
     //sorting...
     void sortView(zen::ColumnTypeRim type, zen::ItemPathFormat pathFmt, bool onLeft, bool ascending); //always call this method for sorting, never sort externally!
@@ -123,14 +125,40 @@ private:
 
     struct RefIndex
     {
-        size_t folderIndex = 0; //because of alignment there's no benefit in using "unsigned int" in 64-bit code here!
+        uint32_t folderIndex = 0; //"unsigned int" + keyIndex fit into the alignment gap of 64-bit code
+        uint32_t keyIndex    = 0; //position in sortKeys_: fixed by setData()/removeInvalidRows(), unaffected by sorting
         FileSystemObject::ObjectId objId = nullptr;
     };
 
+    //precomputed CmpNaturalSort collation keys (see appendNaturalSortKey()): built on first sort by a column, reused by subsequent sorts
+    enum class SortKeyType
+    {
+        ITEM_NAME,
+        EXTENSION,
+        FULL_PATH,
+        RELATIVE_FOLDER, //side doesn't matter
+        PAIR_ITEM_NAME,  //
+    };
+
+    struct SortKeyList
+    {
+        NaturalSortKeyRef getKey(uint32_t keyIndex) const
+        {
+            const size_t keyBegin = keyIndex == 0 ? 0 : keyEnds[keyIndex - 1];
+            return { keys.data() + keyBegin, keyEnds[keyIndex] - keyBegin };
+        }
+
+        std::string keys;            //all keys concatenated
+        std::vector<size_t> keyEnds; //end position of each key in "keys"
+    };
+
+    const SortKeyList& getSortKeys(SortKeyType type, SelectedSide side);
+    template <SelectedSide side> static void appendSortKey(const FileSystemObject& fsObj, SortKeyType type, std::string& keys);
+
     template <class Predicate> void updateView(Predicate pred);
 
 
-    std::unordered_map<FileSystemObject::ObjectIdConst, size_t> rowPositions_; //find row positions on sortedRef directly
+    std::unordered_map<FileSystemObject::ObjectIdConst, size_t, ObjectHandle::Hash> rowPositions_; //find row positions on sortedRef directly
     std::unordered_map<const void*, size_t> rowPositionsFirstChild_; //find first child on sortedRef of a hierarchy object
     //void* instead of ContainerObject*: these are weak pointers and should *never be dereferenced*!
 
@@ -145,33 +173,27 @@ private:
     //std::shared_ptr<FolderComparison> folderCmp; //actual comparison data: owned by FileView!
     size_t folderPairCount_ = 0; //number of non-empty folder pairs
 
+    std::map<std::pair<SortKeyType, SelectedSide>, SortKeyList> sortKeys_; //cache: invalidated whenever sortedRef_ is rebuilt
 
-    class SerializeHierarchy;
-
-    //sorting classes
-    template <bool ascending, SelectedSide side>
-    struct LessFullPath;
 
-    template <bool ascending>
-    struct LessRelativeFolder;
-
-    template <bool ascending, SelectedSide side>
-    struct LessShortFileName;
+    class SerializeHierarchy;
 
-    template <bool ascending, SelectedSide side>
-    struct LessFilesize;
+    //sorting: extract packed items (one per row) in parallel, sort them, then reorder sortedRef_
+    template <class Item, class InitItem> //InitItem: void(Item& item, const FileSystemObject* fsObj /*nullptr for invalid rows*/, const RefIndex& ref)
+    std::vector<Item> getSortItems(InitItem initItem) const;
 
-    template <bool ascending, SelectedSide side>
-    struct LessFiletime;
+    template <class Item>
+    void applySortOrder(const std::vector<Item>& sortedItems);
 
-    template <bool ascending, SelectedSide side>
-    struct LessExtension;
+    using GetSortRank = uint8_t (*)(const FileSystemObject& fsObj);
 
-    template <bool ascending>
-    struct LessCmpResult;
+    //order by: rank, folder pair (optional), key, sub rank, sub key; ascending/descending applies to folder pair and keys only
+    void sortByNaturalKeys(GetSortRank getRank,    const SortKeyList& keys,
+                           GetSortRank getSubRank, const SortKeyList* subKeys, //optional
+                           bool byFolderPair, bool ascending, bool stable);
 
-    template <bool ascending>
-    struct LessSyncDirection;
+    template <class GetSortKey> //GetSortKey: FixedSortKey(const FileSystemObject&)
+    void sortByFixedKey(GetSortKey getSortKey);
 
     Opt<SortInfo> currentSort_;
 };
@@ -3715,6 +3715,10 @@ void MainDialog::OnCompare(wxCommandEvent& event)
                              true, //allowUserInteraction
                              globalCfg_.runWithBackgroundPriority,
                              globalCfg_.folderAccessTimeout,
+                             globalCfg_.traverserThreadsPerFolder,
+                             globalCfg_.contentCompareThreads,
+                             globalCfg_.contentCompareSkipUnchanged,
+                             nullptr, //changeList: GUI always compares all folders
                              globalCfg_.createLockFile,
                              dirLocks,
                              cmpConfig,
@@ -3940,6 +3944,8 @@ void MainDialog::OnStartSync(wxCommandEvent& event)
                     globalCfg_.failSafeFileCopy,
                     globalCfg_.runWithBackgroundPriority,
                     globalCfg_.folderAccessTimeout,
+                    globalCfg_.syncThreadsPerFolderPair,
+                    globalCfg_.syncParallelFolderPairs,
                     syncProcessCfg,
                     folderCmp_,
                     globalCfg_.optDialogs,
@@ -4076,6 +4082,7 @@ void MainDialog::OnSwapSides(wxCommandEvent& event)
     {
         showNotificationDialog(this, DialogInfoType::ERROR2, PopupDialogCfg().setDetailInstructions(e.toString()));
     }
+    filegrid::getDataView(*m_gridMainC).invalidateSortKeys(); //item names switched sides
 
     updateGui();
 }
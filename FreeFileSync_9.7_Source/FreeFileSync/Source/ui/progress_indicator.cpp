@@ -518,11 +518,12 @@ public:
         if (row < viewRef_.size())
         {
             const Line& line = viewRef_[row];
+            const LogEntry entry = log_[line.logPos_]; //decode lazily: log may be huge
 
             LogEntryView output;
-            output.time = line.logIt_->time;
-            output.type = line.logIt_->type;
-            output.messageLine = extractLine(line.logIt_->message, line.rowNumber_);
+            output.time = entry.time;
+            output.type = entry.type;
+            output.messageLine = extractLine(entry.message, line.rowNumber_);
             output.firstLine = line.rowNumber_ == 0; //this is virtually always correct, unless first line of the original message is empty!
             return output;
         }
@@ -533,7 +534,8 @@ public:
     {
         viewRef_.clear();
 
-        for (auto it = log_.begin(); it != log_.end(); ++it)
+        size_t logPos = 0;
+        for (auto it = log_.begin(); it != log_.end(); ++it, ++logPos)
             if (it->type & includedTypes)
             {
                 static_assert(IsSameType<GetCharType<MsgString>::Type, wchar_t>::value, "");
@@ -545,7 +547,7 @@ public:
                     if (c == L'\n')
                     {
                         if (!lastCharNewline) //do not reference empty lines!
-                            viewRef_.emplace_back(it, rowNumber);
+                            viewRef_.emplace_back(logPos, rowNumber);
                         ++rowNumber;
                         lastCharNewline = true;
                     }
@@ -553,7 +555,7 @@ public:
                         lastCharNewline = false;
 
                 if (!lastCharNewline)
-                    viewRef_.emplace_back(it, rowNumber);
+                    viewRef_.emplace_back(logPos, rowNumber);
             }
     }
 
@@ -580,9 +582,9 @@ private:
 
     struct Line
     {
-        Line(ErrorLog::const_iterator logIt, size_t rowNumber) : logIt_(logIt), rowNumber_(rowNumber) {}
+        Line(size_t logPos, size_t rowNumber) : logPos_(logPos), rowNumber_(rowNumber) {}
 
-        ErrorLog::const_iterator logIt_; //always bound!
+        size_t logPos_; //position in log_
         size_t rowNumber_; //LogEntry::message may span multiple rows
     };
 
@@ -31,170 +31,119 @@ bool isDirectoryPair(const FileSystemObject& fsObj)
 }
 
 
-template <bool ascending, SelectedSide side> inline
-bool lessShortFileName(const FileSystemObject& a, const FileSystemObject& b)
+/*
+grid sort order:
+    1. rank:     coarse order independent from sort direction, e.g. empty rows always last
+    2. sort key: natural sort keys (see appendNaturalSortKey()) or fixed-width values, ascending or descending
+*/
+
+//sort order: first files/symlinks, then directories then empty rows; then by short name
+template <SelectedSide side> inline
+uint8_t getShortFileNameRank(const FileSystemObject& fsObj)
 {
-    //sort order: first files/symlinks, then directories then empty rows
+    if (fsObj.isEmpty<side>())
+        return 2; //empty rows always last
 
-    //empty rows always last
-    if (a.isEmpty<side>())
-        return false;
-    else if (b.isEmpty<side>())
-        return true;
-
-    //directories after files/symlinks:
-    if (isDirectoryPair(a))
-    {
-        if (!isDirectoryPair(b))
-            return false;
-    }
-    else if (isDirectoryPair(b))
-        return true;
-
-    //sort directories and files/symlinks by short name
-    return makeSortDirection(LessNaturalSort() /*even on Linux*/, Int2Type<ascending>())(a.getItemName<side>(), b.getItemName<side>());
+    if (isDirectoryPair(fsObj))
+        return 1; //directories after files/symlinks
+    return 0;
 }
 
 
-template <bool ascending, SelectedSide side> inline
-bool lessFullPath(const FileSystemObject& a, const FileSystemObject& b)
+template <SelectedSide side> inline
+uint8_t getFullPathRank(const FileSystemObject& fsObj)
 {
-    //empty rows always last
-    if (a.isEmpty<side>())
-        return false;
-    else if (b.isEmpty<side>())
-        return true;
-
-    return makeSortDirection(LessNaturalSort() /*even on Linux*/, Int2Type<ascending>())(
-               utfTo<Zstring>(AFS::getDisplayPath(a.getAbstractPath<side>())),
-               utfTo<Zstring>(AFS::getDisplayPath(b.getAbstractPath<side>())));
+    return fsObj.isEmpty<side>() ? 1 : 0; //empty rows always last
 }
 
 
-template <bool ascending>  inline //side currently unused!
-bool lessRelativeFolder(const FileSystemObject& a, const FileSystemObject& b)
+//sort order: relative folder first (for files/symlinks: parent folder), then directories before contained files, then by item name
+inline
+uint8_t getRelativeFolderSubRank(const FileSystemObject& fsObj)
 {
-    const bool isDirectoryA = isDirectoryPair(a);
-    const Zstring& relFolderA = isDirectoryA ?
-                                a.getPairRelativePath() :
-                                a.parent().getPairRelativePath();
-
-    const bool isDirectoryB = isDirectoryPair(b);
-    const Zstring& relFolderB = isDirectoryB ?
-                                b.getPairRelativePath() :
-                                b.parent().getPairRelativePath();
-
-    //compare relative names without filepaths first
-    const int rv = CmpNaturalSort()(relFolderA.c_str(), relFolderA.size(),
-                                    relFolderB.c_str(), relFolderB.size());
-    if (rv != 0)
-        return makeSortDirection(std::less<int>(), Int2Type<ascending>())(rv, 0);
-
-    //make directories always appear before contained files
-    if (isDirectoryB)
-        return false;
-    else if (isDirectoryA)
-        return true;
-
-    return makeSortDirection(LessNaturalSort(), Int2Type<ascending>())(a.getPairItemName(), b.getPairItemName());
+    return isDirectoryPair(fsObj) ? 0 : 1;
 }
 
 
+//sort order: files/symlinks by extension, then directories (not sorted by extension) then empty rows
+template <SelectedSide side> inline
+uint8_t getExtensionRank(const FileSystemObject& fsObj)
+{
+    if (fsObj.isEmpty<side>())
+        return 2; //empty rows always last
+
+    if (isDirectoryPair(fsObj))
+        return 1; //directories last
+    return 0;
+}
+
+
+//fixed-width sort key: order by "rank", then by "value" => sort large lists by radix sort instead of comparing objects
+struct FixedSortKey
+{
+    uint8_t  rank  = 0;
+    uint64_t value = 0;
+};
+
+template <bool ascending> inline
+uint64_t getSortValue(uint64_t value) { return ascending ? value : ~value; }
+
+
 template <bool ascending, SelectedSide side> inline
-bool lessFilesize(const FileSystemObject& a, const FileSystemObject& b)
+FixedSortKey getFilesizeSortKey(const FileSystemObject& fsObj)
 {
     //empty rows always last
-    if (a.isEmpty<side>())
-        return false;
-    else if (b.isEmpty<side>())
-        return true;
+    if (fsObj.isEmpty<side>())
+        return { 3, 0 };
 
     //directories second last
-    if (isDirectoryPair(a))
-        return false;
-    else if (isDirectoryPair(b))
-        return true;
-
-    const FilePair* fileA = dynamic_cast<const FilePair*>(&a);
-    const FilePair* fileB = dynamic_cast<const FilePair*>(&b);
+    if (isDirectoryPair(fsObj))
+        return { 2, 0 };
 
     //then symlinks
-    if (!fileA)
-        return false;
-    else if (!fileB)
-        return true;
+    const FilePair* file = dynamic_cast<const FilePair*>(&fsObj);
+    if (!file)
+        return { 1, 0 };
 
     //return list beginning with largest files first
-    return makeSortDirection(std::less<>(), Int2Type<ascending>())(fileA->getFileSize<side>(), fileB->getFileSize<side>());
+    return { 0, getSortValue<ascending>(file->getFileSize<side>()) };
 }
 
 
 template <bool ascending, SelectedSide side> inline
-bool lessFiletime(const FileSystemObject& a, const FileSystemObject& b)
+FixedSortKey getFiletimeSortKey(const FileSystemObject& fsObj)
 {
-    if (a.isEmpty<side>())
-        return false; //empty rows always last
-    else if (b.isEmpty<side>())
-        return true; //empty rows always last
-
-    const FilePair* fileA = dynamic_cast<const FilePair*>(&a);
-    const FilePair* fileB = dynamic_cast<const FilePair*>(&b);
+    if (fsObj.isEmpty<side>())
+        return { 2, 0 }; //empty rows always last
 
-    const SymlinkPair* symlinkA = dynamic_cast<const SymlinkPair*>(&a);
-    const SymlinkPair* symlinkB = dynamic_cast<const SymlinkPair*>(&b);
+    const FilePair*    file    = dynamic_cast<const FilePair*   >(&fsObj);
+    const SymlinkPair* symlink = dynamic_cast<const SymlinkPair*>(&fsObj);
 
-    if (!fileA && !symlinkA)
-        return false; //directories last
-    else if (!fileB && !symlinkB)
-        return true; //directories last
+    if (!file && !symlink)
+        return { 1, 0 }; //directories last
 
-    const int64_t dateA = fileA ? fileA->getLastWriteTime<side>() : symlinkA->getLastWriteTime<side>();
-    const int64_t dateB = fileB ? fileB->getLastWriteTime<side>() : symlinkB->getLastWriteTime<side>();
+    const int64_t date = file ? file->getLastWriteTime<side>() : symlink->getLastWriteTime<side>();
 
     //return list beginning with newest files first
-    return makeSortDirection(std::less<>(), Int2Type<ascending>())(dateA, dateB);
-}
-
-
-template <bool ascending, SelectedSide side> inline
-bool lessExtension(const FileSystemObject& a, const FileSystemObject& b)
-{
-    if (a.isEmpty<side>())
-        return false; //empty rows always last
-    else if (b.isEmpty<side>())
-        return true; //empty rows always last
-
-    if (dynamic_cast<const FolderPair*>(&a))
-        return false; //directories last
-    else if (dynamic_cast<const FolderPair*>(&b))
-        return true; //directories last
-
-    auto getExtension = [](const FileSystemObject& fsObj)
-    {
-        return afterLast(fsObj.getItemName<side>(), Zchar('.'), zen::IF_MISSING_RETURN_NONE);
-    };
-
-    return makeSortDirection(LessNaturalSort() /*even on Linux*/, Int2Type<ascending>())(getExtension(a), getExtension(b));
+    return { 0, getSortValue<ascending>(static_cast<uint64_t>(date) ^ (1ULL << 63)) }; //flip sign bit: preserve signed order
 }
 
 
 template <bool ascending> inline
-bool lessCmpResult(const FileSystemObject& a, const FileSystemObject& b)
+FixedSortKey getCmpResultSortKey(const FileSystemObject& fsObj)
 {
     //presort result: equal shall appear at end of list
-    if (a.getCategory() == FILE_EQUAL)
-        return false;
-    if (b.getCategory() == FILE_EQUAL)
-        return true;
+    if (fsObj.getCategory() == FILE_EQUAL)
+        return { 1, 0 };
 
-    return makeSortDirection(std::less<CompareFilesResult>(), Int2Type<ascending>())(a.getCategory(), b.getCategory());
+    return { 0, getSortValue<ascending>(fsObj.getCategory()) };
 }
 
 
 template <bool ascending> inline
-bool lessSyncDirection(const FileSystemObject& a, const FileSystemObject& b)
+FixedSortKey getSyncDirectionSortKey(const FileSystemObject& fsObj)
 {
-    return makeSortDirection(std::less<>(), Int2Type<ascending>())(a.getSyncOperation(), b.getSyncOperation());
+    return { 0, getSortValue<ascending>(fsObj.getSyncOperation()) };
 }
 }
 
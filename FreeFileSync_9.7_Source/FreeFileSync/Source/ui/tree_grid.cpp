@@ -110,6 +110,8 @@ void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
         else
         {
             subDirCont.objId = folder.getId();
+            const Zstring& folderName = folder.getPairItemName();
+            appendNaturalSortKey(folderName.c_str(), folderName.size(), subDirCont.nameSortKey);
             compressNode(subDirCont);
         }
     }
@@ -212,23 +214,25 @@ struct TreeView::LessShortName
         if (lhs.type != rhs.type)       //
             return lhs.type < rhs.type; //shouldn't happen! root nodes not mixed with files or directories
 
+        auto getKey = [](const std::string& key) { return NaturalSortKeyRef{ key.c_str(), key.size() }; };
+
         switch (lhs.type)
         {
             case TreeView::TYPE_ROOT:
-                return makeSortDirection(LessNaturalSort() /*even on Linux*/, Int2Type<ascending>())(static_cast<const RootNodeImpl*>(lhs.node)->displayName,
-                        static_cast<const RootNodeImpl*>(rhs.node)->displayName);
+                return makeSortDirection(LessNaturalSortKey() /*even on Linux*/, Int2Type<ascending>())(getKey(static_cast<const RootNodeImpl*>(lhs.node)->nameSortKey),
+                        getKey(static_cast<const RootNodeImpl*>(rhs.node)->nameSortKey));
 
             case TreeView::TYPE_DIRECTORY:
             {
-                const auto* folderL = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(lhs.node)->objId));
-                const auto* folderR = dynamic_cast<const FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl*>(rhs.node)->objId));
+                const auto* dirL = static_cast<const DirNodeImpl*>(lhs.node);
+                const auto* dirR = static_cast<const DirNodeImpl*>(rhs.node);
 
-                if (!folderL)  //might be pathologic, but it's covered
+                if (!FileSystemObject::retrieve(dirL->objId)) //might be pathologic, but it's covered
                     return false;
-                else if (!folderR)
+                else if (!FileSystemObject::retrieve(dirR->objId))
                     return true;
 
-                return makeSortDirection(LessNaturalSort() /*even on Linux*/, Int2Type<ascending>())(folderL->getPairItemName(), folderR->getPairItemName());
+                return makeSortDirection(LessNaturalSortKey() /*even on Linux*/, Int2Type<ascending>())(getKey(dirL->nameSortKey), getKey(dirR->nameSortKey));
             }
 
             case TreeView::TYPE_FILES:
@@ -419,6 +423,7 @@ void TreeView::updateView(Predicate pred)
             root.baseFolder = baseObj;
             root.displayName = getShortDisplayNameForFolderPair(baseObj->getAbstractPath< LEFT_SIDE>(),
                                                                 baseObj->getAbstractPath<RIGHT_SIDE>());
+            appendNaturalSortKey(root.displayName.c_str(), root.displayName.size(), root.nameSortKey);
 
             this->compressNode(root); //"this->" required by two-pass lookup as enforced by GCC 4.7
         }
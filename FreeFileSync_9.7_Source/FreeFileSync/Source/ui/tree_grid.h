@@ -121,12 +121,14 @@ private:
     struct DirNodeImpl : public Container
     {
         FileSystemObject::ObjectId objId = nullptr; //weak pointer to FolderPair
+        std::string nameSortKey; //precomputed collation key of the folder name: see appendNaturalSortKey()
     };
 
     struct RootNodeImpl : public Container
     {
         std::shared_ptr<BaseFolderPair> baseFolder;
         Zstring displayName;
+        std::string nameSortKey; //collation key of displayName
     };
 
     enum NodeType
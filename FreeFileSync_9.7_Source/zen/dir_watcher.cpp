@@ -17,6 +17,7 @@
     #include <unistd.h> //close
     #include <limits.h> //NAME_MAX
     #include "file_traverser.h"
+    #include "file_access.h"
 
 
 using namespace zen;
@@ -24,17 +25,17 @@ using namespace zen;
 
 struct DirWatcher::Impl
 {
+    void addWatches(const Zstring& folderPath); //throw FileError: folder including subfolders
+
     int notifDescr = 0;
     std::map<int, Zstring> watchDescrs; //watch descriptor and (sub-)directory name (postfixed with separator) -> owned by "notifDescr"
 };
 
 
-DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
-    baseDirPath(dirPath),
-    pimpl_(std::make_unique<Impl>())
+void DirWatcher::Impl::addWatches(const Zstring& folderPath) //throw FileError
 {
     //get all subdirectories
-    std::vector<Zstring> fullFolderList { baseDirPath };
+    std::vector<Zstring> fullFolderList { folderPath };
     {
         std::function<void (const Zstring& path)> traverse;
 
@@ -46,30 +47,12 @@ DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
             [&](const std::wstring& errorMsg) { throw FileError(errorMsg); });
         };
 
-        traverse(baseDirPath);
+        traverse(folderPath);
     }
 
-    //init
-    pimpl_->notifDescr  = ::inotify_init();
-    if (pimpl_->notifDescr == -1)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath)), L"inotify_init");
-
-    ZEN_ON_SCOPE_FAIL( ::close(pimpl_->notifDescr); );
-
-    //set non-blocking mode
-    bool initSuccess = false;
-    {
-        int flags = ::fcntl(pimpl_->notifDescr, F_GETFL);
-        if (flags != -1)
-            initSuccess = ::fcntl(pimpl_->notifDescr, F_SETFL, flags | O_NONBLOCK) != -1;
-    }
-    if (!initSuccess)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath)), L"fcntl");
-
-    //add watches
     for (const Zstring& subDirPath : fullFolderList)
     {
-        int wd = ::inotify_add_watch(pimpl_->notifDescr, subDirPath.c_str(),
+        int wd = ::inotify_add_watch(notifDescr, subDirPath.c_str(),
                                      IN_ONLYDIR     | //"Only watch pathname if it is a directory."
                                      IN_DONT_FOLLOW | //don't follow symbolic links
                                      IN_CREATE      |
@@ -90,8 +73,33 @@ DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
             throw FileError(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(subDirPath)), formatSystemError(L"inotify_add_watch", ec));
         }
 
-        pimpl_->watchDescrs.emplace(wd, appendSeparator(subDirPath));
+        watchDescrs[wd] = appendSeparator(subDirPath); //existing wd is returned if the folder is already watched
+    }
+}
+
+
+DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
+    baseDirPath(dirPath),
+    pimpl_(std::make_unique<Impl>())
+{
+    //init
+    pimpl_->notifDescr  = ::inotify_init();
+    if (pimpl_->notifDescr == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath)), L"inotify_init");
+
+    ZEN_ON_SCOPE_FAIL( ::close(pimpl_->notifDescr); );
+
+    //set non-blocking mode
+    bool initSuccess = false;
+    {
+        int flags = ::fcntl(pimpl_->notifDescr, F_GETFL);
+        if (flags != -1)
+            initSuccess = ::fcntl(pimpl_->notifDescr, F_SETFL, flags | O_NONBLOCK) != -1;
     }
+    if (!initSuccess)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath)), L"fcntl");
+
+    pimpl_->addWatches(baseDirPath); //throw FileError
 }
 
 
@@ -128,7 +136,9 @@ std::vector<DirWatcher::Entry> DirWatcher::getChanges(const std::function<void()
     {
         struct ::inotify_event& evt = reinterpret_cast<struct ::inotify_event&>(buffer[bytePos]);
 
-        if (evt.len != 0) //exclude case: deletion of "self", already reported by parent directory watch
+        if (evt.mask & IN_Q_OVERFLOW) //events were lost: report the base folder as changed
+            output.emplace_back(ACTION_UPDATE, baseDirPath);
+        else if (evt.len != 0) //exclude case: deletion of "self", already reported by parent directory watch
         {
             auto it = pimpl_->watchDescrs.find(evt.wd);
             if (it != pimpl_->watchDescrs.end())
@@ -139,7 +149,21 @@ std::vector<DirWatcher::Entry> DirWatcher::getChanges(const std::function<void()
 
                 if ((evt.mask & IN_CREATE) ||
                     (evt.mask & IN_MOVED_TO))
+                {
                     output.emplace_back(ACTION_CREATE, fullname);
+
+                    //watch new subdirectories, too: changes made before the watch is in place are covered by the folder's creation notice
+                    if (evt.mask & IN_ISDIR)
+                        try
+                        {
+                            pimpl_->addWatches(fullname); //throw FileError
+                        }
+                        catch (FileError&)
+                        {
+                            if (dirAvailable(fullname)) //else: folder already deleted again => will be reported
+                                throw;
+                        }
+                }
                 else if ((evt.mask & IN_MODIFY) ||
                          (evt.mask & IN_CLOSE_WRITE))
                     output.emplace_back(ACTION_UPDATE, fullname);
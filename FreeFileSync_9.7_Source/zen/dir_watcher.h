@@ -28,8 +28,9 @@ namespace zen
              Renaming of top watched directory handled incorrectly: Not notified(!) + additional changes in subfolders
              now do report FILE_ACTION_MODIFIED for directory (check that should prevent this fails!)
 
-    Linux: newly added subdirectories are reported but not automatically added for watching! -> reset Dirwatcher!
+    Linux: newly added subdirectories are reported and added for watching by getChanges()
            removal of top watched directory is NOT notified!
+           event queue overflow is reported as an update of the top watched directory
 
     OS X: everything works as expected; renaming of top level folder is also detected
 
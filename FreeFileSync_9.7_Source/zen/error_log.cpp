@@ -0,0 +1,300 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "error_log.h"
+#include <cerrno>
+#include <unordered_map>
+#include "file_access.h"
+
+    #include <stdlib.h> //mkstemp
+    #include <unistd.h> //pread, write
+
+using namespace zen;
+
+
+namespace
+{
+const size_t ENTRIES_PER_INDEX_POS   = 64;               //trade memory of the position index vs. seek time for operator[]
+const size_t MEMORY_BYTES_MAX        = 4 * 1024 * 1024;  //spill stream to disk beyond this size
+const size_t READ_BLOCK_SIZE         = 64 * 1024;        //
+const size_t INTERNED_TEXT_COUNT_MAX = 10000;            //
+const size_t INTERNED_TEXT_SIZE_MAX  = 256;              //
+
+
+void writeVarint(std::string& stream, uint64_t num)
+{
+    while (num >= 0x80)
+    {
+        stream += static_cast<char>(num | 0x80);
+        num >>= 7;
+    }
+    stream += static_cast<char>(num);
+}
+
+
+uint64_t readVarint(const char*& it, const char* itEnd)
+{
+    uint64_t num = 0;
+    for (int shift = 0; it != itEnd && shift < 64; shift += 7)
+    {
+        const unsigned char c = *it++;
+        num |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            return num;
+    }
+    assert(false); //corrupted stream
+    return num;
+}
+
+
+int getTypeIndex(MessageType type)
+{
+    switch (type)
+    {
+        case TYPE_INFO:
+            return 0;
+        case TYPE_WARNING:
+            return 1;
+        case TYPE_ERROR:
+            return 2;
+        case TYPE_FATAL_ERROR:
+            return 3;
+    }
+    assert(false);
+    return 3;
+}
+}
+
+/*
+stream record format:
+    varint  time
+    byte    type
+    varint  id of interned text prefix, 0 if none
+    varint  text length
+    UTF-8   text (after interned prefix)
+*/
+class ErrorLog::Storage
+{
+public:
+    ~Storage() { if (spillFile_ != -1) ::close(spillFile_); }
+
+    void append(time_t time, MessageType type, const std::string& text)
+    {
+        if (entryCount_ % ENTRIES_PER_INDEX_POS == 0)
+            indexPos_.push_back(getStreamSize());
+        ++entryCount_;
+
+        //intern constant part of messages like: Creating file "<path>"
+        size_t internedId = 0;
+        size_t textPos = 0;
+        const size_t quotePos = text.find('\"');
+        if (quotePos != std::string::npos && quotePos < INTERNED_TEXT_SIZE_MAX)
+        {
+            const std::string prefix(text.begin(), text.begin() + quotePos + 1);
+
+            auto it = internedIds_.find(prefix);
+            if (it == internedIds_.end() && internedTexts_.size() < INTERNED_TEXT_COUNT_MAX)
+            {
+                internedTexts_.push_back(prefix);
+                it = internedIds_.emplace(prefix, internedTexts_.size()).first;
+            }
+            if (it != internedIds_.end())
+            {
+                internedId = it->second;
+                textPos = prefix.size();
+            }
+        }
+
+        writeVarint(memStream_, time < 0 ? 0 : time);
+        memStream_ += static_cast<char>(type);
+        writeVarint(memStream_, internedId);
+        writeVarint(memStream_, text.size() - textPos);
+        memStream_.append(text.begin() + textPos, text.end());
+
+        if (memStream_.size() > MEMORY_BYTES_MAX)
+            trySpillToDisk();
+    }
+
+    size_t size() const { return entryCount_; }
+
+    uint64_t getStreamSize() const { return spilledBytes_ + memStream_.size(); }
+
+    uint64_t getStreamPos(size_t entryPos) const //entryPos < size()
+    {
+        uint64_t streamPos = indexPos_[entryPos / ENTRIES_PER_INDEX_POS];
+        for (size_t i = 0; i < entryPos % ENTRIES_PER_INDEX_POS; ++i)
+            streamPos = readEntry(streamPos, nullptr);
+        return streamPos;
+    }
+
+    //return stream position of next entry
+    uint64_t readEntry(uint64_t streamPos, LogEntry* entry) const
+    {
+        const size_t headerSizeMax = 10 + 1 + 10 + 10;
+        const std::string header = readStream(streamPos, static_cast<size_t>(std::min<uint64_t>(headerSizeMax, getStreamSize() - streamPos)));
+
+        const char*       it    = header.c_str();
+        const char* const itEnd = header.c_str() + header.size();
+
+        const time_t time = static_cast<time_t>(readVarint(it, itEnd));
+        const MessageType type = it != itEnd ? static_cast<MessageType>(static_cast<unsigned char>(*it++)) : TYPE_INFO;
+        const size_t internedId = static_cast<size_t>(readVarint(it, itEnd));
+        const size_t textLen    = static_cast<size_t>(readVarint(it, itEnd));
+
+        const uint64_t textPos = streamPos + (it - header.c_str());
+        if (entry)
+        {
+            std::string text;
+            if (0 < internedId && internedId <= internedTexts_.size())
+                text = internedTexts_[internedId - 1];
+            text += readStream(textPos, textLen);
+
+            entry->time    = time;
+            entry->type    = type;
+            entry->message = utfTo<MsgString>(text);
+        }
+        return textPos + textLen;
+    }
+
+private:
+    std::string readStream(uint64_t streamPos, size_t len) const
+    {
+        std::string output;
+        while (len > 0 && streamPos < spilledBytes_) //spilled part
+        {
+            if (!(cachePos_ <= streamPos && streamPos < cachePos_ + cache_.size()))
+            {
+                cachePos_ = streamPos / READ_BLOCK_SIZE * READ_BLOCK_SIZE;
+                cache_.resize(static_cast<size_t>(std::min<uint64_t>(READ_BLOCK_SIZE, spilledBytes_ - cachePos_)));
+
+                const ssize_t bytesRead = ::pread(spillFile_, &cache_[0], cache_.size(), cachePos_);
+                if (bytesRead != static_cast<ssize_t>(cache_.size())) //"should never happen": temp file is ours and already fully written
+                {
+                    assert(false);
+                    cache_.clear();
+                    return output;
+                }
+            }
+            const size_t cacheOffset = static_cast<size_t>(streamPos - cachePos_);
+            const size_t bytesToCopy = std::min(len, cache_.size() - cacheOffset);
+            output.append(cache_.begin() + cacheOffset, cache_.begin() + cacheOffset + bytesToCopy);
+
+            streamPos += bytesToCopy;
+            len       -= bytesToCopy;
+        }
+
+        if (len > 0) //in-memory part
+        {
+            const size_t memOffset = static_cast<size_t>(streamPos - spilledBytes_);
+            output.append(memStream_, memOffset, len);
+        }
+        return output;
+    }
+
+    void trySpillToDisk() //best effort: keep stream in memory on failure
+    {
+        if (spillFile_ == -1)
+        {
+            Zstring tempFolderPath = Zstr("/tmp");
+            try { tempFolderPath = getTempFolderPath(); /*throw FileError*/ }
+            catch (FileError&) {}
+
+            const Zstring templatePath = appendSeparator(tempFolderPath) + Zstr("FFS-log-XXXXXX");
+            std::vector<char> filePath(templatePath.c_str(), templatePath.c_str() + templatePath.size() + 1);
+
+            spillFile_ = ::mkstemp(&filePath[0]);
+            if (spillFile_ == -1)
+                return;
+            ::unlink(&filePath[0]); //file is deleted by the OS once closed
+        }
+
+        size_t bytesWritten = 0;
+        while (bytesWritten < memStream_.size())
+        {
+            const ssize_t rv = ::write(spillFile_, memStream_.c_str() + bytesWritten, memStream_.size() - bytesWritten);
+            if (rv <= 0)
+            {
+                if (rv < 0 && errno == EINTR)
+                    continue;
+                //e.g. disk full: retry later; restore file position for next attempt
+                if (::ftruncate(spillFile_, spilledBytes_) != 0 ||
+                    ::lseek(spillFile_, spilledBytes_, SEEK_SET) < 0)
+                {
+                    ::close(spillFile_);
+                    spillFile_ = -1;
+                }
+                return;
+            }
+            bytesWritten += rv;
+        }
+
+        spilledBytes_ += memStream_.size();
+        memStream_.clear();
+        memStream_.shrink_to_fit();
+    }
+
+    size_t entryCount_ = 0;
+    std::vector<uint64_t> indexPos_; //stream position of every ENTRIES_PER_INDEX_POS'th entry
+
+    std::vector<std::string> internedTexts_;
+    std::unordered_map<std::string, size_t> internedIds_; //id = internedTexts_ position + 1
+
+    std::string memStream_; //stream bytes after spilledBytes_
+    uint64_t spilledBytes_ = 0;
+    int spillFile_ = -1;
+
+    mutable std::string cache_; //read cache for spilled part
+    mutable uint64_t cachePos_ = 0;
+};
+
+
+void ErrorLog::logMsgUtf8(const std::string& text, MessageType type)
+{
+    if (!storage_)
+        storage_ = std::make_shared<Storage>();
+    else if (storage_->getStreamSize() != streamSize_) //another copy has logged, too: don't mix logs
+    {
+        auto storageNew = std::make_shared<Storage>();
+        for (auto it = begin(); it != end(); ++it)
+            storageNew->append(it->time, it->type, utfTo<std::string>(it->message));
+        storage_ = storageNew;
+    }
+
+    storage_->append(std::time(nullptr), type, text);
+    entryCount_ = storage_->size();
+    streamSize_ = storage_->getStreamSize();
+    ++typeCount_[getTypeIndex(type)];
+}
+
+
+ErrorLog::const_iterator ErrorLog::begin() const { return const_iterator(storage_.get(), 0, streamSize_); }
+ErrorLog::const_iterator ErrorLog::end  () const { return const_iterator(storage_.get(), streamSize_, streamSize_); }
+
+
+LogEntry ErrorLog::operator[](size_t pos) const
+{
+    assert(pos < entryCount_);
+    LogEntry entry{};
+    storage_->readEntry(storage_->getStreamPos(pos), &entry);
+    return entry;
+}
+
+
+ErrorLog::const_iterator::const_iterator(const Storage* storage, uint64_t streamPos, uint64_t streamEnd) :
+    storage_(storage), streamPos_(streamPos), streamNext_(streamPos), streamEnd_(streamEnd)
+{
+    if (streamPos_ < streamEnd_)
+        streamNext_ = storage_->readEntry(streamPos_, &entry_);
+}
+
+
+ErrorLog::const_iterator& ErrorLog::const_iterator::operator++()
+{
+    streamPos_ = streamNext_;
+    if (streamPos_ < streamEnd_)
+        streamNext_ = storage_->readEntry(streamPos_, &entry_);
+    return *this;
+}
@@ -11,9 +11,12 @@
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <memory>
+#include <iterator>
 #include "time.h"
 #include "i18n.h"
 #include "string_base.h"
+#include "utf.h"
 
 
 namespace zen
@@ -39,6 +42,14 @@ template <class String>
 String formatMessage(const LogEntry& entry);
 
 
+/*
+memory-bounded log: think 1 million items
+    - entries are stored UTF-8 encoded; message text up to the first quoted parameter (e.g. 'Creating file "') is interned
+    - all but the most recent few MB are spilled to an (already deleted) temporary file
+    - entries are decoded lazily when iterating
+    - the log file is still written at the end of the run: its name and header depend on the final status
+    - copies are cheap: they share the append-only storage and see the entries logged up to the time of copying
+*/
 class ErrorLog
 {
 public:
@@ -48,13 +59,50 @@ public:
     int getItemCount(int typeFilter = TYPE_INFO | TYPE_WARNING | TYPE_ERROR | TYPE_FATAL_ERROR) const;
 
     //subset of std::vector<> interface:
-    using const_iterator = std::vector<LogEntry>::const_iterator;
-    const_iterator begin() const { return entries_.begin(); }
-    const_iterator end  () const { return entries_.end  (); }
-    bool empty() const { return entries_.empty(); }
+    class const_iterator;
+    const_iterator begin() const;
+    const_iterator end  () const;
+    bool empty() const { return entryCount_ == 0; }
+    size_t size() const { return entryCount_; }
+    LogEntry operator[](size_t pos) const; //decoding cost is independent of position
 
 private:
-    std::vector<LogEntry> entries_; //list of non-resolved errors and warnings
+    class Storage;
+    void logMsgUtf8(const std::string& text, MessageType type);
+
+    std::shared_ptr<Storage> storage_; //bound lazily
+    size_t   entryCount_ = 0; //snapshot of storage_
+    uint64_t streamSize_ = 0; //
+    int typeCount_[4] = {};
+};
+
+
+class ErrorLog::const_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = LogEntry;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const LogEntry*;
+    using reference         = const LogEntry&;
+
+    const LogEntry& operator* () const { return entry_; }
+    const LogEntry* operator->() const { return &entry_; }
+
+    const_iterator& operator++();
+
+    inline friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) { return lhs.streamPos_ == rhs.streamPos_; }
+    inline friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) { return !(lhs == rhs); }
+
+private:
+    friend class ErrorLog;
+    const_iterator(const Storage* storage, uint64_t streamPos, uint64_t streamEnd);
+
+    const Storage* storage_ = nullptr;
+    uint64_t streamPos_  = 0;
+    uint64_t streamNext_ = 0;
+    uint64_t streamEnd_  = 0;
+    LogEntry entry_{};
 };
 
 
@@ -69,15 +117,18 @@ private:
 template <class String> inline
 void ErrorLog::logMsg(const String& text, zen::MessageType type)
 {
-    const LogEntry newEntry = { std::time(nullptr), type, copyStringTo<MsgString>(text) };
-    entries_.push_back(newEntry);
+    logMsgUtf8(utfTo<std::string>(text), type);
 }
 
 
 inline
 int ErrorLog::getItemCount(int typeFilter) const
 {
-    return static_cast<int>(std::count_if(entries_.begin(), entries_.end(), [&](const LogEntry& e) { return e.type & typeFilter; }));
+    int itemCount = 0;
+    for (int i = 0; i < 4; ++i)
+        if (typeFilter & (1 << i))
+            itemCount += typeCount_[i];
+    return itemCount;
 }
 
 
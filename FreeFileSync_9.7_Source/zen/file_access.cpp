@@ -14,11 +14,15 @@
 #include "symlink_target.h"
 #include "file_id_def.h"
 #include "file_io.h"
+#include "stream_copy.h"
 #include "crc.h"  //boost dependency!
 #include "guid.h" //
 
     #include <sys/vfs.h> //statfs
     #include <sys/time.h> //lutimes
+    #include <sys/ioctl.h> //ioctl(FICLONE)
+    #include <sys/syscall.h> //kernel file copy
+    #include <linux/fs.h> //FICLONE
     #ifdef HAVE_SELINUX
         #include <selinux/selinux.h>
     #endif
@@ -167,6 +171,20 @@ uint64_t zen::getFileSize(const Zstring& filePath) //throw FileError
 }
 
 
+FileSignature zen::getFileSignature(const Zstring& filePath) //throw FileError
+{
+    struct ::stat fileInfo = {};
+    if (::stat(filePath.c_str(), &fileInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePath)), L"stat");
+
+    FileSignature sig;
+    sig.fileSize  = fileInfo.st_size;
+    sig.modTimeNs = static_cast<int64_t>(fileInfo.st_mtim.tv_sec) * 1000000000 + fileInfo.st_mtim.tv_nsec;
+    sig.fileId    = extractFileId(fileInfo);
+    return sig;
+}
+
+
 uint64_t zen::getFreeDiskSpace(const Zstring& path) //throw FileError, returns 0 if not available
 {
     struct ::statfs info = {};
@@ -593,13 +611,63 @@ void zen::copySymlink(const Zstring& sourceLink, const Zstring& targetLink, bool
 
 namespace
 {
+//let the kernel copy the file content: no user-space buffers, clone file extents (btrfs, XFS) or copy server-side (NFS 4.2, CIFS) if supported
+//return false if not supported: nothing was written in this case
+bool tryCopyFileContentKernel(int fdSource, int fdTarget, uint64_t sourceSize, //throw FileError, X
+                              const Zstring& sourceFile, const Zstring& targetFile,
+                              const IOCallback& notifyUnbufferedIO) //reports bytes copied
+{
+#ifdef FICLONE
+    if (::ioctl(fdTarget, FICLONE, fdSource) == 0) //all or nothing => copy-on-write metadata operation
+    {
+        if (notifyUnbufferedIO) notifyUnbufferedIO(sourceSize); //throw X
+        return true;
+    }
+#endif
+
+#ifdef __NR_copy_file_range //call kernel directly: glibc 2.27-2.29 emulates copy_file_range() in user space!
+    const size_t blockSize = 16 * 1024 * 1024; //limit time between progress notifications
+
+    loff_t offsetIn  = 0; //explicit offsets: don't touch file positions => buffered copy still possible as a fallback
+    loff_t offsetOut = 0; //
+    for (;;)
+    {
+        const ssize_t bytesCopied = ::syscall(__NR_copy_file_range, fdSource, &offsetIn, fdTarget, &offsetOut, blockSize, 0);
+        if (bytesCopied < 0)
+        {
+            const int ec = errno; //copy before making other system calls!
+            if (ec == EINTR)
+                continue;
+            if (offsetOut == 0 && (ec == ENOSYS     || //kernel < 4.5
+                                   ec == EXDEV      || //kernel < 5.3: source and target on different file systems
+                                   ec == EINVAL     || //
+                                   ec == EOPNOTSUPP || //file system without support
+                                   ec == EBADF))       //
+                return false;
+
+            throw FileError(replaceCpy(replaceCpy(_("Cannot copy file %x to %y."), L"%x", L"\n" + fmtPath(sourceFile)), L"%y", L"\n" + fmtPath(targetFile)),
+                            formatSystemError(L"copy_file_range", ec));
+        }
+
+        if (bytesCopied == 0) //EOF
+            //pseudo files (e.g. procfs) may report data with nothing to copy => use buffered copy instead
+            return offsetOut != 0 || sourceSize == 0;
+
+        if (notifyUnbufferedIO) notifyUnbufferedIO(bytesCopied); //throw X
+    }
+#endif
+    return false;
+}
+
+
 FileCopyResult copyFileOsSpecific(const Zstring& sourceFile, //throw FileError, ErrorTargetExisting
                                   const Zstring& targetFile,
                                   const IOCallback& notifyUnbufferedIO)
 {
     int64_t totalUnbufferedIO = 0;
+    AsyncIOCounter readIOCounter; //fileIn is read on a worker thread by bufferedStreamCopyPipelined()
 
-    FileInput fileIn(sourceFile, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError, (ErrorFileLocked -> Windows-only)
+    FileInput fileIn(sourceFile, readIOCounter.getCallback()); //throw FileError, (ErrorFileLocked -> Windows-only)
 
     struct ::stat sourceInfo = {};
     if (::fstat(fileIn.getHandle(), &sourceInfo) != 0)
@@ -630,7 +698,8 @@ FileCopyResult copyFileOsSpecific(const Zstring& sourceFile, //throw FileError,
     //fileOut.preAllocateSpaceBestEffort(sourceInfo.st_size); //throw FileError
     //=> perf: seems like no real benefit...
 
-    bufferedStreamCopy(fileIn, fileOut); //throw FileError, (ErrorFileLocked), X
+    if (!tryCopyFileContentKernel(fileIn.getHandle(), fdTarget, sourceInfo.st_size, sourceFile, targetFile, notifyUnbufferedIO)) //throw FileError, X
+        bufferedStreamCopyPipelined(fileIn, fileOut, readIOCounter, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError, (ErrorFileLocked), X
 
     //flush intermediate buffers before fiddling with the raw file handle
     fileOut.flushBuffers(); //throw FileError, X
@@ -62,6 +62,19 @@ void setFileTime(const Zstring& filePath, time_t modTime, ProcSymlink procSl); /
 uint64_t getFileSize(const Zstring& filePath); //throw FileError
 uint64_t getFreeDiskSpace(const Zstring& path); //throw FileError, returns 0 if not available
 VolumeId getVolumeId(const Zstring& itemPath); //throw FileError
+
+//detect file changes without reading the content, e.g. to validate data cached in memory
+struct FileSignature
+{
+    uint64_t fileSize  = 0;
+    int64_t  modTimeNs = 0; //[ns] since epoch: as precise as supported by the file system
+    FileId   fileId;        //changes when the file is replaced by renaming a temporary file
+};
+inline bool operator==(const FileSignature& lhs, const FileSignature& rhs) { return lhs.fileSize == rhs.fileSize && lhs.modTimeNs == rhs.modTimeNs && lhs.fileId == rhs.fileId; }
+inline bool operator!=(const FileSignature& lhs, const FileSignature& rhs) { return !(lhs == rhs); }
+
+FileSignature getFileSignature(const Zstring& filePath); //throw FileError
+
 //get per-user directory designated for temporary files:
 Zstring getTempFolderPath(); //throw FileError
 
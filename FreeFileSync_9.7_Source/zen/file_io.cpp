@@ -180,7 +180,24 @@ FileBase::FileHandle openHandleForWrite(const Zstring& filePath, FileOutput::Acc
 {
     //checkForUnsupportedType(filePath); -> not needed, open() + O_WRONLY should fail fast
 
-    const FileBase::FileHandle fileHandle = ::open(filePath.c_str(), O_WRONLY | O_CREAT | (access == FileOutput::ACC_CREATE_NEW ? O_EXCL : O_TRUNC),
+    const int accessFlags = [&]
+    {
+        switch (access)
+        {
+            case FileOutput::ACC_OVERWRITE:
+                return O_CREAT | O_TRUNC;
+            case FileOutput::ACC_CREATE_NEW:
+                return O_CREAT | O_EXCL;
+            case FileOutput::ACC_APPEND:
+                return O_CREAT | O_APPEND;
+            case FileOutput::ACC_APPEND_EXISTING:
+                return O_APPEND;
+        }
+        assert(false);
+        return O_CREAT | O_TRUNC;
+    }();
+
+    const FileBase::FileHandle fileHandle = ::open(filePath.c_str(), O_WRONLY | accessFlags,
                                                    S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH); //0666
     if (fileHandle == -1)
     {
@@ -78,7 +78,9 @@ public:
     enum AccessFlag
     {
         ACC_OVERWRITE,
-        ACC_CREATE_NEW
+        ACC_CREATE_NEW,
+        ACC_APPEND, //create if missing; every write() goes to the current end of file
+        ACC_APPEND_EXISTING //same as ACC_APPEND, but fail if missing
     };
     FileOutput(const Zstring& filePath, AccessFlag access, const IOCallback& notifyUnbufferedIO); //throw FileError, ErrorTargetExisting
     FileOutput(FileHandle handle, const Zstring& filePath, const IOCallback& notifyUnbufferedIO); //takes ownership!
@@ -0,0 +1,150 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef SHA256_H_8230957234857234
+#define SHA256_H_8230957234857234
+
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+
+namespace zen
+{
+//SHA-256 according to FIPS 180-4
+class Sha256
+{
+public:
+    void update(const void* data, size_t len);
+
+    template <class String>
+    String finalize(); //return binary digest (32 bytes); don't call update() afterwards!
+
+private:
+    void processBlock(const unsigned char* block);
+
+    uint32_t state_[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    unsigned char buffer_[64] = {};
+    size_t bufferSize_ = 0;
+    uint64_t bytesTotal_ = 0;
+};
+
+
+
+
+
+//------------------------- implementation -------------------------------
+namespace impl
+{
+inline uint32_t rotr(uint32_t val, int bits) { return (val >> bits) | (val << (32 - bits)); }
+}
+
+
+inline
+void Sha256::processBlock(const unsigned char* block)
+{
+    static const uint32_t k[64] =
+    {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    using impl::rotr;
+
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i)
+        w[i] = static_cast<uint32_t>(block[4 * i    ]) << 24 |
+               static_cast<uint32_t>(block[4 * i + 1]) << 16 |
+               static_cast<uint32_t>(block[4 * i + 2]) <<  8 |
+               static_cast<uint32_t>(block[4 * i + 3]);
+    for (int i = 16; i < 64; ++i)
+    {
+        const uint32_t s0 = rotr(w[i - 15],  7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >>  3);
+        const uint32_t s1 = rotr(w[i -  2], 17) ^ rotr(w[i -  2], 19) ^ (w[i -  2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+
+    for (int i = 0; i < 64; ++i)
+    {
+        const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+        const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+    state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+}
+
+
+inline
+void Sha256::update(const void* data, size_t len)
+{
+    const unsigned char* it = static_cast<const unsigned char*>(data);
+    bytesTotal_ += len;
+
+    if (bufferSize_ > 0)
+    {
+        const size_t bytesToCopy = std::min(len, sizeof(buffer_) - bufferSize_);
+        std::memcpy(buffer_ + bufferSize_, it, bytesToCopy);
+        bufferSize_ += bytesToCopy;
+        it          += bytesToCopy;
+        len         -= bytesToCopy;
+
+        if (bufferSize_ < sizeof(buffer_))
+            return;
+        processBlock(buffer_);
+        bufferSize_ = 0;
+    }
+
+    for (; len >= sizeof(buffer_); it += sizeof(buffer_), len -= sizeof(buffer_))
+        processBlock(it);
+
+    std::memcpy(buffer_, it, len);
+    bufferSize_ = len;
+}
+
+
+template <class String> inline
+String Sha256::finalize()
+{
+    const uint64_t bitsTotal = bytesTotal_ * 8;
+
+    const unsigned char padStart = 0x80;
+    update(&padStart, 1);
+    const unsigned char zero = 0;
+    while (bufferSize_ != 56)
+        update(&zero, 1);
+
+    unsigned char lengthBE[8] = {};
+    for (int i = 0; i < 8; ++i)
+        lengthBE[i] = static_cast<unsigned char>(bitsTotal >> (56 - 8 * i));
+    update(lengthBE, sizeof(lengthBE));
+
+    String digest;
+    for (uint32_t val : state_)
+        for (int shift = 24; shift >= 0; shift -= 8)
+            digest += static_cast<char>(static_cast<unsigned char>(val >> shift));
+    return digest;
+}
+}
+
+#endif //SHA256_H_8230957234857234
@@ -0,0 +1,223 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef STREAM_COPY_H_3490857234095723
+#define STREAM_COPY_H_3490857234095723
+
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include "serialize.h"
+#include "thread.h"
+
+
+namespace zen
+{
+//collect IO notifications of the reader thread: forwarded to the calling thread's IOCallback by bufferedStreamCopyPipelined()
+class AsyncIOCounter
+{
+public:
+    IOCallback getCallback() { return [this](int64_t bytesDelta) { bytesPending_ += bytesDelta; }; } //callback must not outlive AsyncIOCounter!
+
+    void forward(const IOCallback& notifyUnbufferedIO) { if (notifyUnbufferedIO) notifyUnbufferedIO(bytesPending_.exchange(0)); } //throw X
+
+private:
+    std::atomic<int64_t> bytesPending_{ 0 };
+};
+
+
+/*
+same as bufferedStreamCopy(), but read and write concurrently: streamIn is read on a worker thread while streamOut is written
+on the calling thread => source and target device are busy at the same time
+
+CONTRACT: streamIn must be constructed with readIOCounter.getCallback(): its notifications are forwarded to "notifyReadIO" on the calling thread
+          streamIn::read() must be callable from a different thread
+*/
+template <class BufferedInputStream, class BufferedOutputStream>
+void bufferedStreamCopyPipelined(BufferedInputStream& streamIn,   //throw X
+                                 BufferedOutputStream& streamOut, //
+                                 AsyncIOCounter& readIOCounter, const IOCallback& notifyReadIO);
+
+
+
+
+
+
+
+
+
+
+//-----------------------implementation-------------------------------
+namespace impl
+{
+//read stream on a separate thread: blocks are passed via a bounded queue; block size is adapted like StreamReader in lib/binary.cpp
+template <class BufferedInputStream>
+class AsyncBlockReader
+{
+public:
+    AsyncBlockReader(BufferedInputStream& streamIn, size_t defaultBlockSize)
+    {
+        reader_ = InterruptibleThread([this, &streamIn, defaultBlockSize]
+        {
+            setCurrentThreadName("Copy Reader");
+            try
+            {
+                size_t dynamicBlockSize = defaultBlockSize;
+                auto lastDelayViolation = std::chrono::steady_clock::now();
+                for (;;)
+                {
+                    std::vector<char> buffer;
+                    {
+                        std::unique_lock<std::mutex> dummy(lockBlocks_);
+                        interruptibleWait(conditionBlockTaken_, dummy, [this] { return blocks_.size() < BLOCKS_BUFFERED_MAX; }); //throw ThreadInterruption
+                        if (!freeBuffers_.empty()) //recycle buffers taken by the writer
+                        {
+                            buffer.swap(freeBuffers_.back());
+                            freeBuffers_.pop_back();
+                        }
+                    }
+                    buffer.resize(dynamicBlockSize);
+
+                    const auto startTime = std::chrono::steady_clock::now();
+                    const size_t bytesRead = streamIn.read(&buffer[0], dynamicBlockSize); //throw X; return "bytesToRead" bytes unless end of stream!
+                    const auto stopTime = std::chrono::steady_clock::now();
+
+                    buffer.resize(bytesRead);
+                    const bool eof = bytesRead < dynamicBlockSize;
+                    {
+                        std::lock_guard<std::mutex> dummy(lockBlocks_);
+                        blocks_.push_back(std::move(buffer));
+                        readerDone_ = eof;
+                        conditionBlockAdded_.notify_all();
+                    }
+                    if (eof)
+                        return;
+                    interruptionPoint(); //throw ThreadInterruption
+
+                    size_t proposedBlockSize = 0;
+                    const auto loopTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(stopTime - startTime).count();
+
+                    if (loopTimeMs >= 100)
+                        lastDelayViolation = stopTime;
+
+                    //avoid "flipping back": e.g. DVD-ROMs read 32MB at once, so first read may be > 500 ms, but second one will be 0ms!
+                    if (stopTime >= lastDelayViolation + std::chrono::seconds(2))
+                    {
+                        lastDelayViolation = stopTime;
+                        proposedBlockSize = dynamicBlockSize * 2;
+                    }
+                    if (loopTimeMs > 500)
+                        proposedBlockSize = dynamicBlockSize / 2;
+
+                    if (defaultBlockSize <= proposedBlockSize && proposedBlockSize <= BLOCK_SIZE_MAX)
+                        dynamicBlockSize = proposedBlockSize;
+                }
+            }
+            catch (ThreadInterruption&) { throw; }
+            catch (...) //e.g. FileError, ErrorFileLocked
+            {
+                std::lock_guard<std::mutex> dummy(lockBlocks_);
+                readError_ = std::current_exception();
+                readerDone_ = true;
+                conditionBlockAdded_.notify_all();
+            }
+        });
+    }
+
+    ~AsyncBlockReader()
+    {
+        reader_.interrupt();
+        reader_.join();
+    }
+
+    enum class BlockStatus
+    {
+        READY,
+        PENDING,
+        END_OF_STREAM,
+    };
+
+    //context of calling thread: return regularly (even if no data is available) to allow for progress notifications
+    BlockStatus takeBlock(std::vector<char>& buffer, std::chrono::milliseconds timeout) //throw X
+    {
+        std::unique_lock<std::mutex> dummy(lockBlocks_);
+        if (!conditionBlockAdded_.wait_for(dummy, timeout, [this] { return !blocks_.empty() || readerDone_; }))
+            return BlockStatus::PENDING;
+
+        if (!blocks_.empty())
+        {
+            freeBuffers_.push_back(std::move(buffer));
+            buffer = std::move(blocks_.front());
+            blocks_.pop_front();
+            conditionBlockTaken_.notify_all();
+            return BlockStatus::READY;
+        }
+        if (readError_)
+            std::rethrow_exception(readError_); //throw X
+        return BlockStatus::END_OF_STREAM;
+    }
+
+private:
+    AsyncBlockReader           (const AsyncBlockReader&) = delete;
+    AsyncBlockReader& operator=(const AsyncBlockReader&) = delete;
+
+    static const size_t BLOCKS_BUFFERED_MAX = 4;
+    static const size_t BLOCK_SIZE_MAX = 4 * 1024 * 1024; //limit memory: copy operations might run in parallel
+
+    std::mutex lockBlocks_;
+    std::condition_variable conditionBlockAdded_;
+    std::condition_variable conditionBlockTaken_;
+    std::deque<std::vector<char>> blocks_;
+    std::vector<std::vector<char>> freeBuffers_;
+    std::exception_ptr readError_;
+    bool readerDone_ = false;
+
+    InterruptibleThread reader_; //declare last: thread accesses members above!
+};
+}
+
+
+template <class BufferedInputStream, class BufferedOutputStream> inline
+void bufferedStreamCopyPipelined(BufferedInputStream& streamIn,   //throw X
+                                 BufferedOutputStream& streamOut, //
+                                 AsyncIOCounter& readIOCounter, const IOCallback& notifyReadIO)
+{
+    const size_t blockSize = streamIn.getBlockSize();
+    if (blockSize == 0)
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ":" + numberTo<std::string>(__LINE__));
+
+    //read first block on the calling thread: no need for a worker thread if the stream is small
+    std::vector<char> buffer(blockSize);
+    const size_t bytesRead = streamIn.read(&buffer[0], blockSize); //throw X; return "bytesToRead" bytes unless end of stream!
+    readIOCounter.forward(notifyReadIO); //throw X
+    streamOut.write(&buffer[0], bytesRead); //throw X
+
+    if (bytesRead < blockSize) //end of file
+        return;
+
+    using Reader = impl::AsyncBlockReader<BufferedInputStream>;
+    Reader reader(streamIn, blockSize);
+    for (;;)
+        switch (reader.takeBlock(buffer, std::chrono::milliseconds(100))) //throw X
+        {
+            case Reader::BlockStatus::READY:
+                readIOCounter.forward(notifyReadIO); //throw X
+                if (!buffer.empty())
+                    streamOut.write(&buffer[0], buffer.size()); //throw X
+                break;
+
+            case Reader::BlockStatus::PENDING: //slow source: still report progress (and allow the callback to abort)
+                readIOCounter.forward(notifyReadIO); //throw X
+                break;
+
+            case Reader::BlockStatus::END_OF_STREAM:
+                readIOCounter.forward(notifyReadIO); //throw X
+                return;
+        }
+}
+}
+
+#endif //STREAM_COPY_H_3490857234095723
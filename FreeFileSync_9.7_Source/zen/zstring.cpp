@@ -139,8 +139,56 @@ int cmpStringNaturalLinux(const char* lhs, size_t lhsLen, const char* rhs, size_
 }
 
 
-namespace
+void appendNaturalSortKey(const Zchar* str, size_t strLen, std::string& key)
 {
+    //tokens are encoded such that their byte order equals the order of cmpStringNaturalLinux():
+    //  whitespace: KEY_WHITE_SPACE (condensed)
+    //  number:     KEY_NUMBER, digit count (without leading zeros), digits
+    //  text:       KEY_TEXT, UTF-8 of towlower() for each code point, 0-terminator ("nothing" before "something")
+    //end of string is represented by the end of the key: "nothing" before "something"
+    const char KEY_WHITE_SPACE = 1;
+    const char KEY_NUMBER      = 2;
+    const char KEY_TEXT        = 3;
+    using namespace zen::implementation;
+
+    const char* it = str;
+    const char* const itEnd = str + strLen;
+    while (it != itEnd)
+        if (isWhiteSpace(*it))
+        {
+            key += KEY_WHITE_SPACE;
+            ++it;
+            while (it != itEnd && isWhiteSpace(*it)) ++it;
+        }
+        else if (isDigit(*it))
+        {
+            while (it != itEnd && *it == '0') ++it;
+            const char* const digitsBegin = it;
+            while (it != itEnd && isDigit(*it)) ++it;
+            const size_t digitCount = it - digitsBegin;
+
+            key += KEY_NUMBER;
+            if (digitCount < 0xff)
+                key += static_cast<char>(digitCount);
+            else //pathological, but preserve order: 0xff + 32-bit big endian count
+            {
+                key += static_cast<char>(0xff);
+                for (int i = 3; i >= 0; --i)
+                    key += static_cast<char>((digitCount >> (8 * i)) & 0xff);
+            }
+            key.append(digitsBegin, it);
+        }
+        else
+        {
+            const char* const textBegin = it++; //current char is neither white space nor digit at this point!
+            while (it != itEnd && !isWhiteSpace(*it) && !isDigit(*it)) ++it;
+
+            key += KEY_TEXT;
+            UtfDecoder<char> dec(textBegin, it - textBegin);
+            while (const Opt<CodePoint> cp = dec.getNext())
+                codePointToUtf8(static_cast<CodePoint>(::towlower(static_cast<wchar_t>(*cp))), [&](char c) { key += c; }); //UTF-8 preserves code point order
+            key += '\0';
+        }
 }
 
 
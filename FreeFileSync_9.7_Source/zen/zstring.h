@@ -30,6 +30,18 @@ struct CmpNaturalSort
     int operator()(const Zchar* lhs, size_t lhsLen, const Zchar* rhs, size_t rhsLen) const;
 };
 
+//binary collation key: comparing keys bytewise (memcmp + shorter first) gives the same order as CmpNaturalSort
+//=> sort large lists without re-decoding UTF-8 for each comparison
+void appendNaturalSortKey(const Zchar* str, size_t strLen, std::string& key);
+
+struct NaturalSortKeyRef //weak reference into a buffer of concatenated keys
+{
+    const char* data = nullptr;
+    size_t size = 0;
+};
+int compareNaturalSortKeys(NaturalSortKeyRef lhs, NaturalSortKeyRef rhs);
+struct LessNaturalSortKey { bool operator()(NaturalSortKeyRef lhs, NaturalSortKeyRef rhs) const { return compareNaturalSortKeys(lhs, rhs) < 0; } };
+
 
 struct LessFilePath
 {
@@ -126,6 +138,16 @@ int CmpFilePath::operator()(const Zchar* lhs, size_t lhsLen, const Zchar* rhs, s
 }
 
 
+inline
+int compareNaturalSortKeys(NaturalSortKeyRef lhs, NaturalSortKeyRef rhs)
+{
+    const int rv = std::memcmp(lhs.data, rhs.data, std::min(lhs.size, rhs.size)); //keys may contain 0: don't use strncmp!
+    if (rv != 0)
+        return rv;
+    return static_cast<int>(lhs.size > rhs.size) - static_cast<int>(lhs.size < rhs.size);
+}
+
+
 template <class S, class T, class U> inline
 S ciReplaceCpy(const S& str, const T& oldTerm, const U& newTerm)
 {